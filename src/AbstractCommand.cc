@@ -67,6 +67,7 @@
 #include "error_code.h"
 #include "SocketRecvBuffer.h"
 #include "ChecksumCheckIntegrityEntry.h"
+#include "metrics.h"
 #ifdef ENABLE_ASYNC_DNS
 #  include "AsyncNameResolver.h"
 #  include "AsyncNameResolverMan.h"
@@ -341,6 +342,12 @@ bool AbstractCommand::execute()
     }
 
     addCommandSelf();
+    // Nothing to do until an I/O event arrives or the timeout expires.
+    // The state of the download is still checked every 10 seconds.
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        checkPoint_.difference(global::wallclock()));
+    e_->sleepCommand(this, std::min<std::chrono::milliseconds>(
+                               timeout_ - elapsed, 10_s));
     return false;
   }
   catch (DlAbortEx& err) {
@@ -767,6 +774,7 @@ std::string AbstractCommand::resolveHostname(std::vector<std::string>& addrs,
 
   e_->findAllCachedIPAddresses(std::back_inserter(addrs), hostname, port);
   if (!addrs.empty()) {
+    metrics::countDnsCacheHit();
     auto ipaddr = addrs.front();
     A2_LOG_INFO(fmt(MSG_DNS_CACHE_HIT, getCuid(), hostname.c_str(),
                     strjoin(std::begin(addrs), std::end(addrs), ", ").c_str()));
@@ -813,6 +821,7 @@ std::string AbstractCommand::resolveHostname(std::vector<std::string>& addrs,
     }
     res.resolve(addrs, hostname);
   }
+  metrics::countDnsLookup();
   A2_LOG_INFO(fmt(MSG_NAME_RESOLUTION_COMPLETE, getCuid(), hostname.c_str(),
                   strjoin(std::begin(addrs), std::end(addrs), ", ").c_str()));
   for (const auto& addr : addrs) {
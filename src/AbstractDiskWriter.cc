@@ -42,6 +42,7 @@
 
 #include <cerrno>
 #include <cstring>
+#include <vector>
 #include <cassert>
 
 #include "File.h"
@@ -53,6 +54,15 @@
 #include "DownloadFailureException.h"
 #include "error_code.h"
 #include "LogFactory.h"
+#include "TimerA2.h"
+#include "metrics.h"
+#include "Tracer.h"
+#ifdef HAVE_SENDFILE
+#  include "FileHandle.h"
+#endif // HAVE_SENDFILE
+#ifdef ENABLE_ASYNC_DISK_WRITE
+#  include "DiskWriteQueue.h"
+#endif // ENABLE_ASYNC_DISK_WRITE
 
 namespace aria2 {
 
@@ -130,6 +140,18 @@ void AbstractDiskWriter::openFile(int64_t totalLength)
 
 void AbstractDiskWriter::closeFile()
 {
+#ifdef ENABLE_ASYNC_DISK_WRITE
+  if (writeQueue_) {
+    // This function is called from the destructor, so just log the
+    // error here.
+    writeQueue_->wait(writeFile_);
+    int errNum = writeQueue_->takeError(writeFile_);
+    if (errNum != 0) {
+      A2_LOG_ERROR(
+          fmt(EX_FILE_WRITE, filename_.c_str(), fileStrerror(errNum).c_str()));
+    }
+  }
+#endif // ENABLE_ASYNC_DISK_WRITE
 #if defined(HAVE_MMAP) || defined(__MINGW32__)
   if (mapaddr_) {
     int errNum = 0;
@@ -156,6 +178,9 @@ void AbstractDiskWriter::closeFile()
     maplen_ = 0;
   }
 #endif // HAVE_MMAP || defined __MINGW32__
+#ifdef HAVE_SENDFILE
+  fileHandle_.reset();
+#endif // HAVE_SENDFILE
   if (fd_ != A2_BAD_FD) {
 #ifdef __MINGW32__
     CloseHandle(fd_);
@@ -290,6 +315,42 @@ ssize_t AbstractDiskWriter::writeDataInternal(const unsigned char* data,
   }
 }
 
+#ifdef HAVE_PWRITEV
+ssize_t AbstractDiskWriter::writeDataVecInternal(const a2iovec* iov,
+                                                 size_t iovcnt, int64_t offset)
+{
+  // pwritev may write partially, so work on a copy of iov which is
+  // advanced past the written bytes.
+  std::vector<a2iovec> v(iov, iov + iovcnt);
+  auto first = v.data();
+  auto last = first + iovcnt;
+  ssize_t writtenLength = 0;
+  while (first != last) {
+    ssize_t ret;
+    while ((ret = pwritev(fd_, first,
+                          std::min(static_cast<size_t>(last - first),
+                                   static_cast<size_t>(A2_IOV_MAX)),
+                          offset)) == -1 &&
+           errno == EINTR)
+      ;
+    if (ret == -1) {
+      return -1;
+    }
+    writtenLength += ret;
+    offset += ret;
+    for (; first != last && static_cast<size_t>(ret) >= first->iov_len;
+         ++first) {
+      ret -= first->iov_len;
+    }
+    if (ret > 0) {
+      first->iov_base = static_cast<char*>(first->iov_base) + ret;
+      first->iov_len -= ret;
+    }
+  }
+  return writtenLength;
+}
+#endif // HAVE_PWRITEV
+
 ssize_t AbstractDiskWriter::readDataInternal(unsigned char* data, size_t len,
                                              int64_t offset)
 {
@@ -441,32 +502,118 @@ bool isDiskFullError(int errNum)
 }
 } // namespace
 
+namespace {
+void throwWriteError(const std::string& filename, int errNum)
+{
+  // If the error indicates disk full situation, throw
+  // DownloadFailureException and abort download instantly.
+  if (isDiskFullError(errNum)) {
+    throw DOWNLOAD_FAILURE_EXCEPTION3(
+        errNum,
+        fmt(EX_FILE_WRITE, filename.c_str(), fileStrerror(errNum).c_str()),
+        error_code::NOT_ENOUGH_DISK_SPACE);
+  }
+  else {
+    throw DL_ABORT_EX3(
+        errNum,
+        fmt(EX_FILE_WRITE, filename.c_str(), fileStrerror(errNum).c_str()),
+        error_code::FILE_IO_ERROR);
+  }
+}
+} // namespace
+
+#ifdef ENABLE_ASYNC_DISK_WRITE
+void AbstractDiskWriter::waitAsyncWrite()
+{
+  if (writeQueue_) {
+    writeQueue_->wait(writeFile_);
+    int errNum = writeQueue_->takeError(writeFile_);
+    if (errNum != 0) {
+      throwWriteError(filename_, errNum);
+    }
+  }
+}
+
+void AbstractDiskWriter::waitAsyncWrite(int64_t offset, size_t len)
+{
+  if (writeQueue_) {
+    writeQueue_->wait(writeFile_, offset, len);
+    int errNum = writeQueue_->takeError(writeFile_);
+    if (errNum != 0) {
+      throwWriteError(filename_, errNum);
+    }
+  }
+}
+#endif // ENABLE_ASYNC_DISK_WRITE
+
 void AbstractDiskWriter::writeData(const unsigned char* data, size_t len,
                                    int64_t offset)
 {
+#ifdef ENABLE_ASYNC_DISK_WRITE
+  if (writeQueue_) {
+    // Wait for the overlapping writes, so that the data is written
+    // in the order of the calls.
+    waitAsyncWrite(offset, len);
+    if (!enableMmap_ && fd_ != A2_BAD_FD) {
+      writeQueue_->push(writeFile_, fd_, data, len, offset);
+      return;
+    }
+  }
+#endif // ENABLE_ASYNC_DISK_WRITE
   ensureMmapWrite(len, offset);
+  TraceSpan span("disk", "AbstractDiskWriter::writeData");
+  Timer start;
   if (writeDataInternal(data, len, offset) < 0) {
-    int errNum = fileError();
-    // If the error indicates disk full situation, throw
-    // DownloadFailureException and abort download instantly.
-    if (isDiskFullError(errNum)) {
-      throw DOWNLOAD_FAILURE_EXCEPTION3(
-          errNum,
-          fmt(EX_FILE_WRITE, filename_.c_str(), fileStrerror(errNum).c_str()),
-          error_code::NOT_ENOUGH_DISK_SPACE);
+    throwWriteError(filename_, fileError());
+  }
+  metrics::diskWriteLatency().observe(start.difference());
+}
+
+void AbstractDiskWriter::writeDataVec(const a2iovec* iov, size_t iovcnt,
+                                      int64_t offset)
+{
+  size_t len = 0;
+  for (size_t i = 0; i < iovcnt; ++i) {
+    len += iov[i].A2IOVEC_LEN;
+  }
+#ifdef ENABLE_ASYNC_DISK_WRITE
+  if (writeQueue_) {
+    waitAsyncWrite(offset, len);
+    if (!enableMmap_ && fd_ != A2_BAD_FD) {
+      writeQueue_->push(writeFile_, fd_, iov, iovcnt, offset);
+      return;
     }
-    else {
-      throw DL_ABORT_EX3(
-          errNum,
-          fmt(EX_FILE_WRITE, filename_.c_str(), fileStrerror(errNum).c_str()),
-          error_code::FILE_IO_ERROR);
+  }
+#endif // ENABLE_ASYNC_DISK_WRITE
+  ensureMmapWrite(len, offset);
+  TraceSpan span("disk", "AbstractDiskWriter::writeDataVec");
+  Timer start;
+#ifdef HAVE_PWRITEV
+  if (!mapaddr_) {
+    if (writeDataVecInternal(iov, iovcnt, offset) < 0) {
+      throwWriteError(filename_, fileError());
     }
+    metrics::diskWriteLatency().observe(start.difference());
+    return;
   }
+#endif // HAVE_PWRITEV
+  for (size_t i = 0; i < iovcnt; ++i) {
+    if (writeDataInternal(
+            reinterpret_cast<const unsigned char*>(iov[i].A2IOVEC_BASE),
+            iov[i].A2IOVEC_LEN, offset) < 0) {
+      throwWriteError(filename_, fileError());
+    }
+    offset += iov[i].A2IOVEC_LEN;
+  }
+  metrics::diskWriteLatency().observe(start.difference());
 }
 
 ssize_t AbstractDiskWriter::readData(unsigned char* data, size_t len,
                                      int64_t offset)
 {
+#ifdef ENABLE_ASYNC_DISK_WRITE
+  waitAsyncWrite(offset, len);
+#endif // ENABLE_ASYNC_DISK_WRITE
   ssize_t ret;
   if ((ret = readDataInternal(data, len, offset)) < 0) {
     int errNum = fileError();
@@ -483,6 +630,9 @@ void AbstractDiskWriter::truncate(int64_t length)
   if (fd_ == A2_BAD_FD) {
     throw DL_ABORT_EX("File not yet opened.");
   }
+#ifdef ENABLE_ASYNC_DISK_WRITE
+  waitAsyncWrite();
+#endif // ENABLE_ASYNC_DISK_WRITE
 #ifdef __MINGW32__
   // Since mingw32's ftruncate cannot handle over 2GB files, we use
   // SetEndOfFile instead.
@@ -504,6 +654,9 @@ void AbstractDiskWriter::allocate(int64_t offset, int64_t length, bool sparse)
   if (fd_ == A2_BAD_FD) {
     throw DL_ABORT_EX("File not yet opened.");
   }
+#ifdef ENABLE_ASYNC_DISK_WRITE
+  waitAsyncWrite();
+#endif // ENABLE_ASYNC_DISK_WRITE
   if (sparse) {
 #ifdef __MINGW32__
     DWORD bytesReturned;
@@ -575,13 +728,36 @@ void AbstractDiskWriter::allocate(int64_t offset, int64_t length, bool sparse)
 #endif // HAVE_SOME_FALLOCATE
 }
 
-int64_t AbstractDiskWriter::size() { return File(filename_).size(); }
+int64_t AbstractDiskWriter::size()
+{
+#ifdef ENABLE_ASYNC_DISK_WRITE
+  waitAsyncWrite();
+#endif // ENABLE_ASYNC_DISK_WRITE
+  return File(filename_).size();
+}
 
 void AbstractDiskWriter::enableReadOnly() { readOnly_ = true; }
 
 void AbstractDiskWriter::disableReadOnly() { readOnly_ = false; }
 
-void AbstractDiskWriter::enableMmap() { enableMmap_ = true; }
+void AbstractDiskWriter::enableMmap()
+{
+#ifdef ENABLE_ASYNC_DISK_WRITE
+  waitAsyncWrite();
+#endif // ENABLE_ASYNC_DISK_WRITE
+  enableMmap_ = true;
+}
+
+void AbstractDiskWriter::enableAsyncWrite(
+    const std::shared_ptr<DiskWriteQueue>& queue)
+{
+#ifdef ENABLE_ASYNC_DISK_WRITE
+  if (!writeFile_) {
+    writeFile_ = std::make_shared<DiskWriteFile>();
+  }
+  writeQueue_ = queue;
+#endif // ENABLE_ASYNC_DISK_WRITE
+}
 
 void AbstractDiskWriter::dropCache(int64_t len, int64_t offset)
 {
@@ -590,4 +766,26 @@ void AbstractDiskWriter::dropCache(int64_t len, int64_t offset)
 #endif // HAVE_POSIX_FADVISE
 }
 
+#ifdef HAVE_SENDFILE
+std::shared_ptr<FileHandle> AbstractDiskWriter::getFileHandle(int64_t offset,
+                                                              size_t len)
+{
+  if (fd_ == A2_BAD_FD) {
+    return nullptr;
+  }
+#  ifdef ENABLE_ASYNC_DISK_WRITE
+  waitAsyncWrite(offset, len);
+#  endif // ENABLE_ASYNC_DISK_WRITE
+  if (!fileHandle_) {
+    int fd = dup(fd_);
+    if (fd == -1) {
+      return nullptr;
+    }
+    util::make_fd_cloexec(fd);
+    fileHandle_ = std::make_shared<FileHandle>(fd);
+  }
+  return fileHandle_;
+}
+#endif // HAVE_SENDFILE
+
 } // namespace aria2
@@ -40,6 +40,13 @@
 
 namespace aria2 {
 
+#ifdef ENABLE_ASYNC_DISK_WRITE
+struct DiskWriteFile;
+#endif // ENABLE_ASYNC_DISK_WRITE
+#ifdef HAVE_SENDFILE
+class FileHandle;
+#endif // HAVE_SENDFILE
+
 class AbstractDiskWriter : public DiskWriter {
 private:
   std::string filename_;
@@ -58,9 +65,32 @@ private:
   unsigned char* mapaddr_;
   int64_t maplen_;
 
+#ifdef HAVE_SENDFILE
+  // Duplicate of fd_ handed out by getFileHandle().  It is released
+  // in closeFile(), but outstanding references keep it open.
+  std::shared_ptr<FileHandle> fileHandle_;
+#endif // HAVE_SENDFILE
+
+#ifdef ENABLE_ASYNC_DISK_WRITE
+  std::shared_ptr<DiskWriteQueue> writeQueue_;
+  std::shared_ptr<DiskWriteFile> writeFile_;
+
+  // Waits for the queued writes to complete and throws an exception
+  // if one of them failed.
+  void waitAsyncWrite();
+
+  // Waits for the queued writes overlapping [offset, offset + len) to
+  // complete and throws an exception if any queued write failed.
+  void waitAsyncWrite(int64_t offset, size_t len);
+#endif // ENABLE_ASYNC_DISK_WRITE
+
   ssize_t writeDataInternal(const unsigned char* data, size_t len,
                             int64_t offset);
   ssize_t readDataInternal(unsigned char* data, size_t len, int64_t offset);
+#ifdef HAVE_PWRITEV
+  ssize_t writeDataVecInternal(const a2iovec* iov, size_t iovcnt,
+                               int64_t offset);
+#endif // HAVE_PWRITEV
 
   void seek(int64_t offset);
 
@@ -82,6 +112,9 @@ public:
   virtual void writeData(const unsigned char* data, size_t len,
                          int64_t offset) CXX11_OVERRIDE;
 
+  virtual void writeDataVec(const a2iovec* iov, size_t iovcnt,
+                            int64_t offset) CXX11_OVERRIDE;
+
   virtual ssize_t readData(unsigned char* data, size_t len,
                            int64_t offset) CXX11_OVERRIDE;
 
@@ -99,7 +132,15 @@ public:
 
   virtual void enableMmap() CXX11_OVERRIDE;
 
+  virtual void enableAsyncWrite(
+      const std::shared_ptr<DiskWriteQueue>& queue) CXX11_OVERRIDE;
+
   virtual void dropCache(int64_t len, int64_t offset) CXX11_OVERRIDE;
+
+#ifdef HAVE_SENDFILE
+  virtual std::shared_ptr<FileHandle> getFileHandle(int64_t offset,
+                                                    size_t len) CXX11_OVERRIDE;
+#endif // HAVE_SENDFILE
 };
 
 } // namespace aria2
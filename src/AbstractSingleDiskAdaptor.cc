@@ -38,7 +38,6 @@
 #include "DiskWriter.h"
 #include "FileEntry.h"
 #include "TruncFileAllocationIterator.h"
-#include "WrDiskCacheEntry.h"
 #include "LogFactory.h"
 #ifdef HAVE_SOME_FALLOCATE
 #  include "FallocFileAllocationIterator.h"
@@ -76,6 +75,12 @@ void AbstractSingleDiskAdaptor::writeData(const unsigned char* data, size_t len,
   diskWriter_->writeData(data, len, offset);
 }
 
+void AbstractSingleDiskAdaptor::writeDataVec(const a2iovec* iov,
+                                             size_t iovcnt, int64_t offset)
+{
+  diskWriter_->writeDataVec(iov, iovcnt, offset);
+}
+
 ssize_t AbstractSingleDiskAdaptor::readData(unsigned char* data, size_t len,
                                             int64_t offset)
 {
@@ -94,15 +99,6 @@ ssize_t AbstractSingleDiskAdaptor::readDataDropCache(unsigned char* data,
   return rv;
 }
 
-void AbstractSingleDiskAdaptor::writeCache(const WrDiskCacheEntry* entry)
-{
-  for (auto& d : entry->getDataSet()) {
-    A2_LOG_DEBUG(fmt("Cache flush goff=%" PRId64 ", len=%lu", d->goff,
-                     static_cast<unsigned long>(d->len)));
-    writeData(d->data + d->offset, d->len, d->goff);
-  }
-}
-
 bool AbstractSingleDiskAdaptor::fileExists()
 {
   return File(getFilePath()).exists();
@@ -147,6 +143,22 @@ void AbstractSingleDiskAdaptor::disableReadOnly()
 
 void AbstractSingleDiskAdaptor::enableMmap() { diskWriter_->enableMmap(); }
 
+void AbstractSingleDiskAdaptor::enableAsyncWrite(
+    const std::shared_ptr<DiskWriteQueue>& queue)
+{
+  diskWriter_->enableAsyncWrite(queue);
+}
+
+#ifdef HAVE_SENDFILE
+std::shared_ptr<FileHandle>
+AbstractSingleDiskAdaptor::getFileHandle(int64_t offset, size_t len,
+                                         int64_t& fileOffset)
+{
+  fileOffset = offset;
+  return diskWriter_->getFileHandle(offset, len);
+}
+#endif // HAVE_SENDFILE
+
 void AbstractSingleDiskAdaptor::cutTrailingGarbage()
 {
   if (File(getFilePath()).size() > totalLength_) {
@@ -64,14 +64,15 @@ public:
   virtual void writeData(const unsigned char* data, size_t len,
                          int64_t offset) CXX11_OVERRIDE;
 
+  virtual void writeDataVec(const a2iovec* iov, size_t iovcnt,
+                            int64_t offset) CXX11_OVERRIDE;
+
   virtual ssize_t readData(unsigned char* data, size_t len,
                            int64_t offset) CXX11_OVERRIDE;
 
   virtual ssize_t readDataDropCache(unsigned char* data, size_t len,
                                     int64_t offset) CXX11_OVERRIDE;
 
-  virtual void writeCache(const WrDiskCacheEntry* entry) CXX11_OVERRIDE;
-
   virtual bool fileExists() CXX11_OVERRIDE;
 
   virtual int64_t size() CXX11_OVERRIDE;
@@ -91,6 +92,15 @@ public:
 
   virtual void enableMmap() CXX11_OVERRIDE;
 
+  virtual void enableAsyncWrite(
+      const std::shared_ptr<DiskWriteQueue>& queue) CXX11_OVERRIDE;
+
+#ifdef HAVE_SENDFILE
+  virtual std::shared_ptr<FileHandle>
+  getFileHandle(int64_t offset, size_t len,
+                int64_t& fileOffset) CXX11_OVERRIDE;
+#endif // HAVE_SENDFILE
+
   virtual void cutTrailingGarbage() CXX11_OVERRIDE;
 
   virtual const std::string& getFilePath() = 0;
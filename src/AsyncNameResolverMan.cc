@@ -81,6 +81,10 @@ void AsyncNameResolverMan::startAsync(const std::string& hostname,
   }
   A2_LOG_INFO(
       fmt(MSG_RESOLVING_HOSTNAME, command->getCuid(), hostname.c_str()));
+  if (Tracer::get()) {
+    traceHostname_ = hostname;
+    traceStart_ = Tracer::Clock::now();
+  }
 }
 
 void AsyncNameResolverMan::startAsyncFamily(const std::string& hostname,
@@ -148,6 +152,20 @@ void AsyncNameResolverMan::disableNameResolverCheck(size_t index,
 }
 
 int AsyncNameResolverMan::getStatus() const
+{
+  auto status = getStatusInternal();
+  if (status != 0 && !traceHostname_.empty()) {
+    auto tracer = Tracer::get();
+    if (tracer) {
+      tracer->addSpan("dns", "AsyncNameResolverMan::resolve", traceStart_,
+                      Tracer::Clock::now(), traceHostname_);
+    }
+    traceHostname_.clear();
+  }
+  return status;
+}
+
+int AsyncNameResolverMan::getStatusInternal() const
 {
   size_t success = 0;
   size_t error = 0;
@@ -202,6 +220,7 @@ void AsyncNameResolverMan::reset(DownloadEngine* e, Command* command)
     asyncNameResolver_[i].reset();
   }
   numResolver_ = 0;
+  traceHostname_.clear();
 }
 
 void configureAsyncNameResolverMan(AsyncNameResolverMan* asyncNameResolverMan,
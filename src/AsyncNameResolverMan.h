@@ -41,6 +41,8 @@
 #include <string>
 #include <memory>
 
+#include "Tracer.h"
+
 namespace aria2 {
 
 class AsyncNameResolver;
@@ -86,12 +88,17 @@ private:
                             Command* command);
   void disableNameResolverCheck(size_t index, DownloadEngine* e,
                                 Command* command);
+  int getStatusInternal() const;
 
   std::shared_ptr<AsyncNameResolver> asyncNameResolver_[2];
   size_t numResolver_;
   int resolverCheck_;
   bool ipv4_;
   bool ipv6_;
+  // The host name being resolved while tracing is enabled.  The span
+  // is added when getStatus() first reports the completion.
+  mutable std::string traceHostname_;
+  Tracer::Clock::time_point traceStart_;
 };
 
 void configureAsyncNameResolverMan(AsyncNameResolverMan* asyncNameResolverMan,
@@ -39,6 +39,8 @@
 
 #include <unistd.h>
 
+#include "a2netcompat.h"
+
 namespace aria2 {
 
 class BinaryStream {
@@ -48,6 +50,18 @@ public:
   virtual void writeData(const unsigned char* data, size_t len,
                          int64_t offset) = 0;
 
+  // Writes |iovcnt| buffers in |iov| to the contiguous region
+  // starting at |offset|.  The default implementation calls
+  // writeData() for each buffer.
+  virtual void writeDataVec(const a2iovec* iov, size_t iovcnt, int64_t offset)
+  {
+    for (size_t i = 0; i < iovcnt; ++i) {
+      writeData(reinterpret_cast<const unsigned char*>(iov[i].A2IOVEC_BASE),
+                iov[i].A2IOVEC_LEN, offset);
+      offset += iov[i].A2IOVEC_LEN;
+    }
+  }
+
   virtual ssize_t readData(unsigned char* data, size_t len, int64_t offset) = 0;
 
   // Truncates a file to given length. The default implementation does
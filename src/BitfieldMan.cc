@@ -156,59 +156,33 @@ bool BitfieldMan::hasMissingPiece(const unsigned char* peerBitfield,
   if (bitfieldLength_ != length) {
     return false;
   }
-  bool retval = false;
-  for (size_t i = 0; i < bitfieldLength_; ++i) {
-    unsigned char temp = peerBitfield[i] & ~bitfield_[i];
-    if (filterEnabled_) {
-      temp &= filterBitfield_[i];
-    }
-    if (temp & 0xffu) {
-      retval = true;
-      break;
-    }
-  }
-  return retval;
+  return bitfield::getMissing(nullptr, bitfield_, nullptr, peerBitfield,
+                              getEnabledFilter(), blocks_);
 }
 
 bool BitfieldMan::getFirstMissingUnusedIndex(size_t& index) const
 {
-  if (filterEnabled_) {
-    return bitfield::getFirstSetBitIndex(
-        index,
-        ~array(bitfield_) & ~array(useBitfield_) & array(filterBitfield_),
-        blocks_);
-  }
-  else {
-    return bitfield::getFirstSetBitIndex(
-        index, ~array(bitfield_) & ~array(useBitfield_), blocks_);
-  }
+  return bitfield::getFirstNMissingIndex(&index, 1, bitfield_, useBitfield_,
+                                         getEnabledFilter(), blocks_) == 1;
 }
 
 size_t BitfieldMan::getFirstNMissingUnusedIndex(std::vector<size_t>& out,
                                                 size_t n) const
 {
-  if (filterEnabled_) {
-    return bitfield::getFirstNSetBitIndex(
-        std::back_inserter(out), n,
-        ~array(bitfield_) & ~array(useBitfield_) & array(filterBitfield_),
-        blocks_);
-  }
-  else {
-    return bitfield::getFirstNSetBitIndex(
-        std::back_inserter(out), n, ~array(bitfield_) & ~array(useBitfield_),
-        blocks_);
-  }
+  n = std::min(n, blocks_);
+  size_t first = out.size();
+  out.resize(first + n);
+  size_t found = bitfield::getFirstNMissingIndex(
+      out.data() + first, n, bitfield_, useBitfield_, getEnabledFilter(),
+      blocks_);
+  out.resize(first + found);
+  return found;
 }
 
 bool BitfieldMan::getFirstMissingIndex(size_t& index) const
 {
-  if (filterEnabled_) {
-    return bitfield::getFirstSetBitIndex(
-        index, ~array(bitfield_) & array(filterBitfield_), blocks_);
-  }
-  else {
-    return bitfield::getFirstSetBitIndex(index, ~array(bitfield_), blocks_);
-  }
+  return bitfield::getFirstNMissingIndex(&index, 1, bitfield_, nullptr,
+                                         getEnabledFilter(), blocks_) == 1;
 }
 
 namespace {
@@ -461,33 +435,12 @@ bool BitfieldMan::getInorderMissingUnusedIndex(
   }
 }
 
-namespace {
-template <typename Array>
-bool copyBitfield(unsigned char* dst, const Array& src, size_t blocks)
-{
-  unsigned char bits = 0;
-  size_t len = (blocks + 7) / 8;
-  for (size_t i = 0; i < len - 1; ++i) {
-    dst[i] = src[i];
-    bits |= dst[i];
-  }
-  dst[len - 1] = src[len - 1] & bitfield::lastByteMask(blocks);
-  bits |= dst[len - 1];
-  return bits != 0;
-}
-} // namespace
-
 bool BitfieldMan::getAllMissingIndexes(unsigned char* misbitfield,
                                        size_t len) const
 {
   assert(len == bitfieldLength_);
-  if (filterEnabled_) {
-    return copyBitfield(misbitfield, ~array(bitfield_) & array(filterBitfield_),
-                        blocks_);
-  }
-  else {
-    return copyBitfield(misbitfield, ~array(bitfield_), blocks_);
-  }
+  return bitfield::getMissing(misbitfield, bitfield_, nullptr, nullptr,
+                              getEnabledFilter(), blocks_);
 }
 
 bool BitfieldMan::getAllMissingIndexes(unsigned char* misbitfield, size_t len,
@@ -498,16 +451,8 @@ bool BitfieldMan::getAllMissingIndexes(unsigned char* misbitfield, size_t len,
   if (bitfieldLength_ != peerBitfieldLength) {
     return false;
   }
-  if (filterEnabled_) {
-    return copyBitfield(misbitfield,
-                        ~array(bitfield_) & array(peerBitfield) &
-                            array(filterBitfield_),
-                        blocks_);
-  }
-  else {
-    return copyBitfield(misbitfield, ~array(bitfield_) & array(peerBitfield),
-                        blocks_);
-  }
+  return bitfield::getMissing(misbitfield, bitfield_, nullptr, peerBitfield,
+                              getEnabledFilter(), blocks_);
 }
 
 bool BitfieldMan::getAllMissingUnusedIndexes(unsigned char* misbitfield,
@@ -519,18 +464,8 @@ bool BitfieldMan::getAllMissingUnusedIndexes(unsigned char* misbitfield,
   if (bitfieldLength_ != peerBitfieldLength) {
     return false;
   }
-  if (filterEnabled_) {
-    return copyBitfield(misbitfield,
-                        ~array(bitfield_) & ~array(useBitfield_) &
-                            array(peerBitfield) & array(filterBitfield_),
-                        blocks_);
-  }
-  else {
-    return copyBitfield(misbitfield,
-                        ~array(bitfield_) & ~array(useBitfield_) &
-                            array(peerBitfield),
-                        blocks_);
-  }
+  return bitfield::getMissing(misbitfield, bitfield_, useBitfield_,
+                              peerBitfield, getEnabledFilter(), blocks_);
 }
 
 size_t BitfieldMan::countMissingBlock() const { return cachedNumMissingBlock_; }
@@ -539,8 +474,7 @@ size_t BitfieldMan::countMissingBlockNow() const
 {
   if (filterEnabled_) {
     return bitfield::countSetBit(filterBitfield_, blocks_) -
-           bitfield::countSetBitSlow(array(bitfield_) & array(filterBitfield_),
-                                     blocks_);
+           bitfield::countSetBitAnd(bitfield_, filterBitfield_, blocks_);
   }
   else {
     return blocks_ - bitfield::countSetBit(bitfield_, blocks_);
@@ -599,12 +533,8 @@ bool BitfieldMan::unsetBit(size_t index)
 bool BitfieldMan::isFilteredAllBitSet() const
 {
   if (filterEnabled_) {
-    for (size_t i = 0; i < bitfieldLength_; ++i) {
-      if ((bitfield_[i] & filterBitfield_[i]) != filterBitfield_[i]) {
-        return false;
-      }
-    }
-    return true;
+    return !bitfield::getMissing(nullptr, bitfield_, nullptr, nullptr,
+                                 filterBitfield_, blocks_);
   }
   else {
     return isAllBitSet();
@@ -795,41 +725,27 @@ int64_t BitfieldMan::getFilteredTotalLengthNow() const
   }
 }
 
-namespace {
-template <typename Array, typename CountFun>
-int64_t computeCompletedLength(const Array& bitfield, const BitfieldMan* btman,
-                               CountFun cntfun)
-{
-  size_t nbits = btman->countBlock();
-  size_t completedBlocks = cntfun(bitfield, nbits);
-  int64_t completedLength = 0;
-  if (completedBlocks == 0) {
-    completedLength = 0;
-  }
-  else {
-    if (bitfield::test(bitfield, nbits, nbits - 1)) {
-      completedLength =
-          ((int64_t)completedBlocks - 1) * btman->getBlockLength() +
-          btman->getLastBlockLength();
-    }
-    else {
-      completedLength = ((int64_t)completedBlocks) * btman->getBlockLength();
-    }
-  }
-  return completedLength;
-}
-} // namespace
-
 int64_t BitfieldMan::getCompletedLength(bool useFilter) const
 {
+  size_t completedBlocks;
+  bool lastBlockCompleted;
   if (useFilter && filterEnabled_) {
-    auto arr = array(bitfield_) & array(filterBitfield_);
-    return computeCompletedLength(arr, this,
-                                  &bitfield::countSetBitSlow<decltype(arr)>);
+    completedBlocks =
+        bitfield::countSetBitAnd(bitfield_, filterBitfield_, blocks_);
+    lastBlockCompleted = blocks_ > 0 && isBitSet(blocks_ - 1) &&
+                         isFilterBitSet(blocks_ - 1);
   }
   else {
-    return computeCompletedLength(bitfield_, this, &bitfield::countSetBit);
+    completedBlocks = bitfield::countSetBit(bitfield_, blocks_);
+    lastBlockCompleted = blocks_ > 0 && isBitSet(blocks_ - 1);
+  }
+  if (completedBlocks == 0) {
+    return 0;
+  }
+  if (lastBlockCompleted) {
+    return ((int64_t)completedBlocks - 1) * blockLength_ + getLastBlockLength();
   }
+  return ((int64_t)completedBlocks) * blockLength_;
 }
 
 int64_t BitfieldMan::getCompletedLengthNow() const
@@ -69,6 +69,12 @@ private:
 
   int64_t getCompletedLength(bool useFilter) const;
 
+  // Returns filterBitfield_ if filter is enabled, or nullptr.
+  const unsigned char* getEnabledFilter() const
+  {
+    return filterEnabled_ ? filterBitfield_ : nullptr;
+  }
+
   // If filterBitfield_ is 0, allocate bitfieldLength_ bytes to it and
   // set 0 to all bytes.
   void ensureFilterBitfield();
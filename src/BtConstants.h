@@ -50,8 +50,8 @@ constexpr size_t MAX_BLOCK_LENGTH = 64_k;
 
 constexpr size_t DEFAULT_MAX_OUTSTANDING_REQUEST = 6;
 
-// Upper Bound of the number of outstanding request
-constexpr size_t UB_MAX_OUTSTANDING_REQUEST = 256;
+// Default upper bound of the number of outstanding request
+constexpr size_t DEFAULT_MAX_OUTSTANDING_REQUEST_LIMIT = 500;
 
 constexpr size_t METADATA_PIECE_SIZE = 16_k;
 
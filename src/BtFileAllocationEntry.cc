@@ -44,6 +44,7 @@
 #include "FileEntry.h"
 #include "PieceStorage.h"
 #include "DiskAdaptor.h"
+#include "RequestGroupMan.h"
 #include "Option.h"
 #include "prefs.h"
 #include "LogFactory.h"
@@ -72,6 +73,10 @@ void BtFileAllocationEntry::prepareForNextAction(
       diskAdaptor->size() <= option->getAsLLInt(PREF_MAX_MMAP_LIMIT)) {
     diskAdaptor->enableMmap();
   }
+  if (e->getRequestGroupMan()->getDiskWriteQueue()) {
+    diskAdaptor->enableAsyncWrite(
+        e->getRequestGroupMan()->getDiskWriteQueue());
+  }
   if (!rg->downloadFinished()) {
     // For DownloadContext::resetDownloadStartTime(), see also
     // RequestGroup::createInitialCommand()
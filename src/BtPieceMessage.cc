@@ -59,8 +59,12 @@
 #include "array_fun.h"
 #include "WrDiskCache.h"
 #include "WrDiskCacheEntry.h"
+#include "RdDiskCache.h"
 #include "DownloadFailureException.h"
 #include "BtRejectMessage.h"
+#ifdef HAVE_SENDFILE
+#  include "FileHandle.h"
+#endif // HAVE_SENDFILE
 
 namespace aria2 {
 
@@ -103,6 +107,9 @@ void BtPieceMessage::doReceivedAction()
   downloadContext_->updateDownload(blockLength_);
   if (slot) {
     getPeer()->snubbing(false);
+    getPeer()->updateBlockRtt(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            slot->getDispatchedTime().difference(global::wallclock())));
     std::shared_ptr<Piece> piece = getPieceStorage()->getPiece(index_);
     int64_t offset =
         static_cast<int64_t>(index_) * downloadContext_->getPieceLength() +
@@ -215,23 +222,73 @@ void BtPieceMessage::send()
 void BtPieceMessage::pushPieceData(int64_t offset, int32_t length) const
 {
   assert(length <= static_cast<int32_t>(MAX_BLOCK_LENGTH));
-  auto buf = std::vector<unsigned char>(length + MESSAGE_HEADER_LENGTH);
+  std::vector<unsigned char> buf;
+  auto rdDiskCache = getPieceStorage()->getRdDiskCache();
+  if (rdDiskCache) {
+    buf.resize(length + MESSAGE_HEADER_LENGTH);
+    if (!rdDiskCache->readData(buf.data() + MESSAGE_HEADER_LENGTH, length,
+                               getPieceStorage()->getDiskAdaptor(), index_,
+                               begin_, offset - begin_,
+                               getPieceStorage()->getPieceLength(index_))) {
+      buf.clear();
+    }
+  }
+  if (buf.empty()) {
+#ifdef HAVE_SENDFILE
+    if (pushPieceDataFromFile(offset, length)) {
+      return;
+    }
+#endif // HAVE_SENDFILE
+    buf.resize(length + MESSAGE_HEADER_LENGTH);
+    ssize_t r;
+    r = getPieceStorage()->getDiskAdaptor()->readData(
+        buf.data() + MESSAGE_HEADER_LENGTH, length, offset);
+    if (r != length) {
+      throw DL_ABORT_EX(EX_DATA_READ);
+    }
+  }
   createMessageHeader(buf.data());
-  ssize_t r;
-  r = getPieceStorage()->getDiskAdaptor()->readData(
-      buf.data() + MESSAGE_HEADER_LENGTH, length, offset);
-  if (r == length) {
-    const auto& peer = getPeer();
-    getPeerConnection()->pushBytes(
-        std::move(buf), make_unique<PieceSendUpdate>(downloadContext_, peer,
-                                                     MESSAGE_HEADER_LENGTH));
-    peer->updateUploadSpeed(length);
-    downloadContext_->updateUploadSpeed(length);
+  const auto& peer = getPeer();
+  getPeerConnection()->pushBytes(
+      std::move(buf), make_unique<PieceSendUpdate>(downloadContext_, peer,
+                                                   MESSAGE_HEADER_LENGTH));
+  peer->updateUploadSpeed(length);
+  downloadContext_->updateUploadSpeed(length);
+}
+
+#ifdef HAVE_SENDFILE
+bool BtPieceMessage::pushPieceDataFromFile(int64_t offset, int32_t length) const
+{
+  if (getPeerConnection()->isEncryptionEnabled()) {
+    return false;
   }
-  else {
-    throw DL_ABORT_EX(EX_DATA_READ);
+  if (getPieceStorage()->getWrDiskCache()) {
+    auto piece = getPieceStorage()->getPiece(index_);
+    if (piece && piece->getWrDiskCacheEntry() &&
+        !piece->getWrDiskCacheEntry()->getDataSet().empty()) {
+      // The cached data may not be written to the file yet.
+      return false;
+    }
+  }
+  int64_t fileOffset;
+  auto fileHandle =
+      getPieceStorage()->getDiskAdaptor()->getFileHandle(offset, length,
+                                                         fileOffset);
+  if (!fileHandle) {
+    return false;
   }
+  auto header = std::vector<unsigned char>(MESSAGE_HEADER_LENGTH);
+  createMessageHeader(header.data());
+  const auto& peer = getPeer();
+  getPeerConnection()->pushBytes(std::move(header));
+  getPeerConnection()->pushFileRange(
+      std::move(fileHandle), fileOffset, length,
+      make_unique<PieceSendUpdate>(downloadContext_, peer, 0));
+  peer->updateUploadSpeed(length);
+  downloadContext_->updateUploadSpeed(length);
+  return true;
 }
+#endif // HAVE_SENDFILE
 
 std::string BtPieceMessage::toString() const
 {
@@ -60,6 +60,12 @@ private:
 
   void pushPieceData(int64_t offset, int32_t length) const;
 
+#ifdef HAVE_SENDFILE
+  // Queues the piece data to be sent with sendfile(2).  Returns false
+  // if the data must be copied into the send buffer instead.
+  bool pushPieceDataFromFile(int64_t offset, int32_t length) const;
+#endif // HAVE_SENDFILE
+
 public:
   BtPieceMessage(size_t index = 0, int32_t begin = 0, int32_t blockLength = 0);
 
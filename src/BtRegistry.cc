@@ -43,6 +43,7 @@
 #include "bittorrent_helper.h"
 #include "LpdMessageReceiver.h"
 #include "UDPTrackerClient.h"
+#include "UtpSocketManager.h"
 #include "NullHandle.h"
 
 namespace aria2 {
@@ -105,6 +106,12 @@ void BtRegistry::setUDPTrackerClient(
   udpTrackerClient_ = tracker;
 }
 
+void BtRegistry::setUtpSocketManager(
+    const std::shared_ptr<UtpSocketManager>& manager)
+{
+  utpSocketManager_ = manager;
+}
+
 BtObject::BtObject(
     const std::shared_ptr<DownloadContext>& downloadContext,
     const std::shared_ptr<PieceStorage>& pieceStorage,
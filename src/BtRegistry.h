@@ -52,6 +52,7 @@ class BtProgressInfoFile;
 class DownloadContext;
 class LpdMessageReceiver;
 class UDPTrackerClient;
+class UtpSocketManager;
 
 struct BtObject {
   std::shared_ptr<DownloadContext> downloadContext;
@@ -80,6 +81,7 @@ private:
   uint16_t udpPort_;
   std::shared_ptr<LpdMessageReceiver> lpdMessageReceiver_;
   std::shared_ptr<UDPTrackerClient> udpTrackerClient_;
+  std::shared_ptr<UtpSocketManager> utpSocketManager_;
 
 public:
   BtRegistry();
@@ -125,6 +127,12 @@ public:
   {
     return udpTrackerClient_;
   }
+
+  void setUtpSocketManager(const std::shared_ptr<UtpSocketManager>& manager);
+  const std::shared_ptr<UtpSocketManager>& getUtpSocketManager() const
+  {
+    return utpSocketManager_;
+  }
 };
 
 } // namespace aria2
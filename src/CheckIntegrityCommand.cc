@@ -54,11 +54,15 @@ CheckIntegrityCommand::CheckIntegrityCommand(cuid_t cuid,
                                              CheckIntegrityEntry* entry)
     : RealtimeCommand{cuid, requestGroup, e}, entry_{entry}
 {
+  auto& queue = e->getCheckIntegrityMan()->getPieceHashQueue();
+  if (queue) {
+    entry_->setPieceHashQueue(queue);
+  }
 }
 
 CheckIntegrityCommand::~CheckIntegrityCommand()
 {
-  getDownloadEngine()->getCheckIntegrityMan()->dropPickedEntry();
+  getDownloadEngine()->getCheckIntegrityMan()->dropPickedEntry(entry_);
 }
 
 bool CheckIntegrityCommand::executeInternal()
@@ -41,6 +41,7 @@
 #include "FileAllocationEntry.h"
 #include "DownloadEngine.h"
 #include "Option.h"
+#include "Tracer.h"
 
 namespace aria2 {
 
@@ -52,7 +53,19 @@ CheckIntegrityEntry::CheckIntegrityEntry(RequestGroup* requestGroup,
 
 CheckIntegrityEntry::~CheckIntegrityEntry() = default;
 
-void CheckIntegrityEntry::validateChunk() { validator_->validateChunk(); }
+void CheckIntegrityEntry::validateChunk()
+{
+  TraceSpan span("hash", "CheckIntegrityEntry::validateChunk");
+  validator_->validateChunk();
+}
+
+void CheckIntegrityEntry::setPieceHashQueue(
+    const std::shared_ptr<PieceHashQueue>& queue)
+{
+  if (validator_) {
+    validator_->setPieceHashQueue(queue);
+  }
+}
 
 int64_t CheckIntegrityEntry::getTotalLength()
 {
@@ -47,6 +47,7 @@ namespace aria2 {
 class IteratableValidator;
 class DownloadEngine;
 class FileAllocationEntry;
+class PieceHashQueue;
 
 class CheckIntegrityEntry : public RequestGroupEntry,
                             public ProgressAwareEntry {
@@ -73,6 +74,10 @@ public:
 
   virtual void validateChunk();
 
+  // Lets the validator compute hashes in the worker threads of
+  // |queue|.  Must be called after initValidator().
+  void setPieceHashQueue(const std::shared_ptr<PieceHashQueue>& queue);
+
   virtual bool finished() CXX11_OVERRIDE;
 
   virtual bool isValidationReady() = 0;
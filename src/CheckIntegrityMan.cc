@@ -0,0 +1,73 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "CheckIntegrityMan.h"
+#include "CheckIntegrityEntry.h"
+#include "Command.h"
+#ifdef HAVE_STD_THREAD
+#  include "PieceHashQueue.h"
+#endif // HAVE_STD_THREAD
+#include "LogFactory.h"
+#include "Logger.h"
+#include "prefs.h"
+#include "fmt.h"
+
+namespace aria2 {
+
+CheckIntegrityMan::CheckIntegrityMan() = default;
+
+CheckIntegrityMan::~CheckIntegrityMan() = default;
+
+void CheckIntegrityMan::initPieceHashQueue(size_t numThreads)
+{
+  if (numThreads == 0) {
+    return;
+  }
+#ifdef HAVE_STD_THREAD
+  auto queue = std::make_shared<PieceHashQueue>(numThreads);
+  if (queue->good()) {
+    pieceHashQueue_ = std::move(queue);
+    setMaxPicked(pieceHashQueue_->getNumThreads());
+  }
+  else {
+    A2_LOG_WARN("Piece hashes are computed in the main thread because piece"
+                " hash threads could not be started.");
+  }
+#else  // !HAVE_STD_THREAD
+  A2_LOG_WARN(fmt("--%s is not supported in this build.",
+                  PREF_CHECK_INTEGRITY_THREADS->k));
+#endif // !HAVE_STD_THREAD
+}
+
+} // namespace aria2
@@ -36,13 +36,38 @@
 #define D_CHECK_INTEGRITY_MAN_H
 
 #include "common.h"
+
+#include <memory>
+
 #include "SequentialPicker.h"
 
 namespace aria2 {
 
 class CheckIntegrityEntry;
+class PieceHashQueue;
+
+class CheckIntegrityMan : public SequentialPicker<CheckIntegrityEntry> {
+private:
+  std::shared_ptr<PieceHashQueue> pieceHashQueue_;
+
+public:
+  CheckIntegrityMan();
+
+  ~CheckIntegrityMan();
+
+  // Starts |numThreads| worker threads which compute piece hashes,
+  // and lets up to |numThreads| entries be verified at the same
+  // time.  If |numThreads| is 0, or threads are not available, hashes
+  // are computed in the calling thread one entry at a time.
+  void initPieceHashQueue(size_t numThreads);
 
-typedef SequentialPicker<CheckIntegrityEntry> CheckIntegrityMan;
+  // Returns nullptr if piece hashes are computed in the calling
+  // thread.
+  const std::shared_ptr<PieceHashQueue>& getPieceHashQueue() const
+  {
+    return pieceHashQueue_;
+  }
+};
 
 } // namespace aria2
 
@@ -36,12 +36,15 @@
 #define D_COMMAND_H
 
 #include "common.h"
+#include "TimerWheel.h"
 
 namespace aria2 {
 
 typedef int64_t cuid_t;
 
-class Command {
+// A Command can be put to sleep with DownloadEngine::sleepCommand().
+// The timer entry is used for that purpose.
+class Command : public TimerWheel::Entry {
 public:
   enum STATUS {
     STATUS_ALL,
@@ -103,6 +106,11 @@ public:
   void hupEventReceived();
 
   void clearIOEvents();
+
+  bool hasIOEvents() const
+  {
+    return readEvent_ || writeEvent_ || errorEvent_ || hupEvent_;
+  }
 };
 
 } // namespace aria2
@@ -0,0 +1,92 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "CommandProfiler.h"
+
+#include <cinttypes>
+#include <typeinfo>
+
+#include "Command.h"
+#include "LogFactory.h"
+#include "Logger.h"
+#include "fmt.h"
+#include "util.h"
+
+namespace aria2 {
+
+void CommandProfiler::record(const Command* command, Duration d, bool idle)
+{
+  auto& stat = stats_[typeid(*command)];
+  stat.add(d);
+  if (idle) {
+    ++stat.idle;
+  }
+}
+
+std::vector<std::pair<std::string, CommandProfiler::Stat>>
+CommandProfiler::getCommandStats() const
+{
+  std::vector<std::pair<std::string, Stat>> res;
+  for (auto& e : stats_) {
+    res.emplace_back(util::demangle(e.first.name()), e.second);
+  }
+  std::sort(std::begin(res), std::end(res),
+            [](const std::pair<std::string, Stat>& lhs,
+               const std::pair<std::string, Stat>& rhs) {
+              return lhs.second.total > rhs.second.total;
+            });
+  return res;
+}
+
+namespace {
+int64_t toMicros(CommandProfiler::Duration d)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+} // namespace
+
+void CommandProfiler::dump() const
+{
+  A2_LOG_NOTICE(fmt("Command profile: poll count=%" PRIu64
+                    " total=%" PRId64 "us max=%" PRId64 "us",
+                    poll_.count, toMicros(poll_.total), toMicros(poll_.max)));
+  for (auto& e : getCommandStats()) {
+    A2_LOG_NOTICE(fmt("Command profile: %s count=%" PRIu64 " idle=%" PRIu64
+                      " total=%" PRId64 "us max=%" PRId64 "us",
+                      e.first.c_str(), e.second.count, e.second.idle,
+                      toMicros(e.second.total), toMicros(e.second.max)));
+  }
+}
+
+} // namespace aria2
@@ -0,0 +1,96 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_COMMAND_PROFILER_H
+#define D_COMMAND_PROFILER_H
+
+#include "common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace aria2 {
+
+class Command;
+
+// Collects the execution time of Commands per their dynamic type, and
+// the time DownloadEngine spends waiting in EventPoll::poll().
+class CommandProfiler {
+public:
+  typedef std::chrono::steady_clock::duration Duration;
+
+  struct Stat {
+    // The number of executions
+    uint64_t count;
+    // The number of executions after which the Command re-queued
+    // itself although it had not received any I/O event.
+    uint64_t idle;
+    Duration total;
+    Duration max;
+
+    Stat() : count(0), idle(0), total(0), max(0) {}
+
+    void add(Duration d)
+    {
+      ++count;
+      total += d;
+      max = std::max(max, d);
+    }
+  };
+
+  void record(const Command* command, Duration d, bool idle);
+
+  void recordPoll(Duration d) { poll_.add(d); }
+
+  const Stat& getPollStat() const { return poll_; }
+
+  // Returns the name of Command types and their Stat, ordered by the
+  // total execution time in descending order.
+  std::vector<std::pair<std::string, Stat>> getCommandStats() const;
+
+  // Writes the statistics to the log.
+  void dump() const;
+
+private:
+  std::unordered_map<std::type_index, Stat> stats_;
+  Stat poll_;
+};
+
+} // namespace aria2
+
+#endif // D_COMMAND_PROFILER_H
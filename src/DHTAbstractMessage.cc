@@ -34,7 +34,6 @@
 /* copyright --> */
 #include "DHTAbstractMessage.h"
 
-#include <cassert>
 
 #include "DHTNode.h"
 #include "DHTConnection.h"
@@ -71,11 +70,9 @@ std::string DHTAbstractMessage::getBencodedMessage()
 bool DHTAbstractMessage::send()
 {
   std::string message = getBencodedMessage();
-  ssize_t r = connection_->sendMessage(
+  return connection_->queueMessage(
       reinterpret_cast<const unsigned char*>(message.c_str()), message.size(),
       getRemoteNode()->getIPAddress(), getRemoteNode()->getPort());
-  assert(r >= 0);
-  return r == static_cast<ssize_t>(message.size());
 }
 
 void DHTAbstractMessage::setConnection(DHTConnection* connection)
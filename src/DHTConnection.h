@@ -39,6 +39,8 @@
 #include <sys/types.h>
 #include <string>
 
+struct Endpoint;
+
 namespace aria2 {
 
 class DHTConnection {
@@ -50,6 +52,22 @@ public:
 
   virtual ssize_t sendMessage(const unsigned char* data, size_t len,
                               const std::string& host, uint16_t port) = 0;
+
+  // Receives at most |num| messages.  The i-th message is stored in
+  // data + i * len and its length and sender are assigned to
+  // lengths[i] and senders[i].  Returns the number of messages
+  // received.
+  virtual size_t receiveMessages(unsigned char* data, size_t len, size_t num,
+                                 size_t* lengths, Endpoint* senders) = 0;
+
+  // Queues a message, which is sent by flush() together with other
+  // queued messages.  Returns false if the queue is full.
+  virtual bool queueMessage(const unsigned char* data, size_t len,
+                            const std::string& host, uint16_t port) = 0;
+
+  // Sends queued messages.  The messages which cannot be sent without
+  // blocking are left in the queue.
+  virtual void flush() = 0;
 };
 
 } // namespace aria2
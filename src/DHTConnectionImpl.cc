@@ -36,6 +36,7 @@
 
 #include <utility>
 #include <algorithm>
+#include <array>
 
 #include "LogFactory.h"
 #include "Logger.h"
@@ -108,4 +109,56 @@ ssize_t DHTConnectionImpl::sendMessage(const unsigned char* data, size_t len,
   return socket_->writeData(data, len, host, port);
 }
 
+size_t DHTConnectionImpl::receiveMessages(unsigned char* data, size_t len,
+                                          size_t num, size_t* lengths,
+                                          Endpoint* senders)
+{
+  return socket_->readDataFromMany(data, len, num, lengths, senders);
+}
+
+bool DHTConnectionImpl::queueMessage(const unsigned char* data, size_t len,
+                                     const std::string& host, uint16_t port)
+{
+  if (sendQueue_.size() >= SocketCore::MAX_DATAGRAM_BATCH) {
+    flush();
+    if (sendQueue_.size() >= SocketCore::MAX_DATAGRAM_BATCH) {
+      return false;
+    }
+  }
+  QueuedMessage msg;
+  socket_->getDestination(msg.dest, host, port);
+  msg.data.assign(data, data + len);
+  sendQueue_.push_back(std::move(msg));
+  return true;
+}
+
+void DHTConnectionImpl::flush()
+{
+  while (!sendQueue_.empty()) {
+    std::array<a2iovec, SocketCore::MAX_DATAGRAM_BATCH> iov;
+    std::array<SockAddr, SocketCore::MAX_DATAGRAM_BATCH> dests;
+    size_t num = std::min(sendQueue_.size(), SocketCore::MAX_DATAGRAM_BATCH);
+    for (size_t i = 0; i < num; ++i) {
+      auto& msg = sendQueue_[i];
+      iov[i].A2IOVEC_BASE = reinterpret_cast<char*>(msg.data.data());
+      iov[i].A2IOVEC_LEN = msg.data.size();
+      dests[i] = msg.dest;
+    }
+    size_t nsent;
+    try {
+      nsent = socket_->writeDataToMany(iov.data(), dests.data(), num);
+    }
+    catch (RecoverableException& e) {
+      // The message is lost.  The receiver of the message is treated
+      // as timed out later.
+      A2_LOG_INFO_EX("Failed to send UDP message.", e);
+      nsent = 1;
+    }
+    sendQueue_.erase(std::begin(sendQueue_), std::begin(sendQueue_) + nsent);
+    if (socket_->wantWrite()) {
+      break;
+    }
+  }
+}
+
 } // namespace aria2
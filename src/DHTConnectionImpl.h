@@ -38,8 +38,11 @@
 #include "DHTConnection.h"
 
 #include <memory>
+#include <vector>
+#include <deque>
 
 #include "SegList.h"
+#include "a2netcompat.h"
 
 namespace aria2 {
 
@@ -51,6 +54,13 @@ private:
 
   int family_;
 
+  struct QueuedMessage {
+    SockAddr dest;
+    std::vector<unsigned char> data;
+  };
+
+  std::deque<QueuedMessage> sendQueue_;
+
 public:
   DHTConnectionImpl(int family);
 
@@ -85,6 +95,18 @@ public:
                               const std::string& host,
                               uint16_t port) CXX11_OVERRIDE;
 
+  virtual size_t receiveMessages(unsigned char* data, size_t len, size_t num,
+                                 size_t* lengths,
+                                 Endpoint* senders) CXX11_OVERRIDE;
+
+  virtual bool queueMessage(const unsigned char* data, size_t len,
+                            const std::string& host,
+                            uint16_t port) CXX11_OVERRIDE;
+
+  virtual void flush() CXX11_OVERRIDE;
+
+  size_t getQueuedMessageCount() const { return sendQueue_.size(); }
+
   const std::shared_ptr<SocketCore>& getSocket() const { return socket_; }
 };
 
@@ -55,6 +55,9 @@
 #include "fmt.h"
 #include "wallclock.h"
 #include "TrackerWatcherCommand.h"
+#include "UtpSocketManager.h"
+#include "ReceiverMSEHandshakeCommand.h"
+#include "Peer.h"
 
 namespace aria2 {
 
@@ -65,7 +68,9 @@ DHTInteractionCommand::DHTInteractionCommand(cuid_t cuid, DownloadEngine* e)
       e_{e},
       dispatcher_{nullptr},
       receiver_{nullptr},
-      taskQueue_{nullptr}
+      taskQueue_{nullptr},
+      recvbuf_{make_unique<unsigned char[]>(SocketCore::MAX_DATAGRAM_BATCH *
+                                             RECV_BUFFER_LENGTH)}
 {
   setStatusRealtime();
 }
@@ -73,6 +78,9 @@ DHTInteractionCommand::DHTInteractionCommand(cuid_t cuid, DownloadEngine* e)
 DHTInteractionCommand::~DHTInteractionCommand()
 {
   disableReadCheckSocket(readCheckSocket_);
+  if (utpSocketManager_) {
+    utpSocketManager_->setEventTarget(nullptr, nullptr);
+  }
 }
 
 void DHTInteractionCommand::setReadCheckSocket(
@@ -109,36 +117,20 @@ bool DHTInteractionCommand::execute()
 
   taskQueue_->executeTask();
 
-  std::string remoteAddr;
-  uint16_t remotePort;
-  std::array<unsigned char, 64_k> data;
   try {
     while (1) {
-      ssize_t length = connection_->receiveMessage(data.data(), data.size(),
-                                                   remoteAddr, remotePort);
-      if (length <= 0) {
-        break;
-      }
-      if (data[0] == 'd') {
-        // udp tracker response does not start with 'd', so assume
-        // this message belongs to DHT. nothrow.
-        receiver_->receiveMessage(remoteAddr, remotePort, data.data(), length);
-      }
-      else {
-        // this may be udp tracker response. nothrow.
-        std::shared_ptr<UDPTrackerRequest> req;
-        if (udpTrackerClient_->receiveReply(req, data.data(), length,
-                                            remoteAddr, remotePort,
-                                            global::wallclock()) == 0) {
-          if (req->action == UDPT_ACT_ANNOUNCE) {
-            auto c = static_cast<TrackerWatcherCommand*>(req->user_data);
-            if (c) {
-              c->setStatus(Command::STATUS_ONESHOT_REALTIME);
-              e_->setNoWait(true);
-            }
-          }
+      size_t num = connection_->receiveMessages(
+          recvbuf_.get(), RECV_BUFFER_LENGTH, SocketCore::MAX_DATAGRAM_BATCH,
+          recvLengths_.data(), recvSenders_.data());
+      for (size_t i = 0; i < num; ++i) {
+        if (recvLengths_[i] > 0) {
+          dispatchMessage(recvbuf_.get() + i * RECV_BUFFER_LENGTH,
+                          recvLengths_[i], recvSenders_[i]);
         }
       }
+      if (num < SocketCore::MAX_DATAGRAM_BATCH) {
+        break;
+      }
     }
   }
   catch (RecoverableException& e) {
@@ -147,6 +139,9 @@ bool DHTInteractionCommand::execute()
   receiver_->handleTimeout();
   udpTrackerClient_->handleTimeout(global::wallclock());
   dispatcher_->sendMessages();
+  std::string remoteAddr;
+  uint16_t remotePort;
+  std::array<unsigned char, 64_k> data;
   while (!udpTrackerClient_->getPendingRequests().empty()) {
     // no throw
     ssize_t length = udpTrackerClient_->createRequest(
@@ -156,7 +151,10 @@ bool DHTInteractionCommand::execute()
     }
     try {
       // throw
-      connection_->sendMessage(data.data(), length, remoteAddr, remotePort);
+      if (!connection_->queueMessage(data.data(), length, remoteAddr,
+                                     remotePort)) {
+        break;
+      }
       udpTrackerClient_->requestSent(global::wallclock());
     }
     catch (RecoverableException& e) {
@@ -164,10 +162,75 @@ bool DHTInteractionCommand::execute()
       udpTrackerClient_->requestFail(UDPT_ERR_NETWORK);
     }
   }
+  if (utpSocketManager_) {
+    processUtp();
+  }
+  connection_->flush();
   e_->addRoutineCommand(std::unique_ptr<Command>(this));
   return false;
 }
 
+void DHTInteractionCommand::dispatchMessage(unsigned char* data, size_t length,
+                                            const Endpoint& sender)
+{
+  if (utpSocketManager_ && UtpSocketManager::isUtpPacket(data, length)) {
+    utpSocketManager_->receivePacket(data, length, sender.addr, sender.port,
+                                     global::wallclock());
+  }
+  else if (data[0] == 'd') {
+    // udp tracker response does not start with 'd', so assume
+    // this message belongs to DHT. nothrow.
+    receiver_->receiveMessage(sender.addr, sender.port, data, length);
+  }
+  else {
+    // this may be udp tracker response. nothrow.
+    std::shared_ptr<UDPTrackerRequest> req;
+    if (udpTrackerClient_->receiveReply(req, data, length, sender.addr,
+                                        sender.port,
+                                        global::wallclock()) == 0) {
+      if (req->action == UDPT_ACT_ANNOUNCE) {
+        auto c = static_cast<TrackerWatcherCommand*>(req->user_data);
+        if (c) {
+          c->setStatus(Command::STATUS_ONESHOT_REALTIME);
+          e_->setNoWait(true);
+        }
+      }
+    }
+  }
+}
+
+void DHTInteractionCommand::processUtp()
+{
+  utpSocketManager_->process(global::wallclock());
+  std::shared_ptr<SocketCore> socket;
+  std::string remoteAddr;
+  uint16_t remotePort;
+  while (utpSocketManager_->popAcceptedConnection(socket, remoteAddr,
+                                                  remotePort)) {
+    auto peer = std::make_shared<Peer>(remoteAddr, remotePort, true);
+    cuid_t cuid = e_->newCUID();
+    e_->addCommand(
+        make_unique<ReceiverMSEHandshakeCommand>(cuid, peer, e_, socket));
+    A2_LOG_DEBUG(fmt("Added CUID#%" PRId64
+                     " to receive BitTorrent/MSE handshake over uTP.",
+                     cuid));
+  }
+  while (!utpSocketManager_->getPendingPackets().empty()) {
+    auto& packet = utpSocketManager_->getPendingPackets().front();
+    try {
+      if (!connection_->queueMessage(packet.data.data(), packet.data.size(),
+                                     packet.remoteAddr, packet.remotePort)) {
+        break;
+      }
+    }
+    catch (RecoverableException& e) {
+      // The packet is lost.  It is retransmitted if necessary.
+      A2_LOG_INFO_EX("Exception thrown while sending uTP packet.", e);
+    }
+    utpSocketManager_->packetSent();
+  }
+}
+
 void DHTInteractionCommand::setMessageDispatcher(
     DHTMessageDispatcher* dispatcher)
 {
@@ -196,4 +259,13 @@ void DHTInteractionCommand::setUDPTrackerClient(
   udpTrackerClient_ = udpTrackerClient;
 }
 
+void DHTInteractionCommand::setUtpSocketManager(
+    const std::shared_ptr<UtpSocketManager>& utpSocketManager)
+{
+  utpSocketManager_ = utpSocketManager;
+  if (utpSocketManager_) {
+    utpSocketManager_->setEventTarget(e_, this);
+  }
+}
+
 } // namespace aria2
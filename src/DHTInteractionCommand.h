@@ -38,6 +38,11 @@
 #include "Command.h"
 
 #include <memory>
+#include <array>
+
+#include "a2netcompat.h"
+#include "a2functional.h"
+#include "SocketCore.h"
 
 namespace aria2 {
 
@@ -45,9 +50,9 @@ class DHTMessageDispatcher;
 class DHTMessageReceiver;
 class DHTTaskQueue;
 class DownloadEngine;
-class SocketCore;
 class DHTConnection;
 class UDPTrackerClient;
+class UtpSocketManager;
 
 class DHTInteractionCommand : public Command {
 private:
@@ -58,6 +63,19 @@ private:
   std::shared_ptr<SocketCore> readCheckSocket_;
   std::unique_ptr<DHTConnection> connection_;
   std::shared_ptr<UDPTrackerClient> udpTrackerClient_;
+  std::shared_ptr<UtpSocketManager> utpSocketManager_;
+
+  // The size of buffer for a UDP message.
+  static const size_t RECV_BUFFER_LENGTH = 64_k;
+
+  std::unique_ptr<unsigned char[]> recvbuf_;
+  std::array<size_t, SocketCore::MAX_DATAGRAM_BATCH> recvLengths_;
+  std::array<Endpoint, SocketCore::MAX_DATAGRAM_BATCH> recvSenders_;
+
+  void dispatchMessage(unsigned char* data, size_t length,
+                       const Endpoint& sender);
+
+  void processUtp();
 
 public:
   DHTInteractionCommand(cuid_t cuid, DownloadEngine* e);
@@ -80,6 +98,9 @@ public:
 
   void setUDPTrackerClient(
       const std::shared_ptr<UDPTrackerClient>& udpTrackerClient);
+
+  void setUtpSocketManager(
+      const std::shared_ptr<UtpSocketManager>& utpSocketManager);
 };
 
 } // namespace aria2
@@ -64,6 +64,7 @@
 #include "DHTMessageTrackerEntry.h"
 #include "DHTMessageEntry.h"
 #include "UDPTrackerClient.h"
+#include "UtpSocketManager.h"
 #include "BtRegistry.h"
 #include "prefs.h"
 #include "Option.h"
@@ -150,6 +151,12 @@ DHTSetup::setup(DownloadEngine* e, int family)
     auto tokenTracker = make_unique<DHTTokenTracker>();
     // For now, UDPTrackerClient was enabled along with DHT
     auto udpTrackerClient = std::make_shared<UDPTrackerClient>();
+    // uTP shares the UDP port with DHT.  IPv6 peers are connected
+    // over TCP.
+    std::shared_ptr<UtpSocketManager> utpSocketManager;
+    if (family == AF_INET && e->getOption()->getAsBool(PREF_BT_ENABLE_UTP)) {
+      utpSocketManager = std::make_shared<UtpSocketManager>();
+    }
     const auto messageTimeout =
         e->getOption()->getAsInt(PREF_DHT_MESSAGE_TIMEOUT);
     // wiring up
@@ -215,6 +222,7 @@ DHTSetup::setup(DownloadEngine* e, int family)
       command->setReadCheckSocket(connection->getSocket());
       command->setConnection(std::move(connection));
       command->setUDPTrackerClient(udpTrackerClient);
+      command->setUtpSocketManager(utpSocketManager);
       tempRoutineCommands.push_back(std::move(command));
     }
     {
@@ -268,6 +276,7 @@ DHTSetup::setup(DownloadEngine* e, int family)
       DHTRegistry::getMutableData().messageReceiver = std::move(receiver);
       DHTRegistry::getMutableData().messageFactory = std::move(factory);
       e->getBtRegistry()->setUDPTrackerClient(udpTrackerClient);
+      e->getBtRegistry()->setUtpSocketManager(utpSocketManager);
       DHTRegistry::setInitialized(true);
     }
     else {
@@ -298,6 +307,8 @@ DHTSetup::setup(DownloadEngine* e, int family)
       DHTRegistry::clearData();
       e->getBtRegistry()->setUDPTrackerClient(
           std::shared_ptr<UDPTrackerClient>{});
+      e->getBtRegistry()->setUtpSocketManager(
+          std::shared_ptr<UtpSocketManager>{});
     }
     else {
       DHTRegistry::clearData6();
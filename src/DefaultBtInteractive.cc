@@ -38,6 +38,7 @@
 #include <vector>
 
 #include "prefs.h"
+#include "Option.h"
 #include "message.h"
 #include "BtHandshakeMessage.h"
 #include "util.h"
@@ -77,6 +78,9 @@
 #include "fmt.h"
 #include "RequestGroup.h"
 #include "RequestGroupMan.h"
+#ifdef ENABLE_ASYNC_DISK_WRITE
+#  include "DiskWriteQueue.h"
+#endif // ENABLE_ASYNC_DISK_WRITE
 #include "bittorrent_helper.h"
 #include "UTMetadataRequestFactory.h"
 #include "UTMetadataRequestTracker.h"
@@ -103,7 +107,6 @@ DefaultBtInteractive::DefaultBtInteractive(
       utPexEnabled_(false),
       dhtEnabled_(false),
       numReceivedMessage_(0),
-      maxOutstandingRequest_(DEFAULT_MAX_OUTSTANDING_REQUEST),
       requestGroupMan_(nullptr),
       tcpPort_(0)
 {
@@ -307,6 +310,14 @@ size_t DefaultBtInteractive::receiveMessages()
         downloadContext_->getOwnerRequestGroup()->doesDownloadSpeedExceed()) {
       break;
     }
+#ifdef ENABLE_ASYNC_DISK_WRITE
+    // Stop receiving BtPieceMessage until the queued data are written
+    // to the disk.
+    if (requestGroupMan_->getDiskWriteQueue() &&
+        requestGroupMan_->getDiskWriteQueue()->full()) {
+      break;
+    }
+#endif // ENABLE_ASYNC_DISK_WRITE
     auto message = btMessageReceiver_->receiveMessage();
     if (!message) {
       break;
@@ -339,16 +350,49 @@ size_t DefaultBtInteractive::receiveMessages()
   }
 
   if (!pieceStorage_->isEndGame() &&
-      countOldOutstandingRequest > dispatcher_->countOutstandingRequest() &&
-      (countOldOutstandingRequest - dispatcher_->countOutstandingRequest()) *
-              4 >=
-          maxOutstandingRequest_) {
-    maxOutstandingRequest_ = std::min((size_t)UB_MAX_OUTSTANDING_REQUEST,
-                                      maxOutstandingRequest_ * 2);
+      countOldOutstandingRequest > dispatcher_->countOutstandingRequest()) {
+    updateMaxOutstandingRequest(countOldOutstandingRequest -
+                                dispatcher_->countOutstandingRequest());
   }
   return msgcount;
 }
 
+void DefaultBtInteractive::updateMaxOutstandingRequest(
+    size_t numCompletedRequest)
+{
+  size_t maxOutstandingRequest = peer_->getMaxOutstandingRequest();
+  auto rtt = peer_->getMinBlockRtt();
+  if (rtt.count() == 0) {
+    // No round-trip time yet.  Double the pipeline if the peer
+    // answered a quarter of it at once.
+    if (numCompletedRequest * 4 >= maxOutstandingRequest) {
+      maxOutstandingRequest *= 2;
+    }
+  }
+  else {
+    // Keep twice the bandwidth-delay product in flight.  While the
+    // download speed is limited by the pipeline itself, this doubles
+    // it every round trip.
+    int64_t bdp = static_cast<int64_t>(peer_->calculateDownloadSpeed()) *
+                  rtt.count() / 1000;
+    maxOutstandingRequest =
+        std::max(DEFAULT_MAX_OUTSTANDING_REQUEST,
+                 static_cast<size_t>((2 * bdp + Piece::BLOCK_LENGTH - 1) /
+                                     Piece::BLOCK_LENGTH));
+  }
+  peer_->setMaxOutstandingRequest(
+      std::min(maxOutstandingRequest, getMaxOutstandingRequestLimit()));
+}
+
+size_t DefaultBtInteractive::getMaxOutstandingRequestLimit() const
+{
+  auto group = downloadContext_->getOwnerRequestGroup();
+  if (!group) {
+    return DEFAULT_MAX_OUTSTANDING_REQUEST_LIMIT;
+  }
+  return group->getOption()->getAsInt(PREF_BT_MAX_OUTSTANDING_REQUEST);
+}
+
 void DefaultBtInteractive::decideInterest()
 {
   if (pieceStorage_->hasMissingPiece(peer_)) {
@@ -416,11 +460,14 @@ void DefaultBtInteractive::addRequests()
   if (!pieceStorage_->isEndGame() && !pieceStorage_->hasMissingUnusedPiece()) {
     pieceStorage_->enterEndGame();
   }
-  fillPiece(maxOutstandingRequest_);
+  // The limit may have been lowered since the depth was last updated.
+  size_t maxOutstandingRequest = std::min(peer_->getMaxOutstandingRequest(),
+                                          getMaxOutstandingRequestLimit());
+  fillPiece(maxOutstandingRequest);
   size_t reqNumToCreate =
-      maxOutstandingRequest_ <= dispatcher_->countOutstandingRequest()
+      maxOutstandingRequest <= dispatcher_->countOutstandingRequest()
           ? 0
-          : maxOutstandingRequest_ - dispatcher_->countOutstandingRequest();
+          : maxOutstandingRequest - dispatcher_->countOutstandingRequest();
 
   if (reqNumToCreate > 0) {
     auto requests = btRequestFactory_->createRequestMessages(
@@ -140,8 +140,6 @@ private:
 
   size_t numReceivedMessage_;
 
-  size_t maxOutstandingRequest_;
-
   RequestGroupMan* requestGroupMan_;
 
   uint16_t tcpPort_;
@@ -155,6 +153,11 @@ private:
   void decideInterest();
   void fillPiece(size_t maxMissingBlock);
   void addRequests();
+  void updateMaxOutstandingRequest(size_t numCompletedRequest);
+  // Returns the upper limit of the number of outstanding requests to
+  // the peer.  It is read from the option every time, so that it can
+  // be changed while the download is running.
+  size_t getMaxOutstandingRequestLimit() const;
   void detectMessageFlooding();
   void checkActiveInteraction();
   void addPeerExchangeMessage();
@@ -67,6 +67,7 @@
 #include "SingletonHolder.h"
 #include "Notifier.h"
 #include "WrDiskCache.h"
+#include "RdDiskCache.h"
 #include "RequestGroup.h"
 #include "SimpleRandomizer.h"
 #ifdef ENABLE_BITTORRENT
@@ -92,7 +93,8 @@ DefaultPieceStorage::DefaultPieceStorage(
       pieceStatMan_(std::make_shared<PieceStatMan>(
           downloadContext->getNumPieces(), true)),
       pieceSelector_(make_unique<RarestPieceSelector>(pieceStatMan_)),
-      wrDiskCache_(nullptr)
+      wrDiskCache_(nullptr),
+      rdDiskCache_(nullptr)
 {
   const std::string& pieceSelectorOpt =
       option_->get(PREF_STREAM_PIECE_SELECTOR);
@@ -114,7 +116,12 @@ DefaultPieceStorage::DefaultPieceStorage(
   }
 }
 
-DefaultPieceStorage::~DefaultPieceStorage() = default;
+DefaultPieceStorage::~DefaultPieceStorage()
+{
+  if (rdDiskCache_ && diskAdaptor_) {
+    rdDiskCache_->remove(diskAdaptor_.get());
+  }
+}
 
 std::shared_ptr<Piece> DefaultPieceStorage::checkOutPiece(size_t index,
                                                           cuid_t cuid)
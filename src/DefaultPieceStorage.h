@@ -95,6 +95,7 @@ private:
   std::unique_ptr<StreamPieceSelector> streamPieceSelector_;
 
   WrDiskCache* wrDiskCache_;
+  RdDiskCache* rdDiskCache_;
 #ifdef ENABLE_BITTORRENT
   void getMissingPiece(std::vector<std::shared_ptr<Piece>>& pieces,
                        size_t minMissingBlocks, const unsigned char* bitfield,
@@ -234,6 +235,8 @@ public:
 
   virtual WrDiskCache* getWrDiskCache() CXX11_OVERRIDE;
 
+  virtual RdDiskCache* getRdDiskCache() CXX11_OVERRIDE { return rdDiskCache_; }
+
   virtual void flushWrDiskCacheEntry() CXX11_OVERRIDE;
 
   virtual int32_t getPieceLength(size_t index) CXX11_OVERRIDE;
@@ -300,6 +303,8 @@ public:
   std::unique_ptr<PieceSelector> popPieceSelector();
 
   void setWrDiskCache(WrDiskCache* wrDiskCache) { wrDiskCache_ = wrDiskCache; }
+
+  void setRdDiskCache(RdDiskCache* rdDiskCache) { rdDiskCache_ = rdDiskCache; }
 };
 
 } // namespace aria2
@@ -33,8 +33,13 @@
  */
 /* copyright --> */
 #include "DiskAdaptor.h"
+
+#include <algorithm>
 #include "FileEntry.h"
 #include "OpenedFileCounter.h"
+#include "WrDiskCacheEntry.h"
+#include "LogFactory.h"
+#include "fmt.h"
 
 namespace aria2 {
 
@@ -42,4 +47,42 @@ DiskAdaptor::DiskAdaptor() : fileAllocationMethod_(FILE_ALLOC_ADAPTIVE) {}
 
 DiskAdaptor::~DiskAdaptor() = default;
 
+size_t DiskAdaptor::writeCache(const WrDiskCacheEntry* entry)
+{
+  return writeCache(std::vector<const WrDiskCacheEntry*>{entry});
+}
+
+size_t
+DiskAdaptor::writeCache(const std::vector<const WrDiskCacheEntry*>& entries)
+{
+  std::vector<const WrDiskCacheEntry::DataCell*> cells;
+  for (auto ent : entries) {
+    cells.insert(std::end(cells), std::begin(ent->getDataSet()),
+                 std::end(ent->getDataSet()));
+  }
+  std::sort(std::begin(cells), std::end(cells),
+            [](const WrDiskCacheEntry::DataCell* lhs,
+               const WrDiskCacheEntry::DataCell* rhs) { return *lhs < *rhs; });
+  size_t nwrite = 0;
+  std::vector<a2iovec> iov;
+  for (auto i = std::begin(cells), eoi = std::end(cells); i != eoi;) {
+    int64_t goff = (*i)->goff;
+    int64_t last = goff;
+    iov.clear();
+    for (; i != eoi && (*i)->goff == last; ++i) {
+      a2iovec v;
+      v.A2IOVEC_BASE = reinterpret_cast<char*>((*i)->data + (*i)->offset);
+      v.A2IOVEC_LEN = (*i)->len;
+      iov.push_back(v);
+      last += (*i)->len;
+    }
+    A2_LOG_DEBUG(fmt("Cache flush goff=%" PRId64 ", len=%" PRId64
+                     ", cells=%lu",
+                     goff, last - goff, static_cast<unsigned long>(iov.size())));
+    writeDataVec(iov.data(), iov.size(), goff);
+    ++nwrite;
+  }
+  return nwrite;
+}
+
 } // namespace aria2
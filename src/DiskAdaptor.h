@@ -49,6 +49,10 @@ class FileEntry;
 class FileAllocationIterator;
 class WrDiskCacheEntry;
 class OpenedFileCounter;
+class DiskWriteQueue;
+#ifdef HAVE_SENDFILE
+class FileHandle;
+#endif // HAVE_SENDFILE
 
 class DiskAdaptor : public BinaryStream {
 public:
@@ -96,6 +100,24 @@ public:
   // have been opened before this method call.
   virtual void enableMmap() {}
 
+  // Offloads writes to the worker threads of |queue|.  Writes are
+  // done synchronously if mmap is enabled.
+  virtual void enableAsyncWrite(const std::shared_ptr<DiskWriteQueue>& queue)
+  {
+  }
+
+#ifdef HAVE_SENDFILE
+  // Returns the handle of the file which contains the whole data in
+  // [offset, offset + len) and stores the offset of the data in the
+  // file in |fileOffset|.  Returns nullptr if the range spans
+  // multiple files or the file cannot be read directly.
+  virtual std::shared_ptr<FileHandle>
+  getFileHandle(int64_t offset, size_t len, int64_t& fileOffset)
+  {
+    return nullptr;
+  }
+#endif // HAVE_SENDFILE
+
   // Assumed each file length is stored in fileEntries or DiskAdaptor knows it.
   // If each actual file's length is larger than that, truncate file to that
   // length.
@@ -111,8 +133,13 @@ public:
   virtual ssize_t readDataDropCache(unsigned char* data, size_t len,
                                     int64_t offset) = 0;
 
-  // Writes cached data to the underlying disk.
-  virtual void writeCache(const WrDiskCacheEntry* entry) = 0;
+  // Writes cached data to the underlying disk.  Contiguous data cells
+  // are gathered into one writeDataVec() call.  Returns the number of
+  // the calls.
+  size_t writeCache(const WrDiskCacheEntry* entry);
+
+  // Same as above, but the data cells are gathered across |entries|.
+  size_t writeCache(const std::vector<const WrDiskCacheEntry*>& entries);
 
   void setFileAllocationMethod(FileAllocationMethod method)
   {
@@ -0,0 +1,261 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "DiskWriteQueue.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <system_error>
+
+#include "SocketCore.h"
+#include "LogFactory.h"
+#include "Logger.h"
+#include "fmt.h"
+#include "util.h"
+#include "a2functional.h"
+#include "TimerA2.h"
+#include "metrics.h"
+
+namespace aria2 {
+
+DiskWriteQueue::DiskWriteQueue(size_t numThreads, size_t maxBytes)
+    : maxBytes_(maxBytes),
+      queuedBytes_(0),
+      shutdown_(false),
+      wakeupPending_(false),
+      wakeupSent_(false),
+      wakeupfd_{-1, -1}
+{
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, wakeupfd_) == -1) {
+    int errNum = errno;
+    A2_LOG_ERROR(
+        fmt("Creating wakeup socket for disk writer threads failed: %s",
+            util::safeStrerror(errNum).c_str()));
+    wakeupfd_[0] = wakeupfd_[1] = -1;
+    return;
+  }
+  for (auto fd : wakeupfd_) {
+    util::make_fd_cloexec(fd);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  }
+  wakeupSocket_ = std::make_shared<SocketCore>(wakeupfd_[0], SOCK_STREAM);
+  try {
+    for (size_t i = 0; i < numThreads; ++i) {
+      workers_.emplace_back(&DiskWriteQueue::run, this);
+    }
+  }
+  catch (std::system_error& e) {
+    A2_LOG_ERROR(fmt("Starting disk writer thread failed: %s", e.what()));
+  }
+  A2_LOG_DEBUG(fmt("Started %lu disk writer threads",
+                   static_cast<unsigned long>(workers_.size())));
+}
+
+DiskWriteQueue::~DiskWriteQueue()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  jobCond_.notify_all();
+  for (auto& th : workers_) {
+    th.join();
+  }
+  if (wakeupfd_[1] != -1) {
+    close(wakeupfd_[1]);
+  }
+  // wakeupfd_[0] is closed by wakeupSocket_.
+}
+
+bool DiskWriteQueue::good() const
+{
+  return wakeupSocket_ && !workers_.empty();
+}
+
+void DiskWriteQueue::push(const std::shared_ptr<DiskWriteFile>& file, int fd,
+                          const unsigned char* data, size_t len,
+                          int64_t offset)
+{
+  a2iovec iov;
+  iov.A2IOVEC_BASE = reinterpret_cast<char*>(const_cast<unsigned char*>(data));
+  iov.A2IOVEC_LEN = len;
+  push(file, fd, &iov, 1, offset);
+}
+
+void DiskWriteQueue::push(const std::shared_ptr<DiskWriteFile>& file, int fd,
+                          const a2iovec* iov, size_t iovcnt, int64_t offset)
+{
+  size_t len = 0;
+  for (size_t i = 0; i < iovcnt; ++i) {
+    len += iov[i].A2IOVEC_LEN;
+  }
+  auto buf = make_unique<unsigned char[]>(len);
+  auto p = buf.get();
+  for (size_t i = 0; i < iovcnt; ++i) {
+    memcpy(p, iov[i].A2IOVEC_BASE, iov[i].A2IOVEC_LEN);
+    p += iov[i].A2IOVEC_LEN;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    file->ranges.emplace_back(offset, len);
+    queuedBytes_ += len;
+    jobs_.push_back(Job{file, fd, std::move(buf), len, offset});
+  }
+  jobCond_.notify_one();
+}
+
+namespace {
+bool overlap(const std::pair<int64_t, size_t>& range, int64_t offset,
+             size_t len)
+{
+  return range.first < offset + static_cast<int64_t>(len) &&
+         offset < range.first + static_cast<int64_t>(range.second);
+}
+} // namespace
+
+void DiskWriteQueue::wait(const std::shared_ptr<DiskWriteFile>& file,
+                          int64_t offset, size_t len)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  doneCond_.wait(lock, [&] {
+    return std::none_of(std::begin(file->ranges), std::end(file->ranges),
+                        [&](const std::pair<int64_t, size_t>& range) {
+                          return overlap(range, offset, len);
+                        });
+  });
+}
+
+void DiskWriteQueue::wait(const std::shared_ptr<DiskWriteFile>& file)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  doneCond_.wait(lock, [&] { return file->ranges.empty(); });
+}
+
+int DiskWriteQueue::takeError(const std::shared_ptr<DiskWriteFile>& file)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  int errNum = file->errNum;
+  file->errNum = 0;
+  return errNum;
+}
+
+bool DiskWriteQueue::full()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (queuedBytes_ < maxBytes_) {
+    return false;
+  }
+  if (wakeupSent_) {
+    // Drain the wakeup socket, so that the Commands which start
+    // waiting now are not woken up until the queue is drained again.
+    // It is not drained when the queue is not full because the
+    // Commands waiting for it may not have seen it yet.
+    unsigned char buf[64];
+    while (read(wakeupfd_[0], buf, sizeof(buf)) > 0)
+      ;
+    wakeupSent_ = false;
+  }
+  wakeupPending_ = true;
+  return true;
+}
+
+size_t DiskWriteQueue::getQueuedBytes()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queuedBytes_;
+}
+
+void DiskWriteQueue::run()
+{
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      jobCond_.wait(lock, [this] { return shutdown_ || !jobs_.empty(); });
+      if (jobs_.empty()) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    int errNum = 0;
+    Timer start;
+    for (size_t written = 0; written < job.len;) {
+      auto nwrite = pwrite(job.fd, job.data.get() + written,
+                           job.len - written, job.offset + written);
+      if (nwrite == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        errNum = errno;
+        break;
+      }
+      written += nwrite;
+    }
+    metrics::diskWriteLatency().observe(start.difference());
+    complete(job, errNum);
+  }
+}
+
+void DiskWriteQueue::complete(const Job& job, int errNum)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& ranges = job.file->ranges;
+    auto i = std::find(std::begin(ranges), std::end(ranges),
+                       std::make_pair(job.offset, job.len));
+    if (i != std::end(ranges)) {
+      ranges.erase(i);
+    }
+    if (errNum != 0 && job.file->errNum == 0) {
+      job.file->errNum = errNum;
+    }
+    queuedBytes_ -= job.len;
+    if (wakeupPending_ && queuedBytes_ <= maxBytes_ / 2) {
+      wakeupPending_ = false;
+      wakeupSent_ = true;
+      unsigned char c = 0;
+      while (write(wakeupfd_[1], &c, 1) == -1 && errno == EINTR)
+        ;
+    }
+  }
+  doneCond_.notify_all();
+}
+
+} // namespace aria2
@@ -0,0 +1,156 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_DISK_WRITE_QUEUE_H
+#define D_DISK_WRITE_QUEUE_H
+
+#include "common.h"
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "a2netcompat.h"
+
+namespace aria2 {
+
+class SocketCore;
+
+// Per-file state shared by AbstractDiskWriter and the worker threads
+// of DiskWriteQueue.  The members are guarded by the mutex of
+// DiskWriteQueue.
+struct DiskWriteFile {
+  // The ranges [offset, offset + length) of the writes which are
+  // queued or in progress.
+  std::vector<std::pair<int64_t, size_t>> ranges;
+  // The error number of the first failed write, or 0.
+  int errNum;
+
+  DiskWriteFile() : errNum(0) {}
+};
+
+// Offloads pwrite(2) calls to a small pool of worker threads so that
+// a slow disk does not stall the event loop.  Except for the worker
+// threads themselves, all functions must be called from the thread
+// which runs DownloadEngine.
+class DiskWriteQueue {
+public:
+  // Starts |numThreads| workers.  Queued bytes above |maxBytes| make
+  // full() return true.
+  DiskWriteQueue(size_t numThreads, size_t maxBytes);
+
+  // Waits for the queued writes to complete and joins the workers.
+  ~DiskWriteQueue();
+
+  // Returns true if the workers and the wakeup socket were created
+  // successfully.
+  bool good() const;
+
+  // Copies |len| bytes pointed by |data| and queues a write of them
+  // to |fd| at |offset|.  The caller must keep |fd| open until
+  // wait(file) returns.
+  void push(const std::shared_ptr<DiskWriteFile>& file, int fd,
+            const unsigned char* data, size_t len, int64_t offset);
+
+  // Same as above, but gathers |iovcnt| buffers in |iov| into one
+  // write.
+  void push(const std::shared_ptr<DiskWriteFile>& file, int fd,
+            const a2iovec* iov, size_t iovcnt, int64_t offset);
+
+  // Blocks until no queued write of |file| overlaps [offset, offset +
+  // len).
+  void wait(const std::shared_ptr<DiskWriteFile>& file, int64_t offset,
+            size_t len);
+
+  // Blocks until all queued writes of |file| complete.
+  void wait(const std::shared_ptr<DiskWriteFile>& file);
+
+  // Returns the error number of the first failed write of |file| and
+  // clears it.  Returns 0 if no write failed.
+  int takeError(const std::shared_ptr<DiskWriteFile>& file);
+
+  // Returns true if the number of queued bytes reached the limit.
+  // Commands which receive data from network should stop reading and
+  // wait for getWakeupSocket() to become readable, which happens
+  // when the queue is drained to the half of the limit.
+  bool full();
+
+  const std::shared_ptr<SocketCore>& getWakeupSocket() const
+  {
+    return wakeupSocket_;
+  }
+
+  size_t getQueuedBytes();
+
+private:
+  struct Job {
+    std::shared_ptr<DiskWriteFile> file;
+    int fd;
+    std::unique_ptr<unsigned char[]> data;
+    size_t len;
+    int64_t offset;
+  };
+
+  void run();
+
+  void complete(const Job& job, int errNum);
+
+  std::vector<std::thread> workers_;
+  std::deque<Job> jobs_;
+  std::mutex mutex_;
+  // Signaled when a job is pushed or the queue is shutting down.
+  std::condition_variable jobCond_;
+  // Signaled when a job completes.
+  std::condition_variable doneCond_;
+  size_t maxBytes_;
+  size_t queuedBytes_;
+  bool shutdown_;
+  // True if full() returned true and the event loop has not been
+  // woken up yet.
+  bool wakeupPending_;
+  // True if a byte was written to the wakeup socket and it has not
+  // been drained yet.
+  bool wakeupSent_;
+  // wakeupfd_[0] is wrapped by wakeupSocket_.  Workers write a byte
+  // to wakeupfd_[1].
+  int wakeupfd_[2];
+  std::shared_ptr<SocketCore> wakeupSocket_;
+};
+
+} // namespace aria2
+
+#endif // D_DISK_WRITE_QUEUE_H
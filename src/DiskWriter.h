@@ -37,8 +37,15 @@
 
 #include "BinaryStream.h"
 
+#include <memory>
+
 namespace aria2 {
 
+class DiskWriteQueue;
+#ifdef HAVE_SENDFILE
+class FileHandle;
+#endif // HAVE_SENDFILE
+
 /**
  * Interface for writing to a binary stream of bytes.
  *
@@ -83,6 +90,23 @@ public:
   // Enables mmap.
   virtual void enableMmap() {}
 
+  // Offloads writes to the worker threads of |queue|. This is an
+  // optional functionality. The default implementation is do nothing.
+  virtual void enableAsyncWrite(const std::shared_ptr<DiskWriteQueue>& queue)
+  {
+  }
+
+#ifdef HAVE_SENDFILE
+  // Returns the handle of the opened file, from which the data in
+  // [offset, offset + len) can be read directly, or nullptr if it is
+  // not available.  The pending writes to the range are completed
+  // before return.
+  virtual std::shared_ptr<FileHandle> getFileHandle(int64_t offset, size_t len)
+  {
+    return nullptr;
+  }
+#endif // HAVE_SENDFILE
+
   // Drops cache in range [offset, offset + len)
   virtual void dropCache(int64_t len, int64_t offset) {}
 };
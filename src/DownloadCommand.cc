@@ -35,6 +35,8 @@
 #include "DownloadCommand.h"
 
 #include <cassert>
+#include <cerrno>
+#include <algorithm>
 
 #include "Request.h"
 #include "RequestGroup.h"
@@ -58,6 +60,9 @@
 #include "prefs.h"
 #include "fmt.h"
 #include "RequestGroupMan.h"
+#ifdef ENABLE_ASYNC_DISK_WRITE
+#  include "DiskWriteQueue.h"
+#endif // ENABLE_ASYNC_DISK_WRITE
 #include "wallclock.h"
 #include "SinkStreamFilter.h"
 #include "FileEntry.h"
@@ -67,6 +72,10 @@
 #include "DownloadFailureException.h"
 #include "MessageDigest.h"
 #include "message_digest_helper.h"
+#ifdef HAVE_SPLICE
+#  include "SplicePipe.h"
+#  include "FileHandle.h"
+#endif // HAVE_SPLICE
 #ifdef ENABLE_BITTORRENT
 #  include "bittorrent_helper.h"
 #endif // ENABLE_BITTORRENT
@@ -84,6 +93,9 @@ DownloadCommand::DownloadCommand(
       lowestDownloadSpeedLimit_(0),
       pieceHashValidationEnabled_(false)
 {
+#ifdef HAVE_SPLICE
+  spliceEnabled_ = false;
+#endif // HAVE_SPLICE
   {
     if (getOption()->getAsBool(PREF_REALTIME_CHUNK_CHECKSUM)) {
       const std::string& algo = getDownloadContext()->getPieceHashType();
@@ -141,13 +153,31 @@ bool DownloadCommand::executeInternal()
     disableWriteCheckSocket();
     return false;
   }
+#ifdef ENABLE_ASYNC_DISK_WRITE
+  {
+    auto& diskWriteQueue =
+        getDownloadEngine()->getRequestGroupMan()->getDiskWriteQueue();
+    if (diskWriteQueue && diskWriteQueue->full()) {
+      // Stop reading from the socket until the queued data are
+      // written to the disk.
+      addCommandSelf();
+      disableWriteCheckSocket();
+      setReadCheckSocket(diskWriteQueue->getWakeupSocket());
+      return false;
+    }
+  }
+#endif // ENABLE_ASYNC_DISK_WRITE
   setReadCheckSocket(getSocket());
 
   const std::shared_ptr<DiskAdaptor>& diskAdaptor =
       getPieceStorage()->getDiskAdaptor();
   std::shared_ptr<Segment> segment = getSegments().front();
   bool eof = false;
-  if (getSocketRecvBuffer()->bufferEmpty()) {
+  bool spliced = false;
+#ifdef HAVE_SPLICE
+  spliced = spliceData(diskAdaptor, segment, eof);
+#endif // HAVE_SPLICE
+  if (!spliced && getSocketRecvBuffer()->bufferEmpty()) {
     // Only read from socket when buffer is empty.  Imagine that When
     // segment length is *short* and we are using HTTP pilelining.  We
     // issued 2 requests in pipeline. When reading first response
@@ -160,7 +190,7 @@ bool DownloadCommand::executeInternal()
     eof = getSocketRecvBuffer()->recv() == 0 && !getSocket()->wantRead() &&
           !getSocket()->wantWrite();
   }
-  if (!eof) {
+  if (!spliced && !eof) {
     size_t bufSize;
     if (sinkFilterOnly_) {
       if (segment->getLength() > 0) {
@@ -294,6 +324,65 @@ bool DownloadCommand::executeInternal()
   }
 }
 
+#ifdef HAVE_SPLICE
+bool DownloadCommand::spliceData(
+    const std::shared_ptr<DiskAdaptor>& diskAdaptor,
+    const std::shared_ptr<Segment>& segment, bool& eof)
+{
+  // The data buffered in SocketRecvBuffer must be written first.
+  if (!spliceEnabled_ || !sinkFilterOnly_ || segment->getLength() == 0 ||
+      !getSocketRecvBuffer()->bufferEmpty() ||
+      segment->getPiece()->getWrDiskCacheEntry()) {
+    return false;
+  }
+  // Don't receive the data beyond the segment because it may belong
+  // to the next response.
+  size_t len;
+  if (segment->getPosition() + segment->getLength() <=
+      getFileEntry()->getLastOffset()) {
+    len = segment->getLength() - segment->getWrittenLength();
+  }
+  else {
+    len = getFileEntry()->getLastOffset() - segment->getPositionToWrite();
+  }
+  if (!splicePipe_) {
+    splicePipe_ = make_unique<SplicePipe>();
+  }
+  len = std::min(len, splicePipe_->getCapacity());
+  if (len == 0) {
+    return false;
+  }
+  int64_t fileOffset;
+  auto fileHandle = diskAdaptor->getFileHandle(segment->getPositionToWrite(),
+                                               len, fileOffset);
+  if (!fileHandle) {
+    return false;
+  }
+  ssize_t n = getSocket()->spliceData(splicePipe_->getWriteFd(), len);
+  if (n == 0) {
+    eof = !getSocket()->wantRead();
+    return true;
+  }
+  int errNum = splicePipe_->moveTo(fileHandle->getFd(), fileOffset, n);
+  if (errNum != 0) {
+    splicePipe_.reset();
+    auto msg = fmt(EX_FILE_WRITE, getFileEntry()->getPath().c_str(),
+                   util::safeStrerror(errNum).c_str());
+    if (errNum == ENOSPC) {
+      throw DOWNLOAD_FAILURE_EXCEPTION3(errNum, msg,
+                                        error_code::NOT_ENOUGH_DISK_SPACE);
+    }
+    throw DL_ABORT_EX3(errNum, msg, error_code::FILE_IO_ERROR);
+  }
+  // The piece hash is not updated here.  It is computed from the
+  // written data when the segment is completed.
+  segment->updateWrittenLength(n);
+  peerStat_->updateDownload(n);
+  getDownloadContext()->updateDownload(n);
+  return true;
+}
+#endif // HAVE_SPLICE
+
 bool DownloadCommand::shouldEnableWriteCheck()
 {
   return getSocket()->wantWrite();
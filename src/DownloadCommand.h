@@ -44,6 +44,10 @@ namespace aria2 {
 class PeerStat;
 class StreamFilter;
 class MessageDigest;
+class DiskAdaptor;
+#ifdef HAVE_SPLICE
+class SplicePipe;
+#endif // HAVE_SPLICE
 
 class DownloadCommand : public AbstractCommand {
 private:
@@ -61,6 +65,19 @@ private:
 
   bool sinkFilterOnly_;
 
+#ifdef HAVE_SPLICE
+  bool spliceEnabled_;
+
+  std::unique_ptr<SplicePipe> splicePipe_;
+
+  // Moves the data of |segment| from the socket to the file with
+  // splice(2).  Returns false if the data must be read in the normal
+  // way.  Otherwise returns true and sets |eof| to true if the socket
+  // reached EOF.
+  bool spliceData(const std::shared_ptr<DiskAdaptor>& diskAdaptor,
+                  const std::shared_ptr<Segment>& segment, bool& eof);
+#endif // HAVE_SPLICE
+
   void validatePieceHash(const std::shared_ptr<Segment>& segment,
                          const std::string& expectedPieceHash,
                          const std::string& actualPieceHash);
@@ -108,6 +125,13 @@ public:
   {
     lowestDownloadSpeedLimit_ = lowestDownloadSpeedLimit;
   }
+
+#ifdef HAVE_SPLICE
+  // Receives the data with splice(2) when only SinkStreamFilter is
+  // installed and the disk cache is not used.  The socket must not be
+  // a secure one.
+  void enableSplice() { spliceEnabled_ = true; }
+#endif // HAVE_SPLICE
 };
 
 } // namespace aria2
@@ -67,6 +67,10 @@
 #include "DownloadContext.h"
 #include "fmt.h"
 #include "wallclock.h"
+#include "metrics.h"
+#include "CommandProfiler.h"
+#include "Tracer.h"
+#include "prefs.h"
 #ifdef ENABLE_BITTORRENT
 #  include "BtRegistry.h"
 #endif // ENABLE_BITTORRENT
@@ -88,6 +92,9 @@ namespace global {
 // 5 ... main loop exited
 volatile sig_atomic_t globalHaltRequested = 0;
 
+// Set to 1 by the signal handler to dump the profile of Commands.
+volatile sig_atomic_t commandProfileDumpRequested = 0;
+
 } // namespace global
 
 namespace {
@@ -108,35 +115,77 @@ DownloadEngine::DownloadEngine(std::unique_ptr<EventPoll> eventPoll)
       asyncDNSServers_(nullptr),
 #endif // HAVE_ARES_ADDR_NODE
       dnsCache_(make_unique<DNSCache>()),
-      option_(nullptr)
+      option_(nullptr),
+      commandTimers_(A2_DELTA_MILLIS, global::wallclock())
 {
   unsigned char sessionId[20];
   util::generateRandomKey(sessionId);
   sessionId_.assign(&sessionId[0], &sessionId[sizeof(sessionId)]);
 }
 
+void DownloadEngine::setCommandProfiler(
+    std::unique_ptr<CommandProfiler> profiler)
+{
+  commandProfiler_ = std::move(profiler);
+}
+
+void DownloadEngine::setTracer(std::unique_ptr<Tracer> tracer)
+{
+  tracer_ = std::move(tracer);
+  Tracer::setInstance(tracer_.get());
+}
+
 DownloadEngine::~DownloadEngine()
 {
 #ifdef HAVE_ARES_ADDR_NODE
   setAsyncDNSServers(nullptr);
 #endif // HAVE_ARES_ADDR_NODE
+  if (tracer_) {
+    Tracer::setInstance(nullptr);
+  }
 }
 
 namespace {
+// Commands which do not match statusFilter are left in place, so
+// that an iteration with few active Commands among thousands does
+// not rotate the whole queue.  An executed Command re-queues itself
+// through DownloadEngine::addCommand() and its old slot is
+// compacted away at the end.  Sleeping Commands are skipped unless
+// they have been activated by an I/O event.  If |profiler| is not
+// null, the execution time of each Command is recorded.
 void executeCommand(std::deque<std::unique_ptr<Command>>& commands,
-                    Command::STATUS statusFilter)
+                    Command::STATUS statusFilter, CommandProfiler* profiler)
 {
+  auto tracer = Tracer::get();
   size_t max = commands.size();
+  size_t executed = 0;
   for (size_t i = 0; i < max; ++i) {
-    auto com = std::move(commands.front());
-    commands.pop_front();
-    if (!com->statusMatch(statusFilter)) {
-      com->clearIOEvents();
-      commands.push_back(std::move(com));
+    if (!commands[i] || !commands[i]->statusMatch(statusFilter) ||
+        (commands[i]->isTimerScheduled() &&
+         !commands[i]->statusMatch(Command::STATUS_ACTIVE))) {
       continue;
     }
+    auto com = std::move(commands[i]);
+    ++executed;
+    com->cancelTimer();
     com->transitStatus();
-    if (com->execute()) {
+    bool done;
+    if (profiler || tracer) {
+      bool ioEvents = com->hasIOEvents();
+      auto start = Tracer::Clock::now();
+      done = com->execute();
+      auto end = Tracer::Clock::now();
+      if (profiler) {
+        profiler->record(com.get(), end - start, !done && !ioEvents);
+      }
+      if (tracer) {
+        tracer->addCommandSpan(com.get(), start, end);
+      }
+    }
+    else {
+      done = com->execute();
+    }
+    if (done) {
       com.reset();
     }
     else {
@@ -144,6 +193,10 @@ void executeCommand(std::deque<std::unique_ptr<Command>>& commands,
       com.release();
     }
   }
+  if (executed) {
+    auto last = std::begin(commands) + max;
+    commands.erase(std::remove(std::begin(commands), last, nullptr), last);
+  }
 }
 } // namespace
 
@@ -173,17 +226,25 @@ int DownloadEngine::run(bool oneshot)
     noWait_ = false;
     global::wallclock().reset();
     calculateStatistics();
+    expireCommandTimers();
     if (lastRefresh_.difference(global::wallclock()) + A2_DELTA_MILLIS >=
         refreshInterval_) {
+      if (refreshInterval_ < DEFAULT_REFRESH_INTERVAL) {
+        // setRefreshInterval(0) requests that all Commands are
+        // executed.
+        commandTimers_.clear();
+      }
       refreshInterval_ = DEFAULT_REFRESH_INTERVAL;
       lastRefresh_ = global::wallclock();
-      executeCommand(commands_, Command::STATUS_ALL);
+      executeCommand(commands_, Command::STATUS_ALL, commandProfiler_.get());
     }
     else {
-      executeCommand(commands_, Command::STATUS_ACTIVE);
+      executeCommand(commands_, Command::STATUS_ACTIVE, commandProfiler_.get());
     }
-    executeCommand(routineCommands_, Command::STATUS_ALL);
+    executeCommand(routineCommands_, Command::STATUS_ALL,
+                   commandProfiler_.get());
     afterEachIteration();
+    metrics::eventLoopLatency().observe(global::wallclock().difference());
     if (!noWait_ && oneshot) {
       return 1;
     }
@@ -199,14 +260,53 @@ void DownloadEngine::waitData()
     tv.tv_sec = tv.tv_usec = 0;
   }
   else {
-    auto t =
-        std::chrono::duration_cast<std::chrono::microseconds>(refreshInterval_);
+    // Wait until the next refresh or the nearest deadline of sleeping
+    // Commands, whichever comes first.
+    Timer now;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        lastRefresh_.difference(now));
+    auto timeout = elapsed < refreshInterval_ ? refreshInterval_ - elapsed
+                                              : std::chrono::milliseconds(0);
+    timeout = commandTimers_.getNextTimeout(now, timeout);
+    auto t = std::chrono::duration_cast<std::chrono::microseconds>(timeout);
     tv.tv_sec = t.count() / 1000000;
     tv.tv_usec = t.count() % 1000000;
   }
+  auto tracer = Tracer::get();
+  if (commandProfiler_ || tracer) {
+    auto start = Tracer::Clock::now();
+    eventPoll_->poll(tv);
+    auto end = Tracer::Clock::now();
+    if (commandProfiler_) {
+      commandProfiler_->recordPoll(end - start);
+    }
+    if (tracer) {
+      tracer->addSpan("engine", "poll", start, end);
+    }
+    return;
+  }
   eventPoll_->poll(tv);
 }
 
+void DownloadEngine::expireCommandTimers()
+{
+  if (commandTimers_.empty()) {
+    return;
+  }
+  // Sleeping Commands check the completion or the halt of downloads
+  // by themselves, so wake them up when it happens.
+  if (haltRequested_ ||
+      (requestGroupMan_ && requestGroupMan_->downloadFinished())) {
+    commandTimers_.clear();
+    return;
+  }
+  commandTimers_.expire(expiredCommandTimers_, global::wallclock());
+  for (auto entry : expiredCommandTimers_) {
+    static_cast<Command*>(entry)->setStatusActive();
+  }
+  expiredCommandTimers_.clear();
+}
+
 bool DownloadEngine::addSocketForReadCheck(
     const std::shared_ptr<SocketCore>& socket, Command* command)
 {
@@ -251,6 +351,27 @@ void DownloadEngine::onEndOfRun()
 
 void DownloadEngine::afterEachIteration()
 {
+  if (global::commandProfileDumpRequested) {
+    global::commandProfileDumpRequested = 0;
+    if (commandProfiler_) {
+      commandProfiler_->dump();
+    }
+    else {
+      A2_LOG_NOTICE("Command profiling is disabled."
+                    " See --profile-commands option.");
+    }
+  }
+  // The profiler is deleted here rather than when the option is
+  // changed, because executeCommand() may be using it then.
+  if (commandProfiler_ && !option_->getAsBool(PREF_PROFILE_COMMANDS)) {
+    commandProfiler_.reset();
+  }
+
+  if (requestGroupMan_ && requestGroupMan_->wakeUpRequested()) {
+    requestGroupMan_->clearWakeUp();
+    setRefreshInterval(std::chrono::milliseconds(0));
+  }
+
   if (global::globalHaltRequested == 1) {
     A2_LOG_NOTICE(_("Shutdown sequence commencing..."
                     " Press Ctrl-C again for emergency shutdown."));
@@ -309,6 +430,12 @@ void DownloadEngine::addRoutineCommand(std::unique_ptr<Command> command)
   routineCommands_.push_back(std::move(command));
 }
 
+void DownloadEngine::sleepCommand(Command* command,
+                                  std::chrono::milliseconds timeout)
+{
+  commandTimers_.schedule(command, global::wallclock(), std::move(timeout));
+}
+
 void DownloadEngine::poolSocket(const std::string& key,
                                 const SocketPoolEntry& entry)
 {
@@ -45,6 +45,7 @@
 
 #include "a2netcompat.h"
 #include "TimerA2.h"
+#include "TimerWheel.h"
 #include "a2io.h"
 #include "CUIDCounter.h"
 #include "FileAllocationMan.h"
@@ -65,6 +66,8 @@ class AuthConfigFactory;
 class Request;
 class EventPoll;
 class Command;
+class CommandProfiler;
+class Tracer;
 #ifdef ENABLE_BITTORRENT
 class BtRegistry;
 #endif // ENABLE_BITTORRENT
@@ -158,6 +161,9 @@ private:
 
   void afterEachIteration();
 
+  // Wakes up the sleeping Commands whose timeout has expired.
+  void expireCommandTimers();
+
   void poolSocket(const std::string& key, const SocketPoolEntry& entry);
 
   std::multimap<std::string, SocketPoolEntry>::iterator
@@ -167,6 +173,9 @@ private:
   std::unique_ptr<FileAllocationMan> fileAllocationMan_;
   std::unique_ptr<CheckIntegrityMan> checkIntegrityMan_;
   Option* option_;
+  // Sleeping Commands.  This must outlive the Commands below.
+  TimerWheel commandTimers_;
+  std::vector<TimerWheel::Entry*> expiredCommandTimers_;
   // Ensure that Commands are cleaned up before requestGroupMan_ is
   // deleted.
   std::deque<std::unique_ptr<Command>> routineCommands_;
@@ -175,6 +184,11 @@ private:
   std::unique_ptr<util::security::HMAC> tokenHMAC_;
   std::unique_ptr<util::security::HMACResult> tokenExpected_;
 
+  // Non-null if profiling of Commands is enabled.
+  std::unique_ptr<CommandProfiler> commandProfiler_;
+
+  std::unique_ptr<Tracer> tracer_;
+
 public:
   DownloadEngine(std::unique_ptr<EventPoll> eventPoll);
 
@@ -247,6 +261,20 @@ public:
 
   void addRoutineCommand(std::unique_ptr<Command> command);
 
+  // Puts |command| to sleep for |timeout|.  The periodic refresh and
+  // the routine command execution skip a sleeping Command.  It is
+  // woken up when the timeout expires, when it receives an I/O event,
+  // when setRefreshInterval(0) is called, or when a download is halted
+  // or paused.  |command| must be in the command queue or the routine
+  // command queue.
+  void sleepCommand(Command* command, std::chrono::milliseconds timeout);
+
+  size_t countSleepingCommand() const { return commandTimers_.size(); }
+
+  size_t countCommand() const { return commands_.size(); }
+
+  size_t countRoutineCommand() const { return routineCommands_.size(); }
+
   void poolSocket(const std::string& ipaddr, uint16_t port,
                   const std::string& username, const std::string& proxyhost,
                   uint16_t proxyport, const std::shared_ptr<SocketCore>& sock,
@@ -342,6 +370,16 @@ public:
 #endif // ENABLE_WEBSOCKET
 
   bool validateToken(const std::string& token);
+
+  void setCommandProfiler(std::unique_ptr<CommandProfiler> profiler);
+
+  CommandProfiler* getCommandProfiler() const
+  {
+    return commandProfiler_.get();
+  }
+
+  // Makes |tracer| the active Tracer while this object is alive.
+  void setTracer(std::unique_ptr<Tracer> tracer);
 };
 
 } // namespace aria2
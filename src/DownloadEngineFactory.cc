@@ -64,6 +64,9 @@
 #ifdef HAVE_EPOLL
 #  include "EpollEventPoll.h"
 #endif // HAVE_EPOLL
+#ifdef HAVE_IO_URING
+#  include "IoUringEventPoll.h"
+#endif // HAVE_IO_URING
 #ifdef HAVE_PORT_ASSOCIATE
 #  include "PortEventPoll.h"
 #endif // HAVE_PORT_ASSOCIATE
@@ -78,6 +81,8 @@
 #include "FileAllocationEntry.h"
 #include "HttpListenCommand.h"
 #include "LogFactory.h"
+#include "CommandProfiler.h"
+#include "Tracer.h"
 
 namespace aria2 {
 
@@ -109,6 +114,17 @@ std::unique_ptr<EventPoll> createEventPoll(Option* op)
   }
   else
 #endif // HAVE_EPLL
+#ifdef HAVE_IO_URING
+      if (pollMethod == V_IO_URING) {
+    auto ep = make_unique<IoUringEventPoll>();
+    if (!ep->good()) {
+      throw DL_ABORT_EX("Initializing IoUringEventPoll failed."
+                        " Try --event-poll=epoll");
+    }
+    return std::move(ep);
+  }
+  else
+#endif // HAVE_IO_URING
 #ifdef HAVE_KQUEUE
       if (pollMethod == V_KQUEUE) {
     auto kp = make_unique<KqueueEventPoll>();
@@ -156,10 +172,23 @@ std::unique_ptr<DownloadEngine> DownloadEngineFactory::newDownloadEngine(
     auto requestGroupMan = make_unique<RequestGroupMan>(
         std::move(requestGroups), MAX_CONCURRENT_DOWNLOADS, op);
     requestGroupMan->initWrDiskCache();
+    requestGroupMan->initRdDiskCache();
+    requestGroupMan->initDiskWriteQueue();
     e->setRequestGroupMan(std::move(requestGroupMan));
   }
   e->setFileAllocationMan(make_unique<FileAllocationMan>());
-  e->setCheckIntegrityMan(make_unique<CheckIntegrityMan>());
+  {
+    auto checkIntegrityMan = make_unique<CheckIntegrityMan>();
+    checkIntegrityMan->initPieceHashQueue(
+        op->getAsInt(PREF_CHECK_INTEGRITY_THREADS));
+    e->setCheckIntegrityMan(std::move(checkIntegrityMan));
+  }
+  if (op->getAsBool(PREF_PROFILE_COMMANDS)) {
+    e->setCommandProfiler(make_unique<CommandProfiler>());
+  }
+  if (!op->blank(PREF_TRACE_FILE)) {
+    e->setTracer(make_unique<Tracer>(op->get(PREF_TRACE_FILE)));
+  }
   e->addRoutineCommand(
       make_unique<FillRequestGroupCommand>(e->newCUID(), e.get()));
   e->addRoutineCommand(make_unique<FileAllocationDispatcherCommand>(
@@ -298,6 +298,33 @@ private:
 
   sock_t sockets_[ARES_GETSOCK_MAXNUM];
 
+  int events_[ARES_GETSOCK_MAXNUM];
+
+  // Stores the sockets of nameResolver_ and their events to |sockets|
+  // and |events|, and returns the number of sockets.
+  size_t getSockets(sock_t* sockets, int* events)
+  {
+    int mask = nameResolver_->getsock(sockets);
+    if (mask == 0) {
+      return 0;
+    }
+    size_t i;
+    for (i = 0; i < ARES_GETSOCK_MAXNUM; ++i) {
+      events[i] = 0;
+      if (ARES_GETSOCK_READABLE(mask, i)) {
+        events[i] |= EventPoll::IEV_READ;
+      }
+      if (ARES_GETSOCK_WRITABLE(mask, i)) {
+        events[i] |= EventPoll::IEV_WRITE;
+      }
+      if (events[i] == 0) {
+        // assume no further sockets are returned.
+        break;
+      }
+    }
+    return i;
+  }
+
 public:
   AsyncNameResolverEntry(std::shared_ptr<AsyncNameResolver> nameResolver,
                          Command* command)
@@ -324,27 +351,10 @@ public:
 
   void addSocketEvents(EventPoll* e)
   {
-    socketsSize_ = 0;
-    int mask = nameResolver_->getsock(sockets_);
-    if (mask == 0) {
-      return;
-    }
-    size_t i;
-    for (i = 0; i < ARES_GETSOCK_MAXNUM; ++i) {
-      int events = 0;
-      if (ARES_GETSOCK_READABLE(mask, i)) {
-        events |= EventPoll::IEV_READ;
-      }
-      if (ARES_GETSOCK_WRITABLE(mask, i)) {
-        events |= EventPoll::IEV_WRITE;
-      }
-      if (events == 0) {
-        // assume no further sockets are returned.
-        break;
-      }
-      e->addEvents(sockets_[i], command_, events, nameResolver_);
+    socketsSize_ = getSockets(sockets_, events_);
+    for (size_t i = 0; i < socketsSize_; ++i) {
+      e->addEvents(sockets_[i], command_, events_[i], nameResolver_);
     }
-    socketsSize_ = i;
   }
 
   void removeSocketEvents(EventPoll* e)
@@ -354,6 +364,29 @@ public:
     }
   }
 
+  // Same as removeSocketEvents() followed by addSocketEvents(), but
+  // the sockets whose events have not changed are not removed.
+  // addEvents() is still called for them, so that EventPoll can
+  // detect a socket descriptor reused for another socket.
+  void updateSocketEvents(EventPoll* e)
+  {
+    sock_t sockets[ARES_GETSOCK_MAXNUM];
+    int events[ARES_GETSOCK_MAXNUM];
+    size_t n = getSockets(sockets, events);
+    for (size_t i = 0; i < socketsSize_; ++i) {
+      auto j = std::find(sockets, sockets + n, sockets_[i]);
+      if (j == sockets + n || events[j - sockets] != events_[i]) {
+        e->deleteEvents(sockets_[i], command_, nameResolver_);
+      }
+    }
+    for (size_t i = 0; i < n; ++i) {
+      sockets_[i] = sockets[i];
+      events_[i] = events[i];
+      e->addEvents(sockets_[i], command_, events_[i], nameResolver_);
+    }
+    socketsSize_ = n;
+  }
+
   // Calls AsyncNameResolver::process(ARES_SOCKET_BAD,
   // ARES_SOCKET_BAD).
   void processTimeout()
@@ -552,6 +552,12 @@ HttpResponseCommand::createHttpDownloadCommand(
     getRequestGroup()->setFileAllocationEnabled(false);
   }
   command->installStreamFilter(std::move(filter));
+#ifdef HAVE_SPLICE
+  if (getOption()->getAsBool(PREF_ENABLE_HTTP_SPLICE) &&
+      !getSocket()->isSecure()) {
+    command->enableSplice();
+  }
+#endif // HAVE_SPLICE
   getRequestGroup()->getURISelector()->tuneDownloadCommand(
       getFileEntry()->getRemainingUris(), command.get());
 
@@ -375,6 +375,11 @@ int HttpServer::setupResponseRecv()
       lastBody_.reset();
       return 0;
     }
+    if (path == "/metrics") {
+      reqType_ = RPC_TYPE_METRICS;
+      lastBody_.reset();
+      return 0;
+    }
   }
   else if (getMethod() == "POST") {
     if (path == "/jsonrpc") {
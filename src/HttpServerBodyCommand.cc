@@ -59,11 +59,17 @@
 #include "RpcResponse.h"
 #include "rpc_helper.h"
 #include "JsonDiskWriter.h"
-#include "ValueBaseJsonParser.h"
+#include "JsonFastParser.h"
+#include "metrics.h"
+#include "prefs.h"
+#include "Option.h"
 #ifdef ENABLE_XML_RPC
 #  include "XmlRpcRequestParserStateMachine.h"
 #  include "XmlRpcDiskWriter.h"
 #endif // ENABLE_XML_RPC
+#ifdef HAVE_ZLIB
+#  include "GZipEncoder.h"
+#endif // HAVE_ZLIB
 
 namespace aria2 {
 
@@ -100,6 +106,35 @@ std::string getJsonRpcContentType(bool script)
 }
 } // namespace
 
+void HttpServerBodyCommand::sendMetrics()
+{
+  // The secret is passed as a bearer token, since there is no
+  // request body to carry it.
+  const auto& auth =
+      httpServer_->getRequestHeader()->find(HttpHeader::AUTHORIZATION);
+  std::string token;
+  if (util::istartsWith(auth, "Bearer ")) {
+    token = auth.substr(7);
+  }
+  if (!e_->validateToken(token)) {
+    httpServer_->feedResponse(401);
+    addHttpServerResponseCommand(false);
+    return;
+  }
+  auto text = metrics::render(
+      e_, e_->getOption()->getAsInt(PREF_RPC_METRICS_MAX_DOWNLOADS));
+#ifdef HAVE_ZLIB
+  if (httpServer_->supportsGZip()) {
+    GZipEncoder o;
+    o.init();
+    text = (o << text).str();
+  }
+#endif // HAVE_ZLIB
+  httpServer_->feedResponse(std::move(text),
+                            "text/plain; version=0.0.4; charset=utf-8");
+  addHttpServerResponseCommand(false);
+}
+
 void HttpServerBodyCommand::sendJsonRpcResponse(const rpc::RpcResponse& res,
                                                 const std::string& callback)
 {
@@ -260,8 +295,8 @@ bool HttpServerBodyCommand::execute()
             json::JsonGetParam param = json::decodeGetParams(query);
             callback = param.callback;
             ssize_t error = 0;
-            json = json::ValueBaseJsonParser().parseFinal(
-                param.request.c_str(), param.request.size(), error);
+            json = json::parse(param.request.c_str(), param.request.size(),
+                               error);
           }
           else {
             auto dw =
@@ -310,6 +345,9 @@ bool HttpServerBodyCommand::execute()
           }
           return true;
         }
+        case RPC_TYPE_METRICS:
+          sendMetrics();
+          return true;
         default:
           httpServer_->feedResponse(404);
           addHttpServerResponseCommand(false);
@@ -57,6 +57,7 @@ private:
   Timer timeoutTimer_;
   bool writeCheck_;
 
+  void sendMetrics();
   void sendJsonRpcResponse(const rpc::RpcResponse& res,
                            const std::string& callback);
   void sendJsonRpcBatchResponse(const std::vector<rpc::RpcResponse>& results,
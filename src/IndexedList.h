@@ -571,6 +571,32 @@ public:
     }
   }
 
+  // Returns the key of the element at position |n|. Complexity: O(1)
+  KeyType getKey(size_t n) const { return seq_[n].first; }
+
+  // Returns the position of the element with |key|, or -1 if it is
+  // not found. Complexity: O(N)
+  ssize_t indexOf(KeyType key) const
+  {
+    if (index_.find(key) == std::end(index_)) {
+      return -1;
+    }
+    for (size_t i = 0, len = seq_.size(); i < len; ++i) {
+      if (seq_[i].first == key) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  // Replaces the value of the element at position |n| with |value|,
+  // keeping its key and position. Complexity: O(1)
+  void replace(size_t n, ValuePtrType value)
+  {
+    index_[seq_[n].first] = value;
+    seq_[n].second = std::move(value);
+  }
+
   size_t size() const { return index_.size(); }
 
   size_t empty() const { return index_.empty(); }
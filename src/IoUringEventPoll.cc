@@ -0,0 +1,584 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "IoUringEventPoll.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+#include "Command.h"
+#include "LogFactory.h"
+#include "Logger.h"
+#include "util.h"
+#include "a2functional.h"
+#include "fmt.h"
+
+namespace aria2 {
+
+IoUringEventPoll::KSocketEntry::KSocketEntry(sock_t s)
+    : SocketEntry<KCommandEvent, KADNSEvent>(s),
+      armedId_(0),
+      armedEvents_(0),
+      updatePending_(false),
+      forceRearm_(false),
+      dev_(0),
+      ino_(0)
+{
+  updateIdentity();
+}
+
+bool IoUringEventPoll::KSocketEntry::updateIdentity()
+{
+  struct stat st;
+  if (fstat(getSocket(), &st) == -1) {
+    dev_ = 0;
+    ino_ = 0;
+    return true;
+  }
+  bool changed = st.st_dev != dev_ || st.st_ino != ino_;
+  dev_ = st.st_dev;
+  ino_ = st.st_ino;
+  return changed;
+}
+
+int accumulateEvent(int events, const IoUringEventPoll::KEvent& event)
+{
+  return events | event.getEvents();
+}
+
+int IoUringEventPoll::KSocketEntry::getEvents()
+{
+#ifdef ENABLE_ASYNC_DNS
+
+  return std::accumulate(adnsEvents_.begin(), adnsEvents_.end(),
+                         std::accumulate(commandEvents_.begin(),
+                                         commandEvents_.end(), 0,
+                                         accumulateEvent),
+                         accumulateEvent);
+
+#else // !ENABLE_ASYNC_DNS
+
+  return std::accumulate(commandEvents_.begin(), commandEvents_.end(), 0,
+                         accumulateEvent);
+
+#endif // !ENABLE_ASYNC_DNS
+}
+
+IoUringEventPoll::IoUringEventPoll()
+    : ringfd_(-1),
+      sqRing_(MAP_FAILED),
+      sqRingSize_(0),
+      sqHead_(nullptr),
+      sqTail_(nullptr),
+      sqFlags_(nullptr),
+      sqMask_(0),
+      sqEntries_(0),
+      sqArray_(nullptr),
+      sqes_(static_cast<struct io_uring_sqe*>(MAP_FAILED)),
+      sqesSize_(0),
+      cqRing_(MAP_FAILED),
+      cqRingSize_(0),
+      cqHead_(nullptr),
+      cqTail_(nullptr),
+      cqMask_(0),
+      cqes_(nullptr),
+      serial_(0)
+{
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+  params.cq_entries = CQ_ENTRIES;
+  ringfd_ = syscall(__NR_io_uring_setup, SQ_ENTRIES, &params);
+  if (ringfd_ == -1) {
+    int errNum = errno;
+    A2_LOG_ERROR(
+        fmt("io_uring_setup failed: %s", util::safeStrerror(errNum).c_str()));
+    return;
+  }
+  // We rely on the timeout argument of io_uring_enter and on the
+  // kernel never dropping completions.
+  if (!(params.features & IORING_FEAT_EXT_ARG) ||
+      !(params.features & IORING_FEAT_NODROP)) {
+    A2_LOG_ERROR("io_uring of this kernel lacks required features.");
+    releaseRing();
+    return;
+  }
+  sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cqRingSize_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (singleMmap) {
+    sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+  }
+  sqRing_ = mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_SQ_RING);
+  if (sqRing_ == MAP_FAILED) {
+    int errNum = errno;
+    A2_LOG_ERROR(fmt("Mapping io_uring submission ring failed: %s",
+                     util::safeStrerror(errNum).c_str()));
+    releaseRing();
+    return;
+  }
+  if (singleMmap) {
+    cqRing_ = sqRing_;
+  }
+  else {
+    cqRing_ = mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_CQ_RING);
+    if (cqRing_ == MAP_FAILED) {
+      int errNum = errno;
+      A2_LOG_ERROR(fmt("Mapping io_uring completion ring failed: %s",
+                       util::safeStrerror(errNum).c_str()));
+      releaseRing();
+      return;
+    }
+  }
+  sqesSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  sqes_ = static_cast<struct io_uring_sqe*>(
+      mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_SQES));
+  if (sqes_ == MAP_FAILED) {
+    int errNum = errno;
+    A2_LOG_ERROR(fmt("Mapping io_uring submission entries failed: %s",
+                     util::safeStrerror(errNum).c_str()));
+    releaseRing();
+    return;
+  }
+  auto sq = static_cast<char*>(sqRing_);
+  sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+  sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  sqFlags_ = reinterpret_cast<unsigned*>(sq + params.sq_off.flags);
+  sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  sqEntries_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+  sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+  auto cq = static_cast<char*>(cqRing_);
+  cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+}
+
+IoUringEventPoll::~IoUringEventPoll() { releaseRing(); }
+
+void IoUringEventPoll::releaseRing()
+{
+  if (sqes_ != MAP_FAILED) {
+    munmap(sqes_, sqesSize_);
+    sqes_ = static_cast<struct io_uring_sqe*>(MAP_FAILED);
+  }
+  if (cqRing_ != MAP_FAILED && cqRing_ != sqRing_) {
+    munmap(cqRing_, cqRingSize_);
+  }
+  cqRing_ = MAP_FAILED;
+  if (sqRing_ != MAP_FAILED) {
+    munmap(sqRing_, sqRingSize_);
+    sqRing_ = MAP_FAILED;
+  }
+  if (ringfd_ != -1) {
+    int r = close(ringfd_);
+    int errNum = errno;
+    if (r == -1) {
+      A2_LOG_ERROR(fmt("Error occurred while closing io_uring file descriptor"
+                       " %d: %s",
+                       ringfd_, util::safeStrerror(errNum).c_str()));
+    }
+    ringfd_ = -1;
+  }
+}
+
+bool IoUringEventPoll::good() const { return ringfd_ != -1; }
+
+uint64_t IoUringEventPoll::nextId(sock_t socket)
+{
+  // user_data 0 is reserved for the completions of cancellation
+  // requests, which we are not interested in.
+  if (++serial_ == 0) {
+    ++serial_;
+  }
+  return (static_cast<uint64_t>(serial_) << 32) |
+         static_cast<uint32_t>(socket);
+}
+
+int IoUringEventPoll::enter(const struct timeval* tv)
+{
+  struct __kernel_timespec ts;
+  struct io_uring_getevents_arg arg;
+  unsigned minComplete = 0;
+  unsigned flags = 0;
+  void* argp = nullptr;
+  size_t argsz = 0;
+  if (tv) {
+    memset(&arg, 0, sizeof(arg));
+    ts.tv_sec = tv->tv_sec;
+    ts.tv_nsec = tv->tv_usec * 1000;
+    arg.ts = reinterpret_cast<uintptr_t>(&ts);
+    minComplete = 1;
+    flags = IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+    argp = &arg;
+    argsz = sizeof(arg);
+  }
+  else if (__atomic_load_n(sqFlags_, __ATOMIC_RELAXED) &
+           IORING_SQ_CQ_OVERFLOW) {
+    // Let the kernel flush completions which did not fit in the
+    // completion ring.
+    flags = IORING_ENTER_GETEVENTS;
+  }
+  int r;
+  for (;;) {
+    unsigned toSubmit = *sqTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    r = syscall(__NR_io_uring_enter, ringfd_, toSubmit, minComplete, flags,
+                argp, argsz);
+    if (r != -1 || errno != EINTR) {
+      break;
+    }
+  }
+  return r;
+}
+
+bool IoUringEventPoll::queueSqe(uint8_t opcode, sock_t fd, int events,
+                                uint64_t addr, uint64_t userData)
+{
+  unsigned tail = *sqTail_;
+  if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) == sqEntries_) {
+    if (enter(nullptr) == -1) {
+      int errNum = errno;
+      A2_LOG_INFO(fmt("io_uring_enter error: %s",
+                      util::safeStrerror(errNum).c_str()));
+      return false;
+    }
+    if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) == sqEntries_) {
+      return false;
+    }
+  }
+  unsigned idx = tail & sqMask_;
+  struct io_uring_sqe* sqe = &sqes_[idx];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = addr;
+  sqe->poll_events = events;
+  sqe->user_data = userData;
+  sqArray_[idx] = idx;
+  __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+void IoUringEventPoll::scheduleUpdate(KSocketEntry& socketEntry)
+{
+  if (!socketEntry.isUpdatePending()) {
+    socketEntry.setUpdatePending(true);
+    updates_.push_back(socketEntry.getSocket());
+  }
+}
+
+void IoUringEventPoll::queueUpdates()
+{
+  for (auto id : cancels_) {
+    queueSqe(IORING_OP_POLL_REMOVE, -1, 0, id, 0);
+  }
+  cancels_.clear();
+
+  std::vector<sock_t> updates;
+  updates.swap(updates_);
+  for (auto fd : updates) {
+    auto i = socketEntries_.find(fd);
+    if (i == std::end(socketEntries_) || !(*i).second.isUpdatePending()) {
+      continue;
+    }
+    auto& socketEntry = (*i).second;
+    socketEntry.setUpdatePending(false);
+    int events = socketEntry.getEvents();
+    if (socketEntry.getArmedId()) {
+      // Removing interest does not require re-arming: the
+      // superfluous events are filtered out on completion.
+      if (!socketEntry.isForceRearm() &&
+          (events & ~socketEntry.getArmedEvents()) == 0) {
+        continue;
+      }
+      queueSqe(IORING_OP_POLL_REMOVE, -1, 0, socketEntry.getArmedId(), 0);
+      socketEntry.setArmed(0, 0);
+    }
+    socketEntry.setForceRearm(false);
+    if (events == 0) {
+      continue;
+    }
+    auto id = nextId(fd);
+    if (queueSqe(IORING_OP_POLL_ADD, fd, events, 0, id)) {
+      socketEntry.setArmed(id, events);
+    }
+    else {
+      A2_LOG_DEBUG(fmt("Failed to add socket event %d", fd));
+      scheduleUpdate(socketEntry);
+    }
+  }
+}
+
+size_t IoUringEventPoll::processCompletions()
+{
+  size_t n = 0;
+  unsigned head = *cqHead_;
+  unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head) {
+    const struct io_uring_cqe& cqe = cqes_[head & cqMask_];
+    if (cqe.user_data == 0) {
+      continue;
+    }
+    auto fd = static_cast<sock_t>(cqe.user_data & 0xffffffffu);
+    auto i = socketEntries_.find(fd);
+    if (i == std::end(socketEntries_) ||
+        (*i).second.getArmedId() != cqe.user_data) {
+      // Stale completion of the request cancelled or superseded.
+      continue;
+    }
+    auto& socketEntry = (*i).second;
+    socketEntry.setArmed(0, 0);
+    if (cqe.res < 0) {
+      // Most likely the socket was closed without deleting its
+      // events.  It is armed again by the next addEvents().
+      A2_LOG_DEBUG(fmt("Polling socket %d failed: %s", fd,
+                       util::safeStrerror(-cqe.res).c_str()));
+      continue;
+    }
+    int events =
+        cqe.res & (socketEntry.getEvents() | IEV_ERROR | IEV_HUP);
+    if (events) {
+      socketEntry.processEvents(events);
+    }
+    // Poll requests are one-shot.
+    scheduleUpdate(socketEntry);
+    ++n;
+  }
+  __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+  return n;
+}
+
+void IoUringEventPoll::poll(const struct timeval& tv)
+{
+  queueUpdates();
+
+  bool wait = tv.tv_sec > 0 || tv.tv_usec > 0;
+  if (!wait) {
+    if (*sqTail_ != __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) ||
+        (__atomic_load_n(sqFlags_, __ATOMIC_RELAXED) &
+         IORING_SQ_CQ_OVERFLOW)) {
+      if (enter(nullptr) == -1) {
+        int errNum = errno;
+        A2_LOG_INFO(fmt("io_uring_enter error: %s",
+                        util::safeStrerror(errNum).c_str()));
+      }
+    }
+    processCompletions();
+  }
+  else {
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::seconds(tv.tv_sec) +
+                    std::chrono::microseconds(tv.tv_usec);
+    struct timeval waittv = tv;
+    for (;;) {
+      if (enter(&waittv) == -1) {
+        if (errno != ETIME) {
+          int errNum = errno;
+          A2_LOG_INFO(fmt("io_uring_enter error: %s",
+                          util::safeStrerror(errNum).c_str()));
+        }
+        processCompletions();
+        break;
+      }
+      if (processCompletions() > 0) {
+        break;
+      }
+      // Only the completions of cancelled or superseded poll
+      // requests arrived.  They are not events, so wait again for
+      // the rest of the timeout.
+      auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+          deadline - std::chrono::steady_clock::now());
+      if (remaining.count() <= 0) {
+        break;
+      }
+      waittv.tv_sec = remaining.count() / 1000000;
+      waittv.tv_usec = remaining.count() % 1000000;
+      queueUpdates();
+    }
+  }
+
+#ifdef ENABLE_ASYNC_DNS
+  // It turns out that we have to call ares_process_fd before ares's
+  // own timeout and ares may create new sockets or closes socket in
+  // their API. So we call ares_process_fd for all ares_channel and
+  // re-register their sockets.  Only the sockets which changed are
+  // re-armed, since re-arming wakes up the next poll().
+  for (auto& i : nameResolverEntries_) {
+    auto& ent = i.second;
+    ent.processTimeout();
+    ent.updateSocketEvents(this);
+  }
+#endif // ENABLE_ASYNC_DNS
+
+  // TODO timeout of name resolver is determined in Command(AbstractCommand,
+  // DHTEntryPoint...Command)
+}
+
+namespace {
+int translateEvents(EventPoll::EventType events)
+{
+  int newEvents = 0;
+  if (EventPoll::EVENT_READ & events) {
+    newEvents |= IoUringEventPoll::IEV_READ;
+  }
+  if (EventPoll::EVENT_WRITE & events) {
+    newEvents |= IoUringEventPoll::IEV_WRITE;
+  }
+  if (EventPoll::EVENT_ERROR & events) {
+    newEvents |= IoUringEventPoll::IEV_ERROR;
+  }
+  if (EventPoll::EVENT_HUP & events) {
+    newEvents |= IoUringEventPoll::IEV_HUP;
+  }
+  return newEvents;
+}
+} // namespace
+
+bool IoUringEventPoll::addEvents(sock_t socket,
+                                 const IoUringEventPoll::KEvent& event)
+{
+  auto i = socketEntries_.lower_bound(socket);
+  if (i == std::end(socketEntries_) || (*i).first != socket) {
+    i = socketEntries_.insert(i, std::make_pair(socket, KSocketEntry(socket)));
+  }
+  else if ((*i).second.updateIdentity()) {
+    // The socket was closed and its descriptor reused since the
+    // current poll request was armed.  The request keeps polling the
+    // old file, so a new one has to be armed.
+    (*i).second.setForceRearm(true);
+  }
+  auto& socketEntry = (*i).second;
+  event.addSelf(&socketEntry);
+  scheduleUpdate(socketEntry);
+  return true;
+}
+
+bool IoUringEventPoll::addEvents(sock_t socket, Command* command,
+                                 EventPoll::EventType events)
+{
+  int pollEvents = translateEvents(events);
+  return addEvents(socket, KCommandEvent(command, pollEvents));
+}
+
+#ifdef ENABLE_ASYNC_DNS
+bool IoUringEventPoll::addEvents(sock_t socket, Command* command, int events,
+                                 const std::shared_ptr<AsyncNameResolver>& rs)
+{
+  return addEvents(socket, KADNSEvent(rs, command, socket, events));
+}
+#endif // ENABLE_ASYNC_DNS
+
+bool IoUringEventPoll::deleteEvents(sock_t socket,
+                                    const IoUringEventPoll::KEvent& event)
+{
+  auto i = socketEntries_.find(socket);
+  if (i == std::end(socketEntries_)) {
+    A2_LOG_DEBUG(fmt("Socket %d is not found in SocketEntries.", socket));
+    return false;
+  }
+
+  auto& socketEntry = (*i).second;
+  event.removeSelf(&socketEntry);
+  if (socketEntry.eventEmpty()) {
+    if (socketEntry.getArmedId()) {
+      cancels_.push_back(socketEntry.getArmedId());
+    }
+    socketEntries_.erase(i);
+  }
+  return true;
+}
+
+#ifdef ENABLE_ASYNC_DNS
+bool IoUringEventPoll::deleteEvents(
+    sock_t socket, Command* command,
+    const std::shared_ptr<AsyncNameResolver>& rs)
+{
+  return deleteEvents(socket, KADNSEvent(rs, command, socket, 0));
+}
+#endif // ENABLE_ASYNC_DNS
+
+bool IoUringEventPoll::deleteEvents(sock_t socket, Command* command,
+                                    EventPoll::EventType events)
+{
+  int pollEvents = translateEvents(events);
+  return deleteEvents(socket, KCommandEvent(command, pollEvents));
+}
+
+#ifdef ENABLE_ASYNC_DNS
+bool IoUringEventPoll::addNameResolver(
+    const std::shared_ptr<AsyncNameResolver>& resolver, Command* command)
+{
+  auto key = std::make_pair(resolver.get(), command);
+  auto itr = nameResolverEntries_.lower_bound(key);
+
+  if (itr != std::end(nameResolverEntries_) && (*itr).first == key) {
+    return false;
+  }
+
+  itr = nameResolverEntries_.insert(
+      itr, std::make_pair(key, KAsyncNameResolverEntry(resolver, command)));
+  (*itr).second.addSocketEvents(this);
+  return true;
+}
+
+bool IoUringEventPoll::deleteNameResolver(
+    const std::shared_ptr<AsyncNameResolver>& resolver, Command* command)
+{
+  auto key = std::make_pair(resolver.get(), command);
+  auto itr = nameResolverEntries_.find(key);
+  if (itr == std::end(nameResolverEntries_)) {
+    return false;
+  }
+
+  (*itr).second.removeSocketEvents(this);
+  nameResolverEntries_.erase(itr);
+  return true;
+}
+#endif // ENABLE_ASYNC_DNS
+
+} // namespace aria2
@@ -0,0 +1,228 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_IO_URING_EVENT_POLL_H
+#define D_IO_URING_EVENT_POLL_H
+
+#include "EventPoll.h"
+
+#include <poll.h>
+#include <sys/types.h>
+#include <linux/io_uring.h>
+
+#include <map>
+#include <vector>
+
+#include "Event.h"
+#include "a2functional.h"
+#ifdef ENABLE_ASYNC_DNS
+#  include "AsyncNameResolver.h"
+#endif // ENABLE_ASYNC_DNS
+
+namespace aria2 {
+
+// EventPoll implementation using io_uring one-shot poll requests.
+// Interest changes made by addEvents()/deleteEvents() are not sent
+// to the kernel immediately.  They are queued in the submission ring
+// at the beginning of poll() and submitted, together with waiting
+// for completions, in a single io_uring_enter(2) call.
+class IoUringEventPoll : public EventPoll {
+private:
+  class KSocketEntry;
+
+  typedef Event<KSocketEntry> KEvent;
+  typedef CommandEvent<KSocketEntry, IoUringEventPoll> KCommandEvent;
+  typedef ADNSEvent<KSocketEntry, IoUringEventPoll> KADNSEvent;
+  typedef AsyncNameResolverEntry<IoUringEventPoll> KAsyncNameResolverEntry;
+  friend class AsyncNameResolverEntry<IoUringEventPoll>;
+
+  class KSocketEntry : public SocketEntry<KCommandEvent, KADNSEvent> {
+  private:
+    // user_data of the poll request in flight, or 0 if none.
+    uint64_t armedId_;
+    // events the poll request in flight was armed with.
+    int armedEvents_;
+    // true if this entry is in IoUringEventPoll::updates_.
+    bool updatePending_;
+    // true if the poll request in flight must be re-armed even if
+    // its events cover the current interest.
+    bool forceRearm_;
+    // identity of the file the socket descriptor refers to.
+    dev_t dev_;
+    ino_t ino_;
+
+  public:
+    KSocketEntry(sock_t socket);
+
+    KSocketEntry(const KSocketEntry&) = delete;
+    KSocketEntry(KSocketEntry&&) = default;
+
+    int getEvents();
+
+    uint64_t getArmedId() const { return armedId_; }
+
+    int getArmedEvents() const { return armedEvents_; }
+
+    void setArmed(uint64_t id, int events)
+    {
+      armedId_ = id;
+      armedEvents_ = events;
+    }
+
+    bool isUpdatePending() const { return updatePending_; }
+
+    void setUpdatePending(bool f) { updatePending_ = f; }
+
+    bool isForceRearm() const { return forceRearm_; }
+
+    void setForceRearm(bool f) { forceRearm_ = f; }
+
+    // Reads the identity of the file the socket descriptor refers to
+    // and returns true if it differs from the one read last time or
+    // cannot be read.
+    bool updateIdentity();
+  };
+
+  friend int accumulateEvent(int events, const KEvent& event);
+
+private:
+  typedef std::map<sock_t, KSocketEntry> KSocketEntrySet;
+  KSocketEntrySet socketEntries_;
+#ifdef ENABLE_ASYNC_DNS
+  typedef std::map<std::pair<AsyncNameResolver*, Command*>,
+                   KAsyncNameResolverEntry>
+      KAsyncNameResolverEntrySet;
+  KAsyncNameResolverEntrySet nameResolverEntries_;
+#endif // ENABLE_ASYNC_DNS
+
+  // Sockets whose poll request has to be (re-)armed in the next
+  // poll().
+  std::vector<sock_t> updates_;
+  // user_data of poll requests which have to be cancelled in the
+  // next poll().
+  std::vector<uint64_t> cancels_;
+
+  int ringfd_;
+
+  // Submission queue ring
+  void* sqRing_;
+  size_t sqRingSize_;
+  unsigned* sqHead_;
+  unsigned* sqTail_;
+  unsigned* sqFlags_;
+  unsigned sqMask_;
+  unsigned sqEntries_;
+  unsigned* sqArray_;
+  struct io_uring_sqe* sqes_;
+  size_t sqesSize_;
+
+  // Completion queue ring.  If the kernel supports
+  // IORING_FEAT_SINGLE_MMAP, it shares the mapping with sqRing_.
+  void* cqRing_;
+  size_t cqRingSize_;
+  unsigned* cqHead_;
+  unsigned* cqTail_;
+  unsigned cqMask_;
+  struct io_uring_cqe* cqes_;
+
+  // Generation counter used to build user_data of poll requests.
+  uint32_t serial_;
+
+  static const unsigned SQ_ENTRIES = 1024;
+  static const unsigned CQ_ENTRIES = 16384;
+
+  bool addEvents(sock_t socket, const KEvent& event);
+
+  bool deleteEvents(sock_t socket, const KEvent& event);
+
+  bool addEvents(sock_t socket, Command* command, int events,
+                 const std::shared_ptr<AsyncNameResolver>& rs);
+
+  bool deleteEvents(sock_t socket, Command* command,
+                    const std::shared_ptr<AsyncNameResolver>& rs);
+
+  void scheduleUpdate(KSocketEntry& socketEntry);
+
+  // Appends SQE to the submission ring.  If the ring is full, queued
+  // SQEs are submitted first to make room.  Returns false on error.
+  bool queueSqe(uint8_t opcode, sock_t fd, int events, uint64_t addr,
+                uint64_t userData);
+
+  void queueUpdates();
+
+  // Submits queued SQEs.  If tv is not nullptr, waits for at least
+  // one completion or until tv elapses.
+  int enter(const struct timeval* tv);
+
+  // Processes completions and returns the number of those delivered
+  // for the poll requests in flight.
+  size_t processCompletions();
+
+  uint64_t nextId(sock_t socket);
+
+  void releaseRing();
+
+public:
+  IoUringEventPoll();
+
+  bool good() const;
+
+  virtual ~IoUringEventPoll();
+
+  virtual void poll(const struct timeval& tv) CXX11_OVERRIDE;
+
+  virtual bool addEvents(sock_t socket, Command* command,
+                         EventPoll::EventType events) CXX11_OVERRIDE;
+
+  virtual bool deleteEvents(sock_t socket, Command* command,
+                            EventPoll::EventType events) CXX11_OVERRIDE;
+#ifdef ENABLE_ASYNC_DNS
+
+  virtual bool
+  addNameResolver(const std::shared_ptr<AsyncNameResolver>& resolver,
+                  Command* command) CXX11_OVERRIDE;
+  virtual bool
+  deleteNameResolver(const std::shared_ptr<AsyncNameResolver>& resolver,
+                     Command* command) CXX11_OVERRIDE;
+#endif // ENABLE_ASYNC_DNS
+
+  static const int IEV_READ = POLLIN;
+  static const int IEV_WRITE = POLLOUT;
+  static const int IEV_ERROR = POLLERR;
+  static const int IEV_HUP = POLLHUP;
+};
+
+} // namespace aria2
+
+#endif // D_IO_URING_EVENT_POLL_H
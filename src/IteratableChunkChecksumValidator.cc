@@ -37,6 +37,7 @@
 #include <array>
 #include <cstring>
 #include <cstdlib>
+#include <algorithm>
 
 #include "util.h"
 #include "message.h"
@@ -51,9 +52,21 @@
 #include "MessageDigest.h"
 #include "fmt.h"
 #include "DlAbortEx.h"
+#include "A2STR.h"
+#ifdef HAVE_STD_THREAD
+#  include "PieceHashQueue.h"
+#endif // HAVE_STD_THREAD
 
 namespace aria2 {
 
+#ifdef HAVE_STD_THREAD
+namespace {
+// The maximum number of bytes of the pieces which are read but not
+// hashed yet.
+const size_t MAX_PENDING_BYTES = 64_m;
+} // namespace
+#endif // HAVE_STD_THREAD
+
 IteratableChunkChecksumValidator::IteratableChunkChecksumValidator(
     const std::shared_ptr<DownloadContext>& dctx,
     const std::shared_ptr<PieceStorage>& pieceStorage)
@@ -61,30 +74,31 @@ IteratableChunkChecksumValidator::IteratableChunkChecksumValidator(
       pieceStorage_(pieceStorage),
       bitfield_(make_unique<BitfieldMan>(dctx_->getPieceLength(),
                                          dctx_->getTotalLength())),
-      currentIndex_(0)
+      currentIndex_(0),
+      nextIndex_(0)
 {
 }
 
-IteratableChunkChecksumValidator::~IteratableChunkChecksumValidator() = default;
+IteratableChunkChecksumValidator::~IteratableChunkChecksumValidator()
+{
+  cancelPendingJobs();
+}
 
 void IteratableChunkChecksumValidator::validateChunk()
 {
-  if (!finished()) {
+  if (finished()) {
+    return;
+  }
+#ifdef HAVE_STD_THREAD
+  if (pieceHashQueue_) {
+    validateChunkParallel();
+  }
+  else
+#endif // HAVE_STD_THREAD
+  {
     std::string actualChecksum;
     try {
       actualChecksum = calculateActualChecksum();
-      if (actualChecksum == dctx_->getPieceHashes()[currentIndex_]) {
-        bitfield_->setBit(currentIndex_);
-      }
-      else {
-        A2_LOG_INFO(
-            fmt(EX_INVALID_CHUNK_CHECKSUM,
-                static_cast<unsigned long>(currentIndex_),
-                static_cast<int64_t>(getCurrentOffset()),
-                util::toHex(dctx_->getPieceHashes()[currentIndex_]).c_str(),
-                util::toHex(actualChecksum).c_str()));
-        bitfield_->unsetBit(currentIndex_);
-      }
     }
     catch (RecoverableException& ex) {
       A2_LOG_DEBUG_EX(fmt("Caught exception while validating piece index=%lu."
@@ -92,29 +106,137 @@ void IteratableChunkChecksumValidator::validateChunk()
                           " Continue operation.",
                           static_cast<unsigned long>(currentIndex_)),
                       ex);
-      bitfield_->unsetBit(currentIndex_);
     }
+    checkPiece(actualChecksum);
+  }
+  if (finished()) {
+    pieceStorage_->setBitfield(bitfield_->getBitfield(),
+                               bitfield_->getBitfieldLength());
+  }
+}
+
+void IteratableChunkChecksumValidator::checkPiece(
+    const std::string& actualChecksum)
+{
+  // actualChecksum is empty if the piece could not be read.
+  if (actualChecksum.empty()) {
+    bitfield_->unsetBit(currentIndex_);
+  }
+  else if (actualChecksum == dctx_->getPieceHashes()[currentIndex_]) {
+    bitfield_->setBit(currentIndex_);
+  }
+  else {
+    A2_LOG_INFO(fmt(EX_INVALID_CHUNK_CHECKSUM,
+                    static_cast<unsigned long>(currentIndex_),
+                    static_cast<int64_t>(getCurrentOffset()),
+                    util::toHex(dctx_->getPieceHashes()[currentIndex_]).c_str(),
+                    util::toHex(actualChecksum).c_str()));
+    bitfield_->unsetBit(currentIndex_);
+  }
+  ++currentIndex_;
+}
+
+#ifdef HAVE_STD_THREAD
+void IteratableChunkChecksumValidator::validateChunkParallel()
+{
+  // Read one piece per call so that other commands can run while
+  // the workers hash the pending pieces.  Block only when enough
+  // pieces are pending.
+  size_t maxPending =
+      std::max(static_cast<size_t>(2),
+               std::min(pieceHashQueue_->getNumThreads() *
+                            PieceHashQueue::MAX_BATCH,
+                        MAX_PENDING_BYTES / dctx_->getPieceLength()));
+  if (nextIndex_ < dctx_->getNumPieces() &&
+      pendingJobs_.size() < maxPending) {
+    pendingJobs_.push_back(readPiece(nextIndex_));
+    ++nextIndex_;
+  }
+  else if (pendingJobs_.front()) {
+    pieceHashQueue_->wait(pendingJobs_.front());
+  }
+  while (!pendingJobs_.empty()) {
+    auto& job = pendingJobs_.front();
+    if (!job) {
+      checkPiece(A2STR::NIL);
+    }
+    else if (pieceHashQueue_->done(job)) {
+      checkPiece(job->digest);
+    }
+    else {
+      break;
+    }
+    pendingJobs_.pop_front();
+  }
+}
 
-    ++currentIndex_;
-    if (finished()) {
-      pieceStorage_->setBitfield(bitfield_->getBitfield(),
-                                 bitfield_->getBitfieldLength());
+std::shared_ptr<PieceHashJob>
+IteratableChunkChecksumValidator::readPiece(size_t index)
+{
+  int64_t offset = static_cast<int64_t>(index) * dctx_->getPieceLength();
+  size_t length = getPieceLength(index);
+  auto data = make_unique<unsigned char[]>(length);
+  try {
+    for (size_t pos = 0; pos < length;) {
+      size_t r = pieceStorage_->getDiskAdaptor()->readDataDropCache(
+          data.get() + pos, length - pos, offset + pos);
+      if (r == 0) {
+        throw DL_ABORT_EX(fmt(EX_FILE_READ, dctx_->getBasePath().c_str(),
+                              "data is too short"));
+      }
+      pos += r;
     }
   }
+  catch (RecoverableException& ex) {
+    A2_LOG_DEBUG_EX(fmt("Caught exception while validating piece index=%lu."
+                        " Some part of file may be missing."
+                        " Continue operation.",
+                        static_cast<unsigned long>(index)),
+                    ex);
+    return nullptr;
+  }
+  auto job = std::make_shared<PieceHashJob>(dctx_->getPieceHashType(),
+                                            std::move(data), length);
+  pieceHashQueue_->push(job);
+  return job;
 }
+#endif // HAVE_STD_THREAD
 
-std::string IteratableChunkChecksumValidator::calculateActualChecksum()
+void IteratableChunkChecksumValidator::cancelPendingJobs()
+{
+#ifdef HAVE_STD_THREAD
+  for (auto& job : pendingJobs_) {
+    if (job) {
+      pieceHashQueue_->cancel(job);
+    }
+  }
+#endif // HAVE_STD_THREAD
+  pendingJobs_.clear();
+  nextIndex_ = currentIndex_;
+}
+
+void IteratableChunkChecksumValidator::setPieceHashQueue(
+    const std::shared_ptr<PieceHashQueue>& queue)
+{
+  cancelPendingJobs();
+  pieceHashQueue_ = queue;
+}
+
+size_t IteratableChunkChecksumValidator::getPieceLength(size_t index) const
 {
-  int64_t offset = getCurrentOffset();
-  size_t length;
   // When validating last piece
-  if (currentIndex_ + 1 == dctx_->getNumPieces()) {
-    length = dctx_->getTotalLength() - offset;
+  if (index + 1 == dctx_->getNumPieces()) {
+    return dctx_->getTotalLength() -
+           static_cast<int64_t>(index) * dctx_->getPieceLength();
   }
   else {
-    length = dctx_->getPieceLength();
+    return dctx_->getPieceLength();
   }
-  return digest(offset, length);
+}
+
+std::string IteratableChunkChecksumValidator::calculateActualChecksum()
+{
+  return digest(getCurrentOffset(), getPieceLength(currentIndex_));
 }
 
 void IteratableChunkChecksumValidator::init()
@@ -122,6 +244,7 @@ void IteratableChunkChecksumValidator::init()
   ctx_ = MessageDigest::create(dctx_->getPieceHashType());
   bitfield_->clearAllBit();
   currentIndex_ = 0;
+  cancelPendingJobs();
 }
 
 std::string IteratableChunkChecksumValidator::digest(int64_t offset,
@@ -39,6 +39,7 @@
 
 #include <string>
 #include <memory>
+#include <deque>
 
 namespace aria2 {
 
@@ -46,6 +47,7 @@ class DownloadContext;
 class PieceStorage;
 class BitfieldMan;
 class MessageDigest;
+struct PieceHashJob;
 
 class IteratableChunkChecksumValidator : public IteratableValidator {
 private:
@@ -54,11 +56,27 @@ private:
   std::unique_ptr<BitfieldMan> bitfield_;
   size_t currentIndex_;
   std::unique_ptr<MessageDigest> ctx_;
+  std::shared_ptr<PieceHashQueue> pieceHashQueue_;
+  // The pieces in [currentIndex_, nextIndex_) have been pushed to
+  // pieceHashQueue_.  nullptr is stored for the piece which could not
+  // be read.
+  std::deque<std::shared_ptr<PieceHashJob>> pendingJobs_;
+  size_t nextIndex_;
+
+  size_t getPieceLength(size_t index) const;
 
   std::string calculateActualChecksum();
 
   std::string digest(int64_t offset, size_t length);
 
+  void checkPiece(const std::string& actualChecksum);
+
+  void validateChunkParallel();
+
+  std::shared_ptr<PieceHashJob> readPiece(size_t index);
+
+  void cancelPendingJobs();
+
 public:
   IteratableChunkChecksumValidator(
       const std::shared_ptr<DownloadContext>& dctx,
@@ -75,6 +93,9 @@ public:
   virtual int64_t getCurrentOffset() const CXX11_OVERRIDE;
 
   virtual int64_t getTotalLength() const CXX11_OVERRIDE;
+
+  virtual void setPieceHashQueue(const std::shared_ptr<PieceHashQueue>& queue)
+      CXX11_OVERRIDE;
 };
 
 } // namespace aria2
@@ -39,8 +39,12 @@
 
 #include <unistd.h>
 
+#include <memory>
+
 namespace aria2 {
 
+class PieceHashQueue;
+
 /**
  * This class provides the interface to validate files.
  *
@@ -62,6 +66,12 @@ public:
   virtual int64_t getCurrentOffset() const = 0;
 
   virtual int64_t getTotalLength() const = 0;
+
+  // Lets the validator compute hashes in the worker threads of
+  // |queue|.  The default implementation does nothing.
+  virtual void setPieceHashQueue(const std::shared_ptr<PieceHashQueue>& queue)
+  {
+  }
 };
 
 } // namespace aria2
@@ -35,14 +35,65 @@
 #ifndef D_JSON_DISK_WRITER_H
 #define D_JSON_DISK_WRITER_H
 
-#include "ValueBaseDiskWriter.h"
-#include "JsonParser.h"
+#include "DiskWriter.h"
+
+#include <string>
+
+#include "ValueBase.h"
 
 namespace aria2 {
 
 namespace json {
 
-typedef ValueBaseDiskWriter<JsonParser> JsonDiskWriter;
+// DiskWriter which keeps the written JSON text in memory and parses
+// it in finalize() with json::parse(), which is faster than feeding
+// JsonParser piece by piece.  The size of the text is limited by
+// --rpc-max-request-size.  It is only capable of sequential write so
+// offset argument in write() will be ignored.  It also does not offer
+// read().
+class JsonDiskWriter : public DiskWriter {
+public:
+  JsonDiskWriter();
+
+  virtual ~JsonDiskWriter();
+
+  virtual void initAndOpenFile(int64_t totalLength = 0) CXX11_OVERRIDE;
+
+  virtual void openFile(int64_t totalLength = 0) CXX11_OVERRIDE
+  {
+    initAndOpenFile(totalLength);
+  }
+
+  virtual void closeFile() CXX11_OVERRIDE {}
+
+  virtual void openExistingFile(int64_t totalLength = 0) CXX11_OVERRIDE
+  {
+    initAndOpenFile(totalLength);
+  }
+
+  virtual int64_t size() CXX11_OVERRIDE { return 0; }
+
+  virtual void writeData(const unsigned char* data, size_t len,
+                         int64_t offset) CXX11_OVERRIDE;
+
+  virtual ssize_t readData(unsigned char* data, size_t len,
+                           int64_t offset) CXX11_OVERRIDE
+  {
+    return 0;
+  }
+
+  // Parses the written text.  Returns 0 on success, or one of the
+  // negative error codes of JsonParser.
+  int finalize();
+
+  std::unique_ptr<ValueBase> getResult();
+
+  void reset();
+
+private:
+  std::string text_;
+  std::unique_ptr<ValueBase> result_;
+};
 
 } // namespace json
 
@@ -0,0 +1,352 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "JsonFastParser.h"
+
+#include <cstring>
+
+#include "ValueBaseJsonParser.h"
+
+#if (defined(__clang__) && __clang_major__ >= 4) ||                            \
+    (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 5)
+#  define JSON_VECTOR 1
+#endif
+
+namespace aria2 {
+
+namespace json {
+
+namespace {
+// JsonParser fails at about this depth.  Deeper text is left to it.
+const int MAX_DEPTH = 32;
+
+#ifdef JSON_VECTOR
+typedef unsigned char v16u8 __attribute__((vector_size(16)));
+
+// Returns the index of the first byte in p[0..15] which is '"' or
+// '\\', or 16 if there is none.  The comparison is done in 16 byte
+// vectors, which are SSE2 or NEON registers on the common targets.
+inline size_t findQuoteOrEscape16(const char* p)
+{
+  v16u8 v;
+  memcpy(&v, p, sizeof(v));
+  v16u8 m = (v == '"') | (v == '\\');
+  uint64_t lanes[2];
+  memcpy(lanes, &m, sizeof(m));
+  for (size_t i = 0; i < 2; ++i) {
+    if (lanes[i]) {
+#  if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      return i * 8 + __builtin_clzll(lanes[i]) / 8;
+#  else
+      return i * 8 + __builtin_ctzll(lanes[i]) / 8;
+#  endif
+    }
+  }
+  return 16;
+}
+#endif // JSON_VECTOR
+
+// Returns the position of the first '"' or '\\' in [first, last), or
+// last if there is none.
+const char* findQuoteOrEscape(const char* first, const char* last)
+{
+#ifdef JSON_VECTOR
+  for (; last - first >= 16; first += 16) {
+    size_t n = findQuoteOrEscape16(first);
+    if (n < 16) {
+      return first + n;
+    }
+  }
+#endif // JSON_VECTOR
+  for (; first != last && *first != '"' && *first != '\\'; ++first)
+    ;
+  return first;
+}
+
+class FastParser {
+public:
+  FastParser(const char* data, size_t size)
+      : first_(data), p_(data), last_(data + size)
+  {
+  }
+
+  std::unique_ptr<ValueBase> parse(size_t& consumed)
+  {
+    skipSpace();
+    if (p_ == last_) {
+      return nullptr;
+    }
+    // JsonParser cannot tell the end of a number at the end of the
+    // text, and regards it as premature data.
+    if (*p_ != '{' && *p_ != '[' && *p_ != '"') {
+      return nullptr;
+    }
+    auto v = parseValue(0);
+    if (v) {
+      consumed = p_ - first_;
+    }
+    return v;
+  }
+
+private:
+  void skipSpace()
+  {
+    for (; p_ != last_ &&
+           (*p_ == ' ' || *p_ == '\t' || *p_ == '\r' || *p_ == '\n');
+         ++p_)
+      ;
+  }
+
+  // Reads the string after the opening '"' into |s|.
+  bool parseString(std::string& s)
+  {
+    auto q = findQuoteOrEscape(p_, last_);
+    if (q == last_) {
+      return false;
+    }
+    if (*q == '"') {
+      // The common case: no escape
+      s.assign(p_, q);
+      p_ = q + 1;
+      return true;
+    }
+    s.clear();
+    for (;;) {
+      s.append(p_, q);
+      p_ = q + 1;
+      if (*q == '"') {
+        return true;
+      }
+      if (p_ == last_) {
+        return false;
+      }
+      switch (*p_) {
+      case 'u':
+        return false;
+      case 'b':
+        s += '\b';
+        break;
+      case 'f':
+        s += '\f';
+        break;
+      case 'n':
+        s += '\n';
+        break;
+      case 'r':
+        s += '\r';
+        break;
+      case 't':
+        s += '\t';
+        break;
+      default:
+        // JsonParser takes the other escaped characters as they are.
+        s += *p_;
+      }
+      ++p_;
+      q = findQuoteOrEscape(p_, last_);
+      if (q == last_) {
+        return false;
+      }
+    }
+  }
+
+  std::unique_ptr<ValueBase> parseNumber()
+  {
+    int64_t sign = 1;
+    if (*p_ == '-') {
+      sign = -1;
+      ++p_;
+    }
+    auto digits = p_;
+    int64_t number = 0;
+    for (; p_ != last_ && '0' <= *p_ && *p_ <= '9'; ++p_) {
+      if ((INT64_MAX - (*p_ - '0')) / 10 < number) {
+        return nullptr;
+      }
+      number = number * 10 + (*p_ - '0');
+    }
+    if (p_ == digits || p_ == last_ || *p_ == '.' || *p_ == 'e' ||
+        *p_ == 'E') {
+      return nullptr;
+    }
+    return Integer::g(sign * number);
+  }
+
+  bool consumeLiteral(const char* lit, size_t len)
+  {
+    if (static_cast<size_t>(last_ - p_) < len || memcmp(p_, lit, len) != 0) {
+      return false;
+    }
+    p_ += len;
+    return true;
+  }
+
+  std::unique_ptr<ValueBase> parseDict(int depth)
+  {
+    auto dict = Dict::g();
+    skipSpace();
+    if (p_ != last_ && *p_ == '}') {
+      ++p_;
+      return std::move(dict);
+    }
+    std::string key;
+    for (;;) {
+      if (p_ == last_ || *p_ != '"') {
+        return nullptr;
+      }
+      ++p_;
+      if (!parseString(key)) {
+        return nullptr;
+      }
+      skipSpace();
+      if (p_ == last_ || *p_ != ':') {
+        return nullptr;
+      }
+      ++p_;
+      skipSpace();
+      auto v = parseValue(depth + 1);
+      if (!v) {
+        return nullptr;
+      }
+      // JsonParser drops the members with an empty key.
+      if (!key.empty()) {
+        dict->put(std::move(key), std::move(v));
+      }
+      skipSpace();
+      if (p_ == last_) {
+        return nullptr;
+      }
+      if (*p_ == '}') {
+        ++p_;
+        return std::move(dict);
+      }
+      if (*p_ != ',') {
+        return nullptr;
+      }
+      ++p_;
+      skipSpace();
+    }
+  }
+
+  std::unique_ptr<ValueBase> parseList(int depth)
+  {
+    auto list = List::g();
+    skipSpace();
+    if (p_ != last_ && *p_ == ']') {
+      ++p_;
+      return std::move(list);
+    }
+    for (;;) {
+      auto v = parseValue(depth + 1);
+      if (!v) {
+        return nullptr;
+      }
+      list->append(std::move(v));
+      skipSpace();
+      if (p_ == last_) {
+        return nullptr;
+      }
+      if (*p_ == ']') {
+        ++p_;
+        return std::move(list);
+      }
+      if (*p_ != ',') {
+        return nullptr;
+      }
+      ++p_;
+      skipSpace();
+    }
+  }
+
+  std::unique_ptr<ValueBase> parseValue(int depth)
+  {
+    if (depth > MAX_DEPTH || p_ == last_) {
+      return nullptr;
+    }
+    switch (*p_) {
+    case '{':
+      ++p_;
+      return parseDict(depth);
+    case '[':
+      ++p_;
+      return parseList(depth);
+    case '"': {
+      ++p_;
+      std::string s;
+      if (!parseString(s)) {
+        return nullptr;
+      }
+      return String::g(std::move(s));
+    }
+    case 't':
+      return consumeLiteral("true", 4) ? Bool::gTrue() : nullptr;
+    case 'f':
+      return consumeLiteral("false", 5) ? Bool::gFalse() : nullptr;
+    case 'n':
+      return consumeLiteral("null", 4) ? Null::g() : nullptr;
+    default:
+      if (*p_ == '-' || ('0' <= *p_ && *p_ <= '9')) {
+        return parseNumber();
+      }
+      return nullptr;
+    }
+  }
+
+  const char* first_;
+  const char* p_;
+  const char* last_;
+};
+} // namespace
+
+std::unique_ptr<ValueBase> parseFast(const char* data, size_t size,
+                                     size_t& consumed)
+{
+  return FastParser(data, size).parse(consumed);
+}
+
+std::unique_ptr<ValueBase> parse(const char* data, size_t size,
+                                 ssize_t& error)
+{
+  size_t consumed;
+  auto v = parseFast(data, size, consumed);
+  if (v) {
+    error = consumed;
+    return v;
+  }
+  return ValueBaseJsonParser().parseFinal(data, size, error);
+}
+
+} // namespace json
+
+} // namespace aria2
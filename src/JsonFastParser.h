@@ -0,0 +1,69 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_JSON_FAST_PARSER_H
+#define D_JSON_FAST_PARSER_H
+
+#include "common.h"
+
+#include <memory>
+
+#include "ValueBase.h"
+
+namespace aria2 {
+
+namespace json {
+
+// Parses JSON text |data| of |size| bytes, which must be all in
+// memory, and builds ValueBase directly from it.  This is much faster
+// than ValueBaseJsonParser, but handles only the subset of JSON used
+// in RPC requests: \u escapes, fractions, exponents, deep structures,
+// numbers and literals at the top level and malformed text are not
+// handled.  On success, returns the value
+// and sets |consumed| to the number of bytes up to the end of the
+// value.  Otherwise returns nullptr.
+std::unique_ptr<ValueBase> parseFast(const char* data, size_t size,
+                                     size_t& consumed);
+
+// Parses JSON text |data| of |size| bytes with parseFast(), and with
+// ValueBaseJsonParser if parseFast() fails.  The result and |error|
+// are the same as ValueBaseJsonParser::parseFinal().
+std::unique_ptr<ValueBase> parse(const char* data, size_t size,
+                                 ssize_t& error);
+
+} // namespace json
+
+} // namespace aria2
+
+#endif // D_JSON_FAST_PARSER_H
@@ -0,0 +1,76 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "LazyRequestGroup.h"
+#include "Option.h"
+
+namespace aria2 {
+
+LazyRequestGroup::LazyRequestGroup(std::shared_ptr<GroupId> gid,
+                                   std::vector<std::string> uris,
+                                   OptionDelta options,
+                                   std::shared_ptr<const Option> globalOption,
+                                   bool pauseRequested)
+    : gid_{std::move(gid)},
+      uris_{std::move(uris)},
+      options_{std::move(options)},
+      globalOption_{std::move(globalOption)},
+      pauseRequested_{pauseRequested}
+{
+}
+
+LazyRequestGroup::~LazyRequestGroup() = default;
+
+const std::string* LazyRequestGroup::findOption(PrefPtr pref) const
+{
+  for (auto& p : options_) {
+    if (p.first == pref) {
+      return &p.second;
+    }
+  }
+  return nullptr;
+}
+
+std::shared_ptr<Option> LazyRequestGroup::createOption() const
+{
+  auto option = std::make_shared<Option>(*globalOption_);
+  for (auto& p : options_) {
+    option->put(p.first, p.second);
+  }
+  option->removeLocal(PREF_PAUSE);
+  option->removeLocal(PREF_GID);
+  return option;
+}
+
+} // namespace aria2
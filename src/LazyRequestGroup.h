@@ -0,0 +1,106 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_LAZY_REQUEST_GROUP_H
+#define D_LAZY_REQUEST_GROUP_H
+
+#include "common.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+
+#include "prefs.h"
+#include "GroupId.h"
+
+namespace aria2 {
+
+class Option;
+
+// Compact representation of a waiting HTTP(S)/FTP/SFTP download
+// which is created by addUri.  It only holds GID, URIs, the options
+// given by the request and the snapshot of the global options taken
+// when the download was added.  RequestGroupMan builds the real
+// RequestGroup from it when the download is activated or modified.
+// Queries are answered from this object directly.
+class LazyRequestGroup {
+public:
+  typedef std::vector<std::pair<PrefPtr, std::string>> OptionDelta;
+
+  LazyRequestGroup(std::shared_ptr<GroupId> gid,
+                   std::vector<std::string> uris, OptionDelta options,
+                   std::shared_ptr<const Option> globalOption,
+                   bool pauseRequested);
+
+  ~LazyRequestGroup();
+
+  a2_gid_t getGID() const { return gid_->getNumericId(); }
+
+  const std::shared_ptr<GroupId>& getGroupId() const { return gid_; }
+
+  const std::vector<std::string>& getUris() const { return uris_; }
+
+  const OptionDelta& getOptions() const { return options_; }
+
+  const std::shared_ptr<const Option>& getGlobalOption() const
+  {
+    return globalOption_;
+  }
+
+  // Returns the value of |pref| in the option delta, or nullptr if
+  // |pref| is not in it.
+  const std::string* findOption(PrefPtr pref) const;
+
+  // Creates the options of the RequestGroup built from this object:
+  // the global option snapshot overridden by the option delta, without
+  // one-shot options.  This is cheap since Option shares its table
+  // among the copies.
+  std::shared_ptr<Option> createOption() const;
+
+  bool isPauseRequested() const { return pauseRequested_; }
+
+  void setPauseRequested(bool f) { pauseRequested_ = f; }
+
+private:
+  std::shared_ptr<GroupId> gid_;
+  std::vector<std::string> uris_;
+  OptionDelta options_;
+  std::shared_ptr<const Option> globalOption_;
+  bool pauseRequested_;
+};
+
+} // namespace aria2
+
+#endif // D_LAZY_REQUEST_GROUP_H
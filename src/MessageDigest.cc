@@ -40,6 +40,9 @@
 #include "MessageDigestImpl.h"
 #include "util.h"
 #include "array_fun.h"
+#ifdef USE_INTERNAL_MD
+#  include "crypto_hash.h"
+#endif // USE_INTERNAL_MD
 
 namespace aria2 {
 
@@ -81,6 +84,30 @@ MessageDigest::create(const std::string& hashType)
   return make_unique<MessageDigest>(MessageDigestImpl::create(hashType));
 }
 
+std::vector<std::string>
+MessageDigest::digestMany(const std::string& hashType,
+                          const unsigned char* const* data,
+                          const size_t* lengths, size_t count)
+{
+#ifdef USE_INTERNAL_MD
+  auto algo = crypto::hash::lookup(hashType);
+  if (algo != crypto::hash::algoNone) {
+    std::vector<const void*> ptrs(data, data + count);
+    std::vector<uint64_t> lens(lengths, lengths + count);
+    return crypto::hash::computeMany(algo, ptrs.data(), lens.data(), count);
+  }
+#endif // USE_INTERNAL_MD
+  std::vector<std::string> rv;
+  rv.reserve(count);
+  auto ctx = create(hashType);
+  for (size_t i = 0; i < count; ++i) {
+    ctx->update(data[i], lengths[i]);
+    rv.push_back(ctx->digest());
+    ctx->reset();
+  }
+  return rv;
+}
+
 bool MessageDigest::supports(const std::string& hashType)
 {
   return MessageDigestImpl::supports(hashType);
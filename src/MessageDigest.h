@@ -76,6 +76,16 @@ public:
   // Returns the number of bytes needed to store digest for hashType.
   static size_t getDigestLength(const std::string& hashType);
 
+  // Returns the raw digests of |count| independent messages.  The
+  // i-th message is |lengths[i]| bytes pointed by |data[i]|.  The
+  // internal implementation hashes several messages at once using
+  // SIMD instructions if they are available.  Throws exception if
+  // hashType is not supported.
+  static std::vector<std::string> digestMany(const std::string& hashType,
+                                             const unsigned char* const* data,
+                                             const size_t* lengths,
+                                             size_t count);
+
   // Returns true if hash type specified by lhs is stronger than the
   // one specified by rhs. Returns false if at least one of lhs and
   // rhs are not supported. Otherwise returns false.
@@ -50,7 +50,6 @@
 #include "Logger.h"
 #include "LogFactory.h"
 #include "SimpleRandomizer.h"
-#include "WrDiskCacheEntry.h"
 #include "OpenedFileCounter.h"
 
 namespace aria2 {
@@ -188,6 +187,9 @@ void MultiDiskAdaptor::resetDiskWriterEntries()
       if (readOnly_) {
         dwent->getDiskWriter()->enableReadOnly();
       }
+      if (diskWriteQueue_) {
+        dwent->getDiskWriter()->enableAsyncWrite(diskWriteQueue_);
+      }
       // TODO mmap is not enabled at this moment. Call enableMmap()
       // after this function call.
     }
@@ -357,6 +359,72 @@ void MultiDiskAdaptor::writeData(const unsigned char* data, size_t len,
   }
 }
 
+void MultiDiskAdaptor::writeDataVec(const a2iovec* iov, size_t iovcnt,
+                                    int64_t offset)
+{
+  size_t len = 0;
+  for (size_t i = 0; i < iovcnt; ++i) {
+    len += iov[i].A2IOVEC_LEN;
+  }
+  auto first = findFirstDiskWriterEntry(diskWriterEntries_, offset);
+  ssize_t rem = len;
+  int64_t fileOffset = offset - (*first)->getFileEntry()->getOffset();
+  // The buffers are split at the file boundaries.
+  std::vector<a2iovec> fileIov;
+  size_t iovIndex = 0;
+  size_t iovOffset = 0;
+  for (auto i = first, eoi = diskWriterEntries_.cend(); i != eoi; ++i) {
+    ssize_t writeLength = calculateLength((*i).get(), fileOffset, rem);
+    openIfNot((*i).get(), &DiskWriterEntry::openFile);
+    if (!(*i)->isOpen()) {
+      throwOnDiskWriterNotOpened((*i).get(), offset + (len - rem));
+    }
+    fileIov.clear();
+    for (size_t n = writeLength; n > 0;) {
+      auto& v = iov[iovIndex];
+      size_t m = std::min(n, v.A2IOVEC_LEN - iovOffset);
+      if (m > 0) {
+        a2iovec fv;
+        fv.A2IOVEC_BASE = static_cast<char*>(v.A2IOVEC_BASE) + iovOffset;
+        fv.A2IOVEC_LEN = m;
+        fileIov.push_back(fv);
+        n -= m;
+        iovOffset += m;
+      }
+      if (iovOffset == v.A2IOVEC_LEN) {
+        ++iovIndex;
+        iovOffset = 0;
+      }
+    }
+    (*i)->getDiskWriter()->writeDataVec(fileIov.data(), fileIov.size(),
+                                        fileOffset);
+    rem -= writeLength;
+    fileOffset = 0;
+    if (rem == 0) {
+      break;
+    }
+  }
+}
+
+#ifdef HAVE_SENDFILE
+std::shared_ptr<FileHandle> MultiDiskAdaptor::getFileHandle(int64_t offset,
+                                                            size_t len,
+                                                            int64_t& fileOffset)
+{
+  auto first = findFirstDiskWriterEntry(diskWriterEntries_, offset);
+  auto entry = (*first).get();
+  fileOffset = offset - entry->getFileEntry()->getOffset();
+  if (calculateLength(entry, fileOffset, len) != static_cast<ssize_t>(len)) {
+    return nullptr;
+  }
+  openIfNot(entry, &DiskWriterEntry::openFile);
+  if (!entry->isOpen()) {
+    throwOnDiskWriterNotOpened(entry, offset);
+  }
+  return entry->getDiskWriter()->getFileHandle(fileOffset, len);
+}
+#endif // HAVE_SENDFILE
+
 ssize_t MultiDiskAdaptor::readData(unsigned char* data, size_t len,
                                    int64_t offset)
 {
@@ -410,15 +478,6 @@ ssize_t MultiDiskAdaptor::readData(unsigned char* data, size_t len,
   return totalReadLength;
 }
 
-void MultiDiskAdaptor::writeCache(const WrDiskCacheEntry* entry)
-{
-  for (auto& d : entry->getDataSet()) {
-    A2_LOG_DEBUG(fmt("Cache flush goff=%" PRId64 ", len=%lu", d->goff,
-                     static_cast<unsigned long>(d->len)));
-    writeData(d->data + d->offset, d->len, d->goff);
-  }
-}
-
 bool MultiDiskAdaptor::fileExists()
 {
   return std::find_if(std::begin(getFileEntries()), std::end(getFileEntries()),
@@ -455,6 +514,18 @@ void MultiDiskAdaptor::enableMmap()
   }
 }
 
+void MultiDiskAdaptor::enableAsyncWrite(
+    const std::shared_ptr<DiskWriteQueue>& queue)
+{
+  diskWriteQueue_ = queue;
+  for (auto& dwent : diskWriterEntries_) {
+    auto& dw = dwent->getDiskWriter();
+    if (dw) {
+      dw->enableAsyncWrite(queue);
+    }
+  }
+}
+
 void MultiDiskAdaptor::cutTrailingGarbage()
 {
   for (auto& dwent : diskWriterEntries_) {
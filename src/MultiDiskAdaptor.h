@@ -103,6 +103,8 @@ private:
 
   bool readOnly_;
 
+  std::shared_ptr<DiskWriteQueue> diskWriteQueue_;
+
   void resetDiskWriterEntries();
 
   void openIfNot(DiskWriterEntry* entry, void (DiskWriterEntry::*f)());
@@ -127,14 +129,15 @@ public:
   virtual void writeData(const unsigned char* data, size_t len,
                          int64_t offset) CXX11_OVERRIDE;
 
+  virtual void writeDataVec(const a2iovec* iov, size_t iovcnt,
+                            int64_t offset) CXX11_OVERRIDE;
+
   virtual ssize_t readData(unsigned char* data, size_t len,
                            int64_t offset) CXX11_OVERRIDE;
 
   virtual ssize_t readDataDropCache(unsigned char* data, size_t len,
                                     int64_t offset) CXX11_OVERRIDE;
 
-  virtual void writeCache(const WrDiskCacheEntry* entry) CXX11_OVERRIDE;
-
   virtual bool fileExists() CXX11_OVERRIDE;
 
   virtual int64_t size() CXX11_OVERRIDE;
@@ -152,6 +155,15 @@ public:
   // opened.
   virtual void enableMmap() CXX11_OVERRIDE;
 
+  virtual void enableAsyncWrite(
+      const std::shared_ptr<DiskWriteQueue>& queue) CXX11_OVERRIDE;
+
+#ifdef HAVE_SENDFILE
+  virtual std::shared_ptr<FileHandle>
+  getFileHandle(int64_t offset, size_t len,
+                int64_t& fileOffset) CXX11_OVERRIDE;
+#endif // HAVE_SENDFILE
+
   void setPieceLength(int32_t pieceLength) { pieceLength_ = pieceLength; }
 
   int32_t getPieceLength() const { return pieceLength_; }
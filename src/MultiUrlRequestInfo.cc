@@ -67,6 +67,7 @@
 #include "console.h"
 #ifdef ENABLE_WEBSOCKET
 #  include "WebSocketSessionMan.h"
+#  include "WebSocketSubscriptionCommand.h"
 #else // !ENABLE_WEBSOCKET
 #  include "NullWebSocketSessionMan.h"
 #endif // !ENABLE_WEBSOCKET
@@ -83,6 +84,8 @@ namespace global {
 
 extern volatile sig_atomic_t globalHaltRequested;
 
+extern volatile sig_atomic_t commandProfileDumpRequested;
+
 } // namespace global
 
 namespace {
@@ -93,6 +96,12 @@ static const DWORD mainThread = GetCurrentThreadId();
 
 static void handler(int signal)
 {
+#ifdef SIGUSR2
+  if (signal == SIGUSR2) {
+    global::commandProfileDumpRequested = 1;
+    return;
+  }
+#endif // SIGUSR2
   if (
 #ifdef SIGHUP
       signal == SIGHUP ||
@@ -211,6 +220,8 @@ int MultiUrlRequestInfo::prepare()
       e_->setWebSocketSessionMan(make_unique<rpc::WebSocketSessionMan>());
       SingletonHolder<Notifier>::instance()->addDownloadEventListener(
           e_->getWebSocketSessionMan().get());
+      e_->addRoutineCommand(make_unique<rpc::WebSocketSubscriptionCommand>(
+          e_->newCUID(), e_.get()));
     }
 #endif // ENABLE_WEBSOCKET
 
@@ -392,11 +403,17 @@ void MultiUrlRequestInfo::setupSignalHandlers()
 #  ifdef SIGHUP
   sigaddset(&mask_, SIGHUP);
 #  endif // SIGHUP
+#  ifdef SIGUSR2
+  sigaddset(&mask_, SIGUSR2);
+#  endif // SIGUSR2
 #endif   // HAVE_SIGACTION
 
 #ifdef SIGHUP
   util::setGlobalSignalHandler(SIGHUP, &mask_, handler, 0);
 #endif // SIGHUP
+#ifdef SIGUSR2
+  util::setGlobalSignalHandler(SIGUSR2, &mask_, handler, 0);
+#endif // SIGUSR2
   util::setGlobalSignalHandler(SIGINT, &mask_, handler, 0);
   util::setGlobalSignalHandler(SIGTERM, &mask_, handler, 0);
 }
@@ -409,6 +426,9 @@ void MultiUrlRequestInfo::resetSignalHandlers()
 #ifdef SIGHUP
   util::setGlobalSignalHandler(SIGHUP, &mask_, SIG_DFL, 0);
 #endif // SIGHUP
+#ifdef SIGUSR2
+  util::setGlobalSignalHandler(SIGUSR2, &mask_, SIG_DFL, 0);
+#endif // SIGUSR2
   util::setGlobalSignalHandler(SIGINT, &mask_, SIG_DFL, 0);
   util::setGlobalSignalHandler(SIGTERM, &mask_, SIG_DFL, 0);
 
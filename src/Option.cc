@@ -36,65 +36,172 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
+#include <unordered_map>
 
-#include "bitfield.h"
+#include "A2STR.h"
 
 namespace aria2 {
 
-Option::Option()
-    : table_(option::countOption()), use_((option::countOption() + 7) / 8)
+namespace {
+struct DerefHash {
+  size_t operator()(const std::string* s) const
+  {
+    return std::hash<std::string>()(*s);
+  }
+};
+
+struct DerefEqual {
+  bool operator()(const std::string* a, const std::string* b) const
+  {
+    return *a == *b;
+  }
+};
+
+const size_t MIN_SWEEP_SIZE = 1024;
+
+// Interns option values, so that the same value put in many Option
+// objects, like dir or header, is stored only once.  The values no
+// longer referenced by any Option are swept when the pool has doubled
+// since the last sweep.  Like the rest of Option, this is not thread
+// safe.
+class StringPool {
+public:
+  StringPool() : sweepSize_(MIN_SWEEP_SIZE) {}
+
+  std::shared_ptr<const std::string> intern(const std::string& s)
+  {
+    auto i = pool_.find(&s);
+    if (i != std::end(pool_)) {
+      return (*i).second;
+    }
+    if (pool_.size() >= sweepSize_) {
+      sweep();
+    }
+    auto v = std::make_shared<const std::string>(s);
+    pool_.emplace(v.get(), v);
+    return v;
+  }
+
+private:
+  void sweep()
+  {
+    for (auto i = std::begin(pool_); i != std::end(pool_);) {
+      if ((*i).second.use_count() == 1) {
+        i = pool_.erase(i);
+      }
+      else {
+        ++i;
+      }
+    }
+    sweepSize_ = std::max(MIN_SWEEP_SIZE, pool_.size() * 2);
+  }
+
+  std::unordered_map<const std::string*, std::shared_ptr<const std::string>,
+                     DerefHash, DerefEqual>
+      pool_;
+  size_t sweepSize_;
+};
+
+StringPool& getStringPool()
 {
+  static StringPool pool;
+  return pool;
 }
 
+// The maximum number of overrides kept before they are folded into
+// a new table.
+const size_t MAX_OVERRIDES = 16;
+
+const std::shared_ptr<const std::string> NO_VALUE;
+
+typedef std::pair<size_t, std::shared_ptr<const std::string>> OverrideEntry;
+
+bool overrideLess(const OverrideEntry& o, size_t id)
+{
+  return o.first < id;
+}
+} // namespace
+
+Option::Option() = default;
+
 Option::~Option() = default;
 
 Option::Option(const Option& option) = default;
 
-Option& Option::operator=(const Option& option)
+Option& Option::operator=(const Option& option) = default;
+
+const std::shared_ptr<const std::string>& Option::findLocal(size_t id) const
 {
-  if (this != &option) {
-    table_ = option.table_;
-    use_ = option.use_;
-    parent_ = option.parent_;
+  if (!overrides_.empty()) {
+    auto i = std::lower_bound(std::begin(overrides_), std::end(overrides_), id,
+                              overrideLess);
+    if (i != std::end(overrides_) && (*i).first == id) {
+      return (*i).second;
+    }
   }
-  return *this;
+  if (base_) {
+    return (*base_)[id];
+  }
+  return NO_VALUE;
 }
 
-namespace {
-
-template <typename V> void setBit(V& b, PrefPtr pref)
+void Option::set(size_t id, std::shared_ptr<const std::string> value)
 {
-  b[pref->i / 8] |= 128 >> (pref->i % 8);
+  if (!base_) {
+    base_ = std::make_shared<Table>(option::countOption());
+  }
+  auto i = std::lower_bound(std::begin(overrides_), std::end(overrides_), id,
+                            overrideLess);
+  bool found = i != std::end(overrides_) && (*i).first == id;
+  if (base_.use_count() == 1) {
+    // No copy shares base_, so it can be updated in place.
+    if (found) {
+      overrides_.erase(i);
+    }
+    (*base_)[id] = std::move(value);
+    return;
+  }
+  if (found) {
+    (*i).second = std::move(value);
+    return;
+  }
+  overrides_.insert(i, Override(id, std::move(value)));
+  if (overrides_.size() > MAX_OVERRIDES) {
+    flatten();
+  }
 }
 
-template <typename V> void unsetBit(V& b, PrefPtr pref)
+void Option::flatten()
 {
-  b[pref->i / 8] &= ~(128 >> (pref->i % 8));
+  auto table = std::make_shared<Table>(*base_);
+  for (auto& o : overrides_) {
+    (*table)[o.first] = std::move(o.second);
+  }
+  overrides_.clear();
+  base_ = std::move(table);
 }
 
-} // namespace
-
 void Option::put(PrefPtr pref, const std::string& value)
 {
-  setBit(use_, pref);
-  table_[pref->i] = value;
+  set(pref->i, getStringPool().intern(value));
 }
 
 bool Option::defined(PrefPtr pref) const
 {
-  return bitfield::test(use_, use_.size() * 8, pref->i) ||
-         (parent_ && parent_->defined(pref));
+  return findLocal(pref->i) || (parent_ && parent_->defined(pref));
 }
 
 bool Option::definedLocal(PrefPtr pref) const
 {
-  return bitfield::test(use_, use_.size() * 8, pref->i);
+  return static_cast<bool>(findLocal(pref->i));
 }
 
 bool Option::blank(PrefPtr pref) const
 {
-  if (bitfield::test(use_, use_.size() * 8, pref->i)) {
-    return table_[pref->i].empty();
+  auto& v = findLocal(pref->i);
+  if (v) {
+    return v->empty();
   }
   else {
     return !parent_ || parent_->blank(pref);
@@ -103,8 +210,9 @@ bool Option::blank(PrefPtr pref) const
 
 const std::string& Option::get(PrefPtr pref) const
 {
-  if (bitfield::test(use_, use_.size() * 8, pref->i)) {
-    return table_[pref->i];
+  auto& v = findLocal(pref->i);
+  if (v) {
+    return *v;
   }
   else if (parent_) {
     return parent_->get(pref);
@@ -151,8 +259,9 @@ double Option::getAsDouble(PrefPtr pref) const
 
 void Option::removeLocal(PrefPtr pref)
 {
-  unsetBit(use_, pref);
-  table_[pref->i].clear();
+  if (findLocal(pref->i)) {
+    set(pref->i, nullptr);
+  }
 }
 
 void Option::remove(PrefPtr pref)
@@ -165,17 +274,16 @@ void Option::remove(PrefPtr pref)
 
 void Option::clear()
 {
-  std::fill(use_.begin(), use_.end(), 0);
-  std::fill(table_.begin(), table_.end(), "");
+  base_.reset();
+  overrides_.clear();
 }
 
 void Option::merge(const Option& option)
 {
-  size_t bits = option.use_.size() * 8;
-  for (size_t i = 1, len = table_.size(); i < len; ++i) {
-    if (bitfield::test(option.use_, bits, i)) {
-      use_[i / 8] |= 128 >> (i % 8);
-      table_[i] = option.table_[i];
+  for (size_t i = 1, len = option::countOption(); i < len; ++i) {
+    auto& v = option.findLocal(i);
+    if (v) {
+      set(i, v);
     }
   }
 }
@@ -189,8 +297,12 @@ const std::shared_ptr<Option>& Option::getParent() const { return parent_; }
 
 bool Option::emptyLocal() const
 {
-  size_t dst;
-  return !bitfield::getFirstSetBitIndex(dst, use_, use_.size() * 8);
+  for (size_t i = 1, len = option::countOption(); i < len; ++i) {
+    if (findLocal(i)) {
+      return false;
+    }
+  }
+  return true;
 }
 
 } // namespace aria2
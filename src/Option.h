@@ -47,10 +47,25 @@ namespace aria2 {
 
 class Option {
 private:
-  std::vector<std::string> table_;
-  std::vector<unsigned char> use_;
+  // Option values indexed by pref ID.  nullptr means the value is not
+  // defined.
+  typedef std::vector<std::shared_ptr<const std::string>> Table;
+  typedef std::pair<size_t, std::shared_ptr<const std::string>> Override;
+
+  // Dense table of option values.  It is shared among the copies of
+  // this object and is never modified while it is shared.
+  std::shared_ptr<Table> base_;
+  // Values which were put or removed after base_ got shared, sorted by
+  // pref ID.  nullptr value means the option is removed.  They are
+  // folded into a new base_ once there are too many of them.
+  std::vector<Override> overrides_;
   std::shared_ptr<Option> parent_;
 
+  // Returns the value of option ID |id| in this object, or nullptr.
+  const std::shared_ptr<const std::string>& findLocal(size_t id) const;
+  void set(size_t id, std::shared_ptr<const std::string> value);
+  void flatten();
+
 public:
   Option();
   ~Option();
@@ -83,9 +98,6 @@ public:
   // Removes all option values from this object. This function does
   // not modify parent_.
   void clear();
-  // Returns the option value table of this object. It does not
-  // contain option values in parent_ and so forth.
-  const std::vector<std::string>& getTable() const { return table_; }
   // Copy option values defined in option to this option. parent_ is
   // left unmodified for this object.
   void merge(const Option& option);
@@ -125,6 +125,14 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_ADVANCED);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new NumberOptionHandler(PREF_CHECK_INTEGRITY_THREADS,
+                                              TEXT_CHECK_INTEGRITY_THREADS,
+                                              "0", 0, 64));
+    op->addTag(TAG_ADVANCED);
+    op->addTag(TAG_CHECKSUM);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new BooleanOptionHandler(PREF_CHECK_INTEGRITY,
                                                TEXT_CHECK_INTEGRITY, A2_V_FALSE,
@@ -185,6 +193,25 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_ADVANCED);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new UnitNumberOptionHandler(
+        PREF_DISK_READ_CACHE, TEXT_DISK_READ_CACHE, "0", 0));
+    op->addTag(TAG_ADVANCED);
+    op->addTag(TAG_BITTORRENT);
+    handlers.push_back(op);
+  }
+  {
+    OptionHandler* op(new UnitNumberOptionHandler(
+        PREF_DISK_WRITE_QUEUE_SIZE, TEXT_DISK_WRITE_QUEUE_SIZE, "32M", 1_m));
+    op->addTag(TAG_ADVANCED);
+    handlers.push_back(op);
+  }
+  {
+    OptionHandler* op(new NumberOptionHandler(
+        PREF_DISK_WRITE_THREADS, TEXT_DISK_WRITE_THREADS, "0", 0, 64));
+    op->addTag(TAG_ADVANCED);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new ParameterOptionHandler(
         PREF_CONSOLE_LOG_LEVEL, TEXT_CONSOLE_LOG_LEVEL, V_NOTICE,
@@ -302,6 +329,9 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
 #ifdef HAVE_EPOLL
                                                      V_EPOLL,
 #endif // HAVE_EPOLL
+#ifdef HAVE_IO_URING
+                                                     V_IO_URING,
+#endif // HAVE_IO_URING
 #ifdef HAVE_KQUEUE
                                                      V_KQUEUE,
 #endif // HAVE_KQUEUE
@@ -629,6 +659,14 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_ADVANCED);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new BooleanOptionHandler(
+        PREF_PROFILE_COMMANDS, TEXT_PROFILE_COMMANDS, A2_V_FALSE,
+        OptionHandler::OPT_ARG));
+    op->addTag(TAG_ADVANCED);
+    op->setChangeGlobalOption(true);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new BooleanOptionHandler(
         PREF_REALTIME_CHUNK_CHECKSUM, TEXT_REALTIME_CHUNK_CHECKSUM, A2_V_TRUE,
@@ -731,6 +769,13 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_ADVANCED);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new LocalFilePathOptionHandler(
+        PREF_TRACE_FILE, TEXT_TRACE_FILE, NO_DEFAULT_VALUE,
+        /* acceptStdin = */ false, 0, /* mustExist = */ false));
+    op->addTag(TAG_ADVANCED);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new BooleanOptionHandler(
         PREF_TRUNCATE_CONSOLE_READOUT, TEXT_TRUNCATE_CONSOLE_READOUT, A2_V_TRUE,
@@ -778,6 +823,14 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_RPC);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new NumberOptionHandler(PREF_RPC_METRICS_MAX_DOWNLOADS,
+                                              TEXT_RPC_METRICS_MAX_DOWNLOADS,
+                                              "100", 0, INT32_MAX));
+    op->addTag(TAG_RPC);
+    op->setChangeGlobalOption(true);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new LocalFilePathOptionHandler(
         PREF_RPC_PRIVATE_KEY, TEXT_RPC_PRIVATE_KEY, NO_DEFAULT_VALUE, false));
@@ -1086,6 +1139,21 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->setChangeOptionForReserved(true);
     handlers.push_back(op);
   }
+#ifdef HAVE_SPLICE
+  {
+    OptionHandler* op(new BooleanOptionHandler(PREF_ENABLE_HTTP_SPLICE,
+                                               TEXT_ENABLE_HTTP_SPLICE,
+                                               A2_V_FALSE,
+                                               OptionHandler::OPT_ARG));
+    op->addTag(TAG_HTTP);
+    op->addTag(TAG_ADVANCED);
+    op->addTag(TAG_EXPERIMENTAL);
+    op->setInitialOption(true);
+    op->setChangeGlobalOption(true);
+    op->setChangeOptionForReserved(true);
+    handlers.push_back(op);
+  }
+#endif // HAVE_SPLICE
   {
     OptionHandler* op(new CumulativeOptionHandler(PREF_HEADER, TEXT_HEADER,
                                                   NO_DEFAULT_VALUE, "\n"));
@@ -1551,6 +1619,24 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->setChangeGlobalOption(true);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new BooleanOptionHandler(PREF_BT_ENABLE_UTP,
+                                               TEXT_BT_ENABLE_UTP, A2_V_FALSE,
+                                               OptionHandler::OPT_ARG));
+    op->addTag(TAG_BITTORRENT);
+    handlers.push_back(op);
+  }
+  {
+    OptionHandler* op(new NumberOptionHandler(PREF_BT_MAX_OUTSTANDING_REQUEST,
+                                              TEXT_BT_MAX_OUTSTANDING_REQUEST,
+                                              "500", 1, 4096));
+    op->addTag(TAG_BITTORRENT);
+    op->setInitialOption(true);
+    op->setChangeOption(true);
+    op->setChangeGlobalOption(true);
+    op->setChangeOptionForReserved(true);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(
         new NumberOptionHandler(PREF_BT_MAX_PEERS, TEXT_BT_MAX_PEERS, "55", 0));
@@ -393,4 +393,34 @@ size_t Peer::countOutstandingUpload() const
   return res_->countOutstandingUpload();
 }
 
+size_t Peer::getMaxOutstandingRequest() const
+{
+  assert(res_);
+  return res_->getMaxOutstandingRequest();
+}
+
+void Peer::setMaxOutstandingRequest(size_t n)
+{
+  assert(res_);
+  res_->setMaxOutstandingRequest(n);
+}
+
+void Peer::updateBlockRtt(std::chrono::milliseconds rtt)
+{
+  assert(res_);
+  res_->updateBlockRtt(rtt);
+}
+
+std::chrono::milliseconds Peer::getBlockRtt() const
+{
+  assert(res_);
+  return res_->getBlockRtt();
+}
+
+std::chrono::milliseconds Peer::getMinBlockRtt() const
+{
+  assert(res_);
+  return res_->getMinBlockRtt();
+}
+
 } // namespace aria2
@@ -266,6 +266,16 @@ public:
   void setBtMessageDispatcher(BtMessageDispatcher* dpt);
 
   size_t countOutstandingUpload() const;
+
+  size_t getMaxOutstandingRequest() const;
+
+  void setMaxOutstandingRequest(size_t n);
+
+  void updateBlockRtt(std::chrono::milliseconds rtt);
+
+  std::chrono::milliseconds getBlockRtt() const;
+
+  std::chrono::milliseconds getMinBlockRtt() const;
 };
 
 template <typename InputIterator>
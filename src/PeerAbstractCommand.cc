@@ -62,7 +62,8 @@ PeerAbstractCommand::PeerAbstractCommand(cuid_t cuid,
       peer_(peer),
       checkSocketIsReadable_(false),
       checkSocketIsWritable_(false),
-      noCheck_(false)
+      noCheck_(false),
+      idleSleepEnabled_(true)
 {
   if (socket_ && socket_->isOpen()) {
     setReadCheckSocket(socket_);
@@ -97,7 +98,15 @@ bool PeerAbstractCommand::execute()
     if (checkPoint_.difference(global::wallclock()) >= timeout_) {
       throw DL_ABORT_EX(EX_TIME_OUT);
     }
-    return executeInternal();
+    if (executeInternal()) {
+      return true;
+    }
+    if (idleSleepEnabled_ && !noCheck_ &&
+        (checkSocketIsReadable_ || checkSocketIsWritable_)) {
+      // Sleep until an I/O event arrives or the timeout expires.
+      sleepUntilTimeout();
+    }
+    return false;
   }
   catch (DownloadFailureException& err) {
     A2_LOG_ERROR_EX(EX_DOWNLOAD_ABORTED, err);
@@ -114,6 +123,14 @@ bool PeerAbstractCommand::execute()
   }
 }
 
+void PeerAbstractCommand::sleepUntilTimeout()
+{
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      checkPoint_.difference(global::wallclock()));
+  e_->sleepCommand(
+      this, std::min<std::chrono::milliseconds>(timeout_ - elapsed, 10_s));
+}
+
 // TODO this method removed when PeerBalancerCommand is implemented
 bool PeerAbstractCommand::prepareForNextPeer(time_t wait) { return true; }
 
@@ -181,6 +198,11 @@ void PeerAbstractCommand::setWriteCheckSocket(
 
 void PeerAbstractCommand::setNoCheck(bool check) { noCheck_ = check; }
 
+void PeerAbstractCommand::setIdleSleepEnabled(bool f)
+{
+  idleSleepEnabled_ = f;
+}
+
 void PeerAbstractCommand::updateKeepAlive()
 {
   checkPoint_ = global::wallclock();
@@ -61,6 +61,7 @@ private:
   std::shared_ptr<SocketCore> readCheckTarget_;
   std::shared_ptr<SocketCore> writeCheckTarget_;
   bool noCheck_;
+  bool idleSleepEnabled_;
 
 protected:
   DownloadEngine* getDownloadEngine() const { return e_; }
@@ -69,6 +70,11 @@ protected:
 
   void createSocket();
 
+  void setSocket(const std::shared_ptr<SocketCore>& socket)
+  {
+    socket_ = socket;
+  }
+
   const std::shared_ptr<Peer>& getPeer() const { return peer_; }
 
   void setTimeout(std::chrono::seconds timeout)
@@ -88,8 +94,14 @@ protected:
   void disableReadCheckSocket();
   void disableWriteCheckSocket();
   void setNoCheck(bool check);
+  // If true, this Command sleeps while it is waiting for I/O events.
+  // The default is true.
+  void setIdleSleepEnabled(bool f);
   void updateKeepAlive();
   void addCommandSelf();
+  // Puts this Command to sleep until the timeout expires, but at most
+  // 10 seconds so that exitBeforeExecute() is checked.
+  void sleepUntilTimeout();
 
 public:
   PeerAbstractCommand(
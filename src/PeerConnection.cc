@@ -92,6 +92,17 @@ void PeerConnection::pushBytes(std::vector<unsigned char> data,
   socketBuffer_.pushBytes(std::move(data), std::move(progressUpdate));
 }
 
+#ifdef HAVE_SENDFILE
+void PeerConnection::pushFileRange(
+    std::shared_ptr<FileHandle> fileHandle, int64_t fileOffset, size_t length,
+    std::unique_ptr<ProgressUpdate> progressUpdate)
+{
+  assert(!encryptionEnabled_);
+  socketBuffer_.pushFileRange(std::move(fileHandle), fileOffset, length,
+                              std::move(progressUpdate));
+}
+#endif // HAVE_SENDFILE
+
 bool PeerConnection::receiveMessage(unsigned char* data, size_t& dataLength)
 {
   while (1) {
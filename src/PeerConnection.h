@@ -100,8 +100,21 @@ public:
                  std::unique_ptr<ProgressUpdate> progressUpdate =
                      std::unique_ptr<ProgressUpdate>{});
 
+#ifdef HAVE_SENDFILE
+  // Pushes |length| bytes of the file |fileHandle| starting at
+  // |fileOffset| into send buffer.  The data is sent to the socket
+  // without being copied into user space, so encryption must not be
+  // enabled.
+  void pushFileRange(std::shared_ptr<FileHandle> fileHandle,
+                     int64_t fileOffset, size_t length,
+                     std::unique_ptr<ProgressUpdate> progressUpdate =
+                         std::unique_ptr<ProgressUpdate>{});
+#endif // HAVE_SENDFILE
+
   bool receiveMessage(unsigned char* data, size_t& dataLength);
 
+  bool isEncryptionEnabled() const { return encryptionEnabled_; }
+
   /**
    * Returns true if a handshake message is fully received, otherwise returns
    * false.
@@ -49,6 +49,9 @@
 #include "PeerConnection.h"
 #include "RequestGroup.h"
 #include "util.h"
+#include "BtRegistry.h"
+#include "UtpSocketManager.h"
+#include "wallclock.h"
 #include "fmt.h"
 
 namespace aria2 {
@@ -68,18 +71,88 @@ PeerInitiateConnectionCommand::PeerInitiateConnectionCommand(
 
 PeerInitiateConnectionCommand::~PeerInitiateConnectionCommand()
 {
+  if (utpSocket_) {
+    auto& utpSocketManager =
+        getDownloadEngine()->getBtRegistry()->getUtpSocketManager();
+    if (utpSocketManager) {
+      utpSocketManager->setConnectWaiter(utpSocket_, nullptr);
+    }
+  }
   requestGroup_->decreaseNumCommand();
   btRuntime_->decreaseConnections();
 }
 
 bool PeerInitiateConnectionCommand::executeInternal()
 {
+  if (connectUtp()) {
+    return true;
+  }
+  if (utpSocket_) {
+    addCommandSelf();
+    return false;
+  }
   A2_LOG_INFO(fmt(MSG_CONNECTING_TO_SERVER, getCuid(),
                   getPeer()->getIPAddress().c_str(), getPeer()->getPort()));
   createSocket();
   getSocket()->establishConnection(getPeer()->getIPAddress(),
                                    getPeer()->getPort(), false);
   getSocket()->applyIpDscp();
+  addHandshakeCommand();
+  return true;
+}
+
+// Tries uTP first if it is enabled.  Returns true if the uTP
+// connection is established.  While it is being established,
+// utpSocket_ is not null.  If it fails, we fall back to TCP.
+bool PeerInitiateConnectionCommand::connectUtp()
+{
+  auto& utpSocketManager =
+      getDownloadEngine()->getBtRegistry()->getUtpSocketManager();
+  if (!utpSocketManager) {
+    return false;
+  }
+  if (!utpSocket_) {
+    if (getPeer()->getIPAddress().find(':') != std::string::npos) {
+      return false;
+    }
+    A2_LOG_INFO(fmt("CUID#%" PRId64 " - Connecting to %s:%d over uTP",
+                    getCuid(), getPeer()->getIPAddress().c_str(),
+                    getPeer()->getPort()));
+    try {
+      utpSocket_ = utpSocketManager->connect(
+          getPeer()->getIPAddress(), getPeer()->getPort(), global::wallclock());
+      utpSocketManager->setConnectWaiter(utpSocket_, this);
+    }
+    catch (RecoverableException& e) {
+      A2_LOG_INFO_EX(fmt("CUID#%" PRId64 " - Failed to create uTP socket",
+                         getCuid()),
+                     e);
+      return false;
+    }
+  }
+  switch (utpSocketManager->getConnectionState(utpSocket_)) {
+  case UTP_CS_CONNECTED:
+    setSocket(utpSocket_);
+    addHandshakeCommand();
+    return true;
+  case UTP_CS_SYN_SENT:
+    // There is no I/O event on the socket until the connection is
+    // established.  utpSocketManager wakes us up when it is
+    // established or fails.
+    sleepUntilTimeout();
+    return false;
+  default:
+    A2_LOG_INFO(fmt("CUID#%" PRId64 " - uTP connection to %s:%d failed."
+                    " Falling back to TCP",
+                    getCuid(), getPeer()->getIPAddress().c_str(),
+                    getPeer()->getPort()));
+    utpSocket_.reset();
+    return false;
+  }
+}
+
+void PeerInitiateConnectionCommand::addHandshakeCommand()
+{
   if (mseHandshakeEnabled_) {
     auto c = make_unique<InitiatorMSEHandshakeCommand>(
         getCuid(), requestGroup_, getPeer(), getDownloadEngine(), btRuntime_,
@@ -94,7 +167,6 @@ bool PeerInitiateConnectionCommand::executeInternal()
         pieceStorage_, peerStorage_, getSocket(),
         PeerInteractionCommand::INITIATOR_SEND_HANDSHAKE));
   }
-  return true;
 }
 
 // TODO this method removed when PeerBalancerCommand is implemented
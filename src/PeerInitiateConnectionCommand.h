@@ -56,6 +56,13 @@ private:
 
   bool mseHandshakeEnabled_;
 
+  // The socket bridged to the uTP connection being established.
+  std::shared_ptr<SocketCore> utpSocket_;
+
+  bool connectUtp();
+
+  void addHandshakeCommand();
+
 protected:
   virtual bool executeInternal() CXX11_OVERRIDE;
   virtual bool prepareForNextPeer(time_t wait) CXX11_OVERRIDE;
@@ -72,6 +72,9 @@
 #include "RequestGroup.h"
 #include "DefaultExtensionMessageFactory.h"
 #include "RequestGroupMan.h"
+#ifdef ENABLE_ASYNC_DISK_WRITE
+#  include "DiskWriteQueue.h"
+#endif // ENABLE_ASYNC_DISK_WRITE
 #include "ExtensionMessageRegistry.h"
 #include "bittorrent_helper.h"
 #include "UTMetadataRequestFactory.h"
@@ -94,6 +97,9 @@ PeerInteractionCommand::PeerInteractionCommand(
       peerStorage_{peerStorage},
       sequence_{sequence}
 {
+  // BtInteractive sends have, request and keep-alive messages without
+  // I/O events, so this Command must be executed periodically.
+  setIdleSleepEnabled(false);
   // TODO move following bunch of processing to separate method, like init()
   if (sequence_ == INITIATOR_SEND_HANDSHAKE) {
     disableReadCheckSocket();
@@ -353,7 +359,18 @@ bool PeerInteractionCommand::executeInternal()
         setNoCheck(true);
       }
       else {
-        setReadCheckSocket(getSocket());
+#ifdef ENABLE_ASYNC_DISK_WRITE
+        auto& diskWriteQueue =
+            getDownloadEngine()->getRequestGroupMan()->getDiskWriteQueue();
+        if (diskWriteQueue && diskWriteQueue->full()) {
+          // Wait for the queued data to be written to the disk.
+          setReadCheckSocket(diskWriteQueue->getWakeupSocket());
+        }
+        else
+#endif // ENABLE_ASYNC_DISK_WRITE
+        {
+          setReadCheckSocket(getSocket());
+        }
       }
 
       done = true;
@@ -51,6 +51,10 @@ PeerSessionResource::PeerSessionResource(int32_t pieceLength,
       lastDownloadUpdate_(Timer::zero()),
       lastAmUnchoking_(Timer::zero()),
       dispatcher_(nullptr),
+      maxOutstandingRequest_(DEFAULT_MAX_OUTSTANDING_REQUEST),
+      blockRtt_(0),
+      minBlockRtt_(0),
+      minBlockRttTimer_(Timer::zero()),
       amChoking_(true),
       amInterested_(false),
       peerChoking_(true),
@@ -227,6 +231,25 @@ void PeerSessionResource::setBtMessageDispatcher(BtMessageDispatcher* dpt)
   dispatcher_ = dpt;
 }
 
+void PeerSessionResource::updateBlockRtt(std::chrono::milliseconds rtt)
+{
+  // 0 means no sample.
+  rtt = std::max(rtt, std::chrono::milliseconds(1));
+  if (blockRtt_.count() == 0) {
+    blockRtt_ = rtt;
+  }
+  else {
+    blockRtt_ = (blockRtt_ * 7 + rtt) / 8;
+  }
+  // The minimum excludes the time the requests wait in the queue of
+  // the peer.  It expires so that a route change is picked up.
+  if (minBlockRtt_.count() == 0 || rtt <= minBlockRtt_ ||
+      minBlockRttTimer_.difference(global::wallclock()) >= 10_s) {
+    minBlockRtt_ = rtt;
+    minBlockRttTimer_ = global::wallclock();
+  }
+}
+
 size_t PeerSessionResource::countOutstandingUpload() const
 {
   assert(dispatcher_);
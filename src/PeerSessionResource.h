@@ -67,6 +67,16 @@ private:
 
   BtMessageDispatcher* dispatcher_;
 
+  // The number of block requests we may have outstanding to this peer
+  size_t maxOutstandingRequest_;
+
+  // Smoothed round-trip time of block requests and the minimum one
+  // observed in the current window.  Both are 0 until the first
+  // requested block arrives.
+  std::chrono::milliseconds blockRtt_;
+  std::chrono::milliseconds minBlockRtt_;
+  Timer minBlockRttTimer_;
+
   // localhost is choking this peer
   bool amChoking_;
   // localhost is interested in this peer
@@ -199,6 +209,18 @@ public:
   void setBtMessageDispatcher(BtMessageDispatcher* dpt);
 
   size_t countOutstandingUpload() const;
+
+  size_t getMaxOutstandingRequest() const { return maxOutstandingRequest_; }
+
+  void setMaxOutstandingRequest(size_t n) { maxOutstandingRequest_ = n; }
+
+  // Adds the round-trip time of a block request, measured from the
+  // request being queued to the arrival of the piece message.
+  void updateBlockRtt(std::chrono::milliseconds rtt);
+
+  std::chrono::milliseconds getBlockRtt() const { return blockRtt_; }
+
+  std::chrono::milliseconds getMinBlockRtt() const { return minBlockRtt_; }
 };
 
 } // namespace aria2
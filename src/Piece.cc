@@ -48,6 +48,7 @@
 #include "fmt.h"
 #include "DiskAdaptor.h"
 #include "MessageDigest.h"
+#include "Tracer.h"
 
 namespace aria2 {
 
@@ -199,6 +200,7 @@ bool Piece::updateHash(int64_t begin, const unsigned char* data,
   }
   if (begin == nextBegin_ &&
       nextBegin_ + static_cast<int64_t>(dataLength) <= length_) {
+    TraceSpan span("hash", "Piece::updateHash");
     if (!mdctx_) {
       mdctx_ = MessageDigest::create(hashType_);
     }
@@ -254,6 +256,7 @@ std::string
 Piece::getDigestWithWrCache(size_t pieceLength,
                             const std::shared_ptr<DiskAdaptor>& adaptor)
 {
+  TraceSpan span("hash", "Piece::getDigestWithWrCache");
   auto mdctx = MessageDigest::create(hashType_);
   int64_t start = static_cast<int64_t>(index_) * pieceLength;
   int64_t goff = start;
@@ -315,9 +318,7 @@ void Piece::flushWrCache(WrDiskCache* diskCache)
     return;
   }
   assert(wrCache_);
-  ssize_t size = static_cast<ssize_t>(wrCache_->getSize());
-  diskCache->update(wrCache_.get(), -size);
-  wrCache_->writeToDisk();
+  diskCache->flush(wrCache_.get());
 }
 
 void Piece::clearWrCache(WrDiskCache* diskCache)
@@ -363,7 +364,7 @@ size_t Piece::appendWrCache(WrDiskCache* diskCache, int64_t goff,
   size_t delta = wrCache_->append(goff, data, len);
   bool rv;
   if (delta > 0) {
-    rv = diskCache->update(wrCache_.get(), delta);
+    rv = diskCache->merge(wrCache_.get(), delta);
     assert(rv);
   }
   return delta;
@@ -0,0 +1,151 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "PieceHashQueue.h"
+
+#include <algorithm>
+#include <system_error>
+
+#include "MessageDigest.h"
+#include "LogFactory.h"
+#include "Logger.h"
+#include "fmt.h"
+
+namespace aria2 {
+
+const size_t PieceHashQueue::MAX_BATCH;
+
+PieceHashQueue::PieceHashQueue(size_t numThreads) : shutdown_(false)
+{
+  try {
+    for (size_t i = 0; i < numThreads; ++i) {
+      workers_.emplace_back(&PieceHashQueue::run, this);
+    }
+  }
+  catch (std::system_error& e) {
+    A2_LOG_ERROR(fmt("Starting piece hash thread failed: %s", e.what()));
+  }
+  A2_LOG_DEBUG(fmt("Started %lu piece hash threads",
+                   static_cast<unsigned long>(workers_.size())));
+}
+
+PieceHashQueue::~PieceHashQueue()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+    jobs_.clear();
+  }
+  jobCond_.notify_all();
+  for (auto& th : workers_) {
+    th.join();
+  }
+}
+
+void PieceHashQueue::push(const std::shared_ptr<PieceHashJob>& job)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.push_back(job);
+  }
+  jobCond_.notify_one();
+}
+
+bool PieceHashQueue::done(const std::shared_ptr<PieceHashJob>& job)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return job->done;
+}
+
+void PieceHashQueue::wait(const std::shared_ptr<PieceHashJob>& job)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  doneCond_.wait(lock, [&job] { return job->done; });
+}
+
+void PieceHashQueue::cancel(const std::shared_ptr<PieceHashJob>& job)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto i = std::find(std::begin(jobs_), std::end(jobs_), job);
+  if (i != std::end(jobs_)) {
+    jobs_.erase(i);
+  }
+}
+
+void PieceHashQueue::run()
+{
+  std::vector<std::shared_ptr<PieceHashJob>> batch;
+  std::vector<const unsigned char*> data;
+  std::vector<size_t> lengths;
+  for (;;) {
+    batch.clear();
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      jobCond_.wait(lock, [this] { return shutdown_ || !jobs_.empty(); });
+      if (shutdown_) {
+        return;
+      }
+      // Take a fair share of the queued jobs of the same hash type,
+      // so that MessageDigest::digestMany() can hash them at once.
+      size_t n = std::min(
+          MAX_BATCH, std::max(static_cast<size_t>(1),
+                              jobs_.size() / workers_.size()));
+      do {
+        batch.push_back(std::move(jobs_.front()));
+        jobs_.pop_front();
+      } while (batch.size() < n && !jobs_.empty() &&
+               jobs_.front()->hashType == batch.front()->hashType);
+    }
+    // Only the worker which took the jobs touches their data until
+    // done is set.
+    data.clear();
+    lengths.clear();
+    for (auto& job : batch) {
+      data.push_back(job->data.get());
+      lengths.push_back(job->length);
+    }
+    auto digests = MessageDigest::digestMany(
+        batch.front()->hashType, data.data(), lengths.data(), batch.size());
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (size_t i = 0; i < batch.size(); ++i) {
+        batch[i]->digest = std::move(digests[i]);
+        batch[i]->done = true;
+      }
+    }
+    doneCond_.notify_all();
+  }
+}
+
+} // namespace aria2
@@ -0,0 +1,117 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_PIECE_HASH_QUEUE_H
+#define D_PIECE_HASH_QUEUE_H
+
+#include "common.h"
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace aria2 {
+
+// A piece whose hash is computed by one of the workers of
+// PieceHashQueue.  hashType must be supported by MessageDigest.
+// digest and done are guarded by the mutex of PieceHashQueue.
+struct PieceHashJob {
+  std::string hashType;
+  std::unique_ptr<unsigned char[]> data;
+  size_t length;
+  std::string digest;
+  bool done;
+
+  PieceHashJob(std::string hashType, std::unique_ptr<unsigned char[]> data,
+               size_t length)
+      : hashType(std::move(hashType)),
+        data(std::move(data)),
+        length(length),
+        done(false)
+  {
+  }
+};
+
+// Computes the hash of pieces in a pool of worker threads.  The
+// thread which runs DownloadEngine reads the data of pieces and
+// pushes them, so that hashing a piece overlaps with reading the
+// next one.  When jobs pile up, a worker takes up to MAX_BATCH of
+// them and hashes them with MessageDigest::digestMany().  Except for
+// the worker threads themselves, all functions must be called from
+// the thread which runs DownloadEngine.
+class PieceHashQueue {
+public:
+  explicit PieceHashQueue(size_t numThreads);
+
+  // Discards the queued jobs and joins the workers.
+  ~PieceHashQueue();
+
+  bool good() const { return !workers_.empty(); }
+
+  size_t getNumThreads() const { return workers_.size(); }
+
+  // The maximum number of jobs a worker hashes in one go.
+  static const size_t MAX_BATCH = 8;
+
+  void push(const std::shared_ptr<PieceHashJob>& job);
+
+  // Returns true if the digest of |job| has been computed.
+  bool done(const std::shared_ptr<PieceHashJob>& job);
+
+  // Blocks until the digest of |job| is computed.
+  void wait(const std::shared_ptr<PieceHashJob>& job);
+
+  // Removes |job| from the queue if no worker has started it.
+  void cancel(const std::shared_ptr<PieceHashJob>& job);
+
+private:
+  void run();
+
+  std::vector<std::thread> workers_;
+  std::deque<std::shared_ptr<PieceHashJob>> jobs_;
+  std::mutex mutex_;
+  // Signaled when a job is pushed or the queue is shutting down.
+  std::condition_variable jobCond_;
+  // Signaled when a job completes.
+  std::condition_variable doneCond_;
+  bool shutdown_;
+};
+
+} // namespace aria2
+
+#endif // D_PIECE_HASH_QUEUE_H
@@ -38,49 +38,89 @@
 #include <algorithm>
 
 #include "SimpleRandomizer.h"
-#include "bitfield.h"
 
 namespace aria2 {
 
 PieceStatMan::PieceStatMan(size_t pieceNum, bool randomShuffle)
-    : order_(pieceNum), counts_(pieceNum)
+    : order_(pieceNum),
+      counts_(pieceNum),
+      pos_(pieceNum),
+      bucketStart_{0, pieceNum},
+      randomShuffle_(randomShuffle)
 {
   for (size_t i = 0; i < pieceNum; ++i) {
     order_[i] = i;
   }
   // we need some randomness in ordering.
-  if (randomShuffle) {
+  if (randomShuffle_) {
     std::shuffle(order_.begin(), order_.end(),
                  *SimpleRandomizer::getInstance());
   }
+  for (size_t i = 0; i < pieceNum; ++i) {
+    pos_[order_[i]] = i;
+  }
 }
 
 PieceStatMan::~PieceStatMan() = default;
 
-namespace {
-void inc(int& x)
+void PieceStatMan::swapPieces(size_t pos1, size_t pos2)
 {
-  if (x < std::numeric_limits<int>::max()) {
-    ++x;
+  std::swap(order_[pos1], order_[pos2]);
+  pos_[order_[pos1]] = pos1;
+  pos_[order_[pos2]] = pos2;
+}
+
+void PieceStatMan::shuffleInBucket(size_t pos, size_t first, size_t last)
+{
+  // Keeps the bucket in random order, which breaks ties between pieces
+  // of the same rarity.
+  if (randomShuffle_ && last - first > 1) {
+    swapPieces(pos, first + SimpleRandomizer::getInstance()->getRandomNumber(
+                                last - first));
   }
 }
-} // namespace
 
-namespace {
-void sub(int& x)
+void PieceStatMan::inc(size_t index)
 {
-  if (x > 0) {
-    --x;
+  auto c = static_cast<size_t>(counts_[index]);
+  if (counts_[index] == std::numeric_limits<int>::max()) {
+    return;
+  }
+  if (bucketStart_.size() < c + 3) {
+    bucketStart_.resize(c + 3, order_.size());
   }
+  // Move the piece to the last position of its bucket, which becomes
+  // the first position of the next bucket.
+  auto pos = --bucketStart_[c + 1];
+  swapPieces(pos_[index], pos);
+  ++counts_[index];
+  shuffleInBucket(pos, bucketStart_[c + 1], bucketStart_[c + 2]);
+}
+
+void PieceStatMan::dec(size_t index)
+{
+  auto c = static_cast<size_t>(counts_[index]);
+  if (c == 0) {
+    return;
+  }
+  // Move the piece to the first position of its bucket, which becomes
+  // the last position of the previous bucket.
+  auto pos = bucketStart_[c]++;
+  swapPieces(pos_[index], pos);
+  --counts_[index];
+  shuffleInBucket(pos, bucketStart_[c - 1], bucketStart_[c]);
 }
-} // namespace
 
 void PieceStatMan::addPieceStats(const unsigned char* bitfield,
                                  size_t bitfieldLength)
 {
-  for (size_t i = 0, nbits = counts_.size(); i < nbits; ++i) {
-    if (bitfield::test(bitfield, nbits, i)) {
-      inc(counts_[i]);
+  size_t nbits = std::min(counts_.size(), bitfieldLength * 8);
+  for (size_t i = 0; i < nbits; i += 8) {
+    unsigned char b = bitfield[i / 8];
+    for (size_t j = i; b; ++j, b <<= 1) {
+      if ((b & 0x80u) && j < nbits) {
+        inc(j);
+      }
     }
   }
 }
@@ -88,9 +128,13 @@ void PieceStatMan::addPieceStats(const unsigned char* bitfield,
 void PieceStatMan::subtractPieceStats(const unsigned char* bitfield,
                                       size_t bitfieldLength)
 {
-  for (size_t i = 0, nbits = counts_.size(); i < nbits; ++i) {
-    if (bitfield::test(bitfield, nbits, i)) {
-      sub(counts_[i]);
+  size_t nbits = std::min(counts_.size(), bitfieldLength * 8);
+  for (size_t i = 0; i < nbits; i += 8) {
+    unsigned char b = bitfield[i / 8];
+    for (size_t j = i; b; ++j, b <<= 1) {
+      if ((b & 0x80u) && j < nbits) {
+        dec(j);
+      }
     }
   }
 }
@@ -99,20 +143,23 @@ void PieceStatMan::updatePieceStats(const unsigned char* newBitfield,
                                     size_t newBitfieldLength,
                                     const unsigned char* oldBitfield)
 {
-  for (size_t i = 0, nbits = counts_.size(); i < nbits; ++i) {
-    bool inNew = bitfield::test(newBitfield, nbits, i);
-    bool inOld = bitfield::test(oldBitfield, nbits, i);
-    if (inNew) {
-      if (!inOld) {
-        inc(counts_[i]);
+  size_t nbits = std::min(counts_.size(), newBitfieldLength * 8);
+  for (size_t i = 0; i < nbits; i += 8) {
+    unsigned char nb = newBitfield[i / 8];
+    unsigned char diff = nb ^ oldBitfield[i / 8];
+    for (size_t j = i; diff; ++j, diff <<= 1, nb <<= 1) {
+      if ((diff & 0x80u) && j < nbits) {
+        if (nb & 0x80u) {
+          inc(j);
+        }
+        else {
+          dec(j);
+        }
       }
     }
-    else if (inOld) {
-      sub(counts_[i]);
-    }
   }
 }
 
-void PieceStatMan::addPieceStats(size_t index) { inc(counts_[index]); }
+void PieceStatMan::addPieceStats(size_t index) { inc(index); }
 
 } // namespace aria2
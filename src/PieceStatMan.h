@@ -41,10 +41,33 @@
 
 namespace aria2 {
 
+// Keeps the number of peers which have each piece.  Piece indexes
+// are kept sorted by the count, so that the rarest pieces come first.
+// The pieces with the same count form a bucket, which is a contiguous
+// range in order_.  Changing the count of a piece moves it to the
+// neighbor bucket by one swap, so each update is O(1).
 class PieceStatMan {
 private:
+  // Piece indexes sorted by counts_.  If randomShuffle is true, the
+  // order of pieces in the same bucket is random.
   std::vector<size_t> order_;
   std::vector<int> counts_;
+  // pos_[i] is the position of piece i in order_.
+  std::vector<size_t> pos_;
+  // bucketStart_[c] is the position of the first piece whose count
+  // is c or more.  The trailing elements are order_.size().
+  std::vector<size_t> bucketStart_;
+  bool randomShuffle_;
+
+  void swapPieces(size_t pos1, size_t pos2);
+
+  // Moves the piece at |pos| to a random position in
+  // [first, last).
+  void shuffleInBucket(size_t pos, size_t first, size_t last);
+
+  void inc(size_t index);
+
+  void dec(size_t index);
 
 public:
   PieceStatMan(size_t pieceNum, bool randomShuffle);
@@ -61,9 +84,13 @@ public:
                         size_t newBitfieldLength,
                         const unsigned char* oldBitfield);
 
+  // Returns piece indexes sorted by count in ascending order.
   const std::vector<size_t>& getOrder() const { return order_; }
 
   const std::vector<int>& getCounts() const { return counts_; }
+
+  // Returns the position of each piece in getOrder().
+  const std::vector<size_t>& getPositions() const { return pos_; }
 };
 
 } // namespace aria2
@@ -52,6 +52,7 @@ class Peer;
 #endif // ENABLE_BITTORRENT
 class DiskAdaptor;
 class WrDiskCache;
+class RdDiskCache;
 
 class PieceStorage {
 public:
@@ -226,6 +227,9 @@ public:
 
   virtual WrDiskCache* getWrDiskCache() = 0;
 
+  // Returns nullptr if the read cache is disabled.
+  virtual RdDiskCache* getRdDiskCache() = 0;
+
   // Flushes write disk cache for in-flight piece and evicts them.
   virtual void flushWrDiskCacheEntry() = 0;
 
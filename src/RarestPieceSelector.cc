@@ -34,7 +34,7 @@
 /* copyright --> */
 #include "RarestPieceSelector.h"
 
-#include <limits>
+#include <cstring>
 #include <algorithm>
 
 #include "PieceStatMan.h"
@@ -51,24 +51,50 @@ RarestPieceSelector::RarestPieceSelector(
 bool RarestPieceSelector::select(size_t& index, const unsigned char* bitfield,
                                  size_t nbits) const
 {
-  const std::vector<size_t>& order = pieceStatMan_->getOrder();
-  const std::vector<int>& counts = pieceStatMan_->getCounts();
-  int min = std::numeric_limits<int>::max();
-  size_t bestIdx = nbits;
-  for (size_t i = 0; i < nbits; ++i) {
-    size_t idx = order[i];
-    if (bitfield::test(bitfield, nbits, idx) && counts[idx] < min) {
-      min = counts[idx];
-      bestIdx = idx;
+  const auto& order = pieceStatMan_->getOrder();
+  // The order is sorted by rarity, so the first piece in bitfield is
+  // the rarest one.  If there are many candidates, one of them is
+  // found near the front of the order.  Each probe is a random access
+  // to bitfield, so only a few are tried before the scan below.
+  size_t probe = std::min(order.size(), std::max(nbits / 4096, (size_t)64));
+  for (size_t i = 0; i < probe; ++i) {
+    if (bitfield::test(bitfield, nbits, order[i])) {
+      index = order[i];
+      return true;
     }
   }
-  if (bestIdx == nbits) {
-    return false;
+  // Otherwise, visit the set bits of bitfield, skipping 64 pieces
+  // without any at a time, and take the one which comes first in the
+  // order.  This costs O(nbits / 64 + candidates) instead of a random
+  // access to bitfield per piece in the order.
+  const auto& pos = pieceStatMan_->getPositions();
+  nbits = std::min(nbits, pos.size());
+  size_t len = (nbits + 7) / 8;
+  size_t best = pos.size();
+  auto visit = [&](size_t first, size_t last) {
+    for (size_t j = first; j < last; ++j) {
+      unsigned char b = bitfield[j];
+      for (size_t k = j * 8; b; ++k, b <<= 1) {
+        if ((b & 0x80u) && k < nbits && pos[k] < best) {
+          best = pos[k];
+        }
+      }
+    }
+  };
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, bitfield + i, sizeof(word));
+    if (word) {
+      visit(i, i + sizeof(word));
+    }
   }
-  else {
-    index = bestIdx;
-    return true;
+  visit(i, len);
+  if (best == pos.size()) {
+    return false;
   }
+  index = order[best];
+  return true;
 }
 
 } // namespace aria2
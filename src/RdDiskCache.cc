@@ -0,0 +1,122 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "RdDiskCache.h"
+
+#include <cstring>
+
+#include "DiskAdaptor.h"
+#include "LogFactory.h"
+#include "fmt.h"
+
+namespace aria2 {
+
+RdDiskCache::RdDiskCache(size_t limit) : limit_(limit), total_(0), stat_() {}
+
+RdDiskCache::~RdDiskCache()
+{
+  A2_LOG_INFO(fmt("Read disk cache stat: hits=%" PRIu64 ", misses=%" PRIu64
+                  ", readaheads=%" PRIu64 ", evictions=%" PRIu64
+                  ", bytes=%" PRIu64,
+                  stat_.hits, stat_.misses, stat_.readaheads,
+                  stat_.evictions, stat_.bytesServed));
+}
+
+bool RdDiskCache::readData(unsigned char* data, size_t len,
+                           const std::shared_ptr<DiskAdaptor>& diskAdaptor,
+                           size_t index, int32_t begin, int64_t pieceOffset,
+                           int32_t pieceLength)
+{
+  auto key = Key(diskAdaptor.get(), index);
+  auto i = index_.find(key);
+  if (i == std::end(index_)) {
+    ++stat_.misses;
+    if (begin != 0 || static_cast<size_t>(pieceLength) > limit_) {
+      return false;
+    }
+    // The peer starts downloading the piece.  It will most likely
+    // request the rest of the piece, and so will the other peers.
+    std::vector<unsigned char> buf(pieceLength);
+    if (diskAdaptor->readData(buf.data(), pieceLength, pieceOffset) !=
+        pieceLength) {
+      return false;
+    }
+    A2_LOG_DEBUG(fmt("Read cache piece index=%lu, length=%d",
+                     static_cast<unsigned long>(index), pieceLength));
+    ++stat_.readaheads;
+    total_ += pieceLength;
+    lru_.push_front(Entry{key, std::move(buf)});
+    i = index_.insert(std::make_pair(key, std::begin(lru_))).first;
+    ensureLimit();
+  }
+  else {
+    ++stat_.hits;
+    lru_.splice(std::begin(lru_), lru_, (*i).second);
+  }
+  auto& buf = (*i).second->data;
+  if (begin < 0 || begin + len > buf.size()) {
+    return false;
+  }
+  memcpy(data, buf.data() + begin, len);
+  stat_.bytesServed += len;
+  return true;
+}
+
+void RdDiskCache::remove(const DiskAdaptor* diskAdaptor)
+{
+  auto first = index_.lower_bound(Key(diskAdaptor, 0));
+  auto i = first;
+  for (; i != std::end(index_) && (*i).first.first == diskAdaptor; ++i) {
+    total_ -= (*i).second->data.size();
+    lru_.erase((*i).second);
+  }
+  index_.erase(first, i);
+}
+
+void RdDiskCache::ensureLimit()
+{
+  // The entry just added is at the front, and it is not evicted
+  // because its length does not exceed the limit.
+  while (total_ > limit_) {
+    auto& ent = lru_.back();
+    A2_LOG_DEBUG(fmt("Evict read cache piece index=%lu",
+                     static_cast<unsigned long>(ent.key.second)));
+    total_ -= ent.data.size();
+    index_.erase(ent.key);
+    lru_.pop_back();
+    ++stat_.evictions;
+  }
+}
+
+} // namespace aria2
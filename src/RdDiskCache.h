@@ -0,0 +1,113 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_RD_DISK_CACHE_H
+#define D_RD_DISK_CACHE_H
+
+#include "common.h"
+
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace aria2 {
+
+class DiskAdaptor;
+
+// Memory limited LRU cache of whole pieces read from the disk.  It is
+// used to serve the same pieces to many peers without reading them
+// from the disk each time.  The cache storage is shared by all
+// downloads.
+class RdDiskCache {
+public:
+  struct Stat {
+    // The number of reads served from the cache.
+    uint64_t hits;
+    // The number of reads of the pieces not in the cache.
+    uint64_t misses;
+    // The number of pieces read from the disk into the cache.
+    uint64_t readaheads;
+    // The number of pieces evicted to keep the cache under the limit.
+    uint64_t evictions;
+    // The number of bytes served from the cache.
+    uint64_t bytesServed;
+  };
+
+  RdDiskCache(size_t limit);
+  ~RdDiskCache();
+
+  // Copies |len| bytes at |begin| in the piece |index| to |data|.  If
+  // the piece is not cached and |begin| is 0, the whole piece of
+  // |pieceLength| bytes at |pieceOffset| is read from |diskAdaptor|
+  // and cached first.  Returns false if the data is not in the cache,
+  // and the caller must read it from the disk.
+  bool readData(unsigned char* data, size_t len,
+                const std::shared_ptr<DiskAdaptor>& diskAdaptor, size_t index,
+                int32_t begin, int64_t pieceOffset, int32_t pieceLength);
+
+  // Removes the cached pieces of |diskAdaptor|.
+  void remove(const DiskAdaptor* diskAdaptor);
+
+  size_t getSize() const { return total_; }
+
+  size_t countPiece() const { return index_.size(); }
+
+  const Stat& getStat() const { return stat_; }
+
+private:
+  typedef std::pair<const DiskAdaptor*, size_t> Key;
+
+  struct Entry {
+    Key key;
+    std::vector<unsigned char> data;
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  void ensureLimit();
+
+  // Maximum number of bytes the storage can cache.
+  size_t limit_;
+  // Current number of bytes cached.
+  size_t total_;
+  // The most recently used entry comes first.
+  EntryList lru_;
+  std::map<Key, EntryList::iterator> index_;
+  Stat stat_;
+};
+
+} // namespace aria2
+
+#endif // D_RD_DISK_CACHE_H
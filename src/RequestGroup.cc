@@ -596,6 +596,7 @@ void RequestGroup::initPieceStorage()
 #endif // !ENABLE_BITTORRENT
     if (requestGroupMan_) {
       ps->setWrDiskCache(requestGroupMan_->getWrDiskCache());
+      ps->setRdDiskCache(requestGroupMan_->getRdDiskCache());
     }
     if (diskWriterFactory_) {
       ps->setDiskWriterFactory(diskWriterFactory_);
@@ -1002,6 +1003,9 @@ void RequestGroup::setHaltRequested(bool f, HaltReason haltReason)
   if (haltRequested_) {
     pauseRequested_ = false;
     haltReason_ = haltReason;
+    if (requestGroupMan_) {
+      requestGroupMan_->requestWakeUp();
+    }
   }
 #ifdef ENABLE_BITTORRENT
   if (btRuntime_) {
@@ -1016,7 +1020,13 @@ void RequestGroup::setForceHaltRequested(bool f, HaltReason haltReason)
   forceHaltRequested_ = f;
 }
 
-void RequestGroup::setPauseRequested(bool f) { pauseRequested_ = f; }
+void RequestGroup::setPauseRequested(bool f)
+{
+  pauseRequested_ = f;
+  if (pauseRequested_ && requestGroupMan_) {
+    requestGroupMan_->requestWakeUp();
+  }
+}
 
 void RequestGroup::setRestartRequested(bool f) { restartRequested_ = f; }
 
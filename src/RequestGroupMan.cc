@@ -78,11 +78,16 @@
 #include "Notifier.h"
 #include "PeerStat.h"
 #include "WrDiskCache.h"
+#include "RdDiskCache.h"
 #include "PieceStorage.h"
 #include "DiskAdaptor.h"
 #include "SimpleRandomizer.h"
 #include "array_fun.h"
 #include "OpenedFileCounter.h"
+#include "LazyRequestGroup.h"
+#ifdef ENABLE_ASYNC_DISK_WRITE
+#  include "DiskWriteQueue.h"
+#endif // ENABLE_ASYNC_DISK_WRITE
 #include "wallclock.h"
 #include "RpcMethodImpl.h"
 #ifdef ENABLE_BITTORRENT
@@ -119,6 +124,7 @@ RequestGroupMan::RequestGroupMan(
           option->getAsInt(PREF_MAX_OVERALL_UPLOAD_LIMIT)),
       keepRunning_(option->getAsBool(PREF_ENABLE_RPC)),
       queueCheck_(true),
+      wakeUp_(false),
       removedErrorResult_(0),
       removedLastErrorResult_(error_code::FINISHED),
       maxDownloadResult_(option->getAsInt(PREF_MAX_DOWNLOAD_RESULT)),
@@ -205,6 +211,26 @@ void RequestGroupMan::insertReservedGroup(
   reservedGroups_.insert(pos, group->getGID(), group);
 }
 
+void RequestGroupMan::addReservedGroup(std::unique_ptr<LazyRequestGroup> group)
+{
+  requestQueueCheck();
+  auto gid = group->getGID();
+  if (reservedGroups_.push_back(gid, nullptr)) {
+    lazyGroups_.emplace(gid, std::move(group));
+  }
+}
+
+void RequestGroupMan::insertReservedGroup(
+    size_t pos, std::unique_ptr<LazyRequestGroup> group)
+{
+  requestQueueCheck();
+  pos = std::min(reservedGroups_.size(), pos);
+  auto gid = group->getGID();
+  if (reservedGroups_.insert(pos, gid, nullptr) != reservedGroups_.end()) {
+    lazyGroups_.emplace(gid, std::move(group));
+  }
+}
+
 size_t RequestGroupMan::countRequestGroup() const
 {
   return requestGroups_.size();
@@ -219,6 +245,58 @@ std::shared_ptr<RequestGroup> RequestGroupMan::findGroup(a2_gid_t gid) const
   return rg;
 }
 
+std::shared_ptr<RequestGroup> RequestGroupMan::materializeGroup(a2_gid_t gid)
+{
+  auto rg = findGroup(gid);
+  if (!rg && lazyGroups_.count(gid)) {
+    auto pos = reservedGroups_.indexOf(gid);
+    materializeReservedGroups(pos, pos + 1);
+    rg = reservedGroups_[pos];
+  }
+  return rg;
+}
+
+const LazyRequestGroup* RequestGroupMan::findLazyGroup(a2_gid_t gid) const
+{
+  auto i = lazyGroups_.find(gid);
+  if (i == std::end(lazyGroups_)) {
+    return nullptr;
+  }
+  return (*i).second.get();
+}
+
+LazyRequestGroup* RequestGroupMan::findLazyGroup(a2_gid_t gid)
+{
+  auto i = lazyGroups_.find(gid);
+  if (i == std::end(lazyGroups_)) {
+    return nullptr;
+  }
+  return (*i).second.get();
+}
+
+void RequestGroupMan::materializeReservedGroups(size_t first, size_t last)
+{
+  if (lazyGroups_.empty()) {
+    return;
+  }
+  last = std::min(last, reservedGroups_.size());
+  for (; first < last; ++first) {
+    if (reservedGroups_[first]) {
+      continue;
+    }
+    auto i = lazyGroups_.find(reservedGroups_.getKey(first));
+    reservedGroups_.replace(first, materializeRequestGroup(*(*i).second));
+    lazyGroups_.erase(i);
+  }
+}
+
+void RequestGroupMan::setLazyGroupsPauseRequested(bool f)
+{
+  for (auto& elem : lazyGroups_) {
+    elem.second->setPauseRequested(f);
+  }
+}
+
 size_t RequestGroupMan::changeReservedGroupPosition(a2_gid_t gid, int pos,
                                                     OffsetMode how)
 {
@@ -234,6 +312,7 @@ size_t RequestGroupMan::changeReservedGroupPosition(a2_gid_t gid, int pos,
 
 bool RequestGroupMan::removeReservedGroup(a2_gid_t gid)
 {
+  lazyGroups_.erase(gid);
   return reservedGroups_.remove(gid);
 }
 
@@ -525,10 +604,12 @@ void RequestGroupMan::fillRequestGroupFromReserver(DownloadEngine* e)
   }
   int count = 0;
   int num = maxConcurrentDownloads - numActive_;
-  std::vector<std::shared_ptr<RequestGroup>> pending;
+  // The position of the first download in reservedGroups_ which is
+  // not skipped because it is paused or waiting for dependency.
+  size_t pos = 0;
 
-  while (count < num && (uriListParser_ || !reservedGroups_.empty())) {
-    if (uriListParser_ && reservedGroups_.empty()) {
+  while (count < num && (uriListParser_ || pos < reservedGroups_.size())) {
+    if (uriListParser_ && pos == reservedGroups_.size()) {
       std::vector<std::shared_ptr<RequestGroup>> groups;
       // May throw exception
       bool ok = createRequestGroupFromUriListParser(groups, option_,
@@ -538,18 +619,27 @@ void RequestGroupMan::fillRequestGroupFromReserver(DownloadEngine* e)
       }
       else {
         uriListParser_.reset();
-        if (reservedGroups_.empty()) {
+        if (pos == reservedGroups_.size()) {
           break;
         }
       }
     }
-    std::shared_ptr<RequestGroup> groupToAdd = *reservedGroups_.begin();
-    reservedGroups_.pop_front();
-    if ((keepRunning_ && groupToAdd->isPauseRequested()) ||
-        !groupToAdd->isDependencyResolved()) {
-      pending.push_back(groupToAdd);
+    std::shared_ptr<RequestGroup> groupToAdd = reservedGroups_[pos];
+    if (!groupToAdd) {
+      auto i = lazyGroups_.find(reservedGroups_.getKey(pos));
+      if (keepRunning_ && (*i).second->isPauseRequested()) {
+        ++pos;
+        continue;
+      }
+      groupToAdd = materializeRequestGroup(*(*i).second);
+      lazyGroups_.erase(i);
+    }
+    else if ((keepRunning_ && groupToAdd->isPauseRequested()) ||
+             !groupToAdd->isDependencyResolved()) {
+      ++pos;
       continue;
     }
+    reservedGroups_.erase(reservedGroups_.begin() + pos);
     // Drop pieceStorage here because paused download holds its
     // reference.
     groupToAdd->dropPieceStorage();
@@ -581,10 +671,6 @@ void RequestGroupMan::fillRequestGroupFromReserver(DownloadEngine* e)
                                PREF_ON_DOWNLOAD_START);
     notifyDownloadEvent(EVENT_ON_DOWNLOAD_START, groupToAdd);
   }
-  if (!pending.empty()) {
-    reservedGroups_.insert(reservedGroups_.begin(), RequestGroupKeyFunc(),
-                           pending.begin(), pending.end());
-  }
   if (count > 0) {
     e->setNoWait(true);
     e->setRefreshInterval(std::chrono::milliseconds(0));
@@ -1054,6 +1140,38 @@ void RequestGroupMan::initWrDiskCache()
   }
 }
 
+void RequestGroupMan::initRdDiskCache()
+{
+  assert(!rdDiskCache_);
+  size_t limit = option_->getAsInt(PREF_DISK_READ_CACHE);
+  if (limit > 0) {
+    rdDiskCache_ = make_unique<RdDiskCache>(limit);
+  }
+}
+
+void RequestGroupMan::initDiskWriteQueue()
+{
+  assert(!diskWriteQueue_);
+  size_t numThreads = option_->getAsInt(PREF_DISK_WRITE_THREADS);
+  if (numThreads == 0) {
+    return;
+  }
+#ifdef ENABLE_ASYNC_DISK_WRITE
+  auto queue = std::make_shared<DiskWriteQueue>(
+      numThreads, option_->getAsLLInt(PREF_DISK_WRITE_QUEUE_SIZE));
+  if (queue->good()) {
+    diskWriteQueue_ = std::move(queue);
+  }
+  else {
+    A2_LOG_WARN("Disk writes are done in the main thread because disk"
+                " writer threads could not be started.");
+  }
+#else  // !ENABLE_ASYNC_DISK_WRITE
+  A2_LOG_WARN(fmt("--%s is not supported in this build.",
+                  PREF_DISK_WRITE_THREADS->k));
+#endif // !ENABLE_ASYNC_DISK_WRITE
+}
+
 void RequestGroupMan::decreaseNumActive()
 {
   assert(numActive_ > 0);
@@ -41,6 +41,7 @@
 #include <deque>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <memory>
 
 #include "DownloadResult.h"
@@ -60,7 +61,10 @@ class Option;
 class OutputFile;
 class UriListParser;
 class WrDiskCache;
+class RdDiskCache;
 class OpenedFileCounter;
+class DiskWriteQueue;
+class LazyRequestGroup;
 
 typedef IndexedList<a2_gid_t, std::shared_ptr<RequestGroup>> RequestGroupList;
 typedef IndexedList<a2_gid_t, std::shared_ptr<DownloadResult>>
@@ -70,6 +74,10 @@ class RequestGroupMan {
 private:
   RequestGroupList requestGroups_;
   RequestGroupList reservedGroups_;
+  // Waiting downloads which have not been materialized yet.  Their
+  // entries in reservedGroups_ hold nullptr.
+  std::unordered_map<a2_gid_t, std::unique_ptr<LazyRequestGroup>>
+      lazyGroups_;
   DownloadResultList downloadResults_;
   // This includes download result which did not finish, and deleted
   // from downloadResults_.  This is used to save them in
@@ -107,6 +115,8 @@ private:
 
   bool queueCheck_;
 
+  bool wakeUp_;
+
   // The number of error DownloadResult removed because of upper limit
   // of the queue
   int removedErrorResult_;
@@ -121,8 +131,12 @@ private:
 
   std::unique_ptr<WrDiskCache> wrDiskCache_;
 
+  std::unique_ptr<RdDiskCache> rdDiskCache_;
+
   std::shared_ptr<OpenedFileCounter> openedFileCounter_;
 
+  std::shared_ptr<DiskWriteQueue> diskWriteQueue_;
+
   // The number of stopped downloads so far in total, including
   // evicted DownloadResults.
   size_t numStoppedTotal_;
@@ -184,16 +198,46 @@ public:
   void insertReservedGroup(size_t pos,
                            const std::shared_ptr<RequestGroup>& group);
 
+  void addReservedGroup(std::unique_ptr<LazyRequestGroup> group);
+
+  void insertReservedGroup(size_t pos, std::unique_ptr<LazyRequestGroup> group);
+
   size_t countRequestGroup() const;
 
   const RequestGroupList& getRequestGroups() const { return requestGroups_; }
 
+  const Option* getOption() const { return option_; }
+
+  // The entries of lazily represented downloads are nullptr.  Call
+  // materializeReservedGroups() or findLazyGroup() to get them.
   const RequestGroupList& getReservedGroups() const { return reservedGroups_; }
 
   // Returns RequestGroup object whose gid is gid. This method returns
-  // RequestGroup either in requestGroups_ or reservedGroups_.
+  // RequestGroup either in requestGroups_ or reservedGroups_.  The
+  // lazily represented download is not returned.  Use
+  // findLazyGroup() to inspect it, or materializeGroup() to modify
+  // it.
   std::shared_ptr<RequestGroup> findGroup(a2_gid_t gid) const;
 
+  // Same as findGroup(), but the lazily represented download is
+  // materialized in place and returned.
+  std::shared_ptr<RequestGroup> materializeGroup(a2_gid_t gid);
+
+  // Returns lazily represented waiting download whose gid is gid, or
+  // nullptr.
+  const LazyRequestGroup* findLazyGroup(a2_gid_t gid) const;
+
+  LazyRequestGroup* findLazyGroup(a2_gid_t gid);
+
+  // Materializes the lazily represented downloads in the positions
+  // [first, last) of reservedGroups_.
+  void materializeReservedGroups(size_t first, size_t last);
+
+  // Sets pause flag of all lazily represented downloads to f.
+  void setLazyGroupsPauseRequested(bool f);
+
+  size_t countLazyGroup() const { return lazyGroups_.size(); }
+
   // Changes the position of download denoted by gid.  If how is
   // POS_SET, it moves the download to a position relative to the
   // beginning of the queue.  If how is POS_CUR, it moves the download
@@ -327,6 +371,15 @@ public:
 
   bool queueCheckRequested() const { return queueCheck_; }
 
+  // Call this function when a download is told to halt or pause.
+  // DownloadEngine wakes up the sleeping Commands, so that they
+  // notice it without waiting for their timeout.
+  void requestWakeUp() { wakeUp_ = true; }
+
+  void clearWakeUp() { wakeUp_ = false; }
+
+  bool wakeUpRequested() const { return wakeUp_; }
+
   // Returns currently used hosts and its use count.
   void getUsedHosts(std::vector<std::pair<size_t, std::string>>& usedHosts);
 
@@ -347,6 +400,23 @@ public:
   // its value is 0, cache storage will not be initialized.
   void initWrDiskCache();
 
+  RdDiskCache* getRdDiskCache() const { return rdDiskCache_.get(); }
+
+  // Initializes RdDiskCache according to PREF_DISK_READ_CACHE option.
+  // If its value is 0, cache storage will not be initialized.
+  void initRdDiskCache();
+
+  // Returns nullptr if disk writes are done in the event loop.
+  const std::shared_ptr<DiskWriteQueue>& getDiskWriteQueue() const
+  {
+    return diskWriteQueue_;
+  }
+
+  // Initializes DiskWriteQueue according to PREF_DISK_WRITE_THREADS
+  // option.  If its value is 0, DiskWriteQueue will not be
+  // initialized.
+  void initDiskWriteQueue();
+
   void setKeepRunning(bool flag) { keepRunning_ = flag; }
 
   bool getKeepRunning() const { return keepRunning_; }
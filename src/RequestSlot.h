@@ -101,6 +101,8 @@ public:
 
   const std::shared_ptr<Piece>& getPiece() const { return piece_; }
 
+  const Timer& getDispatchedTime() const { return dispatchedTime_; }
+
   // For unit test
   void setDispatchedTime(Timer t) { dispatchedTime_ = std::move(t); }
 
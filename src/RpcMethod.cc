@@ -49,6 +49,8 @@
 #include "DlAbortEx.h"
 #include "a2functional.h"
 #include "util.h"
+#include "Tracer.h"
+#include "json.h"
 
 namespace aria2 {
 
@@ -88,12 +90,28 @@ void RpcMethod::authorize(RpcRequest& req, DownloadEngine* e)
   }
 }
 
+bool RpcMethod::writeJson(const RpcRequest& req, DownloadEngine* e,
+                          json::JsonWriter& w)
+{
+  return false;
+}
+
 RpcResponse RpcMethod::execute(RpcRequest req, DownloadEngine* e)
 {
+  TraceSpan span("rpc", "RpcMethod::execute", req.methodName);
   auto authorized = RpcResponse::NOTAUTHORIZED;
   try {
     authorize(req, e);
     authorized = RpcResponse::AUTHORIZED;
+    if (req.jsonRpc) {
+      std::string jsonParam;
+      json::JsonWriter w(jsonParam);
+      if (writeJson(req, e, w)) {
+        RpcResponse res(0, authorized, nullptr, std::move(req.id));
+        res.jsonParam = std::move(jsonParam);
+        return res;
+      }
+    }
     auto r = process(req, e);
     return RpcResponse(0, authorized, std::move(r), std::move(req.id));
   }
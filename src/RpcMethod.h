@@ -49,6 +49,10 @@ class OptionParser;
 class Option;
 class Exception;
 
+namespace json {
+class JsonWriter;
+} // namespace json
+
 namespace rpc {
 
 struct RpcRequest;
@@ -73,6 +77,14 @@ protected:
   virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
                                              DownloadEngine* e) = 0;
 
+  // Writes the result of JSON-RPC request req to w instead of
+  // returning it from process().  The methods which may return large
+  // results override this to skip building ValueBase.  Returns false
+  // if this method does not support it.  The default implementation
+  // returns false.
+  virtual bool writeJson(const RpcRequest& req, DownloadEngine* e,
+                         json::JsonWriter& w);
+
   void gatherRequestOption(Option* option, const Dict* optionsDict);
 
   void gatherChangeableOption(Option* option, Option* pendingOption,
@@ -87,6 +87,9 @@ std::vector<std::string> rpcMethodNames = {
     "aria2.shutdown",
     "aria2.forceShutdown",
     "aria2.getGlobalStat",
+    "aria2.getCommandProfile",
+    "aria2.subscribe",
+    "aria2.unsubscribe",
     "aria2.saveSession",
     "system.multicall",
     "system.listMethods",
@@ -104,6 +107,7 @@ std::vector<std::string> rpcNotificationsNames = {
 #ifdef ENABLE_BITTORRENT
     "aria2.onBtDownloadComplete",
 #endif // ENABLE_BITTORRENT
+    "aria2.onStatusChange",
 };
 } // namespace
 
@@ -247,6 +251,18 @@ std::unique_ptr<RpcMethod> createMethod(const std::string& methodName)
     return make_unique<GetGlobalStatRpcMethod>();
   }
 
+  if (methodName == GetCommandProfileRpcMethod::getMethodName()) {
+    return make_unique<GetCommandProfileRpcMethod>();
+  }
+
+  if (methodName == SubscribeRpcMethod::getMethodName()) {
+    return make_unique<SubscribeRpcMethod>();
+  }
+
+  if (methodName == UnsubscribeRpcMethod::getMethodName()) {
+    return make_unique<UnsubscribeRpcMethod>();
+  }
+
   if (methodName == SaveSessionRpcMethod::getMethodName()) {
     return make_unique<SaveSessionRpcMethod>();
   }
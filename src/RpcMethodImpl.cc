@@ -69,6 +69,13 @@
 #include "MessageDigest.h"
 #include "message_digest_helper.h"
 #include "OpenedFileCounter.h"
+#include "WrDiskCache.h"
+#include "RdDiskCache.h"
+#include "LazyRequestGroup.h"
+#include "CommandProfiler.h"
+#ifdef ENABLE_WEBSOCKET
+#  include "WebSocketSession.h"
+#endif // ENABLE_WEBSOCKET
 #ifdef ENABLE_BITTORRENT
 #  include "bittorrent_helper.h"
 #  include "BtRegistry.h"
@@ -119,6 +126,8 @@ const char KEY_PORT[] = "port";
 const char KEY_AM_CHOKING[] = "amChoking";
 const char KEY_PEER_CHOKING[] = "peerChoking";
 const char KEY_SEEDER[] = "seeder";
+const char KEY_MAX_OUTSTANDING_REQUEST[] = "maxOutstandingRequest";
+const char KEY_RTT[] = "rtt";
 const char KEY_INDEX[] = "index";
 const char KEY_PATH[] = "path";
 const char KEY_SELECTED[] = "selected";
@@ -147,6 +156,26 @@ const char KEY_NUM_ACTIVE[] = "numActive";
 const char KEY_NUM_STOPPED_TOTAL[] = "numStoppedTotal";
 const char KEY_VERIFIED_LENGTH[] = "verifiedLength";
 const char KEY_VERIFY_PENDING[] = "verifyIntegrityPending";
+const char KEY_DISK_CACHE[] = "diskCache";
+const char KEY_SIZE[] = "size";
+const char KEY_WRITES[] = "writes";
+const char KEY_HITS[] = "hits";
+const char KEY_FLUSHES[] = "flushes";
+const char KEY_EVICTIONS[] = "evictions";
+const char KEY_CELLS_FLUSHED[] = "cellsFlushed";
+const char KEY_WRITE_CALLS[] = "writeCalls";
+const char KEY_BYTES_FLUSHED[] = "bytesFlushed";
+const char KEY_READ_CACHE[] = "readCache";
+const char KEY_NUM_PIECE[] = "numPiece";
+const char KEY_MISSES[] = "misses";
+const char KEY_READAHEADS[] = "readaheads";
+const char KEY_BYTES_SERVED[] = "bytesServed";
+const char KEY_COUNT[] = "count";
+const char KEY_TOTAL_TIME[] = "totalTime";
+const char KEY_MAX_TIME[] = "maxTime";
+const char KEY_IDLE_COUNT[] = "idleCount";
+const char KEY_POLL[] = "poll";
+const char KEY_COMMANDS[] = "commands";
 } // namespace
 
 namespace {
@@ -175,6 +204,22 @@ addRequestGroup(const std::shared_ptr<RequestGroup>& group, DownloadEngine* e,
 }
 } // namespace
 
+namespace {
+std::unique_ptr<ValueBase>
+addRequestGroup(std::unique_ptr<LazyRequestGroup> group, DownloadEngine* e,
+                bool posGiven, int pos)
+{
+  auto gid = group->getGID();
+  if (posGiven) {
+    e->getRequestGroupMan()->insertReservedGroup(pos, std::move(group));
+  }
+  else {
+    e->getRequestGroupMan()->addReservedGroup(std::move(group));
+  }
+  return createGIDResponse(gid);
+}
+} // namespace
+
 namespace {
 bool checkPosParam(const Integer* posParam)
 {
@@ -238,14 +283,27 @@ std::unique_ptr<ValueBase> AddUriRpcMethod::process(const RpcRequest& req,
     throw DL_ABORT_EX("URI is not provided.");
   }
 
-  auto requestOption = std::make_shared<Option>(*e->getOption());
+  // Options given by the request are gathered on top of the snapshot
+  // of the global options, so that they stay apart from it.
+  auto globalOption = std::make_shared<Option>(*e->getOption());
+  auto requestOption = std::make_shared<Option>();
+  requestOption->setParent(globalOption);
   gatherRequestOption(requestOption.get(), optsParam);
 
   bool posGiven = checkPosParam(posParam);
   size_t pos = posGiven ? posParam->i() : 0;
 
+  // Plain HTTP(S)/FTP/SFTP downloads are kept in the compact form
+  // until they are activated.
+  auto lazy = createLazyRequestGroupForUri(globalOption, requestOption, uris);
+  if (lazy) {
+    return addRequestGroup(std::move(lazy), e, posGiven, pos);
+  }
+
+  auto option = std::make_shared<Option>(*globalOption);
+  option->merge(*requestOption);
   std::vector<std::shared_ptr<RequestGroup>> result;
-  createRequestGroupForUri(result, requestOption, uris,
+  createRequestGroupForUri(result, option, uris,
                            /* ignoreForceSeq = */ true,
                            /* ignoreLocalPath = */ true);
 
@@ -392,7 +450,8 @@ std::unique_ptr<ValueBase> removeDownload(const RpcRequest& req,
   const String* gidParam = checkRequiredParam<String>(req, 0);
 
   a2_gid_t gid = str2Gid(gidParam);
-  auto group = e->getRequestGroupMan()->findGroup(gid);
+  auto& rgman = e->getRequestGroupMan();
+  auto group = rgman->findGroup(gid);
   if (group) {
     if (group->getState() == RequestGroup::STATE_ACTIVE) {
       if (forceRemove) {
@@ -405,7 +464,7 @@ std::unique_ptr<ValueBase> removeDownload(const RpcRequest& req,
     }
     else {
       if (group->isDependencyResolved()) {
-        e->getRequestGroupMan()->removeReservedGroup(gid);
+        rgman->removeReservedGroup(gid);
       }
       else {
         throw DL_ABORT_EX(
@@ -413,6 +472,10 @@ std::unique_ptr<ValueBase> removeDownload(const RpcRequest& req,
       }
     }
   }
+  else if (rgman->findLazyGroup(gid)) {
+    // Lazily represented download is waiting and depends on nothing.
+    rgman->removeReservedGroup(gid);
+  }
   else {
     throw DL_ABORT_EX(fmt("Active Download not found for GID#%s",
                           GroupId::toHex(gid).c_str()));
@@ -448,6 +511,13 @@ std::unique_ptr<ValueBase> pauseDownload(const RpcRequest& req,
       return createGIDResponse(gid);
     }
   }
+  else {
+    auto lazy = e->getRequestGroupMan()->findLazyGroup(gid);
+    if (lazy && !lazy->isPauseRequested()) {
+      lazy->setPauseRequested(true);
+      return createGIDResponse(gid);
+    }
+  }
   throw DL_ABORT_EX(
       fmt("GID#%s cannot be paused now", GroupId::toHex(gid).c_str()));
 }
@@ -471,7 +541,10 @@ void pauseRequestGroups(InputIterator first, InputIterator last, bool reserved,
                         bool forcePause)
 {
   for (; first != last; ++first) {
-    pauseRequestGroup(*first, reserved, forcePause);
+    // Lazily represented downloads are nullptr.
+    if (*first) {
+      pauseRequestGroup(*first, reserved, forcePause);
+    }
   }
 }
 } // namespace
@@ -485,6 +558,8 @@ std::unique_ptr<ValueBase> pauseAllDownloads(const RpcRequest& req,
   auto& reservedGroups = e->getRequestGroupMan()->getReservedGroups();
   pauseRequestGroups(reservedGroups.begin(), reservedGroups.end(), true,
                      forcePause);
+  e->getRequestGroupMan()->setLazyGroupsPauseRequested(true);
+  e->setRefreshInterval(std::chrono::milliseconds(0));
   return createOKResponse();
 }
 } // namespace
@@ -507,15 +582,21 @@ std::unique_ptr<ValueBase> UnpauseRpcMethod::process(const RpcRequest& req,
   const String* gidParam = checkRequiredParam<String>(req, 0);
 
   a2_gid_t gid = str2Gid(gidParam);
-  auto group = e->getRequestGroupMan()->findGroup(gid);
-  if (!group || group->getState() != RequestGroup::STATE_WAITING ||
-      !group->isPauseRequested()) {
+  auto& rgman = e->getRequestGroupMan();
+  auto group = rgman->findGroup(gid);
+  auto lazy = rgman->findLazyGroup(gid);
+  if (lazy && lazy->isPauseRequested()) {
+    lazy->setPauseRequested(false);
+    rgman->requestQueueCheck();
+  }
+  else if (!group || group->getState() != RequestGroup::STATE_WAITING ||
+           !group->isPauseRequested()) {
     throw DL_ABORT_EX(
         fmt("GID#%s cannot be unpaused now", GroupId::toHex(gid).c_str()));
   }
   else {
     group->setPauseRequested(false);
-    e->getRequestGroupMan()->requestQueueCheck();
+    rgman->requestQueueCheck();
   }
   return createGIDResponse(gid);
 }
@@ -525,402 +606,566 @@ std::unique_ptr<ValueBase> UnpauseAllRpcMethod::process(const RpcRequest& req,
 {
   auto& groups = e->getRequestGroupMan()->getReservedGroups();
   for (auto& group : groups) {
-    group->setPauseRequested(false);
+    if (group) {
+      group->setPauseRequested(false);
+    }
   }
+  e->getRequestGroupMan()->setLazyGroupsPauseRequested(false);
   e->getRequestGroupMan()->requestQueueCheck();
   return createOKResponse();
 }
 
 namespace {
-template <typename InputIterator>
-void createUriEntry(List* uriList, InputIterator first, InputIterator last,
-                    const std::string& status)
+template <typename Writer, typename InputIterator>
+void writeUriEntries(Writer& w, InputIterator first, InputIterator last,
+                     const char* status)
 {
   for (; first != last; ++first) {
-    auto entry = Dict::g();
-    entry->put(KEY_URI, *first);
-    entry->put(KEY_STATUS, status);
-    uriList->append(std::move(entry));
+    w.beginObject();
+    w.key(KEY_STATUS).string(status);
+    w.key(KEY_URI).string(*first);
+    w.endObject();
   }
 }
 } // namespace
 
 namespace {
-void createUriEntry(List* uriList, const std::shared_ptr<FileEntry>& file)
+template <typename Writer>
+void writeUriEntries(Writer& w, const std::shared_ptr<FileEntry>& file)
 {
-  createUriEntry(uriList, std::begin(file->getSpentUris()),
-                 std::end(file->getSpentUris()), VLB_USED);
-  createUriEntry(uriList, std::begin(file->getRemainingUris()),
-                 std::end(file->getRemainingUris()), VLB_WAITING);
+  writeUriEntries(w, std::begin(file->getSpentUris()),
+                  std::end(file->getSpentUris()), VLB_USED);
+  writeUriEntries(w, std::begin(file->getRemainingUris()),
+                  std::end(file->getRemainingUris()), VLB_WAITING);
 }
 } // namespace
 
+// The keys of the objects below are written in the sorted order, which
+// is the order of Dict, so that the JSON output is the same whether it
+// is written by json::JsonWriter directly or through ValueBase.
+
 namespace {
-template <typename InputIterator>
-void createFileEntry(List* files, InputIterator first, InputIterator last,
-                     const BitfieldMan* bf)
+template <typename Writer, typename InputIterator>
+void writeFileEntries(Writer& w, InputIterator first, InputIterator last,
+                      const BitfieldMan* bf)
 {
   size_t index = 1;
+  w.beginArray();
   for (; first != last; ++first, ++index) {
-    auto entry = Dict::g();
-    entry->put(KEY_INDEX, util::uitos(index));
-    entry->put(KEY_PATH, (*first)->getPath());
-    entry->put(KEY_SELECTED, (*first)->isRequested() ? VLB_TRUE : VLB_FALSE);
-    entry->put(KEY_LENGTH, util::itos((*first)->getLength()));
     int64_t completedLength = bf->getOffsetCompletedLength(
         (*first)->getOffset(), (*first)->getLength());
-    entry->put(KEY_COMPLETED_LENGTH, util::itos(completedLength));
-
-    auto uriList = List::g();
-    createUriEntry(uriList.get(), *first);
-    entry->put(KEY_URIS, std::move(uriList));
-    files->append(std::move(entry));
-  }
+    w.beginObject();
+    w.key(KEY_COMPLETED_LENGTH).string(util::itos(completedLength));
+    w.key(KEY_INDEX).string(util::uitos(index));
+    w.key(KEY_LENGTH).string(util::itos((*first)->getLength()));
+    w.key(KEY_PATH).string((*first)->getPath());
+    w.key(KEY_SELECTED).string((*first)->isRequested() ? VLB_TRUE : VLB_FALSE);
+    w.key(KEY_URIS).beginArray();
+    writeUriEntries(w, *first);
+    w.endArray();
+    w.endObject();
+  }
+  w.endArray();
 }
 } // namespace
 
 namespace {
-template <typename InputIterator>
-void createFileEntry(List* files, InputIterator first, InputIterator last,
-                     int64_t totalLength, int32_t pieceLength,
-                     const std::string& bitfield)
+template <typename Writer, typename InputIterator>
+void writeFileEntries(Writer& w, InputIterator first, InputIterator last,
+                      int64_t totalLength, int32_t pieceLength,
+                      const std::string& bitfield)
 {
   BitfieldMan bf(pieceLength, totalLength);
   bf.setBitfield(reinterpret_cast<const unsigned char*>(bitfield.data()),
                  bitfield.size());
-  createFileEntry(files, first, last, &bf);
+  writeFileEntries(w, first, last, &bf);
 }
 } // namespace
 
 namespace {
-template <typename InputIterator>
-void createFileEntry(List* files, InputIterator first, InputIterator last,
-                     int64_t totalLength, int32_t pieceLength,
-                     const std::shared_ptr<PieceStorage>& ps)
+template <typename Writer, typename InputIterator>
+void writeFileEntries(Writer& w, InputIterator first, InputIterator last,
+                      int64_t totalLength, int32_t pieceLength,
+                      const std::shared_ptr<PieceStorage>& ps)
 {
   BitfieldMan bf(pieceLength, totalLength);
   if (ps) {
     bf.setBitfield(ps->getBitfield(), ps->getBitfieldLength());
   }
-  createFileEntry(files, first, last, &bf);
+  writeFileEntries(w, first, last, &bf);
 }
 } // namespace
 
 namespace {
-bool requested_key(const std::vector<std::string>& keys, const std::string& k)
+// Writes the file entries of the lazily represented download lazy.
+// option must be the one created by lazy.createOption().
+template <typename Writer>
+void writeFileEntries(Writer& w, const LazyRequestGroup& lazy,
+                      const Option& option)
 {
-  return keys.empty() || std::find(keys.begin(), keys.end(), k) != keys.end();
+  auto fileEntry = createLazyFileEntry(lazy, option);
+  writeFileEntries(w, &fileEntry, &fileEntry + 1, 0,
+                   option.getAsInt(PREF_PIECE_LENGTH),
+                   std::shared_ptr<PieceStorage>());
 }
 } // namespace
 
-void gatherProgressCommon(Dict* entryDict,
-                          const std::shared_ptr<RequestGroup>& group,
-                          const std::vector<std::string>& keys)
+namespace {
+// Indexed by StatusKeys::Key.
+const char* const STATUS_KEY_NAMES[] = {
+    KEY_BELONGS_TO,
+    KEY_BITFIELD,
+    KEY_BITTORRENT,
+    KEY_COMPLETED_LENGTH,
+    KEY_CONNECTIONS,
+    KEY_DIR,
+    KEY_DOWNLOAD_SPEED,
+    KEY_ERROR_CODE,
+    KEY_ERROR_MESSAGE,
+    KEY_FILES,
+    KEY_FOLLOWED_BY,
+    KEY_FOLLOWING,
+    KEY_GID,
+    KEY_INFO_HASH,
+    KEY_NUM_PIECES,
+    KEY_NUM_SEEDERS,
+    KEY_PIECE_LENGTH,
+    KEY_SEEDER,
+    KEY_STATUS,
+    KEY_TOTAL_LENGTH,
+    KEY_UPLOAD_LENGTH,
+    KEY_UPLOAD_SPEED,
+    KEY_VERIFIED_LENGTH,
+    KEY_VERIFY_PENDING};
+} // namespace
+
+StatusKeys::StatusKeys(const std::vector<std::string>& keys) : bits_(0)
 {
-  auto& ps = group->getPieceStorage();
-  if (requested_key(keys, KEY_GID)) {
-    entryDict->put(KEY_GID, GroupId::toHex(group->getGID()).c_str());
+  static_assert(arraySize(STATUS_KEY_NAMES) == MAX_KEY,
+                "STATUS_KEY_NAMES must have a name for each key");
+  static_assert(MAX_KEY <= 32, "StatusKeys::bits_ is too small");
+  if (keys.empty()) {
+    bits_ = (static_cast<uint64_t>(1) << MAX_KEY) - 1;
+    return;
   }
-  if (requested_key(keys, KEY_TOTAL_LENGTH)) {
-    // This is "filtered" total length if --select-file is used.
-    entryDict->put(KEY_TOTAL_LENGTH, util::itos(group->getTotalLength()));
+  for (auto& k : keys) {
+    for (size_t i = 0; i < MAX_KEY; ++i) {
+      if (k == STATUS_KEY_NAMES[i]) {
+        bits_ |= 1u << i;
+        break;
+      }
+    }
   }
-  if (requested_key(keys, KEY_COMPLETED_LENGTH)) {
-    // This is "filtered" total length if --select-file is used.
-    entryDict->put(KEY_COMPLETED_LENGTH,
-                   util::itos(group->getCompletedLength()));
+}
+
+const char* StatusKeys::getName(Key key) { return STATUS_KEY_NAMES[key]; }
+
+namespace {
+template <typename Writer> void writeGidList(Writer& w, const char* key,
+                                             const std::vector<a2_gid_t>& gids)
+{
+  if (!gids.empty()) {
+    w.key(key).beginArray();
+    // The element is GID.
+    for (auto gid : gids) {
+      w.string(GroupId::toHex(gid));
+    }
+    w.endArray();
   }
-  TransferStat stat = group->calculateStat();
-  if (requested_key(keys, KEY_DOWNLOAD_SPEED)) {
-    entryDict->put(KEY_DOWNLOAD_SPEED, util::itos(stat.downloadSpeed));
+}
+} // namespace
+
+#ifdef ENABLE_BITTORRENT
+namespace {
+// Writes the members of the object of BitTorrent metadata.
+template <typename Writer>
+void writeBitTorrentMetadata(Writer& w, TorrentAttribute* torrentAttrs)
+{
+  w.key(KEY_ANNOUNCE_LIST).beginArray();
+  for (auto& annlist : torrentAttrs->announceList) {
+    w.beginArray();
+    for (auto& ann : annlist) {
+      w.string(ann);
+    }
+    w.endArray();
   }
-  if (requested_key(keys, KEY_UPLOAD_SPEED)) {
-    entryDict->put(KEY_UPLOAD_SPEED, util::itos(stat.uploadSpeed));
+  w.endArray();
+  if (!torrentAttrs->comment.empty()) {
+    w.key(KEY_COMMENT).string(torrentAttrs->comment);
   }
-  if (requested_key(keys, KEY_UPLOAD_LENGTH)) {
-    entryDict->put(KEY_UPLOAD_LENGTH, util::itos(stat.allTimeUploadLength));
+  if (torrentAttrs->creationDate) {
+    w.key(KEY_CREATION_DATE).integer(torrentAttrs->creationDate);
   }
-  if (requested_key(keys, KEY_CONNECTIONS)) {
-    entryDict->put(KEY_CONNECTIONS, util::itos(group->getNumConnection()));
+  if (!torrentAttrs->metadata.empty()) {
+    w.key(KEY_INFO).beginObject();
+    w.key(KEY_NAME).string(torrentAttrs->name);
+    w.endObject();
   }
-  if (requested_key(keys, KEY_BITFIELD)) {
-    if (ps) {
-      if (ps->getBitfieldLength() > 0) {
-        entryDict->put(KEY_BITFIELD,
-                       util::toHex(ps->getBitfield(), ps->getBitfieldLength()));
-      }
-    }
+  if (torrentAttrs->mode) {
+    w.key(KEY_MODE).string(bittorrent::getModeString(torrentAttrs->mode));
   }
+}
+} // namespace
+#endif // ENABLE_BITTORRENT
+
+namespace {
+// Writes the members of the object of the progress of group.  If
+// status is not nullptr, it is written as the status.  If e is
+// nullptr, the BitTorrent specific data and the progress of the
+// verification are omitted.
+template <typename Writer>
+void writeProgress(Writer& w, const std::shared_ptr<RequestGroup>& group,
+                   DownloadEngine* e, const StatusKeys& keys,
+                   const char* status)
+{
+  auto& ps = group->getPieceStorage();
   auto& dctx = group->getDownloadContext();
-  if (requested_key(keys, KEY_PIECE_LENGTH)) {
-    entryDict->put(KEY_PIECE_LENGTH, util::itos(dctx->getPieceLength()));
-  }
-  if (requested_key(keys, KEY_NUM_PIECES)) {
-    entryDict->put(KEY_NUM_PIECES, util::uitos(dctx->getNumPieces()));
-  }
-  if (requested_key(keys, KEY_FOLLOWED_BY)) {
-    if (!group->followedBy().empty()) {
-      auto list = List::g();
-      // The element is GID.
-      for (auto& gid : group->followedBy()) {
-        list->append(GroupId::toHex(gid));
-      }
-      entryDict->put(KEY_FOLLOWED_BY, std::move(list));
-    }
+  TransferStat stat;
+  if (keys.has(StatusKeys::DOWNLOAD_SPEED) ||
+      keys.has(StatusKeys::UPLOAD_LENGTH) ||
+      keys.has(StatusKeys::UPLOAD_SPEED)) {
+    stat = group->calculateStat();
   }
-  if (requested_key(keys, KEY_FOLLOWING)) {
-    if (group->following()) {
-      entryDict->put(KEY_FOLLOWING, GroupId::toHex(group->following()));
+#ifdef ENABLE_BITTORRENT
+  TorrentAttribute* torrentAttrs = nullptr;
+  BtObject* btObject = nullptr;
+  if (e && dctx->hasAttribute(CTX_ATTR_BT)) {
+    torrentAttrs = bittorrent::getTorrentAttrs(dctx);
+    if (keys.has(StatusKeys::NUM_SEEDERS)) {
+      btObject = e->getBtRegistry()->get(group->getGID());
     }
   }
-  if (requested_key(keys, KEY_BELONGS_TO)) {
-    if (group->belongsTo()) {
-      entryDict->put(KEY_BELONGS_TO, GroupId::toHex(group->belongsTo()));
+#endif // ENABLE_BITTORRENT
+  CheckIntegrityEntry* verifyEntry = nullptr;
+  bool verifyPending = false;
+  if (e && e->getCheckIntegrityMan()) {
+    if (keys.has(StatusKeys::VERIFIED_LENGTH)) {
+      verifyEntry = e->getCheckIntegrityMan()->findPickedEntry(
+          [&group](const CheckIntegrityEntry& ent) {
+            return ent.getRequestGroup() == group.get();
+          });
+    }
+    if (keys.has(StatusKeys::VERIFY_PENDING)) {
+      verifyPending = e->getCheckIntegrityMan()->isQueued(
+          [&group](const CheckIntegrityEntry& ent) {
+            return ent.getRequestGroup() == group.get();
+          });
     }
   }
-  if (requested_key(keys, KEY_FILES)) {
-    auto files = List::g();
-    createFileEntry(files.get(), std::begin(dctx->getFileEntries()),
-                    std::end(dctx->getFileEntries()), dctx->getTotalLength(),
-                    dctx->getPieceLength(), ps);
-    entryDict->put(KEY_FILES, std::move(files));
+
+  if (group->belongsTo() && keys.has(StatusKeys::BELONGS_TO)) {
+    w.key(KEY_BELONGS_TO).string(GroupId::toHex(group->belongsTo()));
   }
-  if (requested_key(keys, KEY_DIR)) {
-    entryDict->put(KEY_DIR, group->getOption()->get(PREF_DIR));
+  if (keys.has(StatusKeys::BITFIELD) && ps && ps->getBitfieldLength() > 0) {
+    w.key(KEY_BITFIELD)
+        .string(util::toHex(ps->getBitfield(), ps->getBitfieldLength()));
   }
-}
-
 #ifdef ENABLE_BITTORRENT
-void gatherBitTorrentMetadata(Dict* btDict, TorrentAttribute* torrentAttrs)
-{
-  if (!torrentAttrs->comment.empty()) {
-    btDict->put(KEY_COMMENT, torrentAttrs->comment);
+  if (torrentAttrs && keys.has(StatusKeys::BITTORRENT)) {
+    w.key(KEY_BITTORRENT).beginObject();
+    writeBitTorrentMetadata(w, torrentAttrs);
+    w.endObject();
   }
-  if (torrentAttrs->creationDate) {
-    btDict->put(KEY_CREATION_DATE, Integer::g(torrentAttrs->creationDate));
+#endif // ENABLE_BITTORRENT
+  if (keys.has(StatusKeys::COMPLETED_LENGTH)) {
+    // This is "filtered" total length if --select-file is used.
+    w.key(KEY_COMPLETED_LENGTH).string(util::itos(group->getCompletedLength()));
   }
-  if (torrentAttrs->mode) {
-    btDict->put(KEY_MODE, bittorrent::getModeString(torrentAttrs->mode));
+  if (keys.has(StatusKeys::CONNECTIONS)) {
+    w.key(KEY_CONNECTIONS).string(util::itos(group->getNumConnection()));
   }
-  auto destAnnounceList = List::g();
-  for (auto& annlist : torrentAttrs->announceList) {
-    auto destAnnounceTier = List::g();
-    for (auto& ann : annlist) {
-      destAnnounceTier->append(ann);
-    }
-    destAnnounceList->append(std::move(destAnnounceTier));
+  if (keys.has(StatusKeys::DIR)) {
+    w.key(KEY_DIR).string(group->getOption()->get(PREF_DIR));
   }
-  btDict->put(KEY_ANNOUNCE_LIST, std::move(destAnnounceList));
-  if (!torrentAttrs->metadata.empty()) {
-    auto infoDict = Dict::g();
-    infoDict->put(KEY_NAME, torrentAttrs->name);
-    btDict->put(KEY_INFO, std::move(infoDict));
+  if (keys.has(StatusKeys::DOWNLOAD_SPEED)) {
+    w.key(KEY_DOWNLOAD_SPEED).string(util::itos(stat.downloadSpeed));
   }
-}
-
-namespace {
-void gatherProgressBitTorrent(Dict* entryDict,
-                              const std::shared_ptr<RequestGroup>& group,
-                              TorrentAttribute* torrentAttrs,
-                              BtObject* btObject,
-                              const std::vector<std::string>& keys)
-{
-  if (requested_key(keys, KEY_INFO_HASH)) {
-    entryDict->put(KEY_INFO_HASH, util::toHex(torrentAttrs->infoHash));
+  if (keys.has(StatusKeys::FILES)) {
+    w.key(KEY_FILES);
+    writeFileEntries(w, std::begin(dctx->getFileEntries()),
+                     std::end(dctx->getFileEntries()), dctx->getTotalLength(),
+                     dctx->getPieceLength(), ps);
+  }
+  if (keys.has(StatusKeys::FOLLOWED_BY)) {
+    writeGidList(w, KEY_FOLLOWED_BY, group->followedBy());
+  }
+  if (group->following() && keys.has(StatusKeys::FOLLOWING)) {
+    w.key(KEY_FOLLOWING).string(GroupId::toHex(group->following()));
   }
-  if (requested_key(keys, KEY_BITTORRENT)) {
-    auto btDict = Dict::g();
-    gatherBitTorrentMetadata(btDict.get(), torrentAttrs);
-    entryDict->put(KEY_BITTORRENT, std::move(btDict));
+  if (keys.has(StatusKeys::GID)) {
+    w.key(KEY_GID).string(GroupId::toHex(group->getGID()));
   }
-  if (requested_key(keys, KEY_NUM_SEEDERS)) {
+#ifdef ENABLE_BITTORRENT
+  if (torrentAttrs && keys.has(StatusKeys::INFO_HASH)) {
+    w.key(KEY_INFO_HASH).string(util::toHex(torrentAttrs->infoHash));
+  }
+#endif // ENABLE_BITTORRENT
+  if (keys.has(StatusKeys::NUM_PIECES)) {
+    w.key(KEY_NUM_PIECES).string(util::uitos(dctx->getNumPieces()));
+  }
+#ifdef ENABLE_BITTORRENT
+  if (torrentAttrs && keys.has(StatusKeys::NUM_SEEDERS)) {
     if (!btObject) {
-      entryDict->put(KEY_NUM_SEEDERS, VLB_ZERO);
+      w.key(KEY_NUM_SEEDERS).string(VLB_ZERO);
     }
     else {
       auto& peerStorage = btObject->peerStorage;
       assert(peerStorage);
       auto& peers = peerStorage->getUsedPeers();
-      entryDict->put(KEY_NUM_SEEDERS,
-                     util::uitos(countSeeder(peers.begin(), peers.end())));
+      w.key(KEY_NUM_SEEDERS)
+          .string(util::uitos(countSeeder(peers.begin(), peers.end())));
     }
   }
-  if (requested_key(keys, KEY_SEEDER)) {
-    entryDict->put(KEY_SEEDER, group->isSeeder() ? VLB_TRUE : VLB_FALSE);
+#endif // ENABLE_BITTORRENT
+  if (keys.has(StatusKeys::PIECE_LENGTH)) {
+    w.key(KEY_PIECE_LENGTH).string(util::itos(dctx->getPieceLength()));
+  }
+#ifdef ENABLE_BITTORRENT
+  if (torrentAttrs && keys.has(StatusKeys::SEEDER)) {
+    w.key(KEY_SEEDER).string(group->isSeeder() ? VLB_TRUE : VLB_FALSE);
+  }
+#endif // ENABLE_BITTORRENT
+  if (status) {
+    w.key(KEY_STATUS).string(status);
+  }
+  if (keys.has(StatusKeys::TOTAL_LENGTH)) {
+    // This is "filtered" total length if --select-file is used.
+    w.key(KEY_TOTAL_LENGTH).string(util::itos(group->getTotalLength()));
+  }
+  if (keys.has(StatusKeys::UPLOAD_LENGTH)) {
+    w.key(KEY_UPLOAD_LENGTH).string(util::itos(stat.allTimeUploadLength));
+  }
+  if (keys.has(StatusKeys::UPLOAD_SPEED)) {
+    w.key(KEY_UPLOAD_SPEED).string(util::itos(stat.uploadSpeed));
+  }
+  if (verifyEntry) {
+    w.key(KEY_VERIFIED_LENGTH)
+        .string(util::itos(verifyEntry->getCurrentLength()));
+  }
+  if (verifyPending) {
+    w.key(KEY_VERIFY_PENDING).string(VLB_TRUE);
   }
 }
 } // namespace
 
 namespace {
-void gatherPeer(List* peers, const std::shared_ptr<PeerStorage>& ps)
+// Writes the members of the object of the lazily represented download
+// lazy.  They are the same as writeProgress() writes for RequestGroup
+// built from lazy, which has not started yet.
+template <typename Writer>
+void writeLazyProgress(Writer& w, const LazyRequestGroup& lazy,
+                       const StatusKeys& keys, const char* status)
 {
-  auto& usedPeers = ps->getUsedPeers();
-  for (auto& peer : usedPeers) {
-    if (!peer->isActive()) {
-      continue;
-    }
-    auto peerEntry = Dict::g();
-    peerEntry->put(KEY_PEER_ID, util::torrentPercentEncode(peer->getPeerId(),
-                                                           PEER_ID_LENGTH));
-    peerEntry->put(KEY_IP, peer->getIPAddress());
-    if (peer->isIncomingPeer()) {
-      peerEntry->put(KEY_PORT, VLB_ZERO);
-    }
-    else {
-      peerEntry->put(KEY_PORT, util::uitos(peer->getPort()));
-    }
-    peerEntry->put(KEY_BITFIELD,
-                   util::toHex(peer->getBitfield(), peer->getBitfieldLength()));
-    peerEntry->put(KEY_AM_CHOKING, peer->amChoking() ? VLB_TRUE : VLB_FALSE);
-    peerEntry->put(KEY_PEER_CHOKING,
-                   peer->peerChoking() ? VLB_TRUE : VLB_FALSE);
-    peerEntry->put(KEY_DOWNLOAD_SPEED,
-                   util::itos(peer->calculateDownloadSpeed()));
-    peerEntry->put(KEY_UPLOAD_SPEED, util::itos(peer->calculateUploadSpeed()));
-    peerEntry->put(KEY_SEEDER, peer->isSeeder() ? VLB_TRUE : VLB_FALSE);
-    peers->append(std::move(peerEntry));
+  auto option = lazy.createOption();
+  if (keys.has(StatusKeys::COMPLETED_LENGTH)) {
+    w.key(KEY_COMPLETED_LENGTH).string(VLB_ZERO);
+  }
+  if (keys.has(StatusKeys::CONNECTIONS)) {
+    w.key(KEY_CONNECTIONS).string(VLB_ZERO);
+  }
+  if (keys.has(StatusKeys::DIR)) {
+    w.key(KEY_DIR).string(option->get(PREF_DIR));
+  }
+  if (keys.has(StatusKeys::DOWNLOAD_SPEED)) {
+    w.key(KEY_DOWNLOAD_SPEED).string(VLB_ZERO);
+  }
+  if (keys.has(StatusKeys::FILES)) {
+    w.key(KEY_FILES);
+    writeFileEntries(w, lazy, *option);
+  }
+  if (keys.has(StatusKeys::GID)) {
+    w.key(KEY_GID).string(lazy.getGroupId()->toHex());
+  }
+  if (keys.has(StatusKeys::NUM_PIECES)) {
+    w.key(KEY_NUM_PIECES).string(VLB_ZERO);
+  }
+  if (keys.has(StatusKeys::PIECE_LENGTH)) {
+    w.key(KEY_PIECE_LENGTH)
+        .string(util::itos(option->getAsInt(PREF_PIECE_LENGTH)));
+  }
+  if (status) {
+    w.key(KEY_STATUS).string(status);
+  }
+  if (keys.has(StatusKeys::TOTAL_LENGTH)) {
+    w.key(KEY_TOTAL_LENGTH).string(VLB_ZERO);
+  }
+  if (keys.has(StatusKeys::UPLOAD_LENGTH)) {
+    w.key(KEY_UPLOAD_LENGTH).string(VLB_ZERO);
+  }
+  if (keys.has(StatusKeys::UPLOAD_SPEED)) {
+    w.key(KEY_UPLOAD_SPEED).string(VLB_ZERO);
   }
 }
 } // namespace
-#endif // ENABLE_BITTORRENT
 
 namespace {
-void gatherProgress(Dict* entryDict, const std::shared_ptr<RequestGroup>& group,
-                    DownloadEngine* e, const std::vector<std::string>& keys)
+// Writes the members of the object of the stopped download ds.
+template <typename Writer>
+void writeStoppedDownload(Writer& w, const std::shared_ptr<DownloadResult>& ds,
+                          const StatusKeys& keys)
 {
-  gatherProgressCommon(entryDict, group, keys);
+  if (ds->belongsTo && keys.has(StatusKeys::BELONGS_TO)) {
+    w.key(KEY_BELONGS_TO).string(GroupId::toHex(ds->belongsTo));
+  }
+  if (!ds->bitfield.empty() && keys.has(StatusKeys::BITFIELD)) {
+    w.key(KEY_BITFIELD).string(util::toHex(ds->bitfield));
+  }
 #ifdef ENABLE_BITTORRENT
-  if (group->getDownloadContext()->hasAttribute(CTX_ATTR_BT)) {
-    gatherProgressBitTorrent(
-        entryDict, group,
-        bittorrent::getTorrentAttrs(group->getDownloadContext()),
-        e->getBtRegistry()->get(group->getGID()), keys);
+  if (ds->attrs.size() > CTX_ATTR_BT && ds->attrs[CTX_ATTR_BT] &&
+      keys.has(StatusKeys::BITTORRENT)) {
+    w.key(KEY_BITTORRENT).beginObject();
+    writeBitTorrentMetadata(
+        w, static_cast<TorrentAttribute*>(ds->attrs[CTX_ATTR_BT].get()));
+    w.endObject();
   }
 #endif // ENABLE_BITTORRENT
-  if (e->getCheckIntegrityMan()) {
-    if (e->getCheckIntegrityMan()->isPicked(
-            [&group](const CheckIntegrityEntry& ent) {
-              return ent.getRequestGroup() == group.get();
-            })) {
-      entryDict->put(
-          KEY_VERIFIED_LENGTH,
-          util::itos(
-              e->getCheckIntegrityMan()->getPickedEntry()->getCurrentLength()));
-    }
-    if (e->getCheckIntegrityMan()->isQueued(
-            [&group](const CheckIntegrityEntry& ent) {
-              return ent.getRequestGroup() == group.get();
-            })) {
-      entryDict->put(KEY_VERIFY_PENDING, VLB_TRUE);
-    }
+  if (keys.has(StatusKeys::COMPLETED_LENGTH)) {
+    w.key(KEY_COMPLETED_LENGTH).string(util::itos(ds->completedLength));
   }
-}
-} // namespace
-
-void gatherStoppedDownload(Dict* entryDict,
-                           const std::shared_ptr<DownloadResult>& ds,
-                           const std::vector<std::string>& keys)
-{
-  if (requested_key(keys, KEY_GID)) {
-    entryDict->put(KEY_GID, ds->gid->toHex());
+  if (keys.has(StatusKeys::CONNECTIONS)) {
+    w.key(KEY_CONNECTIONS).string(VLB_ZERO);
   }
-  if (requested_key(keys, KEY_ERROR_CODE)) {
-    entryDict->put(KEY_ERROR_CODE, util::itos(static_cast<int>(ds->result)));
+  if (keys.has(StatusKeys::DIR)) {
+    w.key(KEY_DIR).string(ds->dir);
   }
-  if (requested_key(keys, KEY_ERROR_MESSAGE)) {
-    entryDict->put(KEY_ERROR_MESSAGE, ds->resultMessage);
+  if (keys.has(StatusKeys::DOWNLOAD_SPEED)) {
+    w.key(KEY_DOWNLOAD_SPEED).string(VLB_ZERO);
   }
-  if (requested_key(keys, KEY_STATUS)) {
-    if (ds->result == error_code::REMOVED) {
-      entryDict->put(KEY_STATUS, VLB_REMOVED);
-    }
-    else if (ds->result == error_code::FINISHED) {
-      entryDict->put(KEY_STATUS, VLB_COMPLETE);
-    }
-    else {
-      entryDict->put(KEY_STATUS, VLB_ERROR);
-    }
+  if (keys.has(StatusKeys::ERROR_CODE)) {
+    w.key(KEY_ERROR_CODE).string(util::itos(static_cast<int>(ds->result)));
   }
-  if (requested_key(keys, KEY_FOLLOWED_BY)) {
-    if (!ds->followedBy.empty()) {
-      auto list = List::g();
-      // The element is GID.
-      for (auto gid : ds->followedBy) {
-        list->append(GroupId::toHex(gid));
-      }
-      entryDict->put(KEY_FOLLOWED_BY, std::move(list));
-    }
+  if (keys.has(StatusKeys::ERROR_MESSAGE)) {
+    w.key(KEY_ERROR_MESSAGE).string(ds->resultMessage);
   }
-  if (requested_key(keys, KEY_FOLLOWING)) {
-    if (ds->following) {
-      entryDict->put(KEY_FOLLOWING, GroupId::toHex(ds->following));
-    }
+  if (keys.has(StatusKeys::FILES)) {
+    w.key(KEY_FILES);
+    writeFileEntries(w, std::begin(ds->fileEntries), std::end(ds->fileEntries),
+                     ds->totalLength, ds->pieceLength, ds->bitfield);
   }
-  if (requested_key(keys, KEY_BELONGS_TO)) {
-    if (ds->belongsTo) {
-      entryDict->put(KEY_BELONGS_TO, GroupId::toHex(ds->belongsTo));
-    }
-  }
-  if (requested_key(keys, KEY_FILES)) {
-    auto files = List::g();
-    createFileEntry(files.get(), std::begin(ds->fileEntries),
-                    std::end(ds->fileEntries), ds->totalLength, ds->pieceLength,
-                    ds->bitfield);
-    entryDict->put(KEY_FILES, std::move(files));
+  if (keys.has(StatusKeys::FOLLOWED_BY)) {
+    writeGidList(w, KEY_FOLLOWED_BY, ds->followedBy);
   }
-  if (requested_key(keys, KEY_TOTAL_LENGTH)) {
-    entryDict->put(KEY_TOTAL_LENGTH, util::itos(ds->totalLength));
+  if (ds->following && keys.has(StatusKeys::FOLLOWING)) {
+    w.key(KEY_FOLLOWING).string(GroupId::toHex(ds->following));
   }
-  if (requested_key(keys, KEY_COMPLETED_LENGTH)) {
-    entryDict->put(KEY_COMPLETED_LENGTH, util::itos(ds->completedLength));
+  if (keys.has(StatusKeys::GID)) {
+    w.key(KEY_GID).string(ds->gid->toHex());
   }
-  if (requested_key(keys, KEY_UPLOAD_LENGTH)) {
-    entryDict->put(KEY_UPLOAD_LENGTH, util::itos(ds->uploadLength));
+  if (!ds->infoHash.empty() && keys.has(StatusKeys::INFO_HASH)) {
+    w.key(KEY_INFO_HASH).string(util::toHex(ds->infoHash));
   }
-  if (requested_key(keys, KEY_BITFIELD)) {
-    if (!ds->bitfield.empty()) {
-      entryDict->put(KEY_BITFIELD, util::toHex(ds->bitfield));
-    }
+  if (keys.has(StatusKeys::NUM_PIECES)) {
+    w.key(KEY_NUM_PIECES).string(util::uitos(ds->numPieces));
   }
-  if (requested_key(keys, KEY_DOWNLOAD_SPEED)) {
-    entryDict->put(KEY_DOWNLOAD_SPEED, VLB_ZERO);
+  if (!ds->infoHash.empty() && keys.has(StatusKeys::NUM_SEEDERS)) {
+    w.key(KEY_NUM_SEEDERS).string(VLB_ZERO);
   }
-  if (requested_key(keys, KEY_UPLOAD_SPEED)) {
-    entryDict->put(KEY_UPLOAD_SPEED, VLB_ZERO);
+  if (keys.has(StatusKeys::PIECE_LENGTH)) {
+    w.key(KEY_PIECE_LENGTH).string(util::itos(ds->pieceLength));
   }
-  if (!ds->infoHash.empty()) {
-    if (requested_key(keys, KEY_INFO_HASH)) {
-      entryDict->put(KEY_INFO_HASH, util::toHex(ds->infoHash));
+  if (keys.has(StatusKeys::STATUS)) {
+    if (ds->result == error_code::REMOVED) {
+      w.key(KEY_STATUS).string(VLB_REMOVED);
+    }
+    else if (ds->result == error_code::FINISHED) {
+      w.key(KEY_STATUS).string(VLB_COMPLETE);
     }
-    if (requested_key(keys, KEY_NUM_SEEDERS)) {
-      entryDict->put(KEY_NUM_SEEDERS, VLB_ZERO);
+    else {
+      w.key(KEY_STATUS).string(VLB_ERROR);
     }
   }
-  if (requested_key(keys, KEY_PIECE_LENGTH)) {
-    entryDict->put(KEY_PIECE_LENGTH, util::itos(ds->pieceLength));
+  if (keys.has(StatusKeys::TOTAL_LENGTH)) {
+    w.key(KEY_TOTAL_LENGTH).string(util::itos(ds->totalLength));
   }
-  if (requested_key(keys, KEY_NUM_PIECES)) {
-    entryDict->put(KEY_NUM_PIECES, util::uitos(ds->numPieces));
+  if (keys.has(StatusKeys::UPLOAD_LENGTH)) {
+    w.key(KEY_UPLOAD_LENGTH).string(util::itos(ds->uploadLength));
   }
-  if (requested_key(keys, KEY_CONNECTIONS)) {
-    entryDict->put(KEY_CONNECTIONS, VLB_ZERO);
+  if (keys.has(StatusKeys::UPLOAD_SPEED)) {
+    w.key(KEY_UPLOAD_SPEED).string(VLB_ZERO);
   }
-  if (requested_key(keys, KEY_DIR)) {
-    entryDict->put(KEY_DIR, ds->dir);
+}
+} // namespace
+
+namespace {
+// Moves the members of the object written to w into entryDict.
+void mergeObject(Dict* entryDict, ValueBaseWriter& w)
+{
+  auto r = w.getResult();
+  for (auto& kv : *downcast<Dict>(r)) {
+    entryDict->put(kv.first, std::move(kv.second));
   }
+}
+} // namespace
+
+void gatherProgressCommon(Dict* entryDict,
+                          const std::shared_ptr<RequestGroup>& group,
+                          const std::vector<std::string>& keys)
+{
+  ValueBaseWriter w;
+  w.beginObject();
+  writeProgress(w, group, nullptr, StatusKeys(keys), nullptr);
+  w.endObject();
+  mergeObject(entryDict, w);
+}
 
 #ifdef ENABLE_BITTORRENT
-  if (ds->attrs.size() > CTX_ATTR_BT && ds->attrs[CTX_ATTR_BT]) {
-    const auto attrs =
-        static_cast<TorrentAttribute*>(ds->attrs[CTX_ATTR_BT].get());
-    if (requested_key(keys, KEY_BITTORRENT)) {
-      auto btDict = Dict::g();
-      gatherBitTorrentMetadata(btDict.get(), attrs);
-      entryDict->put(KEY_BITTORRENT, std::move(btDict));
+void gatherBitTorrentMetadata(Dict* btDict, TorrentAttribute* torrentAttrs)
+{
+  ValueBaseWriter w;
+  w.beginObject();
+  writeBitTorrentMetadata(w, torrentAttrs);
+  w.endObject();
+  mergeObject(btDict, w);
+}
+#endif // ENABLE_BITTORRENT
+
+void gatherStoppedDownload(Dict* entryDict,
+                           const std::shared_ptr<DownloadResult>& ds,
+                           const std::vector<std::string>& keys)
+{
+  ValueBaseWriter w;
+  w.beginObject();
+  writeStoppedDownload(w, ds, StatusKeys(keys));
+  w.endObject();
+  mergeObject(entryDict, w);
+}
+
+#ifdef ENABLE_BITTORRENT
+namespace {
+void gatherPeer(List* peers, const std::shared_ptr<PeerStorage>& ps)
+{
+  auto& usedPeers = ps->getUsedPeers();
+  for (auto& peer : usedPeers) {
+    if (!peer->isActive()) {
+      continue;
     }
+    auto peerEntry = Dict::g();
+    peerEntry->put(KEY_PEER_ID, util::torrentPercentEncode(peer->getPeerId(),
+                                                           PEER_ID_LENGTH));
+    peerEntry->put(KEY_IP, peer->getIPAddress());
+    if (peer->isIncomingPeer()) {
+      peerEntry->put(KEY_PORT, VLB_ZERO);
+    }
+    else {
+      peerEntry->put(KEY_PORT, util::uitos(peer->getPort()));
+    }
+    peerEntry->put(KEY_BITFIELD,
+                   util::toHex(peer->getBitfield(), peer->getBitfieldLength()));
+    peerEntry->put(KEY_AM_CHOKING, peer->amChoking() ? VLB_TRUE : VLB_FALSE);
+    peerEntry->put(KEY_PEER_CHOKING,
+                   peer->peerChoking() ? VLB_TRUE : VLB_FALSE);
+    peerEntry->put(KEY_DOWNLOAD_SPEED,
+                   util::itos(peer->calculateDownloadSpeed()));
+    peerEntry->put(KEY_UPLOAD_SPEED, util::itos(peer->calculateUploadSpeed()));
+    peerEntry->put(KEY_SEEDER, peer->isSeeder() ? VLB_TRUE : VLB_FALSE);
+    peerEntry->put(KEY_MAX_OUTSTANDING_REQUEST,
+                   util::uitos(peer->getMaxOutstandingRequest()));
+    peerEntry->put(KEY_RTT, util::itos(peer->getBlockRtt().count()));
+    peers->append(std::move(peerEntry));
   }
-#endif // ENABLE_BITTORRENT
 }
+} // namespace
+#endif // ENABLE_BITTORRENT
 
 std::unique_ptr<ValueBase> GetFilesRpcMethod::process(const RpcRequest& req,
                                                       DownloadEngine* e)
@@ -928,29 +1173,33 @@ std::unique_ptr<ValueBase> GetFilesRpcMethod::process(const RpcRequest& req,
   const String* gidParam = checkRequiredParam<String>(req, 0);
 
   a2_gid_t gid = str2Gid(gidParam);
-  auto files = List::g();
-  auto group = e->getRequestGroupMan()->findGroup(gid);
+  ValueBaseWriter w;
+  auto& rgman = e->getRequestGroupMan();
+  auto group = rgman->findGroup(gid);
   if (!group) {
-    auto dr = e->getRequestGroupMan()->findDownloadResult(gid);
+    auto lazy = rgman->findLazyGroup(gid);
+    if (lazy) {
+      writeFileEntries(w, *lazy, *lazy->createOption());
+      return w.getResult();
+    }
+    auto dr = rgman->findDownloadResult(gid);
     if (!dr) {
       throw DL_ABORT_EX(fmt("No file data is available for GID#%s",
                             GroupId::toHex(gid).c_str()));
     }
     else {
-      createFileEntry(files.get(), std::begin(dr->fileEntries),
-                      std::end(dr->fileEntries), dr->totalLength,
-                      dr->pieceLength, dr->bitfield);
+      writeFileEntries(w, std::begin(dr->fileEntries),
+                       std::end(dr->fileEntries), dr->totalLength,
+                       dr->pieceLength, dr->bitfield);
     }
   }
   else {
     auto& dctx = group->getDownloadContext();
-    createFileEntry(files.get(),
-                    std::begin(group->getDownloadContext()->getFileEntries()),
-                    std::end(group->getDownloadContext()->getFileEntries()),
-                    dctx->getTotalLength(), dctx->getPieceLength(),
-                    group->getPieceStorage());
+    writeFileEntries(w, std::begin(dctx->getFileEntries()),
+                     std::end(dctx->getFileEntries()), dctx->getTotalLength(),
+                     dctx->getPieceLength(), group->getPieceStorage());
   }
-  return std::move(files);
+  return w.getResult();
 }
 
 std::unique_ptr<ValueBase> GetUrisRpcMethod::process(const RpcRequest& req,
@@ -959,18 +1208,24 @@ std::unique_ptr<ValueBase> GetUrisRpcMethod::process(const RpcRequest& req,
   const String* gidParam = checkRequiredParam<String>(req, 0);
 
   a2_gid_t gid = str2Gid(gidParam);
-  auto group = e->getRequestGroupMan()->findGroup(gid);
-  if (!group) {
+  auto& rgman = e->getRequestGroupMan();
+  auto group = rgman->findGroup(gid);
+  auto lazy = group ? nullptr : rgman->findLazyGroup(gid);
+  if (!group && !lazy) {
     throw DL_ABORT_EX(fmt("No URI data is available for GID#%s",
                           GroupId::toHex(gid).c_str()));
   }
-  auto uriList = List::g();
+  ValueBaseWriter w;
+  w.beginArray();
+  if (lazy) {
+    writeUriEntries(w, createLazyFileEntry(*lazy, *lazy->createOption()));
+  }
   // TODO Current implementation just returns first FileEntry's URIs.
-  if (!group->getDownloadContext()->getFileEntries().empty()) {
-    createUriEntry(uriList.get(),
-                   group->getDownloadContext()->getFirstFileEntry());
+  else if (!group->getDownloadContext()->getFileEntries().empty()) {
+    writeUriEntries(w, group->getDownloadContext()->getFirstFileEntry());
   }
-  return std::move(uriList);
+  w.endArray();
+  return w.getResult();
 }
 
 #ifdef ENABLE_BITTORRENT
@@ -980,13 +1235,13 @@ std::unique_ptr<ValueBase> GetPeersRpcMethod::process(const RpcRequest& req,
   const String* gidParam = checkRequiredParam<String>(req, 0);
 
   a2_gid_t gid = str2Gid(gidParam);
-  auto group = e->getRequestGroupMan()->findGroup(gid);
-  if (!group) {
+  auto& rgman = e->getRequestGroupMan();
+  if (!rgman->findGroup(gid) && !rgman->findLazyGroup(gid)) {
     throw DL_ABORT_EX(fmt("No peer data is available for GID#%s",
                           GroupId::toHex(gid).c_str()));
   }
   auto peers = List::g();
-  auto btObject = e->getBtRegistry()->get(group->getGID());
+  auto btObject = e->getBtRegistry()->get(gid);
   if (btObject) {
     assert(btObject->peerStorage);
     gatherPeer(peers.get(), btObject->peerStorage);
@@ -995,62 +1250,225 @@ std::unique_ptr<ValueBase> GetPeersRpcMethod::process(const RpcRequest& req,
 }
 #endif // ENABLE_BITTORRENT
 
-std::unique_ptr<ValueBase> TellStatusRpcMethod::process(const RpcRequest& req,
-                                                        DownloadEngine* e)
+namespace {
+const char* getWaitingStatus(const std::shared_ptr<RequestGroup>& group)
 {
-  const String* gidParam = checkRequiredParam<String>(req, 0);
-  const List* keysParam = checkParam<List>(req, 1);
+  return group->isPauseRequested() ? VLB_PAUSED : VLB_WAITING;
+}
+} // namespace
 
-  a2_gid_t gid = str2Gid(gidParam);
-  std::vector<std::string> keys;
-  toStringList(std::back_inserter(keys), keysParam);
+namespace {
+const char* getWaitingStatus(const LazyRequestGroup& lazy)
+{
+  return lazy.isPauseRequested() ? VLB_PAUSED : VLB_WAITING;
+}
+} // namespace
 
-  auto group = e->getRequestGroupMan()->findGroup(gid);
-  auto entryDict = Dict::g();
+namespace {
+// Writes the status object of the download gid in the way tellStatus
+// does.  Returns false if there is no such download.
+template <typename Writer>
+bool writeStatusOf(Writer& w, a2_gid_t gid, DownloadEngine* e,
+                   const StatusKeys& keys)
+{
+  auto& rgman = e->getRequestGroupMan();
+  auto group = rgman->findGroup(gid);
   if (!group) {
-    auto ds = e->getRequestGroupMan()->findDownloadResult(gid);
+    auto lazy = rgman->findLazyGroup(gid);
+    if (lazy) {
+      w.beginObject();
+      writeLazyProgress(w, *lazy, keys,
+                        keys.has(StatusKeys::STATUS) ? getWaitingStatus(*lazy)
+                                                     : nullptr);
+      w.endObject();
+      return true;
+    }
+    auto ds = rgman->findDownloadResult(gid);
     if (!ds) {
-      throw DL_ABORT_EX(
-          fmt("No such download for GID#%s", GroupId::toHex(gid).c_str()));
+      return false;
     }
-    gatherStoppedDownload(entryDict.get(), ds, keys);
+    w.beginObject();
+    writeStoppedDownload(w, ds, keys);
+    w.endObject();
   }
   else {
-    if (requested_key(keys, KEY_STATUS)) {
+    const char* status = nullptr;
+    if (keys.has(StatusKeys::STATUS)) {
       if (group->getState() == RequestGroup::STATE_ACTIVE) {
-        entryDict->put(KEY_STATUS, VLB_ACTIVE);
+        status = VLB_ACTIVE;
       }
       else {
-        if (group->isPauseRequested()) {
-          entryDict->put(KEY_STATUS, VLB_PAUSED);
-        }
-        else {
-          entryDict->put(KEY_STATUS, VLB_WAITING);
-        }
+        status = getWaitingStatus(group);
       }
     }
-    gatherProgress(entryDict.get(), group, e, keys);
+    w.beginObject();
+    writeProgress(w, group, e, keys, status);
+    w.endObject();
   }
-  return std::move(entryDict);
+  return true;
 }
+} // namespace
 
-std::unique_ptr<ValueBase> TellActiveRpcMethod::process(const RpcRequest& req,
+namespace {
+template <typename Writer>
+void writeStatus(Writer& w, const RpcRequest& req, DownloadEngine* e)
+{
+  const String* gidParam = checkRequiredParam<String>(req, 0);
+  const List* keysParam = checkParam<List>(req, 1);
+
+  a2_gid_t gid = str2Gid(gidParam);
+  std::vector<std::string> keyList;
+  toStringList(std::back_inserter(keyList), keysParam);
+
+  if (!writeStatusOf(w, gid, e, StatusKeys(keyList))) {
+    throw DL_ABORT_EX(
+        fmt("No such download for GID#%s", GroupId::toHex(gid).c_str()));
+  }
+}
+} // namespace
+
+namespace {
+// Writes the value of each member of the status object to its own
+// string, so that the values can be compared one by one.  The values
+// are written in JSON.
+class StatusValueWriter {
+public:
+  StatusValueWriter(std::vector<std::string>& values)
+      : values_(values), depth_(0)
+  {
+  }
+
+  StatusValueWriter& beginObject()
+  {
+    if (depth_++ > 0) {
+      w_->beginObject();
+    }
+    return *this;
+  }
+
+  StatusValueWriter& endObject()
+  {
+    if (--depth_ > 0) {
+      w_->endObject();
+    }
+    return *this;
+  }
+
+  StatusValueWriter& beginArray()
+  {
+    ++depth_;
+    w_->beginArray();
+    return *this;
+  }
+
+  StatusValueWriter& endArray()
+  {
+    --depth_;
+    w_->endArray();
+    return *this;
+  }
+
+  StatusValueWriter& key(const char* k)
+  {
+    if (depth_ > 1) {
+      w_->key(k);
+      return *this;
+    }
+    // The keys of the status object are KEY_* constants, so that they
+    // are compared by address first.
+    size_t i = 0;
+    for (; i < StatusKeys::MAX_KEY && STATUS_KEY_NAMES[i] != k; ++i)
+      ;
+    if (i == StatusKeys::MAX_KEY) {
+      for (i = 0; i < StatusKeys::MAX_KEY && strcmp(STATUS_KEY_NAMES[i], k);
+           ++i)
+        ;
+    }
+    assert(i < StatusKeys::MAX_KEY);
+    values_[i].clear();
+    w_ = make_unique<json::JsonWriter>(values_[i]);
+    return *this;
+  }
+
+  StatusValueWriter& string(const std::string& s)
+  {
+    w_->string(s);
+    return *this;
+  }
+
+  StatusValueWriter& integer(int64_t i)
+  {
+    w_->integer(i);
+    return *this;
+  }
+
+  StatusValueWriter& boolean(bool b)
+  {
+    w_->boolean(b);
+    return *this;
+  }
+
+private:
+  std::vector<std::string>& values_;
+  std::unique_ptr<json::JsonWriter> w_;
+  int depth_;
+};
+} // namespace
+
+bool writeStatusValues(std::vector<std::string>& values, a2_gid_t gid,
+                       DownloadEngine* e, const StatusKeys& keys)
+{
+  StatusValueWriter w(values);
+  return writeStatusOf(w, gid, e, keys);
+}
+
+std::unique_ptr<ValueBase> TellStatusRpcMethod::process(const RpcRequest& req,
                                                         DownloadEngine* e)
+{
+  ValueBaseWriter w;
+  writeStatus(w, req, e);
+  return w.getResult();
+}
+
+bool TellStatusRpcMethod::writeJson(const RpcRequest& req, DownloadEngine* e,
+                                    json::JsonWriter& w)
+{
+  writeStatus(w, req, e);
+  return true;
+}
+
+namespace {
+template <typename Writer>
+void writeActive(Writer& w, const RpcRequest& req, DownloadEngine* e)
 {
   const List* keysParam = checkParam<List>(req, 0);
-  std::vector<std::string> keys;
-  toStringList(std::back_inserter(keys), keysParam);
-  auto list = List::g();
-  bool statusReq = requested_key(keys, KEY_STATUS);
+  std::vector<std::string> keyList;
+  toStringList(std::back_inserter(keyList), keysParam);
+  StatusKeys keys(keyList);
+  const char* status = keys.has(StatusKeys::STATUS) ? VLB_ACTIVE : nullptr;
+  w.beginArray();
   for (auto& group : e->getRequestGroupMan()->getRequestGroups()) {
-    auto entryDict = Dict::g();
-    if (statusReq) {
-      entryDict->put(KEY_STATUS, VLB_ACTIVE);
-    }
-    gatherProgress(entryDict.get(), group, e, keys);
-    list->append(std::move(entryDict));
+    w.beginObject();
+    writeProgress(w, group, e, keys, status);
+    w.endObject();
   }
-  return std::move(list);
+  w.endArray();
+}
+} // namespace
+
+std::unique_ptr<ValueBase> TellActiveRpcMethod::process(const RpcRequest& req,
+                                                        DownloadEngine* e)
+{
+  ValueBaseWriter w;
+  writeActive(w, req, e);
+  return w.getResult();
+}
+
+bool TellActiveRpcMethod::writeJson(const RpcRequest& req, DownloadEngine* e,
+                                    json::JsonWriter& w)
+{
+  writeActive(w, req, e);
+  return true;
 }
 
 const RequestGroupList& TellWaitingRpcMethod::getItems(DownloadEngine* e) const
@@ -1058,19 +1476,42 @@ const RequestGroupList& TellWaitingRpcMethod::getItems(DownloadEngine* e) const
   return e->getRequestGroupMan()->getReservedGroups();
 }
 
-void TellWaitingRpcMethod::createEntry(
-    Dict* entryDict, const std::shared_ptr<RequestGroup>& item,
-    DownloadEngine* e, const std::vector<std::string>& keys) const
+namespace {
+template <typename Writer>
+void writeWaiting(Writer& w, a2_gid_t gid,
+                  const std::shared_ptr<RequestGroup>& item, DownloadEngine* e,
+                  const StatusKeys& keys)
 {
-  if (requested_key(keys, KEY_STATUS)) {
-    if (item->isPauseRequested()) {
-      entryDict->put(KEY_STATUS, VLB_PAUSED);
-    }
-    else {
-      entryDict->put(KEY_STATUS, VLB_WAITING);
-    }
+  w.beginObject();
+  if (item) {
+    writeProgress(w, item, e, keys,
+                  keys.has(StatusKeys::STATUS) ? getWaitingStatus(item)
+                                                  : nullptr);
   }
-  gatherProgress(entryDict, item, e, keys);
+  else {
+    auto lazy = e->getRequestGroupMan()->findLazyGroup(gid);
+    assert(lazy);
+    writeLazyProgress(w, *lazy, keys,
+                      keys.has(StatusKeys::STATUS) ? getWaitingStatus(*lazy)
+                                                   : nullptr);
+  }
+  w.endObject();
+}
+} // namespace
+
+void TellWaitingRpcMethod::createEntry(
+    ValueBaseWriter& w, a2_gid_t gid, const std::shared_ptr<RequestGroup>& item,
+    DownloadEngine* e, const StatusKeys& keys) const
+{
+  writeWaiting(w, gid, item, e, keys);
+}
+
+void TellWaitingRpcMethod::createEntry(
+    json::JsonWriter& w, a2_gid_t gid,
+    const std::shared_ptr<RequestGroup>& item, DownloadEngine* e,
+    const StatusKeys& keys) const
+{
+  writeWaiting(w, gid, item, e, keys);
 }
 
 const DownloadResultList&
@@ -1080,10 +1521,23 @@ TellStoppedRpcMethod::getItems(DownloadEngine* e) const
 }
 
 void TellStoppedRpcMethod::createEntry(
-    Dict* entryDict, const std::shared_ptr<DownloadResult>& item,
-    DownloadEngine* e, const std::vector<std::string>& keys) const
+    ValueBaseWriter& w, a2_gid_t gid,
+    const std::shared_ptr<DownloadResult>& item, DownloadEngine* e,
+    const StatusKeys& keys) const
+{
+  w.beginObject();
+  writeStoppedDownload(w, item, keys);
+  w.endObject();
+}
+
+void TellStoppedRpcMethod::createEntry(
+    json::JsonWriter& w, a2_gid_t gid,
+    const std::shared_ptr<DownloadResult>& item, DownloadEngine* e,
+    const StatusKeys& keys) const
 {
-  gatherStoppedDownload(entryDict, item, keys);
+  w.beginObject();
+  writeStoppedDownload(w, item, keys);
+  w.endObject();
 }
 
 std::unique_ptr<ValueBase>
@@ -1113,7 +1567,7 @@ std::unique_ptr<ValueBase> ChangeOptionRpcMethod::process(const RpcRequest& req,
   const Dict* optsParam = checkRequiredParam<Dict>(req, 1);
 
   a2_gid_t gid = str2Gid(gidParam);
-  auto group = e->getRequestGroupMan()->findGroup(gid);
+  auto group = e->getRequestGroupMan()->materializeGroup(gid);
   if (group) {
     Option option;
     std::shared_ptr<Option> pendingOption;
@@ -1190,10 +1644,16 @@ std::unique_ptr<ValueBase> GetOptionRpcMethod::process(const RpcRequest& req,
   const String* gidParam = checkRequiredParam<String>(req, 0);
 
   a2_gid_t gid = str2Gid(gidParam);
-  auto group = e->getRequestGroupMan()->findGroup(gid);
+  auto& rgman = e->getRequestGroupMan();
+  auto group = rgman->findGroup(gid);
   auto result = Dict::g();
   if (!group) {
-    auto dr = e->getRequestGroupMan()->findDownloadResult(gid);
+    auto lazy = rgman->findLazyGroup(gid);
+    if (lazy) {
+      pushRequestOption(result.get(), lazy->createOption(), getOptionParser());
+      return std::move(result);
+    }
+    auto dr = rgman->findDownloadResult(gid);
     if (!dr) {
       throw DL_ABORT_EX(
           fmt("Cannot get option for GID#%s", GroupId::toHex(gid).c_str()));
@@ -1210,7 +1670,7 @@ std::unique_ptr<ValueBase>
 GetGlobalOptionRpcMethod::process(const RpcRequest& req, DownloadEngine* e)
 {
   auto result = Dict::g();
-  for (size_t i = 0, len = e->getOption()->getTable().size(); i < len; ++i) {
+  for (size_t i = 0, len = option::countOption(); i < len; ++i) {
     PrefPtr pref = option::i2p(i);
     if (pref == PREF_RPC_SECRET || !e->getOption()->defined(pref)) {
       continue;
@@ -1306,7 +1766,7 @@ std::unique_ptr<ValueBase> ChangeUriRpcMethod::process(const RpcRequest& req,
   bool posGiven = checkPosParam(posParam);
   size_t pos = posGiven ? posParam->i() : 0;
   size_t index = indexParam->i() - 1;
-  auto group = e->getRequestGroupMan()->findGroup(gid);
+  auto group = e->getRequestGroupMan()->materializeGroup(gid);
   if (!group) {
     throw DL_ABORT_EX(
         fmt("Cannot remove URIs from GID#%s", GroupId::toHex(gid).c_str()));
@@ -1323,6 +1783,10 @@ std::unique_ptr<ValueBase> ChangeUriRpcMethod::process(const RpcRequest& req,
       ++delcount;
     }
   }
+  if (delcount && group->getState() == RequestGroup::STATE_ACTIVE) {
+    // Wake up the Commands which use the removed URIs.
+    e->setRefreshInterval(std::chrono::milliseconds(0));
+  }
   size_t addcount = 0;
   if (posGiven) {
     for (auto& elem : *addUrisParam) {
@@ -1390,9 +1854,121 @@ GetGlobalStatRpcMethod::process(const RpcRequest& req, DownloadEngine* e)
   res->put(KEY_NUM_STOPPED, util::uitos(rgman->getDownloadResults().size()));
   res->put(KEY_NUM_STOPPED_TOTAL, util::uitos(rgman->getNumStoppedTotal()));
   res->put(KEY_NUM_ACTIVE, util::uitos(rgman->getRequestGroups().size()));
+  auto wrDiskCache = rgman->getWrDiskCache();
+  if (wrDiskCache) {
+    const auto& stat = wrDiskCache->getStat();
+    auto cache = Dict::g();
+    cache->put(KEY_SIZE, util::uitos(wrDiskCache->getSize()));
+    cache->put(KEY_WRITES, util::uitos(stat.writes));
+    cache->put(KEY_HITS, util::uitos(stat.hits));
+    cache->put(KEY_FLUSHES, util::uitos(stat.flushes));
+    cache->put(KEY_EVICTIONS, util::uitos(stat.evictions));
+    cache->put(KEY_CELLS_FLUSHED, util::uitos(stat.cellsFlushed));
+    cache->put(KEY_WRITE_CALLS, util::uitos(stat.writeCalls));
+    cache->put(KEY_BYTES_FLUSHED, util::uitos(stat.bytesFlushed));
+    res->put(KEY_DISK_CACHE, std::move(cache));
+  }
+  auto rdDiskCache = rgman->getRdDiskCache();
+  if (rdDiskCache) {
+    const auto& stat = rdDiskCache->getStat();
+    auto cache = Dict::g();
+    cache->put(KEY_SIZE, util::uitos(rdDiskCache->getSize()));
+    cache->put(KEY_NUM_PIECE, util::uitos(rdDiskCache->countPiece()));
+    cache->put(KEY_HITS, util::uitos(stat.hits));
+    cache->put(KEY_MISSES, util::uitos(stat.misses));
+    cache->put(KEY_READAHEADS, util::uitos(stat.readaheads));
+    cache->put(KEY_EVICTIONS, util::uitos(stat.evictions));
+    cache->put(KEY_BYTES_SERVED, util::uitos(stat.bytesServed));
+    res->put(KEY_READ_CACHE, std::move(cache));
+  }
+  return std::move(res);
+}
+
+namespace {
+std::unique_ptr<Dict> createProfileStatDict(const CommandProfiler::Stat& stat)
+{
+  using namespace std::chrono;
+  auto dict = Dict::g();
+  dict->put(KEY_COUNT, util::uitos(stat.count));
+  dict->put(KEY_TOTAL_TIME,
+            util::itos(duration_cast<microseconds>(stat.total).count()));
+  dict->put(KEY_MAX_TIME,
+            util::itos(duration_cast<microseconds>(stat.max).count()));
+  return dict;
+}
+} // namespace
+
+std::unique_ptr<ValueBase>
+GetCommandProfileRpcMethod::process(const RpcRequest& req, DownloadEngine* e)
+{
+  auto profiler = e->getCommandProfiler();
+  if (!profiler) {
+    throw DL_ABORT_EX("Command profiling is disabled.");
+  }
+  auto res = Dict::g();
+  res->put(KEY_POLL, createProfileStatDict(profiler->getPollStat()));
+  auto commands = List::g();
+  for (auto& stat : profiler->getCommandStats()) {
+    auto dict = createProfileStatDict(stat.second);
+    dict->put(KEY_NAME, stat.first);
+    dict->put(KEY_IDLE_COUNT, util::uitos(stat.second.idle));
+    commands->append(std::move(dict));
+  }
+  res->put(KEY_COMMANDS, std::move(commands));
   return std::move(res);
 }
 
+std::unique_ptr<ValueBase> SubscribeRpcMethod::process(const RpcRequest& req,
+                                                       DownloadEngine* e)
+{
+  const List* gidsParam = checkParam<List>(req, 0);
+  const List* keysParam = checkParam<List>(req, 1);
+  const Integer* intervalParam = checkParam<Integer>(req, 2);
+
+  std::vector<a2_gid_t> gids;
+  if (gidsParam) {
+    for (auto& elem : *gidsParam) {
+      const String* gidParam = downcast<String>(elem);
+      if (!gidParam) {
+        throw DL_ABORT_EX("GID must be a string.");
+      }
+      gids.push_back(str2Gid(gidParam));
+    }
+  }
+  std::vector<std::string> keys;
+  toStringList(std::back_inserter(keys), keysParam);
+  std::chrono::milliseconds interval = 1_s;
+  if (intervalParam) {
+    // Shorter interval makes the event loop spin.
+    if (intervalParam->i() < 100) {
+      throw DL_ABORT_EX("Interval must be greater than or equal to 100.");
+    }
+    interval = std::chrono::milliseconds(intervalParam->i());
+  }
+#ifdef ENABLE_WEBSOCKET
+  if (req.wsSession) {
+    req.wsSession->setSubscription(make_unique<StatusSubscription>(
+        std::move(gids), std::move(keys), std::move(interval)));
+    return createOKResponse();
+  }
+#endif // ENABLE_WEBSOCKET
+  throw DL_ABORT_EX(
+      fmt("%s is only available over WebSocket.", getMethodName()));
+}
+
+std::unique_ptr<ValueBase>
+UnsubscribeRpcMethod::process(const RpcRequest& req, DownloadEngine* e)
+{
+#ifdef ENABLE_WEBSOCKET
+  if (req.wsSession) {
+    req.wsSession->setSubscription(nullptr);
+    return createOKResponse();
+  }
+#endif // ENABLE_WEBSOCKET
+  throw DL_ABORT_EX(
+      fmt("%s is only available over WebSocket.", getMethodName()));
+}
+
 std::unique_ptr<ValueBase> SaveSessionRpcMethod::process(const RpcRequest& req,
                                                          DownloadEngine* e)
 {
@@ -1418,61 +1994,125 @@ SystemMulticallRpcMethod::process(const RpcRequest& req, DownloadEngine* e)
   return nullptr;
 }
 
-RpcResponse SystemMulticallRpcMethod::execute(RpcRequest req, DownloadEngine* e)
+namespace {
+void writeCallResult(ValueBaseWriter& w, RpcResponse& res)
+{
+  if (res.code == 0) {
+    w.beginArray();
+    w.value(std::move(res.param));
+    w.endArray();
+  }
+  else {
+    w.value(std::move(res.param));
+  }
+}
+} // namespace
+
+namespace {
+void writeCallResult(json::JsonWriter& w, RpcResponse& res)
+{
+  if (res.code == 0) {
+    w.beginArray();
+  }
+  if (res.jsonParam.empty()) {
+    w.value(res.param.get());
+  }
+  else {
+    w.raw(res.jsonParam);
+  }
+  if (res.code == 0) {
+    w.endArray();
+  }
+}
+} // namespace
+
+namespace {
+void writeCallError(ValueBaseWriter& w, std::unique_ptr<ValueBase> error)
+{
+  w.value(std::move(error));
+}
+} // namespace
+
+namespace {
+void writeCallError(json::JsonWriter& w, std::unique_ptr<ValueBase> error)
+{
+  w.value(error.get());
+}
+} // namespace
+
+template <typename Writer>
+RpcResponse::authorization_t
+SystemMulticallRpcMethod::callMethods(Writer& w, const RpcRequest& req,
+                                      DownloadEngine* e)
 {
   auto authorized = RpcResponse::AUTHORIZED;
+  const List* methodSpecs = checkRequiredParam<List>(req, 0);
+  w.beginArray();
+  for (auto& methodSpec : *methodSpecs) {
+    Dict* methodDict = downcast<Dict>(methodSpec);
+    if (!methodDict) {
+      writeCallError(
+          w, createErrorResponse(
+                 DL_ABORT_EX("system.multicall expected struct."), req));
+      continue;
+    }
+    const String* methodName =
+        downcast<String>(methodDict->get(KEY_METHOD_NAME));
+    if (!methodName) {
+      writeCallError(
+          w, createErrorResponse(DL_ABORT_EX("Missing methodName."), req));
+      continue;
+    }
+    if (methodName->s() == getMethodName()) {
+      writeCallError(
+          w, createErrorResponse(
+                 DL_ABORT_EX("Recursive system.multicall forbidden."), req));
+      continue;
+    }
+    // TODO what if params missing?
+    auto tempParamsList = methodDict->get(KEY_PARAMS);
+    std::unique_ptr<List> paramsList;
+    if (downcast<List>(tempParamsList)) {
+      paramsList.reset(
+          static_cast<List*>(methodDict->popValue(KEY_PARAMS).release()));
+    }
+    else {
+      paramsList = List::g();
+    }
+    RpcRequest r = {methodName->s(), std::move(paramsList), nullptr,
+                    req.jsonRpc};
+    r.wsSession = req.wsSession;
+    RpcResponse res = getMethod(methodName->s())->execute(std::move(r), e);
+    if (rpc::not_authorized(res)) {
+      authorized = RpcResponse::NOTAUTHORIZED;
+    }
+    writeCallResult(w, res);
+  }
+  w.endArray();
+  return authorized;
+}
+
+RpcResponse SystemMulticallRpcMethod::execute(RpcRequest req, DownloadEngine* e)
+{
   try {
-    const List* methodSpecs = checkRequiredParam<List>(req, 0);
-    auto list = List::g();
-    for (auto& methodSpec : *methodSpecs) {
-      Dict* methodDict = downcast<Dict>(methodSpec);
-      if (!methodDict) {
-        list->append(createErrorResponse(
-            DL_ABORT_EX("system.multicall expected struct."), req));
-        continue;
-      }
-      const String* methodName =
-          downcast<String>(methodDict->get(KEY_METHOD_NAME));
-      if (!methodName) {
-        list->append(
-            createErrorResponse(DL_ABORT_EX("Missing methodName."), req));
-        continue;
-      }
-      if (methodName->s() == getMethodName()) {
-        list->append(createErrorResponse(
-            DL_ABORT_EX("Recursive system.multicall forbidden."), req));
-        continue;
-      }
-      // TODO what if params missing?
-      auto tempParamsList = methodDict->get(KEY_PARAMS);
-      std::unique_ptr<List> paramsList;
-      if (downcast<List>(tempParamsList)) {
-        paramsList.reset(
-            static_cast<List*>(methodDict->popValue(KEY_PARAMS).release()));
-      }
-      else {
-        paramsList = List::g();
-      }
-      RpcRequest r = {methodName->s(), std::move(paramsList), nullptr,
-                      req.jsonRpc};
-      RpcResponse res = getMethod(methodName->s())->execute(std::move(r), e);
-      if (rpc::not_authorized(res)) {
-        authorized = RpcResponse::NOTAUTHORIZED;
-      }
-      if (res.code == 0) {
-        auto l = List::g();
-        l->append(std::move(res.param));
-        list->append(std::move(l));
-      }
-      else {
-        list->append(std::move(res.param));
-      }
+    // The results of JSON-RPC calls are written as JSON text, so that
+    // the methods which support writeJson() are not converted to
+    // ValueBase here.
+    if (req.jsonRpc) {
+      std::string jsonParam;
+      json::JsonWriter w(jsonParam);
+      auto authorized = callMethods(w, req, e);
+      RpcResponse res(0, authorized, nullptr, std::move(req.id));
+      res.jsonParam = std::move(jsonParam);
+      return res;
     }
-    return RpcResponse(0, authorized, std::move(list), std::move(req.id));
+    ValueBaseWriter w;
+    auto authorized = callMethods(w, req, e);
+    return RpcResponse(0, authorized, w.getResult(), std::move(req.id));
   }
   catch (RecoverableException& ex) {
     A2_LOG_DEBUG_EX(EX_EXCEPTION_CAUGHT, ex);
-    return RpcResponse(1, authorized, createErrorResponse(ex, req),
+    return RpcResponse(1, RpcResponse::AUTHORIZED, createErrorResponse(ex, req),
                        std::move(req.id));
   }
 }
@@ -1685,6 +2325,9 @@ void changeGlobalOption(const Option& option, DownloadEngine* e)
     auto& openedFileCounter = e->getRequestGroupMan()->getOpenedFileCounter();
     openedFileCounter->setMaxOpenFiles(option.getAsInt(PREF_BT_MAX_OPEN_FILES));
   }
+  if (option.getAsBool(PREF_PROFILE_COMMANDS) && !e->getCommandProfiler()) {
+    e->setCommandProfiler(make_unique<CommandProfiler>());
+  }
 }
 
 } // namespace aria2
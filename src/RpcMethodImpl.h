@@ -42,6 +42,7 @@
 #include <algorithm>
 
 #include "RpcRequest.h"
+#include "RpcResponse.h"
 #include "ValueBase.h"
 #include "TorrentAttribute.h"
 #include "DlAbortEx.h"
@@ -49,6 +50,8 @@
 #include "IndexedList.h"
 #include "GroupId.h"
 #include "RequestGroupMan.h"
+#include "json.h"
+#include "ValueBaseWriter.h"
 
 namespace aria2 {
 
@@ -286,11 +289,60 @@ public:
   static const char* getMethodName() { return "aria2.getServers"; }
 };
 
+// The set of the keys of the download status object which the keys
+// parameter of tellStatus, tellActive, tellWaiting and tellStopped
+// selects. The values of the keys not in the set are not computed.
+class StatusKeys {
+public:
+  enum Key {
+    BELONGS_TO,
+    BITFIELD,
+    BITTORRENT,
+    COMPLETED_LENGTH,
+    CONNECTIONS,
+    DIR,
+    DOWNLOAD_SPEED,
+    ERROR_CODE,
+    ERROR_MESSAGE,
+    FILES,
+    FOLLOWED_BY,
+    FOLLOWING,
+    GID,
+    INFO_HASH,
+    NUM_PIECES,
+    NUM_SEEDERS,
+    PIECE_LENGTH,
+    SEEDER,
+    STATUS,
+    TOTAL_LENGTH,
+    UPLOAD_LENGTH,
+    UPLOAD_SPEED,
+    VERIFIED_LENGTH,
+    VERIFY_PENDING,
+    MAX_KEY
+  };
+
+  // If keys is empty, all keys are selected. Unknown keys are
+  // ignored.
+  explicit StatusKeys(const std::vector<std::string>& keys);
+
+  bool has(Key key) const { return (bits_ >> key) & 1; }
+
+  // Returns the name of key, such as "gid".
+  static const char* getName(Key key);
+
+private:
+  uint32_t bits_;
+};
+
 class TellStatusRpcMethod : public RpcMethod {
 protected:
   virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
                                              DownloadEngine* e) CXX11_OVERRIDE;
 
+  virtual bool writeJson(const RpcRequest& req, DownloadEngine* e,
+                         json::JsonWriter& w) CXX11_OVERRIDE;
+
 public:
   static const char* getMethodName() { return "aria2.tellStatus"; }
 };
@@ -300,6 +352,9 @@ protected:
   virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
                                              DownloadEngine* e) CXX11_OVERRIDE;
 
+  virtual bool writeJson(const RpcRequest& req, DownloadEngine* e,
+                         json::JsonWriter& w) CXX11_OVERRIDE;
+
 public:
   static const char* getMethodName() { return "aria2.tellActive"; }
 };
@@ -343,11 +398,8 @@ private:
     return std::make_pair(first, last);
   }
 
-protected:
-  typedef IndexedList<a2_gid_t, std::shared_ptr<T>> ItemListType;
-
-  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
-                                             DownloadEngine* e) CXX11_OVERRIDE
+  template <typename Writer>
+  void writeItems(Writer& w, const RpcRequest& req, DownloadEngine* e)
   {
     const Integer* offsetParam = checkRequiredParam<Integer>(req, 0);
     const Integer* numParam = checkRequiredInteger(req, 1, IntegerGE(0));
@@ -355,39 +407,75 @@ protected:
 
     int64_t offset = offsetParam->i();
     int64_t num = numParam->i();
-    std::vector<std::string> keys;
-    toStringList(std::back_inserter(keys), keysParam);
+    std::vector<std::string> keyList;
+    toStringList(std::back_inserter(keyList), keysParam);
+    StatusKeys keys(keyList);
     const ItemListType& items = getItems(e);
     auto range =
         getPaginationRange(offset, num, std::begin(items), std::end(items));
-    auto list = List::g();
-    for (; range.first != range.second; ++range.first) {
-      auto entryDict = Dict::g();
-      createEntry(entryDict.get(), *range.first, e, keys);
-      list->append(std::move(entryDict));
-    }
+    size_t first = std::distance(std::begin(items), range.first);
+    size_t last = std::distance(std::begin(items), range.second);
+    w.beginArray();
     if (offset < 0) {
-      std::reverse(list->begin(), list->end());
+      // The items are returned in the reverse order.
+      while (first != last) {
+        --last;
+        createEntry(w, items.getKey(last), items[last], e, keys);
+      }
+    }
+    else {
+      for (; first != last; ++first) {
+        createEntry(w, items.getKey(first), items[first], e, keys);
+      }
     }
-    return std::move(list);
+    w.endArray();
+  }
+
+protected:
+  typedef IndexedList<a2_gid_t, std::shared_ptr<T>> ItemListType;
+
+  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
+                                             DownloadEngine* e) CXX11_OVERRIDE
+  {
+    ValueBaseWriter w;
+    writeItems(w, req, e);
+    return w.getResult();
+  }
+
+  virtual bool writeJson(const RpcRequest& req, DownloadEngine* e,
+                         json::JsonWriter& w) CXX11_OVERRIDE
+  {
+    writeItems(w, req, e);
+    return true;
   }
 
   virtual const ItemListType& getItems(DownloadEngine* e) const = 0;
 
-  virtual void createEntry(Dict* entryDict, const std::shared_ptr<T>& item,
-                           DownloadEngine* e,
-                           const std::vector<std::string>& keys) const = 0;
+  // Writes the object of item, whose key in getItems() is gid, to w.
+  virtual void createEntry(ValueBaseWriter& w, a2_gid_t gid,
+                           const std::shared_ptr<T>& item, DownloadEngine* e,
+                           const StatusKeys& keys) const = 0;
+
+  virtual void createEntry(json::JsonWriter& w, a2_gid_t gid,
+                           const std::shared_ptr<T>& item, DownloadEngine* e,
+                           const StatusKeys& keys) const = 0;
 };
 
 class TellWaitingRpcMethod : public AbstractPaginationRpcMethod<RequestGroup> {
 protected:
+  // The items of lazily represented downloads are nullptr.
   virtual const RequestGroupList&
   getItems(DownloadEngine* e) const CXX11_OVERRIDE;
 
-  virtual void
-  createEntry(Dict* entryDict, const std::shared_ptr<RequestGroup>& item,
-              DownloadEngine* e,
-              const std::vector<std::string>& keys) const CXX11_OVERRIDE;
+  virtual void createEntry(ValueBaseWriter& w, a2_gid_t gid,
+                           const std::shared_ptr<RequestGroup>& item,
+                           DownloadEngine* e,
+                           const StatusKeys& keys) const CXX11_OVERRIDE;
+
+  virtual void createEntry(json::JsonWriter& w, a2_gid_t gid,
+                           const std::shared_ptr<RequestGroup>& item,
+                           DownloadEngine* e,
+                           const StatusKeys& keys) const CXX11_OVERRIDE;
 
 public:
   static const char* getMethodName() { return "aria2.tellWaiting"; }
@@ -399,10 +487,15 @@ protected:
   virtual const DownloadResultList&
   getItems(DownloadEngine* e) const CXX11_OVERRIDE;
 
-  virtual void
-  createEntry(Dict* entryDict, const std::shared_ptr<DownloadResult>& item,
-              DownloadEngine* e,
-              const std::vector<std::string>& keys) const CXX11_OVERRIDE;
+  virtual void createEntry(ValueBaseWriter& w, a2_gid_t gid,
+                           const std::shared_ptr<DownloadResult>& item,
+                           DownloadEngine* e,
+                           const StatusKeys& keys) const CXX11_OVERRIDE;
+
+  virtual void createEntry(json::JsonWriter& w, a2_gid_t gid,
+                           const std::shared_ptr<DownloadResult>& item,
+                           DownloadEngine* e,
+                           const StatusKeys& keys) const CXX11_OVERRIDE;
 
 public:
   static const char* getMethodName() { return "aria2.tellStopped"; }
@@ -498,6 +591,33 @@ public:
   static const char* getMethodName() { return "aria2.getGlobalStat"; }
 };
 
+class GetCommandProfileRpcMethod : public RpcMethod {
+protected:
+  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
+                                             DownloadEngine* e) CXX11_OVERRIDE;
+
+public:
+  static const char* getMethodName() { return "aria2.getCommandProfile"; }
+};
+
+class SubscribeRpcMethod : public RpcMethod {
+protected:
+  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
+                                             DownloadEngine* e) CXX11_OVERRIDE;
+
+public:
+  static const char* getMethodName() { return "aria2.subscribe"; }
+};
+
+class UnsubscribeRpcMethod : public RpcMethod {
+protected:
+  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
+                                             DownloadEngine* e) CXX11_OVERRIDE;
+
+public:
+  static const char* getMethodName() { return "aria2.unsubscribe"; }
+};
+
 class ForceShutdownRpcMethod : public RpcMethod {
 protected:
   virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
@@ -517,6 +637,11 @@ public:
 };
 
 class SystemMulticallRpcMethod : public RpcMethod {
+private:
+  template <typename Writer>
+  RpcResponse::authorization_t
+  callMethods(Writer& w, const RpcRequest& req, DownloadEngine* e);
+
 protected:
   virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
                                              DownloadEngine* e) CXX11_OVERRIDE;
@@ -567,6 +692,13 @@ void gatherProgressCommon(Dict* entryDict,
                           const std::shared_ptr<RequestGroup>& group,
                           const std::vector<std::string>& keys);
 
+// Writes the value of each key of the status of the download gid,
+// which tellStatus returns, in JSON to values indexed by
+// StatusKeys::Key.  The values must have StatusKeys::MAX_KEY
+// elements.  Returns false if there is no such download.
+bool writeStatusValues(std::vector<std::string>& values, a2_gid_t gid,
+                       DownloadEngine* e, const StatusKeys& keys);
+
 #ifdef ENABLE_BITTORRENT
 // Helper function to store BitTorrent metadata from torrentAttrs.
 void gatherBitTorrentMetadata(Dict* btDict, TorrentAttribute* torrentAttrs);
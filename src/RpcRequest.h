@@ -45,11 +45,16 @@ namespace aria2 {
 
 namespace rpc {
 
+class WebSocketSession;
+
 struct RpcRequest {
   std::string methodName;
   std::unique_ptr<List> params;
   std::unique_ptr<ValueBase> id;
   bool jsonRpc;
+  // The WebSocket session which the request is received from, or
+  // nullptr.
+  WebSocketSession* wsSession;
 
   RpcRequest();
 
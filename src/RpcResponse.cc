@@ -151,96 +151,80 @@ std::string toXml(const RpcResponse& res, bool gzip)
 }
 
 namespace {
-template <typename OutputStream>
-OutputStream& encodeJsonAll(OutputStream& o, int code, const ValueBase* param,
-                            const ValueBase* id,
-                            const std::string& callback = A2STR::NIL)
+void encodeJsonAll(json::JsonWriter& w, const RpcResponse& res)
 {
-  if (!callback.empty()) {
-    o << callback << "(";
+  w.beginObject();
+  w.key("id").value(res.id.get());
+  w.key("jsonrpc").string("2.0");
+  if (res.code == 0) {
+    w.key("result");
   }
-  o << "{\"id\":";
-  json::encode(o, id);
-  o << ",\"jsonrpc\":\"2.0\",";
-  if (code == 0) {
-    o << "\"result\":";
+  else {
+    w.key("error");
+  }
+  if (res.jsonParam.empty()) {
+    w.value(res.param.get());
   }
   else {
-    o << "\"error\":";
+    w.raw(res.jsonParam);
   }
-  json::encode(o, param);
-  o << "}";
+  w.endObject();
+}
+} // namespace
+
+namespace {
+std::string beginJson(const std::string& callback)
+{
+  std::string out;
   if (!callback.empty()) {
-    o << ")";
+    out += callback;
+    out += "(";
   }
-  return o;
+  return out;
 }
 } // namespace
 
-std::string toJson(const RpcResponse& res, const std::string& callback,
-                   bool gzip)
+namespace {
+// Closes JSONP |callback| if it is not empty, and compresses |out| if
+// |gzip| is true.
+std::string endJson(std::string out, const std::string& callback, bool gzip)
 {
+  if (!callback.empty()) {
+    out += ")";
+  }
   if (gzip) {
 #ifdef HAVE_ZLIB
     GZipEncoder o;
     o.init();
-    return encodeJsonAll(o, res.code, res.param.get(), res.id.get(), callback)
-        .str();
+    return o.write(out.data(), out.size()).str();
 #else  // !HAVE_ZLIB
     abort();
 #endif // !HAVE_ZLIB
   }
-  else {
-    std::stringstream o;
-    return encodeJsonAll(o, res.code, res.param.get(), res.id.get(), callback)
-        .str();
-  }
+  return out;
 }
+} // namespace
 
-namespace {
-template <typename OutputStream>
-OutputStream& encodeJsonBatchAll(OutputStream& o,
-                                 const std::vector<RpcResponse>& results,
-                                 const std::string& callback)
+std::string toJson(const RpcResponse& res, const std::string& callback,
+                   bool gzip)
 {
-  if (!callback.empty()) {
-    o << callback << "(";
-  }
-  o << "[";
-  if (!results.empty()) {
-    encodeJsonAll(o, results[0].code, results[0].param.get(),
-                  results[0].id.get());
-
-    for (auto i = std::begin(results) + 1, eoi = std::end(results); i != eoi;
-         ++i) {
-      o << ",";
-      encodeJsonAll(o, (*i).code, (*i).param.get(), (*i).id.get());
-    }
-  }
-  o << "]";
-  if (!callback.empty()) {
-    o << ")";
-  }
-  return o;
+  auto out = beginJson(callback);
+  json::JsonWriter w(out);
+  encodeJsonAll(w, res);
+  return endJson(std::move(out), callback, gzip);
 }
-} // namespace
 
 std::string toJsonBatch(const std::vector<RpcResponse>& results,
                         const std::string& callback, bool gzip)
 {
-  if (gzip) {
-#ifdef HAVE_ZLIB
-    GZipEncoder o;
-    o.init();
-    return encodeJsonBatchAll(o, results, callback).str();
-#else  // !HAVE_ZLIB
-    abort();
-#endif // !HAVE_ZLIB
-  }
-  else {
-    std::stringstream o;
-    return encodeJsonBatchAll(o, results, callback).str();
+  auto out = beginJson(callback);
+  json::JsonWriter w(out);
+  w.beginArray();
+  for (auto& res : results) {
+    encodeJsonAll(w, res);
   }
+  w.endArray();
+  return endJson(std::move(out), callback, gzip);
 }
 
 } // namespace rpc
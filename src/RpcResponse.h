@@ -51,6 +51,9 @@ struct RpcResponse {
 
   // 0 for success, non-zero for error
   std::unique_ptr<ValueBase> param;
+  // The result encoded in JSON.  If it is not empty, it is sent
+  // instead of param.  See RpcMethod::writeJson().
+  std::string jsonParam;
   std::unique_ptr<ValueBase> id;
   int code;
   authorization_t authorized;
@@ -40,29 +40,74 @@
 #include <deque>
 #include <memory>
 #include <functional>
+#include <algorithm>
 
 namespace aria2 {
 
 template <typename T> class SequentialPicker {
 private:
   std::deque<std::unique_ptr<T>> entries_;
-  std::unique_ptr<T> pickedEntry_;
+  std::deque<std::unique_ptr<T>> pickedEntries_;
+  // The maximum number of entries which can be picked at the same
+  // time.
+  size_t maxPicked_;
 
 public:
-  bool isPicked() const { return pickedEntry_.get(); }
+  SequentialPicker() : maxPicked_(1) {}
 
-  const std::unique_ptr<T>& getPickedEntry() const { return pickedEntry_; }
+  bool isPicked() const { return !pickedEntries_.empty(); }
 
-  void dropPickedEntry() { pickedEntry_.reset(); }
+  // Returns the entry picked first, or nullptr if no entry is picked.
+  T* getPickedEntry() const
+  {
+    return pickedEntries_.empty() ? nullptr : pickedEntries_.front().get();
+  }
+
+  const std::deque<std::unique_ptr<T>>& getPickedEntries() const
+  {
+    return pickedEntries_;
+  }
+
+  void dropPickedEntry()
+  {
+    if (!pickedEntries_.empty()) {
+      pickedEntries_.pop_front();
+    }
+  }
+
+  void dropPickedEntry(const T* entry)
+  {
+    for (auto i = std::begin(pickedEntries_); i != std::end(pickedEntries_);
+         ++i) {
+      if ((*i).get() == entry) {
+        pickedEntries_.erase(i);
+        return;
+      }
+    }
+  }
+
+  void setMaxPicked(size_t maxPicked)
+  {
+    maxPicked_ = std::max<size_t>(1, maxPicked);
+  }
+
+  size_t getMaxPicked() const { return maxPicked_; }
+
+  // Returns true if there is a queued entry and another entry can be
+  // picked now.
+  bool canPickNext() const
+  {
+    return hasNext() && pickedEntries_.size() < maxPicked_;
+  }
 
   bool hasNext() const { return !entries_.empty(); }
 
   T* pickNext()
   {
     if (hasNext()) {
-      pickedEntry_ = std::move(entries_.front());
+      pickedEntries_.push_back(std::move(entries_.front()));
       entries_.pop_front();
-      return pickedEntry_.get();
+      return pickedEntries_.back().get();
     }
     return nullptr;
   }
@@ -76,7 +121,17 @@ public:
 
   bool isPicked(const std::function<bool(const T&)>& pred) const
   {
-    return pickedEntry_ && pred(*pickedEntry_);
+    return findPickedEntry(pred);
+  }
+
+  T* findPickedEntry(const std::function<bool(const T&)>& pred) const
+  {
+    for (auto& e : pickedEntries_) {
+      if (pred(*e)) {
+        return e.get();
+      }
+    }
+    return nullptr;
   }
 
   bool isQueued(const std::function<bool(const T&)>& pred) const
@@ -54,6 +54,7 @@
 #include "OptionParser.h"
 #include "OptionHandler.h"
 #include "SHA1IOFile.h"
+#include "LazyRequestGroup.h"
 
 #if HAVE_ZLIB
 #  include "GZipFile.h"
@@ -107,6 +108,30 @@ bool writeOptionLine(IOFile& fp, PrefPtr pref, const std::string& val)
 }
 } // namespace
 
+namespace {
+// Write option |pref| whose value is |val|.  The value of cumulative
+// option is written 1 line per item.
+bool writeOption(IOFile& fp, PrefPtr pref, const OptionHandler* h,
+                 const std::string& val)
+{
+  if (h->getCumulative()) {
+    std::vector<std::string> v;
+    util::split(val.begin(), val.end(), std::back_inserter(v), '\n', false,
+                false);
+    for (std::vector<std::string>::const_iterator j = v.begin(), eoj = v.end();
+         j != eoj; ++j) {
+      if (!writeOptionLine(fp, pref, *j)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  else {
+    return writeOptionLine(fp, pref, val);
+  }
+}
+} // namespace
+
 namespace {
 bool writeOption(IOFile& fp, const std::shared_ptr<Option>& op)
 {
@@ -115,24 +140,43 @@ bool writeOption(IOFile& fp, const std::shared_ptr<Option>& op)
     PrefPtr pref = option::i2p(i);
     const OptionHandler* h = oparser->find(pref);
     if (h && h->getInitialOption() && op->definedLocal(pref)) {
-      if (h->getCumulative()) {
-        const std::string& val = op->get(pref);
-        std::vector<std::string> v;
-        util::split(val.begin(), val.end(), std::back_inserter(v), '\n', false,
-                    false);
-        for (std::vector<std::string>::const_iterator j = v.begin(),
-                                                      eoj = v.end();
-             j != eoj; ++j) {
-          if (!writeOptionLine(fp, pref, *j)) {
-            return false;
-          }
-        }
+      if (!writeOption(fp, pref, h, op->get(pref))) {
+        return false;
       }
-      else {
-        if (!writeOptionLine(fp, pref, op->get(pref))) {
-          return false;
-        }
+    }
+  }
+  return true;
+}
+} // namespace
+
+namespace {
+// Write options of |lazy|, which are its global option snapshot
+// overridden by its option delta.  This produces the same output as
+// writeOption() does for the materialized RequestGroup.
+bool writeOption(IOFile& fp, const LazyRequestGroup& lazy)
+{
+  const Option& globalOption = *lazy.getGlobalOption();
+  const std::shared_ptr<OptionParser>& oparser = OptionParser::getInstance();
+  for (size_t i = 1, len = option::countOption(); i < len; ++i) {
+    PrefPtr pref = option::i2p(i);
+    // PREF_GID and PREF_PAUSE are one-shot options, and written
+    // separately.
+    if (pref == PREF_GID || pref == PREF_PAUSE) {
+      continue;
+    }
+    const OptionHandler* h = oparser->find(pref);
+    if (!h || !h->getInitialOption()) {
+      continue;
+    }
+    const std::string* val = lazy.findOption(pref);
+    if (!val) {
+      if (!globalOption.definedLocal(pref)) {
+        continue;
       }
+      val = &globalOption.get(pref);
+    }
+    if (!writeOption(fp, pref, h, *val)) {
+      return false;
     }
   }
   return true;
@@ -270,6 +314,28 @@ bool writeDownloadResult(IOFile& fp, std::set<a2_gid_t>& metainfoCache,
 }
 } // namespace
 
+namespace {
+bool writeLazyRequestGroup(IOFile& fp, const LazyRequestGroup& lazy)
+{
+  {
+    Unique<std::string> unique;
+    if (!writeUri(fp, lazy.getUris().begin(), lazy.getUris().end(), unique)) {
+      return false;
+    }
+  }
+  if (fp.write("\n", 1) != 1 ||
+      !writeOptionLine(fp, PREF_GID, lazy.getGroupId()->toHex())) {
+    return false;
+  }
+  if (lazy.isPauseRequested()) {
+    if (!writeOptionLine(fp, PREF_PAUSE, A2_V_TRUE)) {
+      return false;
+    }
+  }
+  return writeOption(fp, lazy);
+}
+} // namespace
+
 namespace {
 template <typename InputIt>
 bool saveDownloadResult(IOFile& fp, std::set<a2_gid_t>& metainfoCache,
@@ -338,7 +404,15 @@ bool SessionSerializer::save(IOFile& fp) const
   }
   if (saveWaiting_) {
     const auto& groups = rgman_->getReservedGroups();
-    for (const auto& rg : groups) {
+    for (size_t i = 0, len = groups.size(); i < len; ++i) {
+      const auto& rg = groups[i];
+      if (!rg) {
+        auto lazy = rgman_->findLazyGroup(groups.getKey(i));
+        if (!writeLazyRequestGroup(fp, *lazy)) {
+          return false;
+        }
+        continue;
+      }
       auto result = rg->createDownloadResult();
       if (!writeDownloadResult(fp, metainfoCache, result,
                                rg->isPauseRequested())) {
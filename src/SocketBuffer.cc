@@ -43,6 +43,9 @@
 #include "fmt.h"
 #include "LogFactory.h"
 #include "a2functional.h"
+#ifdef HAVE_SENDFILE
+#  include "FileHandle.h"
+#endif // HAVE_SENDFILE
 
 namespace aria2 {
 
@@ -102,6 +105,45 @@ const unsigned char* SocketBuffer::StringBufEntry::getData() const
   return reinterpret_cast<const unsigned char*>(str_.c_str());
 }
 
+#ifdef HAVE_SENDFILE
+SocketBuffer::FileBufEntry::FileBufEntry(
+    std::shared_ptr<FileHandle> fileHandle, int64_t fileOffset, size_t length,
+    std::unique_ptr<ProgressUpdate> progressUpdate)
+    : BufEntry(std::move(progressUpdate)),
+      fileHandle_(std::move(fileHandle)),
+      fileOffset_(fileOffset),
+      length_(length)
+{
+}
+
+SocketBuffer::FileBufEntry::~FileBufEntry() = default;
+
+ssize_t
+SocketBuffer::FileBufEntry::send(const std::shared_ptr<SocketCore>& socket,
+                                 size_t offset)
+{
+  ssize_t slen = socket->sendFile(fileHandle_->getFd(), fileOffset_ + offset,
+                                  length_ - offset);
+  if (slen == 0 && !socket->wantWrite()) {
+    // The file is shorter than expected.
+    throw DL_ABORT_EX(EX_DATA_READ);
+  }
+  return slen;
+}
+
+bool SocketBuffer::FileBufEntry::final(size_t offset) const
+{
+  return length_ <= offset;
+}
+
+size_t SocketBuffer::FileBufEntry::getLength() const { return length_; }
+
+const unsigned char* SocketBuffer::FileBufEntry::getData() const
+{
+  return nullptr;
+}
+#endif // HAVE_SENDFILE
+
 SocketBuffer::SocketBuffer(std::shared_ptr<SocketCore> socket)
     : socket_(std::move(socket)), offset_(0)
 {
@@ -127,6 +169,18 @@ void SocketBuffer::pushStr(std::string data,
   }
 }
 
+#ifdef HAVE_SENDFILE
+void SocketBuffer::pushFileRange(std::shared_ptr<FileHandle> fileHandle,
+                                 int64_t fileOffset, size_t length,
+                                 std::unique_ptr<ProgressUpdate> progressUpdate)
+{
+  if (length > 0) {
+    bufq_.push_back(make_unique<FileBufEntry>(
+        std::move(fileHandle), fileOffset, length, std::move(progressUpdate)));
+  }
+}
+#endif // HAVE_SENDFILE
+
 ssize_t SocketBuffer::send()
 {
   a2iovec iov[A2_IOV_MAX];
@@ -136,6 +190,22 @@ ssize_t SocketBuffer::send()
     size_t bufqlen = bufq_.size();
     ssize_t amount = 24_k;
     ssize_t firstlen = bufq_.front()->getLength() - offset_;
+    if (!bufq_.front()->getData()) {
+      ssize_t slen = bufq_.front()->send(socket_, offset_);
+      totalslen += slen;
+      if (firstlen > slen) {
+        offset_ += slen;
+        bufq_.front()->progressUpdate(slen, false);
+        if (socket_->wantWrite()) {
+          goto fin;
+        }
+        continue;
+      }
+      bufq_.front()->progressUpdate(firstlen, true);
+      bufq_.pop_front();
+      offset_ = 0;
+      continue;
+    }
     amount -= firstlen;
     iov[0].A2IOVEC_BASE = reinterpret_cast<char*>(
         const_cast<unsigned char*>(bufq_.front()->getData() + offset_));
@@ -147,7 +217,7 @@ ssize_t SocketBuffer::send()
 
       ssize_t len = (*i)->getLength();
 
-      if (amount < len) {
+      if (amount < len || !(*i)->getData()) {
         break;
       }
 
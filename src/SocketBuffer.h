@@ -45,6 +45,9 @@
 namespace aria2 {
 
 class SocketCore;
+#ifdef HAVE_SENDFILE
+class FileHandle;
+#endif // HAVE_SENDFILE
 
 struct ProgressUpdate {
   virtual ~ProgressUpdate() = default;
@@ -64,6 +67,8 @@ private:
                          size_t offset) = 0;
     virtual bool final(size_t offset) const = 0;
     virtual size_t getLength() const = 0;
+    // Returns nullptr if the data is not in memory.  Such entry is
+    // sent alone by its send().
     virtual const unsigned char* getData() const = 0;
     void progressUpdate(size_t length, bool complete)
     {
@@ -105,6 +110,25 @@ private:
     std::string str_;
   };
 
+#ifdef HAVE_SENDFILE
+  class FileBufEntry : public BufEntry {
+  public:
+    FileBufEntry(std::shared_ptr<FileHandle> fileHandle, int64_t fileOffset,
+                 size_t length, std::unique_ptr<ProgressUpdate> progressUpdate);
+    virtual ~FileBufEntry();
+    virtual ssize_t send(const std::shared_ptr<SocketCore>& socket,
+                         size_t offset) CXX11_OVERRIDE;
+    virtual bool final(size_t offset) const CXX11_OVERRIDE;
+    virtual size_t getLength() const CXX11_OVERRIDE;
+    virtual const unsigned char* getData() const CXX11_OVERRIDE;
+
+  private:
+    std::shared_ptr<FileHandle> fileHandle_;
+    int64_t fileOffset_;
+    size_t length_;
+  };
+#endif // HAVE_SENDFILE
+
   std::shared_ptr<SocketCore> socket_;
 
   std::deque<std::unique_ptr<BufEntry>> bufq_;
@@ -137,6 +161,16 @@ public:
   void pushStr(std::string data,
                std::unique_ptr<ProgressUpdate> progressUpdate = nullptr);
 
+#ifdef HAVE_SENDFILE
+  // Feeds |length| bytes of the file |fileHandle| starting at
+  // |fileOffset| into queue.  The data is sent using sendfile(2), so
+  // the socket must not be a secure one.  |progressUpdate| is treated
+  // as in pushBytes().
+  void pushFileRange(std::shared_ptr<FileHandle> fileHandle,
+                     int64_t fileOffset, size_t length,
+                     std::unique_ptr<ProgressUpdate> progressUpdate = nullptr);
+#endif // HAVE_SENDFILE
+
   // Sends data in queue.  Returns the number of bytes sent.
   ssize_t send();
 
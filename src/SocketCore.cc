@@ -39,6 +39,12 @@
 #endif // HAVE_IPHLPAPI_H
 
 #include <unistd.h>
+#ifdef HAVE_SENDFILE
+#  include <sys/sendfile.h>
+#endif // HAVE_SENDFILE
+#ifdef HAVE_SPLICE
+#  include <fcntl.h>
+#endif // HAVE_SPLICE
 #ifdef HAVE_IFADDRS_H
 #  include <ifaddrs.h>
 #endif // HAVE_IFADDRS_H
@@ -48,6 +54,7 @@
 #include <cassert>
 #include <sstream>
 #include <array>
+#include <algorithm>
 
 #include "message.h"
 #include "DlRetryEx.h"
@@ -136,6 +143,8 @@ std::vector<std::vector<SockAddr>>::iterator SocketCore::bindAddrsListIt_;
 
 int SocketCore::socketRecvBufferSize_ = 0;
 
+size_t SocketCore::numOpenSockets_ = 0;
+
 #ifdef ENABLE_SSL
 std::shared_ptr<TLSContext> SocketCore::clTlsContext_;
 std::shared_ptr<TLSContext> SocketCore::svTlsContext_;
@@ -159,9 +168,10 @@ SocketCore::SocketCore(int sockType) : sockType_(sockType), sockfd_(-1)
 }
 
 SocketCore::SocketCore(sock_t sockfd, int sockType)
-    : sockType_(sockType), sockfd_(sockfd)
+    : sockType_(sockType), sockfd_(-1)
 {
   init();
+  setSockfd(sockfd);
 }
 
 void SocketCore::init()
@@ -214,7 +224,7 @@ void SocketCore::create(int family, int protocol)
 
   applySocketBufferSize(fd);
 
-  sockfd_ = fd;
+  setSockfd(fd);
 }
 
 static sock_t bindInternal(int family, int socktype, int protocol,
@@ -292,7 +302,7 @@ void SocketCore::bindWithFamily(uint16_t port, int family, int flags)
   if (fd == (sock_t)-1) {
     throw DL_ABORT_EX(fmt(EX_SOCKET_BIND, error.c_str()));
   }
-  sockfd_ = fd;
+  setSockfd(fd);
 }
 
 void SocketCore::bind(const char* addr, uint16_t port, int family, int flags)
@@ -311,7 +321,7 @@ void SocketCore::bind(const char* addr, uint16_t port, int family, int flags)
     if (fd == (sock_t)-1) {
       throw DL_ABORT_EX(fmt(EX_SOCKET_BIND, error.c_str()));
     }
-    sockfd_ = fd;
+    setSockfd(fd);
     return;
   }
 
@@ -333,7 +343,7 @@ void SocketCore::bind(const char* addr, uint16_t port, int family, int flags)
       }
       auto fd = bindTo(host.data(), port, family, sockType_, flags, error);
       if (fd != (sock_t)-1) {
-        sockfd_ = fd;
+        setSockfd(fd);
         return;
       }
     }
@@ -357,7 +367,7 @@ void SocketCore::bind(const struct sockaddr* addr, socklen_t addrlen)
   if (fd == (sock_t)-1) {
     throw DL_ABORT_EX(fmt(EX_SOCKET_BIND, error.c_str()));
   }
-  sockfd_ = fd;
+  setSockfd(fd);
 }
 
 void SocketCore::beginListen()
@@ -485,7 +495,7 @@ void SocketCore::establishConnection(const std::string& host, uint16_t port,
       bindAddrs_ = *bindAddrsListIt_;
     }
 
-    sockfd_ = fd;
+    setSockfd(fd);
     // make socket non-blocking mode
     setNonBlockingMode();
     if (tcpNodelay) {
@@ -496,7 +506,7 @@ void SocketCore::establishConnection(const std::string& host, uint16_t port,
       errNum = SOCKET_ERRNO;
       error = errorMsg(errNum);
       CLOSE(sockfd_);
-      sockfd_ = (sock_t)-1;
+      setSockfd(-1);
       continue;
     }
     // TODO at this point, connection may not be established and it may fail
@@ -650,7 +660,18 @@ void SocketCore::closeConnection()
   if (sockfd_ != (sock_t)-1) {
     shutdown(sockfd_, SHUT_WR);
     CLOSE(sockfd_);
-    sockfd_ = -1;
+    setSockfd(-1);
+  }
+}
+
+void SocketCore::setSockfd(sock_t fd)
+{
+  if (sockfd_ != (sock_t)-1) {
+    --numOpenSockets_;
+  }
+  sockfd_ = fd;
+  if (sockfd_ != (sock_t)-1) {
+    ++numOpenSockets_;
   }
 }
 
@@ -796,6 +817,51 @@ ssize_t SocketCore::writeVector(a2iovec* iov, size_t iovcnt)
   return ret;
 }
 
+#ifdef HAVE_SENDFILE
+ssize_t SocketCore::sendFile(int fd, int64_t offset, size_t len)
+{
+  assert(!secure_);
+  ssize_t ret;
+  wantRead_ = false;
+  wantWrite_ = false;
+  off_t off = offset;
+  while ((ret = sendfile(sockfd_, fd, &off, len)) == -1 && errno == EINTR)
+    ;
+  int errNum = errno;
+  if (ret == -1) {
+    if (!A2_WOULDBLOCK(errNum)) {
+      throw DL_RETRY_EX(fmt(EX_SOCKET_SEND, errorMsg(errNum).c_str()));
+    }
+    wantWrite_ = true;
+    ret = 0;
+  }
+  return ret;
+}
+#endif // HAVE_SENDFILE
+
+#ifdef HAVE_SPLICE
+ssize_t SocketCore::spliceData(int pipefd, size_t len)
+{
+  assert(!secure_);
+  ssize_t ret;
+  wantRead_ = false;
+  wantWrite_ = false;
+  while ((ret = splice(sockfd_, nullptr, pipefd, nullptr, len,
+                       SPLICE_F_MOVE | SPLICE_F_NONBLOCK)) == -1 &&
+         errno == EINTR)
+    ;
+  int errNum = errno;
+  if (ret == -1) {
+    if (!A2_WOULDBLOCK(errNum)) {
+      throw DL_RETRY_EX(fmt(EX_SOCKET_RECV, errorMsg(errNum).c_str()));
+    }
+    wantRead_ = true;
+    ret = 0;
+  }
+  return ret;
+}
+#endif // HAVE_SPLICE
+
 ssize_t SocketCore::writeData(const void* data, size_t len)
 {
   ssize_t ret = 0;
@@ -1252,6 +1318,150 @@ ssize_t SocketCore::readDataFrom(void* data, size_t len, Endpoint& sender)
   return r;
 }
 
+const size_t SocketCore::MAX_DATAGRAM_BATCH;
+
+size_t SocketCore::readDataFromMany(unsigned char* data, size_t len,
+                                    size_t num, size_t* lengths,
+                                    Endpoint* senders)
+{
+  wantRead_ = false;
+  wantWrite_ = false;
+  size_t total = 0;
+#ifdef HAVE_RECVMMSG
+  while (total < num) {
+    std::array<mmsghdr, MAX_DATAGRAM_BATCH> msgs;
+    std::array<iovec, MAX_DATAGRAM_BATCH> iovs;
+    std::array<sockaddr_union, MAX_DATAGRAM_BATCH> addrs;
+    size_t n = std::min(num - total, MAX_DATAGRAM_BATCH);
+    memset(msgs.data(), 0, sizeof(mmsghdr) * n);
+    for (size_t i = 0; i < n; ++i) {
+      iovs[i].iov_base = data + (total + i) * len;
+      iovs[i].iov_len = len;
+      msgs[i].msg_hdr.msg_name = &addrs[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    int r;
+    while ((r = recvmmsg(sockfd_, msgs.data(), n, 0, nullptr)) == -1 &&
+           errno == EINTR)
+      ;
+    if (r == -1) {
+      int errNum = errno;
+      if (!A2_WOULDBLOCK(errNum)) {
+        if (total > 0) {
+          // Report the error in the next call.
+          break;
+        }
+        throw DL_RETRY_EX(fmt(EX_SOCKET_RECV, errorMsg(errNum).c_str()));
+      }
+      wantRead_ = true;
+      break;
+    }
+    for (int i = 0; i < r; ++i) {
+      lengths[total + i] = msgs[i].msg_len;
+      senders[total + i] = util::getNumericNameInfo(
+          &addrs[i].sa, msgs[i].msg_hdr.msg_namelen);
+    }
+    total += r;
+    if (static_cast<size_t>(r) < n) {
+      break;
+    }
+  }
+#else  // !HAVE_RECVMMSG
+  for (; total < num; ++total) {
+    ssize_t r;
+    try {
+      r = readDataFrom(data + total * len, len, senders[total]);
+    }
+    catch (RecoverableException& e) {
+      if (total > 0) {
+        break;
+      }
+      throw;
+    }
+    if (r == 0 && wantRead_) {
+      break;
+    }
+    lengths[total] = r;
+  }
+#endif // !HAVE_RECVMMSG
+  return total;
+}
+
+void SocketCore::getDestination(SockAddr& dest, const std::string& host,
+                                uint16_t port) const
+{
+  struct addrinfo* res;
+  int s = callGetaddrinfo(&res, host.c_str(), util::uitos(port).c_str(),
+                          protocolFamily_, sockType_, 0, 0);
+  if (s) {
+    throw DL_ABORT_EX(fmt(EX_SOCKET_SEND, gai_strerror(s)));
+  }
+  std::unique_ptr<addrinfo, decltype(&freeaddrinfo)> resDeleter(res,
+                                                                freeaddrinfo);
+  memcpy(&dest.su, res->ai_addr, res->ai_addrlen);
+  dest.suLength = res->ai_addrlen;
+}
+
+size_t SocketCore::writeDataToMany(const a2iovec* iov, const SockAddr* dests,
+                                   size_t num)
+{
+  wantRead_ = false;
+  wantWrite_ = false;
+  size_t total = 0;
+  int errNum = 0;
+#ifdef HAVE_SENDMMSG
+  while (total < num) {
+    std::array<mmsghdr, MAX_DATAGRAM_BATCH> msgs;
+    size_t n = std::min(num - total, MAX_DATAGRAM_BATCH);
+    memset(msgs.data(), 0, sizeof(mmsghdr) * n);
+    for (size_t i = 0; i < n; ++i) {
+      auto& dest = dests[total + i];
+      msgs[i].msg_hdr.msg_name = const_cast<sockaddr*>(&dest.su.sa);
+      msgs[i].msg_hdr.msg_namelen = dest.suLength;
+      msgs[i].msg_hdr.msg_iov = const_cast<iovec*>(&iov[total + i]);
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    int r;
+    while ((r = sendmmsg(sockfd_, msgs.data(), n, 0)) == -1 && errno == EINTR)
+      ;
+    if (r == -1) {
+      errNum = errno;
+      break;
+    }
+    total += r;
+    if (static_cast<size_t>(r) < n) {
+      break;
+    }
+  }
+#else  // !HAVE_SENDMMSG
+  for (; total < num; ++total) {
+    ssize_t r;
+    // Cast for Windows sendto()
+    while ((r = sendto(sockfd_, reinterpret_cast<const char*>(
+                                    iov[total].A2IOVEC_BASE),
+                       iov[total].A2IOVEC_LEN, 0, &dests[total].su.sa,
+                       dests[total].suLength)) == -1 &&
+           A2_EINTR == SOCKET_ERRNO)
+      ;
+    if (r == -1) {
+      errNum = SOCKET_ERRNO;
+      break;
+    }
+  }
+#endif // !HAVE_SENDMMSG
+  if (errNum != 0) {
+    if (A2_WOULDBLOCK(errNum)) {
+      wantWrite_ = true;
+    }
+    else if (total == 0) {
+      throw DL_ABORT_EX(fmt(EX_SOCKET_SEND, errorMsg(errNum).c_str()));
+    }
+  }
+  return total;
+}
+
 std::string SocketCore::getSocketError() const
 {
   int error;
@@ -79,6 +79,9 @@ private:
 
   static int socketRecvBufferSize_;
 
+  // The number of SocketCore objects which own a descriptor.
+  static size_t numOpenSockets_;
+
   bool blocking_;
   int secure_;
 
@@ -110,11 +113,17 @@ private:
 
   void init();
 
+  void setSockfd(sock_t fd);
+
   void bind(const struct sockaddr* addr, socklen_t addrlen);
 
   void setSockOpt(int level, int optname, void* optval, socklen_t optlen);
 
 public:
+  // The maximum number of datagrams readDataFromMany() and
+  // writeDataToMany() pass to a system call at once.
+  static const size_t MAX_DATAGRAM_BATCH = 16;
+
   SocketCore(int sockType = SOCK_STREAM);
 
   // Formally, private constructor, but made public to use with
@@ -264,6 +273,25 @@ public:
 
   ssize_t writeVector(a2iovec* iov, size_t iovcnt);
 
+  bool isSecure() const { return secure_; }
+
+#ifdef HAVE_SENDFILE
+  // Sends at most |len| bytes of the file |fd| starting at |offset|
+  // using sendfile(2).  This function must not be used for secure
+  // sockets.  Returns the number of bytes sent.  If the socket gets
+  // EAGAIN, wantWrite_ is set.
+  ssize_t sendFile(int fd, int64_t offset, size_t len);
+#endif // HAVE_SENDFILE
+
+#ifdef HAVE_SPLICE
+  // Moves at most |len| bytes of incoming data into the pipe |pipefd|
+  // using splice(2).  This function must not be used for secure
+  // sockets.  Returns the number of bytes moved, or 0 if EOF is
+  // reached or the socket gets EAGAIN, in which case wantRead_ is
+  // set.
+  ssize_t spliceData(int pipefd, size_t len);
+#endif // HAVE_SPLICE
+
   /**
    * Reads up to len bytes from this socket.
    * data is a pointer pointing the first
@@ -285,6 +313,26 @@ public:
   // sender.addr will be numerihost assigned.
   ssize_t readDataFrom(void* data, size_t len, Endpoint& sender);
 
+  // Receives at most |num| datagrams.  The i-th datagram is stored in
+  // data + i * len and its length and sender are assigned to
+  // lengths[i] and senders[i].  Returns the number of datagrams
+  // received.  recvmmsg(2) is used if available, so that many
+  // datagrams are received in a system call.
+  size_t readDataFromMany(unsigned char* data, size_t len, size_t num,
+                          size_t* lengths, Endpoint* senders);
+
+  // Resolves |host| and |port| into the destination address used by
+  // writeDataToMany().
+  void getDestination(SockAddr& dest, const std::string& host,
+                      uint16_t port) const;
+
+  // Sends |num| datagrams.  The i-th datagram is iov[i] and sent to
+  // dests[i].  Returns the number of datagrams sent.  sendmmsg(2) is
+  // used if available.  If the first datagram cannot be sent,
+  // exception is thrown, unless the socket gets EAGAIN.
+  size_t writeDataToMany(const a2iovec* iov, const SockAddr* dests,
+                         size_t num);
+
 #ifdef ENABLE_SSL
   // Performs TLS server side handshake. If handshake is completed,
   // returns true. If handshake has not been done yet, returns false.
@@ -357,6 +405,8 @@ public:
   static void setSocketRecvBufferSize(int size);
   static int getSocketRecvBufferSize();
 
+  static size_t getNumOpenSockets() { return numOpenSockets_; }
+
   // Bind socket to interface. interface may be specified as a
   // hostname, IP address or interface name like eth0.  If the given
   // interface is not found or binding socket is failed, exception
@@ -0,0 +1,99 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "SplicePipe.h"
+
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#include "DlAbortEx.h"
+#include "fmt.h"
+#include "util.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+namespace {
+// The default pipe capacity is 64KiB, which is too small to keep up
+// with fast links.  Try to enlarge it to this size.
+constexpr int PIPE_SIZE = 1_m;
+} // namespace
+
+SplicePipe::SplicePipe() : capacity_(64_k)
+{
+  if (pipe(fds_) == -1) {
+    int errNum = errno;
+    throw DL_ABORT_EX(fmt("Failed to create a pipe, cause: %s",
+                          util::safeStrerror(errNum).c_str()));
+  }
+  util::make_fd_cloexec(fds_[0]);
+  util::make_fd_cloexec(fds_[1]);
+  // Unprivileged processes may be limited to smaller size, so just
+  // use the current size if this fails.
+  fcntl(fds_[1], F_SETPIPE_SZ, PIPE_SIZE);
+  int size = fcntl(fds_[1], F_GETPIPE_SZ);
+  if (size > 0) {
+    capacity_ = size;
+  }
+}
+
+SplicePipe::~SplicePipe()
+{
+  close(fds_[0]);
+  close(fds_[1]);
+}
+
+int SplicePipe::moveTo(int fd, int64_t offset, size_t len)
+{
+  loff_t off = offset;
+  while (len > 0) {
+    ssize_t n = splice(fds_[0], nullptr, fd, &off, len, SPLICE_F_MOVE);
+    if (n == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+    if (n == 0) {
+      return EIO;
+    }
+    len -= n;
+  }
+  return 0;
+}
+
+} // namespace aria2
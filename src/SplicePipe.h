@@ -0,0 +1,73 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_SPLICE_PIPE_H
+#define D_SPLICE_PIPE_H
+
+#include "common.h"
+
+namespace aria2 {
+
+// The pipe through which data received from a socket is moved to a
+// file with splice(2), without copying it into user space.
+class SplicePipe {
+public:
+  // Throws DlAbortEx if a pipe cannot be created.
+  SplicePipe();
+
+  ~SplicePipe();
+
+  // Don't allow copying
+  SplicePipe(const SplicePipe&) = delete;
+  SplicePipe& operator=(const SplicePipe&) = delete;
+
+  // Returns the file descriptor of the write end.
+  int getWriteFd() const { return fds_[1]; }
+
+  // Returns the number of bytes the pipe can hold.
+  size_t getCapacity() const { return capacity_; }
+
+  // Moves |len| bytes in the pipe into the file |fd| at |offset|.
+  // Returns 0 if it succeeds, or errno.  If it fails, the pipe may
+  // still hold the data and must not be used any longer.
+  int moveTo(int fd, int64_t offset, size_t len);
+
+private:
+  int fds_[2];
+  size_t capacity_;
+};
+
+} // namespace aria2
+
+#endif // D_SPLICE_PIPE_H
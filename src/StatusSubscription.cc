@@ -0,0 +1,230 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "StatusSubscription.h"
+
+#include <algorithm>
+#include <set>
+
+#include "DownloadEngine.h"
+#include "RequestGroupMan.h"
+#include "RequestGroup.h"
+#include "RpcMethodImpl.h"
+#include "GroupId.h"
+#include "json.h"
+
+namespace aria2 {
+
+namespace rpc {
+
+namespace {
+const char ON_STATUS_CHANGE[] = "aria2.onStatusChange";
+} // namespace
+
+namespace {
+// Returns StatusKeys::Key of |keys| in the given order, except for
+// the GID.  If |keys| is empty, returns all keys.
+std::vector<int> toKeyIndexes(const std::vector<std::string>& keys)
+{
+  std::vector<int> res;
+  if (keys.empty()) {
+    for (int i = 0; i < StatusKeys::MAX_KEY; ++i) {
+      if (i != StatusKeys::GID) {
+        res.push_back(i);
+      }
+    }
+    return res;
+  }
+  for (auto& key : keys) {
+    for (int i = 0; i < StatusKeys::MAX_KEY; ++i) {
+      if (key == StatusKeys::getName(static_cast<StatusKeys::Key>(i))) {
+        if (i != StatusKeys::GID &&
+            std::find(std::begin(res), std::end(res), i) == std::end(res)) {
+          res.push_back(i);
+        }
+        break;
+      }
+    }
+  }
+  return res;
+}
+} // namespace
+
+StatusSnapshot::StatusSnapshot(DownloadEngine* e,
+                               const std::vector<std::string>& keys)
+    : e_(e), keys_(make_unique<StatusKeys>(keys)), activeGidsDone_(false)
+{
+}
+
+StatusSnapshot::~StatusSnapshot() = default;
+
+const StatusSnapshot::Entry* StatusSnapshot::get(a2_gid_t gid)
+{
+  auto i = entries_.find(gid);
+  if (i != std::end(entries_)) {
+    return (*i).second.get();
+  }
+  auto entry = make_unique<Entry>(StatusKeys::MAX_KEY);
+  if (!writeStatusValues(*entry, gid, e_, *keys_)) {
+    entry.reset();
+  }
+  return (entries_[gid] = std::move(entry)).get();
+}
+
+const std::vector<a2_gid_t>& StatusSnapshot::getActiveGids()
+{
+  if (!activeGidsDone_) {
+    for (auto& group : e_->getRequestGroupMan()->getRequestGroups()) {
+      activeGids_.push_back(group->getGID());
+    }
+    activeGidsDone_ = true;
+  }
+  return activeGids_;
+}
+
+StatusSubscription::StatusSubscription(std::vector<a2_gid_t> gids,
+                                       std::vector<std::string> keys,
+                                       std::chrono::milliseconds interval)
+    : gids_(std::move(gids)),
+      keys_(std::move(keys)),
+      keyIndexes_(toKeyIndexes(keys_)),
+      interval_(std::move(interval)),
+      lastUpdate_(Timer::zero()),
+      updateCount_(0)
+{
+}
+
+std::chrono::milliseconds
+StatusSubscription::getTimeout(const Timer& now) const
+{
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      lastUpdate_.difference(now));
+  return elapsed < interval_ ? interval_ - elapsed
+                             : std::chrono::milliseconds(0);
+}
+
+std::string StatusSubscription::update(StatusSnapshot& snapshot,
+                                       const Timer& now)
+{
+  lastUpdate_ = now;
+  ++updateCount_;
+  const auto& gids = gids_.empty() ? snapshot.getActiveGids() : gids_;
+  std::string msg;
+  json::JsonWriter w(msg);
+  size_t numWatched = 0;
+  for (auto gid : gids) {
+    auto entry = snapshot.get(gid);
+    if (!entry) {
+      continue;
+    }
+    auto& sent = sent_[gid];
+    if (sent.updateCount == updateCount_) {
+      // Listed twice
+      continue;
+    }
+    if (sent.values.empty()) {
+      sent.values.resize(keyIndexes_.size());
+    }
+    sent.updateCount = updateCount_;
+    ++numWatched;
+    bool begun = false;
+    for (size_t i = 0; i < keyIndexes_.size(); ++i) {
+      auto& text = (*entry)[keyIndexes_[i]];
+      auto& last = sent.values[i];
+      if (text == last) {
+        continue;
+      }
+      last = text;
+      if (msg.empty()) {
+        w.beginObject()
+            .key("jsonrpc")
+            .string("2.0")
+            .key("method")
+            .string(ON_STATUS_CHANGE)
+            .key("params")
+            .beginArray();
+      }
+      if (!begun) {
+        w.beginObject()
+            .key(StatusKeys::getName(StatusKeys::GID))
+            .string(GroupId::toHex(gid));
+        begun = true;
+      }
+      w.key(StatusKeys::getName(static_cast<StatusKeys::Key>(keyIndexes_[i])));
+      if (text.empty()) {
+        // The key is gone.  null tells the client to forget it.
+        w.null();
+      }
+      else {
+        w.raw(text);
+      }
+    }
+    if (begun) {
+      w.endObject();
+    }
+  }
+  if (sent_.size() > numWatched) {
+    // Forgets the downloads no longer watched, so that they are sent
+    // in full if they come back.
+    for (auto i = std::begin(sent_); i != std::end(sent_);) {
+      if ((*i).second.updateCount != updateCount_) {
+        i = sent_.erase(i);
+      }
+      else {
+        ++i;
+      }
+    }
+  }
+  if (!msg.empty()) {
+    w.endArray().endObject();
+  }
+  return msg;
+}
+
+std::vector<std::string> StatusSubscription::unionKeys(
+    const std::vector<const StatusSubscription*>& subscriptions)
+{
+  std::set<std::string> keys;
+  for (auto sub : subscriptions) {
+    if (sub->keys_.empty()) {
+      return {};
+    }
+    keys.insert(std::begin(sub->keys_), std::end(sub->keys_));
+  }
+  return std::vector<std::string>(std::begin(keys), std::end(keys));
+}
+
+} // namespace rpc
+
+} // namespace aria2
@@ -0,0 +1,135 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_STATUS_SUBSCRIPTION_H
+#define D_STATUS_SUBSCRIPTION_H
+
+#include "common.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "TimerA2.h"
+#include "GroupId.h"
+
+namespace aria2 {
+
+class DownloadEngine;
+
+namespace rpc {
+
+class StatusKeys;
+
+// The status of downloads taken at a time.  The status of each
+// download is gathered at most once, and shared by all subscriptions
+// which are updated at that time.
+class StatusSnapshot {
+public:
+  // The JSON text of the value of each key, indexed by
+  // StatusKeys::Key.  The keys not in the status are empty.
+  typedef std::vector<std::string> Entry;
+
+  // The status is gathered with |keys| as the keys parameter of
+  // tellStatus.
+  StatusSnapshot(DownloadEngine* e, const std::vector<std::string>& keys);
+
+  ~StatusSnapshot();
+
+  // Returns the status of the download gid, or nullptr if there is no
+  // such download.
+  const Entry* get(a2_gid_t gid);
+
+  // Returns the GIDs of the active downloads.
+  const std::vector<a2_gid_t>& getActiveGids();
+
+private:
+  DownloadEngine* e_;
+  std::unique_ptr<StatusKeys> keys_;
+  std::unordered_map<a2_gid_t, std::unique_ptr<Entry>> entries_;
+  std::vector<a2_gid_t> activeGids_;
+  bool activeGidsDone_;
+};
+
+// A subscription to the changes of the status of downloads, made by
+// aria2.subscribe.
+class StatusSubscription {
+public:
+  // If |gids| is empty, the active downloads are watched.  |keys| is
+  // the keys parameter of tellStatus.  The changes are sent at most
+  // once in |interval|.
+  StatusSubscription(std::vector<a2_gid_t> gids, std::vector<std::string> keys,
+                     std::chrono::milliseconds interval);
+
+  const std::vector<std::string>& getKeys() const { return keys_; }
+
+  // Returns the time until the changes should be sent next.
+  std::chrono::milliseconds getTimeout(const Timer& now) const;
+
+  // Returns the aria2.onStatusChange notification which carries the
+  // values changed since the last call, or an empty string if nothing
+  // has changed.  A key which is no longer in the status is sent as
+  // null.
+  std::string update(StatusSnapshot& snapshot, const Timer& now);
+
+  // Returns the union of the keys of |subscriptions|, which is usable
+  // as the keys of StatusSnapshot.
+  static std::vector<std::string>
+  unionKeys(const std::vector<const StatusSubscription*>& subscriptions);
+
+private:
+  struct Sent {
+    // The values last sent, in the order of keyIndexes_.
+    std::vector<std::string> values;
+    uint64_t updateCount;
+  };
+
+  std::vector<a2_gid_t> gids_;
+  std::vector<std::string> keys_;
+  // StatusKeys::Key of the keys written in the notification, except
+  // for the GID which identifies the download.
+  std::vector<int> keyIndexes_;
+  std::chrono::milliseconds interval_;
+  Timer lastUpdate_;
+  uint64_t updateCount_;
+  std::unordered_map<a2_gid_t, Sent> sent_;
+};
+
+} // namespace rpc
+
+} // namespace aria2
+
+#endif // D_STATUS_SUBSCRIPTION_H
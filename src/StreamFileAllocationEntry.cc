@@ -46,6 +46,7 @@
 #include "FileEntry.h"
 #include "PieceStorage.h"
 #include "DiskAdaptor.h"
+#include "RequestGroupMan.h"
 #include "LogFactory.h"
 
 namespace aria2 {
@@ -75,6 +76,10 @@ void StreamFileAllocationEntry::prepareForNextAction(
       diskAdaptor->size() <= option->getAsLLInt(PREF_MAX_MMAP_LIMIT)) {
     diskAdaptor->enableMmap();
   }
+  if (e->getRequestGroupMan()->getDiskWriteQueue()) {
+    diskAdaptor->enableAsyncWrite(
+        e->getRequestGroupMan()->getDiskWriteQueue());
+  }
   if (getNextCommand()) {
     // Reset download start time of PeerStat because it is started
     // before file allocation begins.
@@ -75,6 +75,10 @@ bool TimeBasedCommand::execute()
   else {
     e_->addCommand(std::unique_ptr<Command>(this));
   }
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      checkPoint_.difference(global::wallclock()));
+  e_->sleepCommand(this, elapsed < interval_ ? interval_ - elapsed
+                                             : std::chrono::milliseconds(0));
   return false;
 }
 
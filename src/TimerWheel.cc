@@ -0,0 +1,240 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "TimerWheel.h"
+
+#include <cassert>
+#include <algorithm>
+
+namespace aria2 {
+
+const size_t TimerWheel::ROOT_BITS;
+const size_t TimerWheel::ROOT_SIZE;
+const size_t TimerWheel::LEVEL_BITS;
+const size_t TimerWheel::LEVEL_SIZE;
+const size_t TimerWheel::NUM_LEVELS;
+
+TimerWheel::Entry::Entry()
+    : wheel_(nullptr), slot_(nullptr), prev_(nullptr), next_(nullptr), expiry_(0)
+{
+}
+
+TimerWheel::Entry::~Entry() { cancelTimer(); }
+
+void TimerWheel::Entry::cancelTimer()
+{
+  if (wheel_) {
+    wheel_->remove(this);
+  }
+}
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, const Timer& now)
+    : tick_(std::move(tick)), size_(0), rootSize_(0)
+{
+  assert(tick_.count() > 0);
+  root_.fill(nullptr);
+  for (auto& level : levels_) {
+    level.fill(nullptr);
+  }
+  now_ = toMillis(now) / tick_.count();
+}
+
+TimerWheel::~TimerWheel() { clear(); }
+
+uint64_t TimerWheel::toMillis(const Timer& t) const
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             t.getTime().time_since_epoch())
+      .count();
+}
+
+void TimerWheel::schedule(Entry* entry, const Timer& now,
+                          std::chrono::milliseconds timeout)
+{
+  entry->cancelTimer();
+  auto tick = static_cast<uint64_t>(tick_.count());
+  auto deadline =
+      toMillis(now) + static_cast<uint64_t>(std::max<int64_t>(
+                          0, static_cast<int64_t>(timeout.count())));
+  // Round up so that an entry never expires before its deadline.
+  entry->expiry_ = (deadline + tick - 1) / tick;
+  add(entry);
+}
+
+void TimerWheel::add(Entry* entry)
+{
+  // An entry which has already expired goes to the slot processed
+  // next.
+  auto expiry = std::max(entry->expiry_, now_);
+  auto idx = expiry - now_;
+  Entry** slot;
+  if (idx < ROOT_SIZE) {
+    slot = &root_[expiry & (ROOT_SIZE - 1)];
+    ++rootSize_;
+  }
+  else {
+    size_t level = 0;
+    auto span = static_cast<uint64_t>(ROOT_SIZE) << LEVEL_BITS;
+    for (; level < NUM_LEVELS - 1 && idx >= span; ++level) {
+      span <<= LEVEL_BITS;
+    }
+    if (idx >= span) {
+      // Too far in the future.  Put it in the farthest slot.  It is
+      // placed again using its real expiry when it is cascaded.
+      expiry = now_ + span - 1;
+    }
+    slot = &levels_[level][(expiry >> (ROOT_BITS + level * LEVEL_BITS)) &
+                           (LEVEL_SIZE - 1)];
+  }
+  entry->wheel_ = this;
+  entry->slot_ = slot;
+  entry->prev_ = nullptr;
+  entry->next_ = *slot;
+  if (*slot) {
+    (*slot)->prev_ = entry;
+  }
+  *slot = entry;
+  ++size_;
+}
+
+bool TimerWheel::inRoot(const Entry* entry) const
+{
+  return entry->slot_ >= root_.data() && entry->slot_ < root_.data() + ROOT_SIZE;
+}
+
+void TimerWheel::remove(Entry* entry)
+{
+  if (inRoot(entry)) {
+    --rootSize_;
+  }
+  if (entry->prev_) {
+    entry->prev_->next_ = entry->next_;
+  }
+  else {
+    *entry->slot_ = entry->next_;
+  }
+  if (entry->next_) {
+    entry->next_->prev_ = entry->prev_;
+  }
+  entry->wheel_ = nullptr;
+  entry->slot_ = nullptr;
+  entry->prev_ = entry->next_ = nullptr;
+  --size_;
+}
+
+void TimerWheel::cascade(size_t level, size_t index)
+{
+  auto& slot = levels_[level][index];
+  while (slot) {
+    auto entry = slot;
+    remove(entry);
+    add(entry);
+  }
+}
+
+void TimerWheel::expire(std::vector<Entry*>& out, const Timer& now)
+{
+  auto target = toMillis(now) / tick_.count();
+  while (now_ <= target) {
+    if (size_ == 0) {
+      now_ = target + 1;
+      break;
+    }
+    auto index = now_ & (ROOT_SIZE - 1);
+    if (index == 0) {
+      for (size_t level = 0; level < NUM_LEVELS; ++level) {
+        auto i = (now_ >> (ROOT_BITS + level * LEVEL_BITS)) & (LEVEL_SIZE - 1);
+        cascade(level, i);
+        if (i != 0) {
+          break;
+        }
+      }
+    }
+    if (rootSize_ == 0) {
+      // Nothing expires until the next cascade.
+      now_ = std::min(target + 1, (now_ | (ROOT_SIZE - 1)) + 1);
+      continue;
+    }
+    auto& slot = root_[index];
+    while (slot) {
+      auto entry = slot;
+      remove(entry);
+      out.push_back(entry);
+    }
+    ++now_;
+  }
+}
+
+std::chrono::milliseconds
+TimerWheel::getNextTimeout(const Timer& now,
+                           std::chrono::milliseconds max) const
+{
+  if (size_ == 0) {
+    return max;
+  }
+  auto nowMillis = toMillis(now);
+  auto tick = static_cast<uint64_t>(tick_.count());
+  auto t = now_;
+  // Entries in the upper wheels may come down to the root wheel when
+  // it wraps around, so the scan stops there.
+  for (; t == now_ || (t & (ROOT_SIZE - 1)) != 0; ++t) {
+    if (root_[t & (ROOT_SIZE - 1)] ||
+        t * tick >= nowMillis + static_cast<uint64_t>(max.count())) {
+      break;
+    }
+  }
+  auto deadline = t * tick;
+  if (deadline <= nowMillis) {
+    return std::chrono::milliseconds(0);
+  }
+  return std::min(max, std::chrono::milliseconds(deadline - nowMillis));
+}
+
+void TimerWheel::clear()
+{
+  for (auto& slot : root_) {
+    while (slot) {
+      remove(slot);
+    }
+  }
+  for (auto& level : levels_) {
+    for (auto& slot : level) {
+      while (slot) {
+        remove(slot);
+      }
+    }
+  }
+}
+
+} // namespace aria2
@@ -0,0 +1,135 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_TIMER_WHEEL_H
+#define D_TIMER_WHEEL_H
+
+#include "common.h"
+
+#include <array>
+#include <vector>
+#include <chrono>
+
+#include "TimerA2.h"
+
+namespace aria2 {
+
+// Hierarchical timer wheel.  The root wheel has 256 slots of one tick
+// each.  The 3 upper wheels have 64 slots each, and their entries are
+// cascaded down to the lower wheel when the lower wheel wraps around.
+// Scheduling and cancellation are O(1).
+class TimerWheel {
+public:
+  // Intrusive timer entry.  An entry removes itself from the wheel
+  // when it is destroyed.
+  class Entry {
+  public:
+    Entry();
+    ~Entry();
+
+    Entry(const Entry&) = delete;
+    Entry& operator=(const Entry&) = delete;
+
+    bool isTimerScheduled() const { return wheel_ != nullptr; }
+
+    void cancelTimer();
+
+  private:
+    friend class TimerWheel;
+
+    TimerWheel* wheel_;
+    Entry** slot_;
+    Entry* prev_;
+    Entry* next_;
+    // The tick at which this entry expires.
+    uint64_t expiry_;
+  };
+
+  TimerWheel(std::chrono::milliseconds tick, const Timer& now);
+
+  ~TimerWheel();
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  // Schedules |entry| so that it expires when |timeout| has elapsed
+  // since |now|.  If |entry| is already scheduled, it is rescheduled.
+  void schedule(Entry* entry, const Timer& now,
+                std::chrono::milliseconds timeout);
+
+  // Removes the entries expired at |now| and appends them to |out|.
+  void expire(std::vector<Entry*>& out, const Timer& now);
+
+  // Returns the time from |now| until the next entry may expire.  The
+  // return value is at most |max|.
+  std::chrono::milliseconds getNextTimeout(const Timer& now,
+                                           std::chrono::milliseconds max) const;
+
+  // Cancels all entries.
+  void clear();
+
+  size_t size() const { return size_; }
+
+  bool empty() const { return size_ == 0; }
+
+  static const size_t ROOT_BITS = 8;
+  static const size_t ROOT_SIZE = 1 << ROOT_BITS;
+  static const size_t LEVEL_BITS = 6;
+  static const size_t LEVEL_SIZE = 1 << LEVEL_BITS;
+  static const size_t NUM_LEVELS = 3;
+
+private:
+  uint64_t toMillis(const Timer& t) const;
+
+  void add(Entry* entry);
+
+  void remove(Entry* entry);
+
+  void cascade(size_t level, size_t index);
+
+  bool inRoot(const Entry* entry) const;
+
+  std::array<Entry*, ROOT_SIZE> root_;
+  std::array<std::array<Entry*, LEVEL_SIZE>, NUM_LEVELS> levels_;
+  std::chrono::milliseconds tick_;
+  // The next tick to be processed by expire().
+  uint64_t now_;
+  size_t size_;
+  // The number of entries in the root wheel.
+  size_t rootSize_;
+};
+
+} // namespace aria2
+
+#endif // D_TIMER_WHEEL_H
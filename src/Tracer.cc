@@ -0,0 +1,123 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "Tracer.h"
+
+#include <cinttypes>
+#include <typeinfo>
+
+#include "BufferedFile.h"
+#include "Command.h"
+#include "DlAbortEx.h"
+#include "fmt.h"
+#include "json.h"
+#include "util.h"
+
+namespace aria2 {
+
+Tracer* Tracer::instance_ = nullptr;
+
+Tracer::Tracer(const std::string& filename, size_t capacity)
+    : fp_(make_unique<BufferedFile>(filename.c_str(), BufferedFile::WRITE)),
+      origin_(Clock::now()),
+      events_(capacity),
+      numEvents_(0),
+      first_(true)
+{
+  if (!*fp_ || fp_->write("[\n") == 0) {
+    throw DL_ABORT_EX(
+        fmt("Failed to open the trace file %s", filename.c_str()));
+  }
+}
+
+Tracer::~Tracer()
+{
+  flush();
+  fp_->write("\n]\n");
+  fp_->close();
+}
+
+void Tracer::addSpan(const char* category, const char* name,
+                     Clock::time_point start, Clock::time_point end,
+                     const std::string& arg)
+{
+  if (numEvents_ == events_.size()) {
+    flush();
+  }
+  auto& ev = events_[numEvents_++];
+  ev.category = category;
+  ev.name = name;
+  ev.arg = arg;
+  ev.start = start;
+  ev.duration = end - start;
+}
+
+void Tracer::addCommandSpan(const Command* command, Clock::time_point start,
+                            Clock::time_point end)
+{
+  auto& name = commandNames_[typeid(*command)];
+  if (name.empty()) {
+    name = util::demangle(typeid(*command).name());
+  }
+  addSpan("command", name.c_str(), start, end,
+          fmt("CUID#%" PRId64, command->getCuid()));
+}
+
+void Tracer::flush()
+{
+  using namespace std::chrono;
+  for (size_t i = 0; i < numEvents_; ++i) {
+    auto& ev = events_[i];
+    if (!first_) {
+      fp_->write(",\n");
+    }
+    first_ = false;
+    fp_->printf("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%" PRId64
+                ",\"dur\":%" PRId64 ",\"pid\":1,\"tid\":1",
+                json::jsonEscape(ev.name).c_str(), ev.category,
+                static_cast<int64_t>(
+                    duration_cast<microseconds>(ev.start - origin_).count()),
+                static_cast<int64_t>(
+                    duration_cast<microseconds>(ev.duration).count()));
+    if (!ev.arg.empty()) {
+      fp_->printf(",\"args\":{\"detail\":\"%s\"}",
+                  json::jsonEscape(ev.arg).c_str());
+    }
+    fp_->write("}");
+  }
+  numEvents_ = 0;
+  fp_->flush();
+}
+
+} // namespace aria2
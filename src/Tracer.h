@@ -0,0 +1,142 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_TRACER_H
+#define D_TRACER_H
+
+#include "common.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace aria2 {
+
+class BufferedFile;
+class Command;
+
+// Writes spans of the engine activity to a file in Chrome Trace Event
+// format, which can be loaded in chrome://tracing or Perfetto.  The
+// events are kept in a fixed size buffer which is written out when it
+// becomes full, so memory usage does not grow with the length of the
+// trace.  All functions must be called from the thread which runs
+// DownloadEngine.
+class Tracer {
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  // Opens |filename| for writing.  Throws DlAbortEx on failure.
+  Tracer(const std::string& filename, size_t capacity = 4096);
+
+  // Writes out the buffered events and closes the file.
+  ~Tracer();
+
+  // Adds the span [start, end) named |name| in |category|.  |name|
+  // must outlive this object.  |arg| is added to the event as its
+  // argument if it is not empty.
+  void addSpan(const char* category, const char* name, Clock::time_point start,
+               Clock::time_point end, const std::string& arg = "");
+
+  // Adds the span of the execution of |command| named after its type.
+  void addCommandSpan(const Command* command, Clock::time_point start,
+                      Clock::time_point end);
+
+  void flush();
+
+  // Returns the active Tracer, or nullptr if tracing is disabled.
+  static Tracer* get() { return instance_; }
+
+  static void setInstance(Tracer* tracer) { instance_ = tracer; }
+
+private:
+  struct Event {
+    const char* category;
+    const char* name;
+    std::string arg;
+    Clock::time_point start;
+    Clock::duration duration;
+  };
+
+  static Tracer* instance_;
+
+  std::unique_ptr<BufferedFile> fp_;
+  Clock::time_point origin_;
+  std::vector<Event> events_;
+  size_t numEvents_;
+  bool first_;
+  // Demangled names of Command types
+  std::unordered_map<std::type_index, std::string> commandNames_;
+};
+
+// Adds the span from its construction to its destruction if tracing
+// is enabled.
+class TraceSpan {
+public:
+  TraceSpan(const char* category, const char* name)
+      : tracer_(Tracer::get()), category_(category), name_(name)
+  {
+    if (tracer_) {
+      start_ = Tracer::Clock::now();
+    }
+  }
+
+  TraceSpan(const char* category, const char* name, const std::string& arg)
+      : TraceSpan(category, name)
+  {
+    if (tracer_) {
+      arg_ = arg;
+    }
+  }
+
+  ~TraceSpan()
+  {
+    if (tracer_) {
+      tracer_->addSpan(category_, name_, start_, Tracer::Clock::now(), arg_);
+    }
+  }
+
+private:
+  Tracer* tracer_;
+  const char* category_;
+  const char* name_;
+  std::string arg_;
+  Tracer::Clock::time_point start_;
+};
+
+} // namespace aria2
+
+#endif // D_TRACER_H
@@ -216,6 +216,8 @@ public:
 
   virtual WrDiskCache* getWrDiskCache() CXX11_OVERRIDE { return nullptr; }
 
+  virtual RdDiskCache* getRdDiskCache() CXX11_OVERRIDE { return nullptr; }
+
   virtual void flushWrDiskCacheEntry() CXX11_OVERRIDE {}
 
   virtual int32_t getPieceLength(size_t index) CXX11_OVERRIDE;
@@ -0,0 +1,542 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "UtpConnection.h"
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+#include "bittorrent_helper.h"
+#include "SimpleRandomizer.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+namespace {
+// The target queuing delay of LEDBAT in microseconds.
+constexpr uint32_t UTP_TARGET_DELAY = 100000;
+// The maximum increase of the congestion window per RTT in bytes.
+constexpr double UTP_MAX_WINDOW_INCREASE = 3000;
+constexpr double UTP_MIN_WINDOW = 2 * UTP_MAX_PAYLOAD_LENGTH;
+constexpr double UTP_INITIAL_WINDOW = 4 * UTP_MAX_PAYLOAD_LENGTH;
+constexpr double UTP_MAX_WINDOW = 4_m;
+// The size of receive buffer advertised to the remote peer.
+constexpr size_t UTP_RECV_WINDOW = 1_m;
+// The number of minutes in the base delay history.
+constexpr size_t UTP_BASE_DELAY_HISTORY = 2;
+constexpr int UTP_DUP_ACK_THRESHOLD = 3;
+constexpr int UTP_MAX_SYN_TRANSMISSIONS = 3;
+constexpr int UTP_MAX_TRANSMISSIONS = 6;
+// In milliseconds
+constexpr int64_t UTP_INITIAL_RTO = 1000;
+constexpr int64_t UTP_MIN_RTO = 500;
+constexpr int64_t UTP_MAX_RTO = 30000;
+constexpr auto UTP_KEEPALIVE_INTERVAL = 29_s;
+constexpr auto UTP_IDLE_TIMEOUT = 90_s;
+// Packets farther ahead than this from the last in-order packet are
+// dropped.
+constexpr uint16_t UTP_MAX_REORDER = 1024;
+} // namespace
+
+namespace {
+// Returns true if a is before b in sequence number space.
+bool seqLess(uint16_t a, uint16_t b)
+{
+  return a != b && static_cast<uint16_t>(b - a) < 0x8000u;
+}
+} // namespace
+
+ssize_t parseUtpHeader(UtpHeader& hdr, const unsigned char* data,
+                       size_t length)
+{
+  if (length < UTP_HEADER_LENGTH || (data[0] & 0x0fu) != 1 ||
+      (data[0] >> 4) > UTP_ST_SYN) {
+    return -1;
+  }
+  hdr.type = data[0] >> 4;
+  hdr.connectionId = bittorrent::getShortIntParam(data, 2);
+  hdr.timestamp = bittorrent::getIntParam(data, 4);
+  hdr.timestampDiff = bittorrent::getIntParam(data, 8);
+  hdr.windowSize = bittorrent::getIntParam(data, 12);
+  hdr.seqNr = bittorrent::getShortIntParam(data, 16);
+  hdr.ackNr = bittorrent::getShortIntParam(data, 18);
+  size_t offset = UTP_HEADER_LENGTH;
+  // Each extension consists of the type of the next extension, its
+  // length and the data.
+  for (uint8_t ext = data[1]; ext != 0;) {
+    if (offset + 2 > length || offset + 2 + data[offset + 1] > length) {
+      return -1;
+    }
+    ext = data[offset];
+    offset += 2 + data[offset + 1];
+  }
+  return offset;
+}
+
+void packUtpHeader(unsigned char* data, const UtpHeader& hdr)
+{
+  data[0] = (hdr.type << 4) | 1;
+  data[1] = 0;
+  bittorrent::setShortIntParam(data + 2, hdr.connectionId);
+  bittorrent::setIntParam(data + 4, hdr.timestamp);
+  bittorrent::setIntParam(data + 8, hdr.timestampDiff);
+  bittorrent::setIntParam(data + 12, hdr.windowSize);
+  bittorrent::setShortIntParam(data + 16, hdr.seqNr);
+  bittorrent::setShortIntParam(data + 18, hdr.ackNr);
+}
+
+uint32_t getUtpTimestamp(const Timer& now)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             now.getTime().time_since_epoch())
+      .count();
+}
+
+UtpConnection::UtpConnection(uint16_t recvId, uint16_t sendId,
+                             const Timer& now)
+    : state_(UTP_CS_SYN_SENT),
+      recvId_(recvId),
+      sendId_(sendId),
+      seqNr_(SimpleRandomizer::getInstance()->getRandomNumber(0x10000)),
+      ackNr_(0),
+      lastAckNr_(0),
+      replyMicro_(0),
+      bytesInFlight_(0),
+      peerWindow_(UTP_RECV_WINDOW),
+      cwnd_(UTP_INITIAL_WINDOW),
+      slowStart_(true),
+      dupAcks_(0),
+      inRecovery_(false),
+      recoverySeqNr_(0),
+      rtt_(0),
+      rttVar_(0),
+      rto_(UTP_INITIAL_RTO),
+      rtoTimer_(now),
+      baseDelayTimer_(now),
+      queuingDelay_(0),
+      recvBufOffset_(0),
+      reorderedBytes_(0),
+      lastAdvertisedWindow_(UTP_RECV_WINDOW),
+      ackPending_(false),
+      finSent_(false),
+      finAcked_(false),
+      eofReceived_(false),
+      lastReceived_(now),
+      lastSent_(now)
+{
+}
+
+UtpConnection::~UtpConnection() = default;
+
+void UtpConnection::connect(const Timer& now)
+{
+  assert(state_ == UTP_CS_SYN_SENT && inflight_.empty());
+  inflight_.push_back(Packet{UTP_ST_SYN, seqNr_++, {}, now, 0});
+  transmit(inflight_.back(), now);
+}
+
+void UtpConnection::accept(const UtpHeader& syn, const Timer& now)
+{
+  state_ = UTP_CS_CONNECTED;
+  ackNr_ = syn.seqNr;
+  lastAckNr_ = seqNr_ - 1;
+  peerWindow_ = syn.windowSize;
+  replyMicro_ = getUtpTimestamp(now) - syn.timestamp;
+  sendState(now);
+}
+
+void UtpConnection::transmit(Packet& packet, const Timer& now)
+{
+  if (inflight_.size() == 1 || packet.transmissions > 0) {
+    rtoTimer_ = now;
+  }
+  packet.sentTime = now;
+  ++packet.transmissions;
+  sendPacket(packet.type, packet.seqNr, packet.payload.data(),
+             packet.payload.size(), now);
+}
+
+void UtpConnection::sendPacket(uint8_t type, uint16_t seqNr,
+                               const unsigned char* payload, size_t length,
+                               const Timer& now)
+{
+  UtpHeader hdr;
+  hdr.type = type;
+  // SYN carries the ID of the packets sent by the remote peer.
+  hdr.connectionId = type == UTP_ST_SYN ? recvId_ : sendId_;
+  hdr.timestamp = getUtpTimestamp(now);
+  hdr.timestampDiff = replyMicro_;
+  hdr.windowSize = lastAdvertisedWindow_ = getAdvertisedWindow();
+  hdr.seqNr = seqNr;
+  hdr.ackNr = ackNr_;
+  std::vector<unsigned char> data(UTP_HEADER_LENGTH + length);
+  packUtpHeader(data.data(), hdr);
+  if (length) {
+    memcpy(data.data() + UTP_HEADER_LENGTH, payload, length);
+  }
+  outgoingPackets_.push_back(std::move(data));
+  lastSent_ = now;
+  // Every packet carries the latest ack_nr.
+  ackPending_ = false;
+}
+
+void UtpConnection::sendState(const Timer& now)
+{
+  sendPacket(UTP_ST_STATE, seqNr_, nullptr, 0, now);
+}
+
+void UtpConnection::sendAck(const Timer& now)
+{
+  if (ackPending_ && state_ == UTP_CS_CONNECTED) {
+    sendState(now);
+  }
+}
+
+void UtpConnection::receivePacket(const UtpHeader& hdr,
+                                  const unsigned char* payload, size_t length,
+                                  const Timer& now)
+{
+  if (state_ == UTP_CS_CLOSED) {
+    return;
+  }
+  if (hdr.type == UTP_ST_RESET) {
+    state_ = UTP_CS_CLOSED;
+    return;
+  }
+  if (hdr.type == UTP_ST_SYN) {
+    if (state_ == UTP_CS_CONNECTED) {
+      // Our ACK to SYN was lost.
+      lastReceived_ = now;
+      sendState(now);
+    }
+    return;
+  }
+  // The remote peer may acknowledge up to the last packet sent.
+  if (seqLess(static_cast<uint16_t>(seqNr_ - 1), hdr.ackNr)) {
+    return;
+  }
+  if (state_ == UTP_CS_SYN_SENT) {
+    if (hdr.type != UTP_ST_STATE) {
+      return;
+    }
+    state_ = UTP_CS_CONNECTED;
+    // The first data packet from the remote peer has the sequence
+    // number of this packet.
+    ackNr_ = hdr.seqNr - 1;
+  }
+  lastReceived_ = now;
+  replyMicro_ = getUtpTimestamp(now) - hdr.timestamp;
+  peerWindow_ = hdr.windowSize;
+  processAck(hdr, hdr.type == UTP_ST_STATE, now);
+  if (hdr.type == UTP_ST_DATA || hdr.type == UTP_ST_FIN) {
+    receiveData(hdr, payload, length, now);
+  }
+}
+
+void UtpConnection::processAck(const UtpHeader& hdr, bool pureAck,
+                               const Timer& now)
+{
+  size_t numAcked = 0;
+  size_t bytesAcked = 0;
+  int64_t rttSample = -1;
+  while (!inflight_.empty() && !seqLess(hdr.ackNr, inflight_.front().seqNr)) {
+    auto& packet = inflight_.front();
+    // Karn's algorithm: retransmitted packets are not sampled.
+    if (packet.transmissions == 1) {
+      rttSample = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      packet.sentTime.difference(now))
+                      .count();
+    }
+    if (packet.type == UTP_ST_FIN) {
+      finAcked_ = true;
+    }
+    bytesAcked += packet.payload.size();
+    ++numAcked;
+    inflight_.pop_front();
+  }
+  if (numAcked) {
+    bytesInFlight_ -= bytesAcked;
+    dupAcks_ = 0;
+    rtoTimer_ = now;
+    if (rttSample >= 0) {
+      updateRtt(rttSample);
+    }
+    updateWindow(bytesAcked, hdr.timestampDiff, now);
+    if (inRecovery_) {
+      if (!seqLess(hdr.ackNr, recoverySeqNr_) || inflight_.empty()) {
+        inRecovery_ = false;
+      }
+      else {
+        // Partial ACK: the next packet was lost as well.
+        transmit(inflight_.front(), now);
+      }
+    }
+  }
+  else if (pureAck && hdr.ackNr == lastAckNr_ && !inflight_.empty() &&
+           ++dupAcks_ == UTP_DUP_ACK_THRESHOLD && !inRecovery_) {
+    cwnd_ = std::max(cwnd_ / 2, UTP_MIN_WINDOW);
+    slowStart_ = false;
+    inRecovery_ = true;
+    recoverySeqNr_ = inflight_.back().seqNr;
+    transmit(inflight_.front(), now);
+  }
+  lastAckNr_ = hdr.ackNr;
+}
+
+void UtpConnection::receiveData(const UtpHeader& hdr,
+                                const unsigned char* payload, size_t length,
+                                const Timer& now)
+{
+  uint16_t distance = hdr.seqNr - ackNr_;
+  if (distance == 0 || distance >= 0x8000u || eofReceived_) {
+    // Duplicate.  Our ACK may have been lost.
+    sendState(now);
+    return;
+  }
+  if (distance > UTP_MAX_REORDER ||
+      getReceivedDataLength() + reorderedBytes_ + length > UTP_RECV_WINDOW) {
+    return;
+  }
+  if (distance == 1) {
+    deliver(hdr.type, payload, length);
+    ++ackNr_;
+    for (auto i = reordered_.find(ackNr_ + 1); i != std::end(reordered_);
+         i = reordered_.find(ackNr_ + 1)) {
+      auto packet = std::move((*i).second);
+      reordered_.erase(i);
+      reorderedBytes_ -= packet.payload.size();
+      deliver(packet.type, packet.payload.data(), packet.payload.size());
+      ++ackNr_;
+    }
+    ackPending_ = true;
+  }
+  else {
+    if (reordered_.count(hdr.seqNr) == 0) {
+      reordered_.emplace(
+          hdr.seqNr,
+          ReorderedPacket{hdr.type, std::vector<unsigned char>(
+                                        payload, payload + length)});
+      reorderedBytes_ += length;
+    }
+    // Acknowledge immediately, so that the duplicate ACKs trigger
+    // the fast retransmission of the missing packet.
+    sendState(now);
+  }
+}
+
+void UtpConnection::deliver(uint8_t type, const unsigned char* payload,
+                            size_t length)
+{
+  if (eofReceived_) {
+    return;
+  }
+  if (type == UTP_ST_FIN) {
+    eofReceived_ = true;
+    reordered_.clear();
+    reorderedBytes_ = 0;
+    return;
+  }
+  recvBuf_.insert(std::end(recvBuf_), payload, payload + length);
+}
+
+const unsigned char* UtpConnection::getReceivedData() const
+{
+  return recvBuf_.data() + recvBufOffset_;
+}
+
+size_t UtpConnection::getReceivedDataLength() const
+{
+  return recvBuf_.size() - recvBufOffset_;
+}
+
+void UtpConnection::consumeReceivedData(size_t length)
+{
+  assert(length <= getReceivedDataLength());
+  recvBufOffset_ += length;
+  if (recvBufOffset_ == recvBuf_.size()) {
+    recvBuf_.clear();
+    recvBufOffset_ = 0;
+  }
+  else if (recvBufOffset_ >= 64_k && recvBufOffset_ * 2 >= recvBuf_.size()) {
+    recvBuf_.erase(std::begin(recvBuf_), std::begin(recvBuf_) + recvBufOffset_);
+    recvBufOffset_ = 0;
+  }
+  // Tell the remote peer that the window opened again.
+  if (lastAdvertisedWindow_ < UTP_RECV_WINDOW / 2 &&
+      getAdvertisedWindow() >= UTP_RECV_WINDOW / 2) {
+    ackPending_ = true;
+  }
+}
+
+size_t UtpConnection::getAdvertisedWindow() const
+{
+  auto used = getReceivedDataLength() + reorderedBytes_;
+  return used >= UTP_RECV_WINDOW ? 0 : UTP_RECV_WINDOW - used;
+}
+
+size_t UtpConnection::getSendWindow() const
+{
+  if (state_ != UTP_CS_CONNECTED || finSent_) {
+    return 0;
+  }
+  auto window = std::min(static_cast<size_t>(cwnd_), peerWindow_);
+  return window > bytesInFlight_ ? window - bytesInFlight_ : 0;
+}
+
+void UtpConnection::write(const unsigned char* data, size_t length,
+                          const Timer& now)
+{
+  assert(state_ == UTP_CS_CONNECTED && !finSent_);
+  while (length) {
+    auto n = std::min(length, UTP_MAX_PAYLOAD_LENGTH);
+    inflight_.push_back(Packet{UTP_ST_DATA, seqNr_++,
+                               std::vector<unsigned char>(data, data + n),
+                               now, 0});
+    transmit(inflight_.back(), now);
+    bytesInFlight_ += n;
+    data += n;
+    length -= n;
+  }
+}
+
+void UtpConnection::close(const Timer& now)
+{
+  if (finSent_ || state_ == UTP_CS_CLOSED) {
+    return;
+  }
+  if (state_ == UTP_CS_SYN_SENT) {
+    state_ = UTP_CS_CLOSED;
+    return;
+  }
+  finSent_ = true;
+  inflight_.push_back(Packet{UTP_ST_FIN, seqNr_++, {}, now, 0});
+  transmit(inflight_.back(), now);
+}
+
+void UtpConnection::handleTimeout(const Timer& now)
+{
+  if (state_ == UTP_CS_CLOSED) {
+    return;
+  }
+  if (lastReceived_.difference(now) >= UTP_IDLE_TIMEOUT) {
+    state_ = UTP_CS_CLOSED;
+    return;
+  }
+  if (!inflight_.empty() &&
+      rtoTimer_.difference(now) >= std::chrono::milliseconds(rto_)) {
+    auto& packet = inflight_.front();
+    if (packet.transmissions >= (state_ == UTP_CS_SYN_SENT
+                                     ? UTP_MAX_SYN_TRANSMISSIONS
+                                     : UTP_MAX_TRANSMISSIONS)) {
+      state_ = UTP_CS_CLOSED;
+      return;
+    }
+    rto_ = std::min(rto_ * 2, UTP_MAX_RTO);
+    cwnd_ = UTP_MIN_WINDOW;
+    slowStart_ = false;
+    dupAcks_ = 0;
+    inRecovery_ = true;
+    recoverySeqNr_ = inflight_.back().seqNr;
+    transmit(packet, now);
+  }
+  else if (state_ == UTP_CS_CONNECTED &&
+           lastSent_.difference(now) >= UTP_KEEPALIVE_INTERVAL) {
+    sendState(now);
+  }
+}
+
+void UtpConnection::updateRtt(int64_t sample)
+{
+  if (rtt_ == 0) {
+    rtt_ = std::max<int64_t>(sample, 1);
+    rttVar_ = rtt_ / 2;
+  }
+  else {
+    auto delta = rtt_ > sample ? rtt_ - sample : sample - rtt_;
+    rttVar_ += (delta - rttVar_) / 4;
+    rtt_ = std::max<int64_t>(rtt_ + (sample - rtt_) / 8, 1);
+  }
+  rto_ = std::max(rtt_ + 4 * rttVar_, UTP_MIN_RTO);
+}
+
+void UtpConnection::updateBaseDelay(uint32_t delay, const Timer& now)
+{
+  if (baseDelays_.empty() || baseDelayTimer_.difference(now) >= 1_min) {
+    baseDelays_.push_back(delay);
+    if (baseDelays_.size() > UTP_BASE_DELAY_HISTORY) {
+      baseDelays_.pop_front();
+    }
+    baseDelayTimer_ = now;
+  }
+  else if (static_cast<int32_t>(delay - baseDelays_.back()) < 0) {
+    baseDelays_.back() = delay;
+  }
+}
+
+void UtpConnection::updateWindow(size_t bytesAcked, uint32_t delay,
+                                 const Timer& now)
+{
+  // The clocks of both ends are not synchronized, so the delay is
+  // only meaningful relative to the base delay.  0 means that the
+  // remote peer has not measured the delay yet.
+  if (delay == 0 || bytesAcked == 0) {
+    return;
+  }
+  updateBaseDelay(delay, now);
+  auto baseDelay = baseDelays_.front();
+  for (auto d : baseDelays_) {
+    if (static_cast<int32_t>(d - baseDelay) < 0) {
+      baseDelay = d;
+    }
+  }
+  queuingDelay_ = delay - baseDelay;
+  if (slowStart_ && queuingDelay_ < UTP_TARGET_DELAY / 2) {
+    cwnd_ += bytesAcked;
+  }
+  else {
+    slowStart_ = false;
+    double offTarget =
+        (static_cast<double>(UTP_TARGET_DELAY) - queuingDelay_) /
+        UTP_TARGET_DELAY;
+    offTarget = std::max(-1.0, std::min(1.0, offTarget));
+    double windowFactor =
+        static_cast<double>(std::min<double>(bytesAcked, cwnd_)) /
+        std::max<double>(cwnd_, bytesAcked);
+    cwnd_ += UTP_MAX_WINDOW_INCREASE * offTarget * windowFactor;
+  }
+  cwnd_ = std::max(UTP_MIN_WINDOW, std::min(UTP_MAX_WINDOW, cwnd_));
+}
+
+} // namespace aria2
@@ -0,0 +1,250 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_UTP_CONNECTION_H
+#define D_UTP_CONNECTION_H
+
+#include "common.h"
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "TimerA2.h"
+
+namespace aria2 {
+
+// Packet types of uTP defined in BEP 29.
+enum UtpPacketType {
+  UTP_ST_DATA = 0,
+  UTP_ST_FIN = 1,
+  UTP_ST_STATE = 2,
+  UTP_ST_RESET = 3,
+  UTP_ST_SYN = 4
+};
+
+enum UtpConnectionState { UTP_CS_SYN_SENT, UTP_CS_CONNECTED, UTP_CS_CLOSED };
+
+constexpr size_t UTP_HEADER_LENGTH = 20;
+
+// The maximum payload of a packet.  A packet with IP and UDP headers
+// fits in the Ethernet MTU.
+constexpr size_t UTP_MAX_PAYLOAD_LENGTH = 1380;
+
+struct UtpHeader {
+  uint8_t type;
+  uint16_t connectionId;
+  uint32_t timestamp;
+  uint32_t timestampDiff;
+  uint32_t windowSize;
+  uint16_t seqNr;
+  uint16_t ackNr;
+};
+
+// Parses uTP header in data.  Extensions are skipped.  Returns the
+// offset of the payload, or -1 if data is not a uTP packet.
+ssize_t parseUtpHeader(UtpHeader& hdr, const unsigned char* data,
+                       size_t length);
+
+// Writes hdr to data, which must be at least UTP_HEADER_LENGTH bytes.
+void packUtpHeader(unsigned char* data, const UtpHeader& hdr);
+
+// Returns the lower 32 bits of now in microseconds.
+uint32_t getUtpTimestamp(const Timer& now);
+
+// A uTP stream.  This class does not do any I/O.  Received packets
+// are given by receivePacket() and the packets to send are appended
+// to getOutgoingPackets().  The congestion window is controlled by
+// LEDBAT: it grows while the one way delay to the remote peer stays
+// below UTP_TARGET_DELAY above the lowest delay seen in the last
+// minutes, and shrinks when the delay goes beyond it, so that uTP
+// yields to other traffic sharing the bottleneck.
+class UtpConnection {
+public:
+  // recvId is the connection ID of incoming packets and sendId is
+  // the one of outgoing packets.
+  UtpConnection(uint16_t recvId, uint16_t sendId, const Timer& now);
+
+  ~UtpConnection();
+
+  // Sends SYN.
+  void connect(const Timer& now);
+
+  // Accepts the connection initiated by SYN packet syn.
+  void accept(const UtpHeader& syn, const Timer& now);
+
+  void receivePacket(const UtpHeader& hdr, const unsigned char* payload,
+                     size_t length, const Timer& now);
+
+  // Retransmits the packets which are not acknowledged within RTO,
+  // sends keep-alive and closes the connection if the remote peer is
+  // unresponsive.
+  void handleTimeout(const Timer& now);
+
+  // Returns the number of bytes which can be written by write()
+  // without exceeding the congestion window and the window of the
+  // remote peer.
+  size_t getSendWindow() const;
+
+  // Splits data into packets and sends them.
+  void write(const unsigned char* data, size_t length, const Timer& now);
+
+  // Sends FIN.  No data can be written after this call.
+  void close(const Timer& now);
+
+  // Sends ACK if there are received packets not acknowledged yet.
+  void sendAck(const Timer& now);
+
+  // The in-order data received from the remote peer, which has not
+  // been consumed yet.
+  const unsigned char* getReceivedData() const;
+  size_t getReceivedDataLength() const;
+  void consumeReceivedData(size_t length);
+
+  // Returns true if FIN from the remote peer and all data before it
+  // have been received.
+  bool isEofReceived() const { return eofReceived_; }
+
+  bool isFinAcked() const { return finAcked_; }
+
+  UtpConnectionState getState() const { return state_; }
+
+  uint16_t getRecvId() const { return recvId_; }
+  uint16_t getSendId() const { return sendId_; }
+
+  std::deque<std::vector<unsigned char>>& getOutgoingPackets()
+  {
+    return outgoingPackets_;
+  }
+
+  // The congestion window in bytes.
+  size_t getWindow() const { return static_cast<size_t>(cwnd_); }
+
+  size_t getBytesInFlight() const { return bytesInFlight_; }
+
+  size_t getPeerWindow() const { return peerWindow_; }
+
+  // The smoothed round trip time in milliseconds.  0 means no sample
+  // has been taken.
+  int64_t getRtt() const { return rtt_; }
+
+  // The last measured queuing delay in microseconds.
+  uint32_t getQueuingDelay() const { return queuingDelay_; }
+
+private:
+  struct Packet {
+    uint8_t type;
+    uint16_t seqNr;
+    std::vector<unsigned char> payload;
+    Timer sentTime;
+    int transmissions;
+  };
+
+  struct ReorderedPacket {
+    uint8_t type;
+    std::vector<unsigned char> payload;
+  };
+
+  void transmit(Packet& packet, const Timer& now);
+
+  void sendPacket(uint8_t type, uint16_t seqNr, const unsigned char* payload,
+                  size_t length, const Timer& now);
+
+  void sendState(const Timer& now);
+
+  void processAck(const UtpHeader& hdr, bool pureAck, const Timer& now);
+
+  void receiveData(const UtpHeader& hdr, const unsigned char* payload,
+                   size_t length, const Timer& now);
+
+  void deliver(uint8_t type, const unsigned char* payload, size_t length);
+
+  void updateRtt(int64_t sample);
+
+  void updateBaseDelay(uint32_t delay, const Timer& now);
+
+  void updateWindow(size_t bytesAcked, uint32_t delay, const Timer& now);
+
+  size_t getAdvertisedWindow() const;
+
+  UtpConnectionState state_;
+  uint16_t recvId_;
+  uint16_t sendId_;
+  // The sequence number of the next packet to send.
+  uint16_t seqNr_;
+  // The sequence number of the last in-order packet received.
+  uint16_t ackNr_;
+  uint16_t lastAckNr_;
+  // The timestamp difference echoed back to the remote peer.
+  uint32_t replyMicro_;
+
+  std::deque<Packet> inflight_;
+  size_t bytesInFlight_;
+  size_t peerWindow_;
+  double cwnd_;
+  bool slowStart_;
+  int dupAcks_;
+  bool inRecovery_;
+  uint16_t recoverySeqNr_;
+
+  int64_t rtt_;
+  int64_t rttVar_;
+  int64_t rto_;
+  Timer rtoTimer_;
+
+  // The lowest delay for each minute in the last few minutes.
+  std::deque<uint32_t> baseDelays_;
+  Timer baseDelayTimer_;
+  uint32_t queuingDelay_;
+
+  std::vector<unsigned char> recvBuf_;
+  size_t recvBufOffset_;
+  std::map<uint16_t, ReorderedPacket> reordered_;
+  size_t reorderedBytes_;
+  size_t lastAdvertisedWindow_;
+  bool ackPending_;
+
+  bool finSent_;
+  bool finAcked_;
+  bool eofReceived_;
+
+  Timer lastReceived_;
+  Timer lastSent_;
+
+  std::deque<std::vector<unsigned char>> outgoingPackets_;
+};
+
+} // namespace aria2
+
+#endif // D_UTP_CONNECTION_H
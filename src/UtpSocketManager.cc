@@ -0,0 +1,411 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "UtpSocketManager.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include "DownloadEngine.h"
+#include "Command.h"
+#include "SocketCore.h"
+#include "SimpleRandomizer.h"
+#include "RecoverableException.h"
+#include "DlAbortEx.h"
+#include "LogFactory.h"
+#include "Logger.h"
+#include "util.h"
+#include "fmt.h"
+
+namespace aria2 {
+
+const size_t UtpSocketManager::MAX_CONNECTIONS;
+const size_t UtpSocketManager::MAX_PENDING_PACKETS;
+
+namespace {
+// Creates a pair of connected stream sockets.  The first one is for
+// the application and the second one is for UtpSocketManager.
+std::pair<std::shared_ptr<SocketCore>, std::shared_ptr<SocketCore>>
+createBridge()
+{
+#ifdef HAVE_SOCKETPAIR
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+    int errNum = errno;
+    throw DL_ABORT_EX(fmt("Failed to create uTP socket: %s",
+                          util::safeStrerror(errNum).c_str()));
+  }
+  auto appSocket = std::make_shared<SocketCore>(fds[0], SOCK_STREAM);
+  auto bridge = std::make_shared<SocketCore>(fds[1], SOCK_STREAM);
+  for (auto& s : {appSocket, bridge}) {
+    util::make_fd_cloexec(s->getSockfd());
+    s->setNonBlockingMode();
+  }
+  return std::make_pair(std::move(appSocket), std::move(bridge));
+#else  // !HAVE_SOCKETPAIR
+  throw DL_ABORT_EX("uTP is not supported on this platform");
+#endif // !HAVE_SOCKETPAIR
+}
+} // namespace
+
+UtpSocketManager::UtpSocketManager()
+    : buf_(64_k), e_(nullptr), command_(nullptr)
+{
+}
+
+UtpSocketManager::~UtpSocketManager() { setEventTarget(nullptr, nullptr); }
+
+void UtpSocketManager::setEventTarget(DownloadEngine* e, Command* command)
+{
+  for (auto& kv : entries_) {
+    auto& entry = *kv.second;
+    if (e_ && entry.readCheck) {
+      e_->deleteSocketForReadCheck(entry.bridge, command_);
+    }
+    if (e_ && entry.writeCheck) {
+      e_->deleteSocketForWriteCheck(entry.bridge, command_);
+    }
+    entry.readCheck = entry.writeCheck = false;
+  }
+  e_ = e;
+  command_ = command;
+}
+
+bool UtpSocketManager::isUtpPacket(const unsigned char* data, size_t length)
+{
+  return length >= UTP_HEADER_LENGTH && (data[0] & 0x0fu) == 1 &&
+         (data[0] >> 4) <= UTP_ST_SYN;
+}
+
+UtpSocketManager::Entry*
+UtpSocketManager::createEntry(std::unique_ptr<UtpConnection> connection,
+                              const std::string& remoteAddr,
+                              uint16_t remotePort,
+                              std::shared_ptr<SocketCore>& appSocket)
+{
+  auto sockets = createBridge();
+  appSocket = std::move(sockets.first);
+  auto key = Key(remoteAddr, remotePort, connection->getRecvId());
+  auto entry = make_unique<Entry>();
+  entry->connection = std::move(connection);
+  entry->remoteAddr = remoteAddr;
+  entry->remotePort = remotePort;
+  entry->bridge = std::move(sockets.second);
+  entry->appfd = appSocket->getSockfd();
+  entry->readCheck = entry->writeCheck = false;
+  entry->connectWaiter = nullptr;
+  auto p = entry.get();
+  appSockets_[p->appfd] = p;
+  entries_.emplace(std::move(key), std::move(entry));
+  return p;
+}
+
+std::shared_ptr<SocketCore>
+UtpSocketManager::connect(const std::string& remoteAddr, uint16_t remotePort,
+                          const Timer& now)
+{
+  uint16_t recvId;
+  do {
+    recvId = SimpleRandomizer::getInstance()->getRandomNumber(0x10000);
+  } while (entries_.count(Key(remoteAddr, remotePort, recvId)));
+  std::shared_ptr<SocketCore> appSocket;
+  auto entry =
+      createEntry(make_unique<UtpConnection>(recvId, recvId + 1, now),
+                  remoteAddr, remotePort, appSocket);
+  entry->connection->connect(now);
+  collectPackets(*entry);
+  return appSocket;
+}
+
+UtpConnectionState UtpSocketManager::getConnectionState(
+    const std::shared_ptr<SocketCore>& socket) const
+{
+  auto i = appSockets_.find(socket->getSockfd());
+  if (i == std::end(appSockets_)) {
+    return UTP_CS_CLOSED;
+  }
+  return (*i).second->connection->getState();
+}
+
+void UtpSocketManager::setConnectWaiter(
+    const std::shared_ptr<SocketCore>& socket, Command* command)
+{
+  auto i = appSockets_.find(socket->getSockfd());
+  if (i != std::end(appSockets_)) {
+    (*i).second->connectWaiter = command;
+  }
+}
+
+UtpSocketManager::Entry* UtpSocketManager::findEntry(
+    const UtpHeader& hdr, const std::string& remoteAddr, uint16_t remotePort)
+{
+  auto i = entries_.find(Key(remoteAddr, remotePort, hdr.connectionId));
+  if (i != std::end(entries_)) {
+    return (*i).second.get();
+  }
+  if (hdr.type == UTP_ST_RESET) {
+    // RESET may carry the ID of the packets we send.
+    for (auto id : {static_cast<uint16_t>(hdr.connectionId + 1),
+                    static_cast<uint16_t>(hdr.connectionId - 1)}) {
+      i = entries_.find(Key(remoteAddr, remotePort, id));
+      if (i != std::end(entries_) &&
+          (*i).second->connection->getSendId() == hdr.connectionId) {
+        return (*i).second.get();
+      }
+    }
+  }
+  return nullptr;
+}
+
+void UtpSocketManager::receivePacket(const unsigned char* data, size_t length,
+                                     const std::string& remoteAddr,
+                                     uint16_t remotePort, const Timer& now)
+{
+  UtpHeader hdr;
+  auto offset = parseUtpHeader(hdr, data, length);
+  if (offset == -1) {
+    return;
+  }
+  if (hdr.type == UTP_ST_SYN) {
+    auto i = entries_.find(Key(remoteAddr, remotePort,
+                               static_cast<uint16_t>(hdr.connectionId + 1)));
+    if (i != std::end(entries_)) {
+      (*i).second->connection->receivePacket(hdr, nullptr, 0, now);
+      collectPackets(*(*i).second);
+      return;
+    }
+    if (entries_.size() >= MAX_CONNECTIONS) {
+      sendReset(hdr, remoteAddr, remotePort, now);
+      return;
+    }
+    std::shared_ptr<SocketCore> appSocket;
+    try {
+      auto entry = createEntry(
+          make_unique<UtpConnection>(hdr.connectionId + 1, hdr.connectionId,
+                                     now),
+          remoteAddr, remotePort, appSocket);
+      entry->connection->accept(hdr, now);
+      collectPackets(*entry);
+    }
+    catch (RecoverableException& e) {
+      A2_LOG_INFO_EX("Failed to accept uTP connection.", e);
+      sendReset(hdr, remoteAddr, remotePort, now);
+      return;
+    }
+    A2_LOG_DEBUG(fmt("Accepted the uTP connection from %s:%u.",
+                     remoteAddr.c_str(), remotePort));
+    acceptedConnections_.emplace_back(std::move(appSocket), remoteAddr,
+                                      remotePort);
+    return;
+  }
+  auto entry = findEntry(hdr, remoteAddr, remotePort);
+  if (!entry) {
+    if (hdr.type != UTP_ST_RESET) {
+      sendReset(hdr, remoteAddr, remotePort, now);
+    }
+    return;
+  }
+  entry->connection->receivePacket(hdr, data + offset, length - offset, now);
+}
+
+void UtpSocketManager::sendReset(const UtpHeader& hdr,
+                                 const std::string& remoteAddr,
+                                 uint16_t remotePort, const Timer& now)
+{
+  UtpHeader rst;
+  rst.type = UTP_ST_RESET;
+  rst.connectionId = hdr.connectionId;
+  rst.timestamp = getUtpTimestamp(now);
+  rst.timestampDiff = 0;
+  rst.windowSize = 0;
+  rst.seqNr = SimpleRandomizer::getInstance()->getRandomNumber(0x10000);
+  rst.ackNr = hdr.seqNr;
+  std::vector<unsigned char> data(UTP_HEADER_LENGTH);
+  packUtpHeader(data.data(), rst);
+  pendingPackets_.push_back(
+      UtpOutgoingPacket{remoteAddr, remotePort, std::move(data)});
+}
+
+void UtpSocketManager::process(const Timer& now)
+{
+  for (auto i = std::begin(entries_); i != std::end(entries_);) {
+    auto& entry = *(*i).second;
+    auto& connection = *entry.connection;
+    connection.handleTimeout(now);
+    if (entry.bridge) {
+      try {
+        pumpBridge(entry, now);
+      }
+      catch (RecoverableException& e) {
+        A2_LOG_INFO_EX(fmt("uTP connection to %s:%u failed.",
+                           entry.remoteAddr.c_str(), entry.remotePort),
+                       e);
+        closeBridge(entry);
+        connection.close(now);
+      }
+    }
+    connection.sendAck(now);
+    collectPackets(entry);
+    if (entry.connectWaiter && connection.getState() != UTP_CS_SYN_SENT) {
+      // The connection is established, reset or timed out.
+      entry.connectWaiter->setStatusActive();
+      entry.connectWaiter = nullptr;
+      if (e_) {
+        e_->setNoWait(true);
+      }
+    }
+    if (connection.getState() == UTP_CS_CLOSED) {
+      closeBridge(entry);
+    }
+    if (!entry.bridge && (connection.getState() == UTP_CS_CLOSED ||
+                          connection.isFinAcked())) {
+      A2_LOG_DEBUG(fmt("uTP connection to %s:%u closed.",
+                       entry.remoteAddr.c_str(), entry.remotePort));
+      i = entries_.erase(i);
+      continue;
+    }
+    updateEvents(entry);
+    ++i;
+  }
+}
+
+void UtpSocketManager::pumpBridge(Entry& entry, const Timer& now)
+{
+  auto& connection = *entry.connection;
+  while (connection.getReceivedDataLength()) {
+    auto n = entry.bridge->writeData(connection.getReceivedData(),
+                                     connection.getReceivedDataLength());
+    if (n <= 0) {
+      break;
+    }
+    connection.consumeReceivedData(n);
+  }
+  if (connection.isEofReceived() && connection.getReceivedDataLength() == 0) {
+    closeBridge(entry);
+    connection.close(now);
+    return;
+  }
+  while (pendingPackets_.size() < MAX_PENDING_PACKETS) {
+    auto len = std::min(connection.getSendWindow(), buf_.size());
+    if (len == 0) {
+      break;
+    }
+    entry.bridge->readData(buf_.data(), len);
+    if (len == 0) {
+      if (!entry.bridge->wantRead()) {
+        // The application closed the socket.
+        closeBridge(entry);
+        connection.close(now);
+      }
+      break;
+    }
+    connection.write(buf_.data(), len, now);
+    collectPackets(entry);
+  }
+}
+
+void UtpSocketManager::closeBridge(Entry& entry)
+{
+  if (!entry.bridge) {
+    return;
+  }
+  auto i = appSockets_.find(entry.appfd);
+  if (i != std::end(appSockets_) && (*i).second == &entry) {
+    appSockets_.erase(i);
+  }
+  if (e_ && entry.readCheck) {
+    e_->deleteSocketForReadCheck(entry.bridge, command_);
+  }
+  if (e_ && entry.writeCheck) {
+    e_->deleteSocketForWriteCheck(entry.bridge, command_);
+  }
+  entry.readCheck = entry.writeCheck = false;
+  entry.bridge.reset();
+}
+
+void UtpSocketManager::updateEvents(Entry& entry)
+{
+  if (!e_ || !entry.bridge) {
+    return;
+  }
+  // Reading is stopped while the window is closed.  Otherwise the
+  // event loop would spin on the pending data.
+  bool readCheck = entry.connection->getSendWindow() > 0 &&
+                   pendingPackets_.size() < MAX_PENDING_PACKETS;
+  bool writeCheck = entry.connection->getReceivedDataLength() > 0;
+  if (readCheck != entry.readCheck) {
+    if (readCheck) {
+      e_->addSocketForReadCheck(entry.bridge, command_);
+    }
+    else {
+      e_->deleteSocketForReadCheck(entry.bridge, command_);
+    }
+    entry.readCheck = readCheck;
+  }
+  if (writeCheck != entry.writeCheck) {
+    if (writeCheck) {
+      e_->addSocketForWriteCheck(entry.bridge, command_);
+    }
+    else {
+      e_->deleteSocketForWriteCheck(entry.bridge, command_);
+    }
+    entry.writeCheck = writeCheck;
+  }
+}
+
+void UtpSocketManager::collectPackets(Entry& entry)
+{
+  auto& packets = entry.connection->getOutgoingPackets();
+  for (auto& data : packets) {
+    pendingPackets_.push_back(UtpOutgoingPacket{
+        entry.remoteAddr, entry.remotePort, std::move(data)});
+  }
+  packets.clear();
+}
+
+void UtpSocketManager::packetSent() { pendingPackets_.pop_front(); }
+
+bool UtpSocketManager::popAcceptedConnection(
+    std::shared_ptr<SocketCore>& socket, std::string& remoteAddr,
+    uint16_t& remotePort)
+{
+  if (acceptedConnections_.empty()) {
+    return false;
+  }
+  std::tie(socket, remoteAddr, remotePort) = acceptedConnections_.front();
+  acceptedConnections_.pop_front();
+  return true;
+}
+
+} // namespace aria2
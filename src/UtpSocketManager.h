@@ -0,0 +1,178 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_UTP_SOCKET_MANAGER_H
+#define D_UTP_SOCKET_MANAGER_H
+
+#include "common.h"
+
+#include <string>
+#include <deque>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "UtpConnection.h"
+#include "a2netcompat.h"
+
+namespace aria2 {
+
+class DownloadEngine;
+class Command;
+class SocketCore;
+
+struct UtpOutgoingPacket {
+  std::string remoteAddr;
+  uint16_t remotePort;
+  std::vector<unsigned char> data;
+};
+
+// Multiplexes uTP connections on the UDP socket of DHT.  Each uTP
+// connection is bridged to a stream socket, so that BitTorrent
+// commands read and write it in the same way as a TCP connection.
+// Like UDPTrackerClient, this class does not own the UDP socket:
+// received packets are given by receivePacket() and the packets to
+// send are taken from getPendingPackets().
+class UtpSocketManager {
+public:
+  UtpSocketManager();
+  ~UtpSocketManager();
+
+  // The bridge sockets are registered to e with command, so that
+  // command is executed when the application side writes data, or
+  // reads data after the bridge socket is full.  nullptr disables
+  // the registration.
+  void setEventTarget(DownloadEngine* e, Command* command);
+
+  // Initiates a uTP connection to remoteAddr:remotePort and returns
+  // the socket of the application side.  Use getConnectionState() to
+  // know whether the connection is established.
+  std::shared_ptr<SocketCore> connect(const std::string& remoteAddr,
+                                      uint16_t remotePort, const Timer& now);
+
+  // Returns the state of the connection bridged to socket.  If the
+  // connection failed or is not found, returns UTP_CS_CLOSED.
+  UtpConnectionState
+  getConnectionState(const std::shared_ptr<SocketCore>& socket) const;
+
+  // Makes command active when the connection bridged to socket is
+  // established or fails, so that command can sleep meanwhile.
+  // nullptr cancels it.
+  void setConnectWaiter(const std::shared_ptr<SocketCore>& socket,
+                        Command* command);
+
+  void receivePacket(const unsigned char* data, size_t length,
+                     const std::string& remoteAddr, uint16_t remotePort,
+                     const Timer& now);
+
+  // Moves data between the connections and the bridge sockets, and
+  // handles timeouts.
+  void process(const Timer& now);
+
+  const std::deque<UtpOutgoingPacket>& getPendingPackets() const
+  {
+    return pendingPackets_;
+  }
+
+  // Tells this object that the first entry of getPendingPackets() is
+  // sent.
+  void packetSent();
+
+  // Takes a connection accepted from the remote peer.  Returns false
+  // if there is no such connection.
+  bool popAcceptedConnection(std::shared_ptr<SocketCore>& socket,
+                             std::string& remoteAddr, uint16_t& remotePort);
+
+  size_t countConnection() const { return entries_.size(); }
+
+  // Returns true if data looks like a uTP packet.  DHT messages start
+  // with 'd' and UDP tracker responses with 0.
+  static bool isUtpPacket(const unsigned char* data, size_t length);
+
+  // The maximum number of connections.  SYN is reset beyond this.
+  static const size_t MAX_CONNECTIONS = 1024;
+
+  // No data is read from the bridge sockets while there are this
+  // number of pending packets.
+  static const size_t MAX_PENDING_PACKETS = 256;
+
+private:
+  struct Entry {
+    std::unique_ptr<UtpConnection> connection;
+    std::string remoteAddr;
+    uint16_t remotePort;
+    // The manager side of the bridge.  nullptr after it is closed.
+    std::shared_ptr<SocketCore> bridge;
+    // The file descriptor of the application side of the bridge.
+    sock_t appfd;
+    bool readCheck;
+    bool writeCheck;
+    // The Command waiting for the connection to be established
+    Command* connectWaiter;
+  };
+
+  typedef std::tuple<std::string, uint16_t, uint16_t> Key;
+
+  Entry* createEntry(std::unique_ptr<UtpConnection> connection,
+                     const std::string& remoteAddr, uint16_t remotePort,
+                     std::shared_ptr<SocketCore>& appSocket);
+
+  Entry* findEntry(const UtpHeader& hdr, const std::string& remoteAddr,
+                   uint16_t remotePort);
+
+  void pumpBridge(Entry& entry, const Timer& now);
+
+  void closeBridge(Entry& entry);
+
+  void updateEvents(Entry& entry);
+
+  void collectPackets(Entry& entry);
+
+  void sendReset(const UtpHeader& hdr, const std::string& remoteAddr,
+                 uint16_t remotePort, const Timer& now);
+
+  std::map<Key, std::unique_ptr<Entry>> entries_;
+  std::map<sock_t, Entry*> appSockets_;
+  std::deque<UtpOutgoingPacket> pendingPackets_;
+  std::deque<std::tuple<std::shared_ptr<SocketCore>, std::string, uint16_t>>
+      acceptedConnections_;
+  std::vector<unsigned char> buf_;
+  DownloadEngine* e_;
+  Command* command_;
+};
+
+} // namespace aria2
+
+#endif // D_UTP_SOCKET_MANAGER_H
@@ -162,10 +162,13 @@ Dict::Dict() {}
 
 void Dict::put(std::string key, std::unique_ptr<ValueBase> vlb)
 {
-  auto p = std::make_pair(std::move(key), std::move(vlb));
-  auto r = dict_.insert(std::move(p));
-  if (!r.second) {
-    (*r.first).second = std::move(p.second);
+  // insert() may move from its argument even if key exists.
+  auto i = dict_.lower_bound(key);
+  if (i != std::end(dict_) && (*i).first == key) {
+    (*i).second = std::move(vlb);
+  }
+  else {
+    dict_.emplace_hint(i, std::move(key), std::move(vlb));
   }
 }
 
@@ -0,0 +1,139 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "ValueBaseWriter.h"
+
+#include <cassert>
+
+namespace aria2 {
+
+ValueBaseWriter::ValueBaseWriter() {}
+
+void ValueBaseWriter::add(std::unique_ptr<ValueBase> vlb)
+{
+  if (stack_.empty()) {
+    result_ = std::move(vlb);
+    return;
+  }
+  auto& parent = stack_.back().value;
+  auto dict = downcast<Dict>(parent);
+  if (dict) {
+    dict->put(std::move(key_), std::move(vlb));
+  }
+  else {
+    static_cast<List*>(parent.get())->append(std::move(vlb));
+  }
+}
+
+void ValueBaseWriter::begin(std::unique_ptr<ValueBase> vlb)
+{
+  stack_.push_back(Frame{std::move(vlb), std::move(key_)});
+}
+
+void ValueBaseWriter::end()
+{
+  assert(!stack_.empty());
+  auto frame = std::move(stack_.back());
+  stack_.pop_back();
+  key_ = std::move(frame.key);
+  add(std::move(frame.value));
+}
+
+ValueBaseWriter& ValueBaseWriter::beginObject()
+{
+  begin(Dict::g());
+  return *this;
+}
+
+ValueBaseWriter& ValueBaseWriter::endObject()
+{
+  end();
+  return *this;
+}
+
+ValueBaseWriter& ValueBaseWriter::beginArray()
+{
+  begin(List::g());
+  return *this;
+}
+
+ValueBaseWriter& ValueBaseWriter::endArray()
+{
+  end();
+  return *this;
+}
+
+ValueBaseWriter& ValueBaseWriter::key(const std::string& k)
+{
+  key_ = k;
+  return *this;
+}
+
+ValueBaseWriter& ValueBaseWriter::string(std::string s)
+{
+  add(String::g(std::move(s)));
+  return *this;
+}
+
+ValueBaseWriter& ValueBaseWriter::integer(int64_t i)
+{
+  add(Integer::g(i));
+  return *this;
+}
+
+ValueBaseWriter& ValueBaseWriter::boolean(bool b)
+{
+  add(b ? Bool::gTrue() : Bool::gFalse());
+  return *this;
+}
+
+ValueBaseWriter& ValueBaseWriter::null()
+{
+  add(Null::g());
+  return *this;
+}
+
+ValueBaseWriter& ValueBaseWriter::value(std::unique_ptr<ValueBase> vlb)
+{
+  add(std::move(vlb));
+  return *this;
+}
+
+std::unique_ptr<ValueBase> ValueBaseWriter::getResult()
+{
+  assert(stack_.empty());
+  return std::move(result_);
+}
+
+} // namespace aria2
@@ -0,0 +1,89 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_VALUE_BASE_WRITER_H
+#define D_VALUE_BASE_WRITER_H
+
+#include "common.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ValueBase.h"
+
+namespace aria2 {
+
+// Builds ValueBase through the same interface as json::JsonWriter, so
+// that the same code can produce a result either as ValueBase or as
+// JSON text.
+class ValueBaseWriter {
+public:
+  ValueBaseWriter();
+
+  ValueBaseWriter& beginObject();
+  ValueBaseWriter& endObject();
+  ValueBaseWriter& beginArray();
+  ValueBaseWriter& endArray();
+  // Sets the key of the next value in the object.
+  ValueBaseWriter& key(const std::string& k);
+  ValueBaseWriter& string(std::string s);
+  ValueBaseWriter& integer(int64_t i);
+  ValueBaseWriter& boolean(bool b);
+  ValueBaseWriter& null();
+  ValueBaseWriter& value(std::unique_ptr<ValueBase> vlb);
+
+  // Returns the built value.  All objects and arrays must have been
+  // closed.
+  std::unique_ptr<ValueBase> getResult();
+
+private:
+  struct Frame {
+    std::unique_ptr<ValueBase> value;
+    // The key of value in the parent object
+    std::string key;
+  };
+
+  void add(std::unique_ptr<ValueBase> vlb);
+  void begin(std::unique_ptr<ValueBase> vlb);
+  void end();
+
+  std::vector<Frame> stack_;
+  std::string key_;
+  std::unique_ptr<ValueBase> result_;
+};
+
+} // namespace aria2
+
+#endif // D_VALUE_BASE_WRITER_H
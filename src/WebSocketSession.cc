@@ -43,6 +43,7 @@
 #include "RecoverableException.h"
 #include "message.h"
 #include "DownloadEngine.h"
+#include "WebSocketSessionMan.h"
 #include "DelayedCommand.h"
 #include "WebSocketInteractionCommand.h"
 #include "rpc_helper.h"
@@ -176,7 +177,7 @@ void onMsgRecvCallback(wslay_event_context_ptr wsctx,
     Dict* jsondict = downcast<Dict>(json);
     auto e = wsSession->getDownloadEngine();
     if (jsondict) {
-      RpcResponse res = processJsonRpcRequest(jsondict, e);
+      RpcResponse res = processJsonRpcRequest(jsondict, e, wsSession);
       addResponse(wsSession, res);
     }
     else {
@@ -189,7 +190,7 @@ void onMsgRecvCallback(wslay_event_context_ptr wsctx,
              i != eoi; ++i) {
           Dict* jsondict = downcast<Dict>(*i);
           if (jsondict) {
-            auto resp = processJsonRpcRequest(jsondict, e);
+            auto resp = processJsonRpcRequest(jsondict, e, wsSession);
             results.push_back(std::move(resp));
           }
         }
@@ -298,6 +299,15 @@ void WebSocketSession::addTextMessage(const std::string& msg, bool delayed)
   wslay_event_queue_msg(wsctx_, &arg);
 }
 
+void WebSocketSession::setSubscription(
+    std::unique_ptr<StatusSubscription> subscription)
+{
+  subscription_ = std::move(subscription);
+  if (subscription_) {
+    e_->getWebSocketSessionMan()->wakeSubscriptionCommand(e_);
+  }
+}
+
 bool WebSocketSession::closeReceived()
 {
   return wslay_event_get_close_received(wsctx_);
@@ -42,6 +42,7 @@
 #include <wslay/wslay.h>
 
 #include "ValueBaseJsonParser.h"
+#include "StatusSubscription.h"
 
 namespace aria2 {
 
@@ -101,6 +102,11 @@ public:
 
   void setIgnorePayload(bool flag) { ignorePayload_ = flag; }
 
+  // Returns the subscription made by aria2.subscribe, or nullptr.
+  StatusSubscription* getSubscription() const { return subscription_.get(); }
+
+  void setSubscription(std::unique_ptr<StatusSubscription> subscription);
+
 private:
   std::shared_ptr<SocketCore> socket_;
   DownloadEngine* e_;
@@ -109,6 +115,7 @@ private:
   int32_t receivedLength_;
   json::ValueBaseJsonParser parser_;
   WebSocketInteractionCommand* command_;
+  std::unique_ptr<StatusSubscription> subscription_;
 };
 
 } // namespace rpc
@@ -42,12 +42,15 @@
 #include "util.h"
 #include "WebSocketInteractionCommand.h"
 #include "LogFactory.h"
+#include "StatusSubscription.h"
+#include "wallclock.h"
+#include "DownloadEngine.h"
 
 namespace aria2 {
 
 namespace rpc {
 
-WebSocketSessionMan::WebSocketSessionMan() {}
+WebSocketSessionMan::WebSocketSessionMan() : subscriptionCommand_(nullptr) {}
 
 WebSocketSessionMan::~WebSocketSessionMan() = default;
 
@@ -83,6 +86,58 @@ void WebSocketSessionMan::addNotification(const std::string& method,
   }
 }
 
+std::chrono::milliseconds
+WebSocketSessionMan::pushStatusChanges(DownloadEngine* e)
+{
+  // Wakes up at least once a second to see whether the downloads
+  // have finished.
+  auto timeout = std::chrono::milliseconds(1_s);
+  const auto& now = global::wallclock();
+  std::vector<WebSocketSession*> due;
+  std::vector<const StatusSubscription*> dueSubscriptions;
+  for (auto& session : sessions_) {
+    auto sub = session->getSubscription();
+    if (!sub) {
+      continue;
+    }
+    if (sub->getTimeout(now) == std::chrono::milliseconds::zero()) {
+      due.push_back(session.get());
+      dueSubscriptions.push_back(sub);
+    }
+  }
+  if (!due.empty()) {
+    // The status of each download is gathered once for all sessions.
+    StatusSnapshot snapshot(e, StatusSubscription::unionKeys(dueSubscriptions));
+    for (auto session : due) {
+      auto msg = session->getSubscription()->update(snapshot, now);
+      if (!msg.empty()) {
+        session->addTextMessage(msg, false);
+        session->getCommand()->updateWriteCheck();
+      }
+    }
+  }
+  for (auto& session : sessions_) {
+    auto sub = session->getSubscription();
+    if (sub) {
+      timeout = std::min(timeout, sub->getTimeout(now));
+    }
+  }
+  return timeout;
+}
+
+void WebSocketSessionMan::setSubscriptionCommand(Command* command)
+{
+  subscriptionCommand_ = command;
+}
+
+void WebSocketSessionMan::wakeSubscriptionCommand(DownloadEngine* e)
+{
+  if (subscriptionCommand_) {
+    subscriptionCommand_->setStatusActive();
+    e->setNoWait(true);
+  }
+}
+
 namespace {
 // The string constants for download events.
 const std::string ON_DOWNLOAD_START = "aria2.onDownloadStart";
@@ -40,12 +40,15 @@
 #include <set>
 #include <string>
 #include <memory>
+#include <chrono>
 
 #include "a2functional.h"
 
 namespace aria2 {
 
 class RequestGroup;
+class DownloadEngine;
+class Command;
 
 namespace rpc {
 
@@ -60,11 +63,21 @@ public:
   void addSession(const std::shared_ptr<WebSocketSession>& wsSession);
   void removeSession(const std::shared_ptr<WebSocketSession>& wsSession);
   void addNotification(const std::string& method, const RequestGroup* group);
+  // Sends the status changes to the sessions whose subscriptions are
+  // due, and returns the time until the next one is due.
+  std::chrono::milliseconds pushStatusChanges(DownloadEngine* e);
+  // Sets the Command which calls pushStatusChanges(), or nullptr.
+  void setSubscriptionCommand(Command* command);
+  // Wakes up the Command set by setSubscriptionCommand(), so that a
+  // new or changed subscription takes effect without waiting for its
+  // current sleep to end.
+  void wakeSubscriptionCommand(DownloadEngine* e);
   virtual void onEvent(DownloadEvent event,
                        const RequestGroup* group) CXX11_OVERRIDE;
 
 private:
   WebSocketSessions sessions_;
+  Command* subscriptionCommand_;
 };
 
 } // namespace rpc
@@ -35,14 +35,25 @@
 #include "WrDiskCache.h"
 
 #include <cassert>
+#include <algorithm>
+#include <functional>
 
 #include "WrDiskCacheEntry.h"
 #include "LogFactory.h"
 #include "fmt.h"
+#include "Tracer.h"
 
 namespace aria2 {
 
-WrDiskCache::WrDiskCache(size_t limit) : limit_(limit), total_(0), clock_(0) {}
+namespace {
+// The neighbouring entries are not coalesced beyond this length.
+constexpr size_t MAX_RUN_LENGTH = 16_m;
+} // namespace
+
+WrDiskCache::WrDiskCache(size_t limit)
+    : limit_(limit), total_(0), clock_(0), stat_()
+{
+}
 
 WrDiskCache::~WrDiskCache()
 {
@@ -50,14 +61,54 @@ WrDiskCache::~WrDiskCache()
     A2_LOG_WARN(fmt("Write disk cache is not empty size=%lu",
                     static_cast<unsigned long>(total_)));
   }
+  A2_LOG_INFO(fmt("Write disk cache stat: writes=%" PRIu64 ", hits=%" PRIu64
+                  ", flushes=%" PRIu64 ", evictions=%" PRIu64
+                  ", cells=%" PRIu64 ", writeCalls=%" PRIu64
+                  ", bytes=%" PRIu64,
+                  stat_.writes, stat_.hits, stat_.flushes, stat_.evictions,
+                  stat_.cellsFlushed, stat_.writeCalls, stat_.bytesFlushed));
+}
+
+bool WrDiskCache::OffsetLess::operator()(const WrDiskCacheEntry* lhs,
+                                         const WrDiskCacheEntry* rhs) const
+{
+  auto la = lhs->getDiskAdaptor().get();
+  auto ra = rhs->getDiskAdaptor().get();
+  if (la != ra) {
+    return std::less<const void*>()(la, ra);
+  }
+  if (lhs->getOffsetKey() != rhs->getOffsetKey()) {
+    return lhs->getOffsetKey() < rhs->getOffsetKey();
+  }
+  return std::less<const WrDiskCacheEntry*>()(lhs, rhs);
+}
+
+bool WrDiskCache::erase(WrDiskCacheEntry* ent)
+{
+  if (!set_.erase(ent)) {
+    return false;
+  }
+  offsetSet_.erase(ent);
+  return true;
+}
+
+void WrDiskCache::insert(WrDiskCacheEntry* ent)
+{
+  ent->setSizeKey(ent->getSize());
+  ent->setOffsetKey(ent->getFirstOffset());
+  ent->setLastUpdate(++clock_);
+  set_.insert(ent);
+  offsetSet_.insert(ent);
 }
 
 bool WrDiskCache::add(WrDiskCacheEntry* ent)
 {
   ent->setSizeKey(ent->getSize());
+  ent->setOffsetKey(ent->getFirstOffset());
   ent->setLastUpdate(++clock_);
   std::pair<EntrySet::iterator, bool> rv = set_.insert(ent);
   if (rv.second) {
+    offsetSet_.insert(ent);
     total_ += ent->getSize();
     ensureLimit();
     return true;
@@ -75,7 +126,7 @@ bool WrDiskCache::add(WrDiskCacheEntry* ent)
 
 bool WrDiskCache::remove(WrDiskCacheEntry* ent)
 {
-  if (set_.erase(ent)) {
+  if (erase(ent)) {
     A2_LOG_DEBUG(fmt("Removed cache entry size=%lu, clock=%" PRId64,
                      static_cast<unsigned long>(ent->getSize()),
                      ent->getLastUpdate()));
@@ -89,40 +140,109 @@ bool WrDiskCache::remove(WrDiskCacheEntry* ent)
 
 bool WrDiskCache::update(WrDiskCacheEntry* ent, ssize_t delta)
 {
-  if (!set_.erase(ent)) {
+  if (!erase(ent)) {
     return false;
   }
   A2_LOG_DEBUG(fmt("Update cache entry size=%lu, delta=%ld, clock=%" PRId64,
                    static_cast<unsigned long>(ent->getSize()),
                    static_cast<long>(delta), ent->getLastUpdate()));
 
-  ent->setSizeKey(ent->getSize());
-  ent->setLastUpdate(++clock_);
-  set_.insert(ent);
+  insert(ent);
 
   if (delta < 0) {
     assert(total_ >= static_cast<size_t>(-delta));
   }
+  else if (delta > 0) {
+    ++stat_.writes;
+  }
   total_ += delta;
   ensureLimit();
   return true;
 }
 
+bool WrDiskCache::merge(WrDiskCacheEntry* ent, size_t delta)
+{
+  if (!update(ent, delta)) {
+    return false;
+  }
+  ++stat_.hits;
+  return true;
+}
+
+bool WrDiskCache::flush(WrDiskCacheEntry* ent)
+{
+  if (!erase(ent)) {
+    return false;
+  }
+  total_ -= ent->getSize();
+  ++stat_.flushes;
+  writeToDisk(std::vector<WrDiskCacheEntry*>{ent});
+  insert(ent);
+  return true;
+}
+
+std::vector<WrDiskCacheEntry*> WrDiskCache::findRun(WrDiskCacheEntry* ent)
+{
+  std::vector<WrDiskCacheEntry*> run{ent};
+  if (ent->getSize() == 0) {
+    return run;
+  }
+  size_t len = ent->getSize();
+  auto joinable = [&](const WrDiskCacheEntry* e) {
+    return e->getDiskAdaptor() == ent->getDiskAdaptor() && e->getSize() > 0 &&
+           len + e->getSize() <= MAX_RUN_LENGTH;
+  };
+  auto i = offsetSet_.find(ent);
+  assert(i != std::end(offsetSet_));
+  for (auto j = i; j != std::begin(offsetSet_);) {
+    auto e = *--j;
+    if (!joinable(e) || e->getLastOffset() != run.back()->getFirstOffset()) {
+      break;
+    }
+    len += e->getSize();
+    run.push_back(e);
+  }
+  std::reverse(std::begin(run), std::end(run));
+  for (auto j = std::next(i); j != std::end(offsetSet_); ++j) {
+    auto e = *j;
+    if (!joinable(e) || e->getFirstOffset() != run.back()->getLastOffset()) {
+      break;
+    }
+    len += e->getSize();
+    run.push_back(e);
+  }
+  return run;
+}
+
+void WrDiskCache::writeToDisk(const std::vector<WrDiskCacheEntry*>& entries)
+{
+  TraceSpan span("disk", "WrDiskCache::writeToDisk");
+  for (auto e : entries) {
+    stat_.cellsFlushed += e->getDataSet().size();
+    stat_.bytesFlushed += e->getSize();
+  }
+  stat_.writeCalls += WrDiskCacheEntry::writeToDisk(entries);
+}
+
 void WrDiskCache::ensureLimit()
 {
   while (total_ > limit_) {
-    auto i = set_.begin();
-    WrDiskCacheEntry* ent = *i;
-    A2_LOG_DEBUG(fmt("Force flush cache entry size=%lu, clock=%" PRId64,
+    auto ent = *set_.begin();
+    auto run = findRun(ent);
+    A2_LOG_DEBUG(fmt("Force flush cache entry size=%lu, clock=%" PRId64
+                     ", neighbours=%lu",
                      static_cast<unsigned long>(ent->getSizeKey()),
-                     ent->getLastUpdate()));
-    total_ -= ent->getSize();
-    ent->writeToDisk();
-    set_.erase(i);
-
-    ent->setSizeKey(ent->getSize());
-    ent->setLastUpdate(++clock_);
-    set_.insert(ent);
+                     ent->getLastUpdate(),
+                     static_cast<unsigned long>(run.size() - 1)));
+    for (auto e : run) {
+      erase(e);
+      total_ -= e->getSize();
+    }
+    stat_.evictions += run.size();
+    writeToDisk(run);
+    for (auto e : run) {
+      insert(e);
+    }
   }
 }
 
@@ -38,6 +38,7 @@
 #include "common.h"
 
 #include <set>
+#include <vector>
 
 #include "a2functional.h"
 
@@ -47,6 +48,25 @@ class WrDiskCacheEntry;
 
 class WrDiskCache {
 public:
+  struct Stat {
+    // The number of writes stored in the cache.
+    uint64_t writes;
+    // The number of writes which were merged into the data already
+    // cached.
+    uint64_t hits;
+    // The number of entries flushed by flush().
+    uint64_t flushes;
+    // The number of entries flushed to keep the cache under the
+    // limit.
+    uint64_t evictions;
+    // The number of data cells flushed to the disk.
+    uint64_t cellsFlushed;
+    // The number of write calls issued by the flushes.  Contiguous
+    // cells are coalesced into one call.
+    uint64_t writeCalls;
+    uint64_t bytesFlushed;
+  };
+
   WrDiskCache(size_t limit);
   ~WrDiskCache();
   // Adds the cache entry |ent| to the storage. The size of cached
@@ -59,19 +79,46 @@ public:
   // bytes is increased in this update. If the size is reduced, use
   // negative value.
   bool update(WrDiskCacheEntry* ent, ssize_t delta);
+  // Same as update(), but |delta| bytes were merged into the data
+  // already cached in |ent|.  This is counted as a hit.
+  bool merge(WrDiskCacheEntry* ent, size_t delta);
+  // Flushes the cached data of the already added entry |ent| to the
+  // disk.
+  bool flush(WrDiskCacheEntry* ent);
   // Evicts entries from storage so that total size of cache is kept
-  // under the limit.
+  // under the limit.  The victim is flushed together with the
+  // neighbouring entries which continue its data, so that they are
+  // written sequentially.
   void ensureLimit();
   size_t getSize() const { return total_; }
+  const Stat& getStat() const { return stat_; }
 
 private:
   typedef std::set<WrDiskCacheEntry*, DerefLess<WrDiskCacheEntry*>> EntrySet;
+
+  // Orders entries by DiskAdaptor, and then by the offset of their
+  // data.
+  struct OffsetLess {
+    bool operator()(const WrDiskCacheEntry* lhs,
+                    const WrDiskCacheEntry* rhs) const;
+  };
+  typedef std::set<WrDiskCacheEntry*, OffsetLess> OffsetSet;
+
+  bool erase(WrDiskCacheEntry* ent);
+  void insert(WrDiskCacheEntry* ent);
+  // Returns the entries to flush together with |ent| in offset order.
+  std::vector<WrDiskCacheEntry*> findRun(WrDiskCacheEntry* ent);
+  // Flushes |entries| to the disk and updates the statistics.
+  void writeToDisk(const std::vector<WrDiskCacheEntry*>& entries);
+
   // Maximum number of bytes the storage can cache.
   size_t limit_;
   // Current number of bytes cached.
   size_t total_;
   EntrySet set_;
+  OffsetSet offsetSet_;
   int64_t clock_;
+  Stat stat_;
 };
 
 } // namespace aria2
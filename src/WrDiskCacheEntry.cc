@@ -47,6 +47,7 @@ namespace aria2 {
 WrDiskCacheEntry::WrDiskCacheEntry(
     const std::shared_ptr<DiskAdaptor>& diskAdaptor)
     : sizeKey_(0),
+      offsetKey_(-1),
       lastUpdate_(0),
       size_(0),
       error_(CACHE_ERR_SUCCESS),
@@ -74,21 +75,55 @@ void WrDiskCacheEntry::deleteDataCells()
   size_ = 0;
 }
 
-void WrDiskCacheEntry::writeToDisk()
+size_t WrDiskCacheEntry::writeToDisk()
 {
+  return writeToDisk(std::vector<WrDiskCacheEntry*>{this});
+}
+
+size_t
+WrDiskCacheEntry::writeToDisk(const std::vector<WrDiskCacheEntry*>& entries)
+{
+  if (entries.empty()) {
+    return 0;
+  }
+  size_t nwrite = 0;
   try {
-    diskAdaptor_->writeCache(this);
+    nwrite = entries[0]->diskAdaptor_->writeCache(
+        std::vector<const WrDiskCacheEntry*>(std::begin(entries),
+                                             std::end(entries)));
   }
   catch (RecoverableException& e) {
     A2_LOG_ERROR_EX("Error when trying to flush write cache", e);
-    error_ = CACHE_ERR_ERROR;
-    errorCode_ = e.getErrorCode();
+    for (auto ent : entries) {
+      ent->error_ = CACHE_ERR_ERROR;
+      ent->errorCode_ = e.getErrorCode();
+    }
   }
-  deleteDataCells();
+  for (auto ent : entries) {
+    ent->deleteDataCells();
+  }
+  return nwrite;
 }
 
 void WrDiskCacheEntry::clear() { deleteDataCells(); }
 
+int64_t WrDiskCacheEntry::getFirstOffset() const
+{
+  if (set_.empty()) {
+    return -1;
+  }
+  return (*set_.begin())->goff;
+}
+
+int64_t WrDiskCacheEntry::getLastOffset() const
+{
+  if (set_.empty()) {
+    return -1;
+  }
+  auto& d = *set_.rbegin();
+  return d->goff + d->len;
+}
+
 bool WrDiskCacheEntry::cacheData(DataCell* dataCell)
 {
   A2_LOG_DEBUG(fmt("WrDiskCacheEntry cache goff=%" PRId64 ", len=%lu",
@@ -39,6 +39,7 @@
 
 #include <set>
 #include <memory>
+#include <vector>
 
 #include "a2functional.h"
 #include "error_code.h"
@@ -68,8 +69,14 @@ public:
   WrDiskCacheEntry(const std::shared_ptr<DiskAdaptor>& diskAdaptor);
   ~WrDiskCacheEntry();
 
-  // Flushes the cached data to the disk and deletes them.
-  void writeToDisk();
+  // Flushes the cached data to the disk and deletes them.  Returns
+  // the number of write calls issued.
+  size_t writeToDisk();
+  // Flushes the cached data of |entries| with the same DiskAdaptor to
+  // the disk and deletes them.  Contiguous data is written together,
+  // even if it spans several entries.  Returns the number of write
+  // calls issued.
+  static size_t writeToDisk(const std::vector<WrDiskCacheEntry*>& entries);
   // Deletes cached data without flushing to the disk.
   void clear();
 
@@ -83,6 +90,8 @@ public:
   size_t getSize() const { return size_; }
   void setSizeKey(size_t sizeKey) { sizeKey_ = sizeKey; }
   size_t getSizeKey() const { return sizeKey_; }
+  void setOffsetKey(int64_t offsetKey) { offsetKey_ = offsetKey; }
+  int64_t getOffsetKey() const { return offsetKey_; }
   void setLastUpdate(int64_t clock) { lastUpdate_ = clock; }
   int64_t getLastUpdate() const { return lastUpdate_; }
   bool operator<(const WrDiskCacheEntry& rhs) const
@@ -98,10 +107,23 @@ public:
 
   const DataCellSet& getDataSet() const { return set_; }
 
+  // Returns the offset of the first cached byte, or -1 if nothing is
+  // cached.
+  int64_t getFirstOffset() const;
+  // Returns the offset one past the last cached byte, or -1 if nothing
+  // is cached.
+  int64_t getLastOffset() const;
+
+  const std::shared_ptr<DiskAdaptor>& getDiskAdaptor() const
+  {
+    return diskAdaptor_;
+  }
+
 private:
   void deleteDataCells();
 
   size_t sizeKey_;
+  int64_t offsetKey_;
   int64_t lastUpdate_;
 
   size_t size_;
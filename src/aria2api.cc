@@ -62,6 +62,7 @@
 #include "SingletonHolder.h"
 #include "Notifier.h"
 #include "ApiCallbackDownloadEventListener.h"
+#include "LazyRequestGroup.h"
 #ifdef ENABLE_BITTORRENT
 #  include "bittorrent_helper.h"
 #endif // ENABLE_BITTORRENT
@@ -266,7 +267,9 @@ int addUri(Session* session, A2Gid* gid, const std::vector<std::string>& uris,
            const KeyVals& options, int position)
 {
   auto& e = session->context->reqinfo->getDownloadEngine();
-  auto requestOption = std::make_shared<Option>(*e->getOption());
+  auto globalOption = std::make_shared<Option>(*e->getOption());
+  auto requestOption = std::make_shared<Option>();
+  requestOption->setParent(globalOption);
   try {
     apiGatherRequestOption(requestOption.get(), options,
                            OptionParser::getInstance());
@@ -275,8 +278,30 @@ int addUri(Session* session, A2Gid* gid, const std::vector<std::string>& uris,
     A2_LOG_INFO_EX(EX_EXCEPTION_CAUGHT, e);
     return -1;
   }
+  std::unique_ptr<LazyRequestGroup> lazy;
+  try {
+    lazy = createLazyRequestGroupForUri(globalOption, requestOption, uris);
+  }
+  catch (RecoverableException& e) {
+    A2_LOG_INFO_EX(EX_EXCEPTION_CAUGHT, e);
+    return -1;
+  }
+  if (lazy) {
+    if (gid) {
+      *gid = lazy->getGID();
+    }
+    if (position >= 0) {
+      e->getRequestGroupMan()->insertReservedGroup(position, std::move(lazy));
+    }
+    else {
+      e->getRequestGroupMan()->addReservedGroup(std::move(lazy));
+    }
+    return 0;
+  }
+  auto option = std::make_shared<Option>(*globalOption);
+  option->merge(*requestOption);
   std::vector<std::shared_ptr<RequestGroup>> result;
-  createRequestGroupForUri(result, requestOption, uris,
+  createRequestGroupForUri(result, option, uris,
                            /* ignoreForceSeq = */ true,
                            /* ignoreLocalPath = */ true);
   if (!result.empty()) {
@@ -369,7 +394,8 @@ int addTorrent(Session* session, A2Gid* gid, const std::string& torrentFile,
 int removeDownload(Session* session, A2Gid gid, bool force)
 {
   auto& e = session->context->reqinfo->getDownloadEngine();
-  std::shared_ptr<RequestGroup> group = e->getRequestGroupMan()->findGroup(gid);
+  auto& rgman = e->getRequestGroupMan();
+  std::shared_ptr<RequestGroup> group = rgman->findGroup(gid);
   if (group) {
     if (group->getState() == RequestGroup::STATE_ACTIVE) {
       if (force) {
@@ -382,13 +408,16 @@ int removeDownload(Session* session, A2Gid gid, bool force)
     }
     else {
       if (group->isDependencyResolved()) {
-        e->getRequestGroupMan()->removeReservedGroup(gid);
+        rgman->removeReservedGroup(gid);
       }
       else {
         return -1;
       }
     }
   }
+  else if (rgman->findLazyGroup(gid)) {
+    rgman->removeReservedGroup(gid);
+  }
   else {
     return -1;
   }
@@ -406,20 +435,33 @@ int pauseDownload(Session* session, A2Gid gid, bool force)
       return 0;
     }
   }
+  else {
+    auto lazy = e->getRequestGroupMan()->findLazyGroup(gid);
+    if (lazy && !lazy->isPauseRequested()) {
+      lazy->setPauseRequested(true);
+      return 0;
+    }
+  }
   return -1;
 }
 
 int unpauseDownload(Session* session, A2Gid gid)
 {
   auto& e = session->context->reqinfo->getDownloadEngine();
-  std::shared_ptr<RequestGroup> group = e->getRequestGroupMan()->findGroup(gid);
-  if (!group || group->getState() != RequestGroup::STATE_WAITING ||
-      !group->isPauseRequested()) {
+  auto& rgman = e->getRequestGroupMan();
+  std::shared_ptr<RequestGroup> group = rgman->findGroup(gid);
+  auto lazy = rgman->findLazyGroup(gid);
+  if (lazy && lazy->isPauseRequested()) {
+    lazy->setPauseRequested(false);
+    rgman->requestQueueCheck();
+  }
+  else if (!group || group->getState() != RequestGroup::STATE_WAITING ||
+           !group->isPauseRequested()) {
     return -1;
   }
   else {
     group->setPauseRequested(false);
-    e->getRequestGroupMan()->requestQueueCheck();
+    rgman->requestQueueCheck();
   }
   return 0;
 }
@@ -439,7 +481,8 @@ int changePosition(Session* session, A2Gid gid, int pos, OffsetMode how)
 int changeOption(Session* session, A2Gid gid, const KeyVals& options)
 {
   auto& e = session->context->reqinfo->getDownloadEngine();
-  std::shared_ptr<RequestGroup> group = e->getRequestGroupMan()->findGroup(gid);
+  std::shared_ptr<RequestGroup> group =
+      e->getRequestGroupMan()->materializeGroup(gid);
   if (group) {
     Option option;
     try {
@@ -867,6 +910,80 @@ struct DownloadResultDH : public DownloadHandle {
 };
 } // namespace
 
+namespace {
+// DownloadHandle of the lazily represented waiting download.  It
+// reports what RequestGroupDH reports for RequestGroup built from it.
+struct LazyRequestGroupDH : public DownloadHandle {
+  LazyRequestGroupDH(const LazyRequestGroup& lazy)
+      : pauseRequested(lazy.isPauseRequested()),
+        option(lazy.createOption()),
+        fileEntry(createLazyFileEntry(lazy, *option))
+  {
+  }
+  virtual ~LazyRequestGroupDH() = default;
+  virtual DownloadStatus getStatus() CXX11_OVERRIDE
+  {
+    return pauseRequested ? DOWNLOAD_PAUSED : DOWNLOAD_WAITING;
+  }
+  virtual int64_t getTotalLength() CXX11_OVERRIDE { return 0; }
+  virtual int64_t getCompletedLength() CXX11_OVERRIDE { return 0; }
+  virtual int64_t getUploadLength() CXX11_OVERRIDE { return 0; }
+  virtual std::string getBitfield() CXX11_OVERRIDE { return ""; }
+  virtual int getDownloadSpeed() CXX11_OVERRIDE { return 0; }
+  virtual int getUploadSpeed() CXX11_OVERRIDE { return 0; }
+  virtual const std::string& getInfoHash() CXX11_OVERRIDE
+  {
+    return A2STR::NIL;
+  }
+  virtual size_t getPieceLength() CXX11_OVERRIDE
+  {
+    return option->getAsInt(PREF_PIECE_LENGTH);
+  }
+  virtual int getNumPieces() CXX11_OVERRIDE { return 0; }
+  virtual int getConnections() CXX11_OVERRIDE { return 0; }
+  virtual int getErrorCode() CXX11_OVERRIDE { return error_code::FINISHED; }
+  virtual const std::vector<A2Gid>& getFollowedBy() CXX11_OVERRIDE
+  {
+    return followedBy;
+  }
+  virtual A2Gid getFollowing() CXX11_OVERRIDE { return 0; }
+  virtual A2Gid getBelongsTo() CXX11_OVERRIDE { return 0; }
+  virtual const std::string& getDir() CXX11_OVERRIDE
+  {
+    return option->get(PREF_DIR);
+  }
+  virtual std::vector<FileData> getFiles() CXX11_OVERRIDE
+  {
+    return {getFile(1)};
+  }
+  virtual int getNumFiles() CXX11_OVERRIDE { return 1; }
+  virtual FileData getFile(int index) CXX11_OVERRIDE
+  {
+    BitfieldMan bf(getPieceLength(), 0);
+    return createFileData(fileEntry, index, &bf);
+  }
+  virtual BtMetaInfoData getBtMetaInfo() CXX11_OVERRIDE
+  {
+    BtMetaInfoData res;
+    res.creationDate = 0;
+    res.mode = BT_FILE_MODE_NONE;
+    return res;
+  }
+  virtual const std::string& getOption(const std::string& name) CXX11_OVERRIDE
+  {
+    return getRequestOption(option, name);
+  }
+  virtual KeyVals getOptions() CXX11_OVERRIDE
+  {
+    return getRequestOptions(option);
+  }
+  bool pauseRequested;
+  std::shared_ptr<Option> option;
+  std::shared_ptr<FileEntry> fileEntry;
+  std::vector<A2Gid> followedBy;
+};
+} // namespace
+
 DownloadHandle* getDownloadHandle(Session* session, A2Gid gid)
 {
   auto& e = session->context->reqinfo->getDownloadEngine();
@@ -875,6 +992,10 @@ DownloadHandle* getDownloadHandle(Session* session, A2Gid gid)
   if (group) {
     return new RequestGroupDH(group);
   }
+  auto lazy = rgman->findLazyGroup(gid);
+  if (lazy) {
+    return new LazyRequestGroupDH(*lazy);
+  }
   else {
     std::shared_ptr<DownloadResult> ds = rgman->findDownloadResult(gid);
     if (ds) {
@@ -34,6 +34,19 @@
 /* copyright --> */
 #include "bitfield.h"
 
+#include "cpu_features.h"
+
+#if (defined(__clang__) && __clang_major__ >= 4) ||                            \
+    (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 5)
+#  define BITFIELD_VECTOR 1
+#  define bitfield_forceinline __attribute__((always_inline)) inline
+#  if defined(__x86_64__) || defined(__i386__)
+#    define BITFIELD_X86 1
+#  endif
+#else
+#  define bitfield_forceinline inline
+#endif
+
 namespace aria2 {
 
 namespace bitfield {
@@ -46,6 +59,437 @@ void flipBit(unsigned char* data, size_t length, size_t bitIndex)
   data[byteIndex] ^= mask;
 }
 
+namespace {
+// Bitfields given to getMissing() and getFirstNMissingIndex().  The
+// kernels are instantiated for each combination of the optional
+// operands.
+enum { OP_USE = 1, OP_PEER = 1 << 1, OP_FILTER = 1 << 2, NUM_OPS = 1 << 3 };
+
+struct Operands {
+  const unsigned char* have;
+  const unsigned char* use;
+  const unsigned char* peer;
+  const unsigned char* filter;
+};
+
+int getOps(const Operands& ops)
+{
+  return (ops.use ? OP_USE : 0) | (ops.peer ? OP_PEER : 0) |
+         (ops.filter ? OP_FILTER : 0);
+}
+
+// W is either uint64_t or a vector of uint64_t.  Since bit 0 is the
+// most significant bit of the first byte, the 64 bit lanes are
+// converted to big endian before looking for the index of a set bit.
+// Vectors are passed by reference, because the functions are not
+// compiled for the instruction set of the caller.
+template <typename W>
+bitfield_forceinline void loadWord(W& w, const unsigned char* p)
+{
+  memcpy(&w, p, sizeof(w));
+}
+
+template <typename W>
+bitfield_forceinline void storeWord(unsigned char* p, const W& w)
+{
+  memcpy(p, &w, sizeof(w));
+}
+
+template <typename W> bitfield_forceinline bool isZero(const W& w)
+{
+  uint64_t lanes[sizeof(W) / 8];
+  memcpy(lanes, &w, sizeof(w));
+  uint64_t bits = 0;
+  for (auto v : lanes) {
+    bits |= v;
+  }
+  return bits == 0;
+}
+
+bitfield_forceinline int countLeadingZero(uint64_t x)
+{
+#ifdef BITFIELD_VECTOR
+  return __builtin_clzll(x);
+#else  // !BITFIELD_VECTOR
+  int n = 0;
+  for (; !(x & (static_cast<uint64_t>(1) << 63)); x <<= 1) {
+    ++n;
+  }
+  return n;
+#endif // !BITFIELD_VECTOR
+}
+
+template <int Ops, typename W>
+bitfield_forceinline void computeMissing(W& w, const Operands& ops, size_t i)
+{
+  W x;
+  loadWord(w, ops.have + i);
+  w = ~w;
+  if (Ops & OP_USE) {
+    loadWord(x, ops.use + i);
+    w &= ~x;
+  }
+  if (Ops & OP_PEER) {
+    loadWord(x, ops.peer + i);
+    w &= x;
+  }
+  if (Ops & OP_FILTER) {
+    loadWord(x, ops.filter + i);
+    w &= x;
+  }
+}
+
+// The kernels process the first len bytes, which is a multiple of
+// sizeof(W).
+template <int Ops, bool Store, typename W>
+bitfield_forceinline bool missingBulk(unsigned char* dst, const Operands& ops,
+                                      size_t len)
+{
+  W bits = W();
+  for (size_t i = 0; i < len; i += sizeof(W)) {
+    W w;
+    computeMissing<Ops>(w, ops, i);
+    if (Store) {
+      storeWord(dst + i, w);
+      bits |= w;
+    }
+    else if (!isZero(w)) {
+      return true;
+    }
+  }
+  return !isZero(bits);
+}
+
+template <int Ops, typename W>
+bitfield_forceinline size_t findBulk(size_t* out, size_t n,
+                                     const Operands& ops, size_t len)
+{
+  size_t found = 0;
+  for (size_t i = 0; i < len; i += sizeof(W)) {
+    W w;
+    computeMissing<Ops>(w, ops, i);
+    if (isZero(w)) {
+      continue;
+    }
+    uint64_t lanes[sizeof(W) / 8];
+    memcpy(lanes, &w, sizeof(w));
+    for (size_t k = 0; k < sizeof(W) / 8; ++k) {
+      for (uint64_t v = ntoh64(lanes[k]); v;) {
+        int lz = countLeadingZero(v);
+        out[found] = (i + k * 8) * 8 + lz;
+        if (++found == n) {
+          return found;
+        }
+        v ^= static_cast<uint64_t>(1) << (63 - lz);
+      }
+    }
+  }
+  return found;
+}
+
+bitfield_forceinline uint64_t countBit64(uint64_t x)
+{
+  x = x - ((x >> 1) & 0x5555555555555555llu);
+  x = (x & 0x3333333333333333llu) + ((x >> 2) & 0x3333333333333333llu);
+  x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fllu;
+  return (x * 0x0101010101010101llu) >> 56;
+}
+
+template <bool And>
+size_t countWord(const unsigned char* a, const unsigned char* b, size_t len)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < len; i += 8) {
+    uint64_t w, x;
+    loadWord(w, a + i);
+    if (And) {
+      loadWord(x, b + i);
+      w &= x;
+    }
+    count += countBit64(w);
+  }
+  return count;
+}
+
+template <int Ops, bool Store>
+bool missingWord(unsigned char* dst, const Operands& ops, size_t len)
+{
+  return missingBulk<Ops, Store, uint64_t>(dst, ops, len);
+}
+
+template <int Ops>
+size_t findWord(size_t* out, size_t n, const Operands& ops, size_t len)
+{
+  return findBulk<Ops, uint64_t>(out, n, ops, len);
+}
+
+#ifdef BITFIELD_VECTOR
+typedef uint64_t v2u64 __attribute__((vector_size(16)));
+typedef uint64_t v4u64 __attribute__((vector_size(32)));
+
+// Counts bits in each byte and sums them up in byte lanes.  A byte
+// lane holds at most 8 * 31 bits before it is flushed to count.
+template <bool And, typename W>
+bitfield_forceinline size_t countBulk(const unsigned char* a,
+                                      const unsigned char* b, size_t len)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < len;) {
+    W sum = W();
+    for (size_t end = std::min(len, i + 31 * sizeof(W)); i < end;
+         i += sizeof(W)) {
+      W x, y;
+      loadWord(x, a + i);
+      if (And) {
+        loadWord(y, b + i);
+        x &= y;
+      }
+      x = x - ((x >> 1) & 0x5555555555555555llu);
+      x = (x & 0x3333333333333333llu) + ((x >> 2) & 0x3333333333333333llu);
+      sum += (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fllu;
+    }
+    sum = (sum & 0x00ff00ff00ff00ffllu) + ((sum >> 8) & 0x00ff00ff00ff00ffllu);
+    uint64_t lanes[sizeof(W) / 8];
+    memcpy(lanes, &sum, sizeof(sum));
+    for (auto v : lanes) {
+      count += (v * 0x0001000100010001llu) >> 48;
+    }
+  }
+  return count;
+}
+
+template <bool And>
+size_t countVec128(const unsigned char* a, const unsigned char* b, size_t len)
+{
+  return countBulk<And, v2u64>(a, b, len);
+}
+
+template <int Ops, bool Store>
+bool missingVec128(unsigned char* dst, const Operands& ops, size_t len)
+{
+  return missingBulk<Ops, Store, v2u64>(dst, ops, len);
+}
+
+template <int Ops>
+size_t findVec128(size_t* out, size_t n, const Operands& ops, size_t len)
+{
+  return findBulk<Ops, v2u64>(out, n, ops, len);
+}
+#endif // BITFIELD_VECTOR
+
+#ifdef BITFIELD_X86
+template <bool And>
+__attribute__((target("avx2"))) size_t
+countAvx2(const unsigned char* a, const unsigned char* b, size_t len)
+{
+  return countBulk<And, v4u64>(a, b, len);
+}
+
+template <int Ops, bool Store>
+__attribute__((target("avx2"))) bool
+missingAvx2(unsigned char* dst, const Operands& ops, size_t len)
+{
+  return missingBulk<Ops, Store, v4u64>(dst, ops, len);
+}
+
+template <int Ops>
+__attribute__((target("avx2"))) size_t
+findAvx2(size_t* out, size_t n, const Operands& ops, size_t len)
+{
+  return findBulk<Ops, v4u64>(out, n, ops, len);
+}
+#endif // BITFIELD_X86
+
+struct Kernels {
+  Kernel kernel;
+  // The number of bytes processed at a time
+  size_t width;
+  size_t (*count[2])(const unsigned char* a, const unsigned char* b,
+                     size_t len);
+  // Indexed by whether the result is stored and by the operands
+  bool (*missing[2][NUM_OPS])(unsigned char* dst, const Operands& ops,
+                              size_t len);
+  size_t (*find[NUM_OPS])(size_t* out, size_t n, const Operands& ops,
+                          size_t len);
+};
+
+#define BITFIELD_KERNELS(kernel, W, name)                                      \
+  {                                                                            \
+    kernel, sizeof(W), {count##name<false>, count##name<true>},                \
+        {{missing##name<0, false>, missing##name<1, false>,                    \
+          missing##name<2, false>, missing##name<3, false>,                    \
+          missing##name<4, false>, missing##name<5, false>,                    \
+          missing##name<6, false>, missing##name<7, false>},                   \
+         {missing##name<0, true>, missing##name<1, true>,                      \
+          missing##name<2, true>, missing##name<3, true>,                      \
+          missing##name<4, true>, missing##name<5, true>,                      \
+          missing##name<6, true>, missing##name<7, true>}},                    \
+    {                                                                          \
+      find##name<0>, find##name<1>, find##name<2>, find##name<3>,              \
+          find##name<4>, find##name<5>, find##name<6>, find##name<7>           \
+    }                                                                          \
+  }
+
+const Kernels wordKernels = BITFIELD_KERNELS(KERNEL_WORD, uint64_t, Word);
+
+#ifdef BITFIELD_VECTOR
+const Kernels vec128Kernels = BITFIELD_KERNELS(KERNEL_VEC128, v2u64, Vec128);
+#endif // BITFIELD_VECTOR
+
+#ifdef BITFIELD_X86
+const Kernels avx2Kernels = BITFIELD_KERNELS(KERNEL_AVX2, v4u64, Avx2);
+#endif // BITFIELD_X86
+
+#undef BITFIELD_KERNELS
+
+const Kernels* findKernels(Kernel kernel)
+{
+  switch (kernel) {
+  case KERNEL_WORD:
+    return &wordKernels;
+#ifdef BITFIELD_VECTOR
+  case KERNEL_VEC128:
+    return &vec128Kernels;
+#endif // BITFIELD_VECTOR
+#ifdef BITFIELD_X86
+  case KERNEL_AVX2:
+    return cpu::getFeatures().avx2 ? &avx2Kernels : nullptr;
+#endif // BITFIELD_X86
+  default:
+    return nullptr;
+  }
+}
+
+const Kernels*& kernels()
+{
+  static const Kernels* current = [] {
+    for (auto k : {KERNEL_AVX2, KERNEL_VEC128}) {
+      auto p = findKernels(k);
+      if (p) {
+        return p;
+      }
+    }
+    return &wordKernels;
+  }();
+  return current;
+}
+
+unsigned char missingByte(const Operands& ops, size_t i)
+{
+  unsigned char bits = ~ops.have[i];
+  if (ops.use) {
+    bits &= ~ops.use[i];
+  }
+  if (ops.peer) {
+    bits &= ops.peer[i];
+  }
+  if (ops.filter) {
+    bits &= ops.filter[i];
+  }
+  return bits;
+}
+
+// Returns the number of leading bytes processed by the kernels.
+size_t getBulkLength(const Kernels* k, size_t nbits)
+{
+  return nbits / 8 / k->width * k->width;
+}
+} // namespace
+
+bool setKernel(Kernel kernel)
+{
+  auto k = findKernels(kernel);
+  if (!k) {
+    return false;
+  }
+  kernels() = k;
+  return true;
+}
+
+Kernel getKernel() { return kernels()->kernel; }
+
+size_t countSetBit(const unsigned char* bitfield, size_t nbits)
+{
+  auto k = kernels();
+  size_t bulk = getBulkLength(k, nbits);
+  size_t count = k->count[0](bitfield, nullptr, bulk);
+  return count + countSetBitSlow(bitfield + bulk, nbits - bulk * 8);
+}
+
+size_t countSetBitAnd(const unsigned char* a, const unsigned char* b,
+                      size_t nbits)
+{
+  auto k = kernels();
+  size_t bulk = getBulkLength(k, nbits);
+  size_t count = k->count[1](a, b, bulk);
+  size_t len = (nbits + 7) / 8;
+  for (size_t i = bulk; i < len; ++i) {
+    unsigned char bits = a[i] & b[i];
+    if (i == len - 1) {
+      bits &= lastByteMask(nbits);
+    }
+    count += cntbits[bits];
+  }
+  return count;
+}
+
+bool getMissing(unsigned char* dst, const unsigned char* have,
+                const unsigned char* use, const unsigned char* peer,
+                const unsigned char* filter, size_t nbits)
+{
+  auto k = kernels();
+  Operands ops{have, use, peer, filter};
+  size_t bulk = getBulkLength(k, nbits);
+  bool found = k->missing[dst != nullptr][getOps(ops)](dst, ops, bulk);
+  if (found && !dst) {
+    return true;
+  }
+  size_t len = (nbits + 7) / 8;
+  for (size_t i = bulk; i < len; ++i) {
+    unsigned char bits = missingByte(ops, i);
+    if (i == len - 1) {
+      bits &= lastByteMask(nbits);
+    }
+    if (dst) {
+      dst[i] = bits;
+    }
+    else if (bits) {
+      return true;
+    }
+    found |= bits != 0;
+  }
+  return found;
+}
+
+size_t getFirstNMissingIndex(size_t* out, size_t n, const unsigned char* have,
+                             const unsigned char* use,
+                             const unsigned char* filter, size_t nbits)
+{
+  if (n == 0) {
+    return 0;
+  }
+  auto k = kernels();
+  Operands ops{have, use, nullptr, filter};
+  size_t bulk = getBulkLength(k, nbits);
+  size_t found = k->find[getOps(ops)](out, n, ops, bulk);
+  size_t len = (nbits + 7) / 8;
+  for (size_t i = bulk; i < len && found < n; ++i) {
+    unsigned char bits = missingByte(ops, i);
+    if (i == len - 1) {
+      bits &= lastByteMask(nbits);
+    }
+    for (size_t j = 0; j < 8 && bits; ++j) {
+      if (bits & (128 >> j)) {
+        out[found] = i * 8 + j;
+        if (++found == n) {
+          break;
+        }
+      }
+    }
+  }
+  return found;
+}
+
 } // namespace bitfield
 
 } // namespace aria2
@@ -40,6 +40,7 @@
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
 
 #include "util.h"
 
@@ -94,31 +95,47 @@ inline size_t countBit32(uint32_t n)
          cntbits[(n >> 16) & 0xffu] + cntbits[(n >> 24) & 0xffu];
 }
 
+// The functions below process whole words and, if the CPU supports
+// it, SIMD vectors at a time.  The fastest kernel available is
+// selected at runtime.
+enum Kernel {
+  // 64 bit words
+  KERNEL_WORD,
+  // 128 bit SSE2 or NEON vectors
+  KERNEL_VEC128,
+  // 256 bit AVX2 vectors
+  KERNEL_AVX2
+};
+
+// Selects the kernel used by the functions below.  Returns false if
+// kernel is not available on this CPU, leaving the current one in
+// place.  This is intended for tests and benchmarks.
+bool setKernel(Kernel kernel);
+
+Kernel getKernel();
+
 // Counts set bit in bitfield.
-inline size_t countSetBit(const unsigned char* bitfield, size_t nbits)
-{
-  if (nbits == 0) {
-    return 0;
-  }
-  size_t count = 0;
-  size_t size = sizeof(uint32_t);
-  size_t len = (nbits + 7) / 8;
-  if (nbits % 32 != 0) {
-    --len;
-    count +=
-        countBit32(static_cast<uint32_t>(bitfield[len] & lastByteMask(nbits)));
-  }
-  size_t to = len / size;
-  for (size_t i = 0; i < to; ++i) {
-    uint32_t v;
-    memcpy(&v, &bitfield[i * size], sizeof(v));
-    count += countBit32(v);
-  }
-  for (size_t i = len - len % size; i < len; ++i) {
-    count += countBit32(static_cast<uint32_t>(bitfield[i]));
-  }
-  return count;
-}
+size_t countSetBit(const unsigned char* bitfield, size_t nbits);
+
+// Counts set bit in a & b.
+size_t countSetBitAnd(const unsigned char* a, const unsigned char* b,
+                      size_t nbits);
+
+// Computes ~have & ~use & peer & filter.  use, peer and filter may be
+// nullptr, in which case they are left out.  If dst is not nullptr,
+// the result is stored in dst with the bits beyond nbits cleared.
+// Returns true if the result has any bit set.  Without dst, returns
+// as soon as a set bit is found.
+bool getMissing(unsigned char* dst, const unsigned char* have,
+                const unsigned char* use, const unsigned char* peer,
+                const unsigned char* filter, size_t nbits);
+
+// Stores at most n indexes of the set bits in ~have & ~use & filter
+// to out in ascending order.  use and filter may be nullptr, in which
+// case they are left out.  Returns the number of stored indexes.
+size_t getFirstNMissingIndex(size_t* out, size_t n, const unsigned char* have,
+                             const unsigned char* use,
+                             const unsigned char* filter, size_t nbits);
 
 // Counts set bit in bitfield. This is a bit slower than countSetBit
 // but can accept array template expression as bitfield.
@@ -147,10 +164,16 @@ void flipBit(unsigned char* data, size_t length, size_t bitIndex);
 template <typename Array>
 bool getFirstSetBitIndex(size_t& index, const Array& bitfield, size_t nbits)
 {
-  for (size_t i = 0; i < nbits; ++i) {
-    if (bitfield::test(bitfield, nbits, i)) {
-      index = i;
-      return true;
+  for (size_t i = 0; i < nbits; i += 8) {
+    unsigned char bits = bitfield[i / 8];
+    if (bits == 0) {
+      continue;
+    }
+    for (size_t j = i, last = std::min(i + 8, nbits); j < last; ++j) {
+      if (bits & (128 >> (j % 8))) {
+        index = j;
+        return true;
+      }
     }
   }
   return false;
@@ -166,11 +189,17 @@ size_t getFirstNSetBitIndex(OutputIterator out, size_t n, const Array& bitfield,
     return 0;
   }
   const size_t origN = n;
-  for (size_t i = 0; i < nbits; ++i) {
-    if (bitfield::test(bitfield, nbits, i)) {
-      *out++ = i;
-      if (--n == 0) {
-        break;
+  for (size_t i = 0; i < nbits; i += 8) {
+    unsigned char bits = bitfield[i / 8];
+    if (bits == 0) {
+      continue;
+    }
+    for (size_t j = i, last = std::min(i + 8, nbits); j < last; ++j) {
+      if (bits & (128 >> (j % 8))) {
+        *out++ = j;
+        if (--n == 0) {
+          return origN;
+        }
       }
     }
   }
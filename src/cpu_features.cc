@@ -0,0 +1,85 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "cpu_features.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+    ((defined(__clang__) && __clang_major__ >= 4) ||                           \
+     (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 5))
+#  define CPU_FEATURES_X86 1
+#  include <cpuid.h>
+#endif
+
+namespace aria2 {
+
+namespace cpu {
+
+namespace {
+Features detectFeatures()
+{
+  Features features{false, false, false, false};
+#ifdef CPU_FEATURES_X86
+  unsigned int a, b, c, d;
+  if (!__get_cpuid(1, &a, &b, &c, &d)) {
+    return features;
+  }
+  features.ssse3 = c & (1 << 9);
+  features.sse41 = c & (1 << 19);
+  // AVX registers must be enabled by the OS.
+  bool ymm = false;
+  if ((c & (1 << 27)) && (c & (1 << 28))) {
+    unsigned int lo, hi;
+    __asm__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    ymm = (lo & 0x6) == 0x6;
+  }
+  if (__get_cpuid_max(0, nullptr) < 7) {
+    return features;
+  }
+  __cpuid_count(7, 0, a, b, c, d);
+  features.avx2 = ymm && (b & (1 << 5));
+  features.sha = b & (1 << 29);
+#endif // CPU_FEATURES_X86
+  return features;
+}
+} // namespace
+
+const Features& getFeatures()
+{
+  static const Features features = detectFeatures();
+  return features;
+}
+
+} // namespace cpu
+
+} // namespace aria2
@@ -5,7 +5,9 @@
 #include "crypto_hash.h"
 #include "crypto_endian.h"
 #include "a2functional.h"
+#include "cpu_features.h"
 
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 #include <unordered_map>
@@ -93,6 +95,13 @@ protected:
 
   virtual void transform(const word_t* buffer) = 0;
 
+  virtual void transformBlocks(const uint8_t* data, size_t blocks)
+  {
+    for (; blocks; --blocks, data += sizeof(buffer_)) {
+      transform(reinterpret_cast<const word_t*>(data));
+    }
+  }
+
   virtual std::string digest()
   {
     return std::string((const char*)state_.bytes, sizeof(state_.bytes));
@@ -119,19 +128,20 @@ public:
       bytes += turn;
       offset_ += turn;
       if (likely(offset_ == sizeof(buffer_))) {
-        transform(buffer_.words);
+        transformBlocks(buffer_.bytes, 1);
         offset_ = 0;
       }
     }
 
     // |transform| as many blocks as possible.
-    while (len >= sizeof(buffer_)) {
+    if (len >= sizeof(buffer_)) {
       // |offset_| has to be 0 at this point!
       // Which is guaranteed by the block above.
 
-      transform(reinterpret_cast<const word_t*>(bytes));
-      bytes += sizeof(buffer_);
-      len -= sizeof(buffer_);
+      const uint64_t blocks = len / sizeof(buffer_);
+      transformBlocks(bytes, blocks);
+      bytes += blocks * sizeof(buffer_);
+      len -= blocks * sizeof(buffer_);
     }
 
     // Buffer remaining bytes, if any.
@@ -149,12 +159,12 @@ public:
     const uint_fast16_t cutoff = sizeof(buffer_) - sizeof(word_t) * 2;
     buffer_.bytes[offset_] = 0x80;
     if (unlikely(++offset_ == sizeof(buffer_))) {
-      transform(buffer_.words);
+      transformBlocks(buffer_.bytes, 1);
       memset(buffer_.bytes, 0x00, cutoff);
     }
     else if (offset_ > cutoff) {
       memset(buffer_.bytes + offset_, 0x00, sizeof(buffer_) - offset_);
-      transform(buffer_.words);
+      transformBlocks(buffer_.bytes, 1);
       memset(buffer_.bytes, 0x00, cutoff);
     }
     else if (likely(offset_ != cutoff)) {
@@ -178,7 +188,7 @@ public:
     }
 
     // Last transform:
-    transform(buffer_.words);
+    transformBlocks(buffer_.bytes, 1);
 
 #if LITTLE_ENDIAN == BYTE_ORDER
     // On little endian, we still need to swap the bytes.
@@ -193,8 +203,596 @@ public:
   }
 
   virtual uint_fast16_t blocksize() const { return sizeof(buffer_); }
+
+  // For |computeMany|, which transforms the blocks of several messages
+  // at once.  The context must not have buffered data.
+  word_t* state() { return state_.words; }
+
+  void skip(uint64_t len) { count_ += len; }
 };
 
+// Runtime CPU dispatch.  SHA-1 and SHA-256 use the SHA extensions if
+// the CPU has them.  Otherwise computeMany() hashes several messages
+// in parallel SIMD lanes with AVX2 (8 lanes) or SSSE3 (4 lanes).
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+    ((defined(__clang__) && __clang_major__ >= 4) ||                           \
+     (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 5))
+#  define CRYPTO_HASH_X86 1
+#  include <immintrin.h>
+#endif
+
+#ifdef CRYPTO_HASH_X86
+namespace {
+static bool hasShaExtensions()
+{
+  const auto& features = aria2::cpu::getFeatures();
+  return features.sha && features.ssse3 && features.sse41;
+}
+
+static const uint32_t sha256k[] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+// SHA extensions.  The state is in host byte order, just like in
+// |SHA1::transform| and |SHA256::transform|.
+__attribute__((target("sha,sse4.1"))) static void
+sha1BlocksShaNi(uint32_t* state, const uint8_t* data, size_t blocks)
+{
+  const __m128i mask =
+      _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+  __m128i abcd, abcdSave, e0, e0Save, e1;
+  __m128i msg0, msg1, msg2, msg3;
+
+  abcd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+  abcd = _mm_shuffle_epi32(abcd, 0x1b);
+  e0 = _mm_set_epi32(state[4], 0, 0, 0);
+
+  for (; blocks; --blocks, data += 64) {
+    abcdSave = abcd;
+    e0Save = e0;
+
+    // Rounds 0-3
+    msg0 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0)), mask);
+    e0 = _mm_add_epi32(e0, msg0);
+    e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+    // Rounds 4-7
+    msg1 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)), mask);
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+    msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+
+    // Rounds 8-11
+    msg2 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)), mask);
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+    msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+    msg0 = _mm_xor_si128(msg0, msg2);
+
+    // Rounds 12-15
+    msg3 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)), mask);
+    e1 = _mm_sha1nexte_epu32(e1, msg3);
+    e0 = abcd;
+    msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+    msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+    msg1 = _mm_xor_si128(msg1, msg3);
+
+    // Rounds 16-19
+    e0 = _mm_sha1nexte_epu32(e0, msg0);
+    e1 = abcd;
+    msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+    msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+    msg2 = _mm_xor_si128(msg2, msg0);
+
+    // Rounds 20-23
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+    msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+    msg3 = _mm_xor_si128(msg3, msg1);
+
+    // Rounds 24-27
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+    msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+    msg0 = _mm_xor_si128(msg0, msg2);
+
+    // Rounds 28-31
+    e1 = _mm_sha1nexte_epu32(e1, msg3);
+    e0 = abcd;
+    msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+    msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+    msg1 = _mm_xor_si128(msg1, msg3);
+
+    // Rounds 32-35
+    e0 = _mm_sha1nexte_epu32(e0, msg0);
+    e1 = abcd;
+    msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+    msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+    msg2 = _mm_xor_si128(msg2, msg0);
+
+    // Rounds 36-39
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+    msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+    msg3 = _mm_xor_si128(msg3, msg1);
+
+    // Rounds 40-43
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+    msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+    msg0 = _mm_xor_si128(msg0, msg2);
+
+    // Rounds 44-47
+    e1 = _mm_sha1nexte_epu32(e1, msg3);
+    e0 = abcd;
+    msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+    msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+    msg1 = _mm_xor_si128(msg1, msg3);
+
+    // Rounds 48-51
+    e0 = _mm_sha1nexte_epu32(e0, msg0);
+    e1 = abcd;
+    msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+    msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+    msg2 = _mm_xor_si128(msg2, msg0);
+
+    // Rounds 52-55
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+    msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+    msg3 = _mm_xor_si128(msg3, msg1);
+
+    // Rounds 56-59
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+    msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+    msg0 = _mm_xor_si128(msg0, msg2);
+
+    // Rounds 60-63
+    e1 = _mm_sha1nexte_epu32(e1, msg3);
+    e0 = abcd;
+    msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+    msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+    msg1 = _mm_xor_si128(msg1, msg3);
+
+    // Rounds 64-67
+    e0 = _mm_sha1nexte_epu32(e0, msg0);
+    e1 = abcd;
+    msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+    msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+    msg2 = _mm_xor_si128(msg2, msg0);
+
+    // Rounds 68-71
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+    msg3 = _mm_xor_si128(msg3, msg1);
+
+    // Rounds 72-75
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+
+    // Rounds 76-79
+    e1 = _mm_sha1nexte_epu32(e1, msg3);
+    e0 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+
+    e0 = _mm_sha1nexte_epu32(e0, e0Save);
+    abcd = _mm_add_epi32(abcd, abcdSave);
+  }
+
+  abcd = _mm_shuffle_epi32(abcd, 0x1b);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), abcd);
+  state[4] = _mm_extract_epi32(e0, 3);
+}
+
+__attribute__((target("sha,sse4.1"))) static void
+sha256BlocksShaNi(uint32_t* state, const uint8_t* data, size_t blocks)
+{
+  const __m128i mask =
+      _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  __m128i state0, state1, abefSave, cdghSave, msg, tmp;
+  __m128i msg0, msg1, msg2, msg3;
+
+  tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+  state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4));
+  tmp = _mm_shuffle_epi32(tmp, 0xb1);          // CDAB
+  state1 = _mm_shuffle_epi32(state1, 0x1b);    // EFGH
+  state0 = _mm_alignr_epi8(tmp, state1, 8);    // ABEF
+  state1 = _mm_blend_epi16(state1, tmp, 0xf0); // CDGH
+
+  for (; blocks; --blocks, data += 64) {
+    abefSave = state0;
+    cdghSave = state1;
+
+    // Rounds 0-3
+    msg0 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0)), mask);
+    msg = _mm_add_epi32(
+        msg0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 0)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+    // Rounds 4-7
+    msg1 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)), mask);
+    msg = _mm_add_epi32(
+        msg1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 4)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    msg0 = _mm_sha256msg1_epu32(msg0, msg1);
+
+    // Rounds 8-11
+    msg2 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)), mask);
+    msg = _mm_add_epi32(
+        msg2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 8)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    msg1 = _mm_sha256msg1_epu32(msg1, msg2);
+
+    // Rounds 12-15
+    msg3 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)), mask);
+    msg = _mm_add_epi32(
+        msg3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 12)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(msg3, msg2, 4);
+    msg0 = _mm_add_epi32(msg0, tmp);
+    msg0 = _mm_sha256msg2_epu32(msg0, msg3);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    msg2 = _mm_sha256msg1_epu32(msg2, msg3);
+
+    // Rounds 16-19
+    msg = _mm_add_epi32(
+        msg0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 16)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(msg0, msg3, 4);
+    msg1 = _mm_add_epi32(msg1, tmp);
+    msg1 = _mm_sha256msg2_epu32(msg1, msg0);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    msg3 = _mm_sha256msg1_epu32(msg3, msg0);
+
+    // Rounds 20-23
+    msg = _mm_add_epi32(
+        msg1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 20)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(msg1, msg0, 4);
+    msg2 = _mm_add_epi32(msg2, tmp);
+    msg2 = _mm_sha256msg2_epu32(msg2, msg1);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    msg0 = _mm_sha256msg1_epu32(msg0, msg1);
+
+    // Rounds 24-27
+    msg = _mm_add_epi32(
+        msg2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 24)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(msg2, msg1, 4);
+    msg3 = _mm_add_epi32(msg3, tmp);
+    msg3 = _mm_sha256msg2_epu32(msg3, msg2);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    msg1 = _mm_sha256msg1_epu32(msg1, msg2);
+
+    // Rounds 28-31
+    msg = _mm_add_epi32(
+        msg3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 28)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(msg3, msg2, 4);
+    msg0 = _mm_add_epi32(msg0, tmp);
+    msg0 = _mm_sha256msg2_epu32(msg0, msg3);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    msg2 = _mm_sha256msg1_epu32(msg2, msg3);
+
+    // Rounds 32-35
+    msg = _mm_add_epi32(
+        msg0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 32)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(msg0, msg3, 4);
+    msg1 = _mm_add_epi32(msg1, tmp);
+    msg1 = _mm_sha256msg2_epu32(msg1, msg0);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    msg3 = _mm_sha256msg1_epu32(msg3, msg0);
+
+    // Rounds 36-39
+    msg = _mm_add_epi32(
+        msg1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 36)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(msg1, msg0, 4);
+    msg2 = _mm_add_epi32(msg2, tmp);
+    msg2 = _mm_sha256msg2_epu32(msg2, msg1);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    msg0 = _mm_sha256msg1_epu32(msg0, msg1);
+
+    // Rounds 40-43
+    msg = _mm_add_epi32(
+        msg2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 40)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(msg2, msg1, 4);
+    msg3 = _mm_add_epi32(msg3, tmp);
+    msg3 = _mm_sha256msg2_epu32(msg3, msg2);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    msg1 = _mm_sha256msg1_epu32(msg1, msg2);
+
+    // Rounds 44-47
+    msg = _mm_add_epi32(
+        msg3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 44)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(msg3, msg2, 4);
+    msg0 = _mm_add_epi32(msg0, tmp);
+    msg0 = _mm_sha256msg2_epu32(msg0, msg3);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    msg2 = _mm_sha256msg1_epu32(msg2, msg3);
+
+    // Rounds 48-51
+    msg = _mm_add_epi32(
+        msg0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 48)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(msg0, msg3, 4);
+    msg1 = _mm_add_epi32(msg1, tmp);
+    msg1 = _mm_sha256msg2_epu32(msg1, msg0);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    msg3 = _mm_sha256msg1_epu32(msg3, msg0);
+
+    // Rounds 52-55
+    msg = _mm_add_epi32(
+        msg1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 52)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(msg1, msg0, 4);
+    msg2 = _mm_add_epi32(msg2, tmp);
+    msg2 = _mm_sha256msg2_epu32(msg2, msg1);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+    // Rounds 56-59
+    msg = _mm_add_epi32(
+        msg2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 56)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(msg2, msg1, 4);
+    msg3 = _mm_add_epi32(msg3, tmp);
+    msg3 = _mm_sha256msg2_epu32(msg3, msg2);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+    // Rounds 60-63
+    msg = _mm_add_epi32(
+        msg3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sha256k + 60)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+    state0 = _mm_add_epi32(state0, abefSave);
+    state1 = _mm_add_epi32(state1, cdghSave);
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1b);       // FEBA
+  state1 = _mm_shuffle_epi32(state1, 0xb1);    // DCHG
+  state0 = _mm_blend_epi16(tmp, state1, 0xf0); // DCBA
+  state1 = _mm_alignr_epi8(state1, tmp, 8);    // ABEF
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+}
+
+// Multi-buffer SHA-1 and SHA-256.  Each lane of the vector type V
+// holds the state of one message.  states[i] and data[i] point to the
+// state and the next block of the message in the i-th lane.  The
+// kernels are always inlined into the functions below, which are
+// compiled for the respective instruction set.
+typedef uint32_t v4u32 __attribute__((vector_size(16)));
+typedef uint32_t v8u32 __attribute__((vector_size(32)));
+
+typedef void (*lanes_fn_t)(uint32_t* const* states,
+                           const uint8_t* const* data, size_t blocks);
+
+#define __hash_vrol(x, n) ((x) << (n) | (x) >> (32 - (n)))
+#define __hash_vror(x, n) ((x) >> (n) | (x) << (32 - (n)))
+
+template <typename V>
+static forceinline void loadLanes(V* w, const uint8_t* const* data,
+                                  size_t offset)
+{
+  for (size_t l = 0; l < sizeof(V) / sizeof(uint32_t); ++l) {
+    for (size_t i = 0; i < 16; ++i) {
+      uint32_t word;
+      memcpy(&word, data[l] + offset + i * 4, sizeof(word));
+      w[i][l] = __crypto_be(word);
+    }
+  }
+}
+
+template <typename V, size_t ssize>
+static forceinline void gatherLanes(V* s, uint32_t* const* states)
+{
+  for (size_t l = 0; l < sizeof(V) / sizeof(uint32_t); ++l) {
+    for (size_t i = 0; i < ssize; ++i) {
+      s[i][l] = states[l][i];
+    }
+  }
+}
+
+template <typename V, size_t ssize>
+static forceinline void scatterLanes(uint32_t* const* states, const V* s)
+{
+  for (size_t l = 0; l < sizeof(V) / sizeof(uint32_t); ++l) {
+    for (size_t i = 0; i < ssize; ++i) {
+      states[l][i] = s[i][l];
+    }
+  }
+}
+
+#define __hash_sha1_lanes_round(f, k)                                          \
+  if (t >= 16) {                                                               \
+    V x = w[(t + 13) & 15] ^ w[(t + 8) & 15] ^ w[(t + 2) & 15] ^ w[t & 15];    \
+    w[t & 15] = __hash_vrol(x, 1);                                             \
+  }                                                                            \
+  tmp = __hash_vrol(a, 5) + (f) + e + (uint32_t)(k) + w[t & 15];               \
+  e = d;                                                                       \
+  d = c;                                                                       \
+  c = __hash_vrol(b, 30);                                                      \
+  b = a;                                                                       \
+  a = tmp
+
+template <typename V>
+static forceinline void sha1Lanes(uint32_t* const* states,
+                                  const uint8_t* const* data, size_t blocks)
+{
+  V s[5];
+  gatherLanes<V, 5>(s, states);
+  for (size_t offset = 0; blocks; --blocks, offset += 64) {
+    V w[16];
+    loadLanes(w, data, offset);
+    V a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], tmp;
+    size_t t = 0;
+    for (; t < 20; ++t) {
+      __hash_sha1_lanes_round(d ^ (b & (c ^ d)), 0x5a827999);
+    }
+    for (; t < 40; ++t) {
+      __hash_sha1_lanes_round(b ^ c ^ d, 0x6ed9eba1);
+    }
+    for (; t < 60; ++t) {
+      __hash_sha1_lanes_round((b & c) | (d & (b | c)), 0x8f1bbcdc);
+    }
+    for (; t < 80; ++t) {
+      __hash_sha1_lanes_round(b ^ c ^ d, 0xca62c1d6);
+    }
+    s[0] += a;
+    s[1] += b;
+    s[2] += c;
+    s[3] += d;
+    s[4] += e;
+  }
+  scatterLanes<V, 5>(states, s);
+}
+
+#undef __hash_sha1_lanes_round
+
+template <typename V>
+static forceinline void sha256Lanes(uint32_t* const* states,
+                                    const uint8_t* const* data, size_t blocks)
+{
+  V s[8];
+  gatherLanes<V, 8>(s, states);
+  for (size_t offset = 0; blocks; --blocks, offset += 64) {
+    V w[16];
+    loadLanes(w, data, offset);
+    V a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6],
+      h = s[7];
+    for (size_t t = 0; t < 64; ++t) {
+      if (t >= 16) {
+        V w2 = w[(t + 14) & 15], w15 = w[(t + 1) & 15];
+        w[t & 15] += (__hash_vror(w2, 17) ^ __hash_vror(w2, 19) ^ (w2 >> 10)) +
+                     w[(t + 9) & 15] +
+                     (__hash_vror(w15, 7) ^ __hash_vror(w15, 18) ^ (w15 >> 3));
+      }
+      V t1 = h + (__hash_vror(e, 6) ^ __hash_vror(e, 11) ^ __hash_vror(e, 25)) +
+             (g ^ (e & (f ^ g))) + sha256k[t] + w[t & 15];
+      V t2 = (__hash_vror(a, 2) ^ __hash_vror(a, 13) ^ __hash_vror(a, 22)) +
+             ((a & b) | (c & (a | b)));
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    s[0] += a;
+    s[1] += b;
+    s[2] += c;
+    s[3] += d;
+    s[4] += e;
+    s[5] += f;
+    s[6] += g;
+    s[7] += h;
+  }
+  scatterLanes<V, 8>(states, s);
+}
+
+#undef __hash_vror
+#undef __hash_vrol
+
+__attribute__((target("avx2"))) static void
+sha1LanesAvx2(uint32_t* const* states, const uint8_t* const* data,
+              size_t blocks)
+{
+  sha1Lanes<v8u32>(states, data, blocks);
+}
+
+__attribute__((target("ssse3"))) static void
+sha1LanesSsse3(uint32_t* const* states, const uint8_t* const* data,
+               size_t blocks)
+{
+  sha1Lanes<v4u32>(states, data, blocks);
+}
+
+__attribute__((target("avx2"))) static void
+sha256LanesAvx2(uint32_t* const* states, const uint8_t* const* data,
+                size_t blocks)
+{
+  sha256Lanes<v8u32>(states, data, blocks);
+}
+
+__attribute__((target("ssse3"))) static void
+sha256LanesSsse3(uint32_t* const* states, const uint8_t* const* data,
+                 size_t blocks)
+{
+  sha256Lanes<v4u32>(states, data, blocks);
+}
+} // namespace
+#endif // CRYPTO_HASH_X86
+
 // Important! Other than the SHA family, MD5 is actually LE.
 class MD5 : public AlgorithmImpl<uint32_t, 16, 4> {
 private:
@@ -513,6 +1111,18 @@ protected:
     state_.words[4] += e;
   }
 
+#ifdef CRYPTO_HASH_X86
+  virtual void transformBlocks(const uint8_t* data, size_t blocks)
+  {
+    if (hasShaExtensions()) {
+      sha1BlocksShaNi(state_.words, data, blocks);
+    }
+    else {
+      AlgorithmImpl::transformBlocks(data, blocks);
+    }
+  }
+#endif // CRYPTO_HASH_X86
+
 public:
   SHA1() { reset(); }
 
@@ -709,6 +1319,18 @@ protected:
     state_.words[7] += h;
   }
 
+#ifdef CRYPTO_HASH_X86
+  virtual void transformBlocks(const uint8_t* data, size_t blocks)
+  {
+    if (hasShaExtensions()) {
+      sha256BlocksShaNi(state_.words, data, blocks);
+    }
+    else {
+      AlgorithmImpl::transformBlocks(data, blocks);
+    }
+  }
+#endif // CRYPTO_HASH_X86
+
 public:
   SHA256() { reset(); }
 
@@ -1077,3 +1699,72 @@ std::unique_ptr<Algorithm> crypto::hash::create(Algorithms algo)
     throw std::domain_error("Invalid hash algorithm");
   }
 }
+
+#ifdef CRYPTO_HASH_X86
+namespace {
+// Hashes up to |lanes| messages in parallel.  Lanes without a message
+// hash a copy of the first one and their result is discarded.
+template <typename H>
+static void computeLanes(lanes_fn_t fn, size_t lanes, const void* const* data,
+                         const uint64_t* lengths, size_t count,
+                         std::string* out)
+{
+  H ctx[8];
+  uint32_t* states[8];
+  const uint8_t* ptrs[8];
+  uint64_t blocks = std::numeric_limits<uint64_t>::max();
+  for (size_t i = 0; i < count; ++i) {
+    blocks = std::min(blocks, lengths[i] / ctx[i].blocksize());
+  }
+  for (size_t i = 0; i < lanes; ++i) {
+    states[i] = ctx[i].state();
+    ptrs[i] = reinterpret_cast<const uint8_t*>(data[i < count ? i : 0]);
+  }
+  fn(states, ptrs, blocks);
+  for (size_t i = 0; i < count; ++i) {
+    const uint64_t done = blocks * ctx[i].blocksize();
+    ctx[i].skip(done);
+    ctx[i].update(ptrs[i] + done, lengths[i] - done);
+    out[i] = ctx[i].finalize();
+  }
+}
+} // namespace
+#endif // CRYPTO_HASH_X86
+
+std::vector<std::string> crypto::hash::computeMany(Algorithms algo,
+                                                   const void* const* data,
+                                                   const uint64_t* lengths,
+                                                   size_t count)
+{
+  std::vector<std::string> rv(count);
+  size_t i = 0;
+#ifdef CRYPTO_HASH_X86
+  // The SHA extensions are faster than the SIMD lanes, except for
+  // SHA-1 with all 8 AVX2 lanes filled.
+  const auto& features = aria2::cpu::getFeatures();
+  const bool sha = hasShaExtensions();
+  if ((algo == algoSHA1 || algo == algoSHA256) &&
+      (!sha || (algo == algoSHA1 && features.avx2)) &&
+      (features.avx2 || features.ssse3)) {
+    const size_t lanes = features.avx2 ? 8 : 4;
+    const size_t minLanes = sha ? lanes : 2;
+    const lanes_fn_t fn =
+        algo == algoSHA1 ? (features.avx2 ? sha1LanesAvx2 : sha1LanesSsse3)
+                         : (features.avx2 ? sha256LanesAvx2 : sha256LanesSsse3);
+    while (count - i >= minLanes) {
+      const size_t n = std::min(lanes, count - i);
+      if (algo == algoSHA1) {
+        computeLanes<SHA1>(fn, lanes, data + i, lengths + i, n, &rv[i]);
+      }
+      else {
+        computeLanes<SHA256>(fn, lanes, data + i, lengths + i, n, &rv[i]);
+      }
+      i += n;
+    }
+  }
+#endif // CRYPTO_HASH_X86
+  for (; i < count; ++i) {
+    rv[i] = compute(algo, data[i], lengths[i]);
+  }
+  return rv;
+}
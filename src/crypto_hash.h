@@ -10,6 +10,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 #include <limits>
 
 namespace crypto {
@@ -93,6 +94,14 @@ inline std::string compute(const std::string& name, const std::string& data)
   return compute(lookup(name), data.data(), data.length());
 }
 
+// Computes the digests of |count| independent messages.  The i-th
+// message is |lengths[i]| bytes pointed by |data[i]|.  SHA-1 and
+// SHA-256 may process up to 8 messages in parallel SIMD lanes, which
+// works best when the messages have the same length, e.g. the pieces
+// of a torrent.
+std::vector<std::string> computeMany(Algorithms algo, const void* const* data,
+                                     const uint64_t* lengths, size_t count);
+
 } // namespace hash
 } // namespace crypto
 
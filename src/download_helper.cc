@@ -63,6 +63,7 @@
 #include "SegList.h"
 #include "download_handlers.h"
 #include "SimpleRandomizer.h"
+#include "LazyRequestGroup.h"
 #ifdef ENABLE_BITTORRENT
 #  include "bittorrent_helper.h"
 #  include "BtConstants.h"
@@ -130,10 +131,14 @@ namespace {
 std::shared_ptr<RequestGroup>
 createRequestGroup(const std::shared_ptr<Option>& optionTemplate,
                    const std::vector<std::string>& uris,
-                   bool useOutOption = false)
+                   bool useOutOption = false,
+                   std::shared_ptr<GroupId> gid = nullptr)
 {
   auto option = util::copy(optionTemplate);
-  auto rg = std::make_shared<RequestGroup>(getGID(option), option);
+  if (!gid) {
+    gid = getGID(option);
+  }
+  auto rg = std::make_shared<RequestGroup>(std::move(gid), option);
   auto dctx = std::make_shared<DownloadContext>(
       option->getAsInt(PREF_PIECE_LENGTH), 0,
       useOutOption && !option->blank(PREF_OUT)
@@ -471,6 +476,23 @@ public:
 };
 } // namespace
 
+namespace {
+template <typename InputIterator>
+std::shared_ptr<RequestGroup>
+createStreamRequestGroup(const std::shared_ptr<Option>& option,
+                         InputIterator first, InputIterator last,
+                         std::shared_ptr<GroupId> gid = nullptr)
+{
+  size_t numIter = option->getAsInt(PREF_MAX_CONNECTION_PER_SERVER);
+  size_t numSplit = option->getAsInt(PREF_SPLIT);
+  std::vector<std::string> streamURIs;
+  splitURI(streamURIs, first, last, numSplit, numIter);
+  auto rg = createRequestGroup(option, streamURIs, true, std::move(gid));
+  rg->setNumConcurrentCommand(numSplit);
+  return rg;
+}
+} // namespace
+
 void createRequestGroupForUri(
     std::vector<std::shared_ptr<RequestGroup>>& result,
     const std::shared_ptr<Option>& option, const std::vector<std::string>& uris,
@@ -494,14 +516,9 @@ void createRequestGroupForUri(
         std::begin(nargs), std::end(nargs), StreamProtocolFilter());
     // let's process http/ftp protocols first.
     if (std::begin(nargs) != strmProtoEnd) {
-      size_t numIter = option->getAsInt(PREF_MAX_CONNECTION_PER_SERVER);
-      size_t numSplit = option->getAsInt(PREF_SPLIT);
-      std::vector<std::string> streamURIs;
-      splitURI(streamURIs, std::begin(nargs), strmProtoEnd, numSplit, numIter);
       try {
-        auto rg = createRequestGroup(option, streamURIs, true);
-        rg->setNumConcurrentCommand(numSplit);
-        result.push_back(rg);
+        result.push_back(createStreamRequestGroup(option, std::begin(nargs),
+                                                  strmProtoEnd));
       }
       catch (RecoverableException& e) {
         if (throwOnError) {
@@ -519,6 +536,61 @@ void createRequestGroupForUri(
   }
 }
 
+std::unique_ptr<LazyRequestGroup>
+createLazyRequestGroupForUri(const std::shared_ptr<Option>& globalOption,
+                             const std::shared_ptr<Option>& requestOption,
+                             const std::vector<std::string>& uris)
+{
+  if (uris.empty() ||
+      requestOption->get(PREF_PARAMETERIZED_URI) == A2_V_TRUE ||
+      !std::all_of(std::begin(uris), std::end(uris), StreamProtocolFilter())) {
+    return nullptr;
+  }
+  LazyRequestGroup::OptionDelta delta;
+  for (size_t i = 1, len = option::countOption(); i < len; ++i) {
+    PrefPtr pref = option::i2p(i);
+    if (pref != PREF_GID && pref != PREF_PAUSE &&
+        requestOption->definedLocal(pref)) {
+      delta.emplace_back(pref, requestOption->get(pref));
+    }
+  }
+  // may throw exception
+  auto gid = getGID(requestOption);
+  return make_unique<LazyRequestGroup>(
+      std::move(gid), uris, std::move(delta), globalOption,
+      requestOption->getAsBool(PREF_ENABLE_RPC) &&
+          requestOption->getAsBool(PREF_PAUSE));
+}
+
+std::shared_ptr<RequestGroup>
+materializeRequestGroup(const LazyRequestGroup& lazy)
+{
+  auto& uris = lazy.getUris();
+  auto rg = createStreamRequestGroup(lazy.createOption(), std::begin(uris),
+                                     std::end(uris), lazy.getGroupId());
+  rg->setPauseRequested(lazy.isPauseRequested());
+  return rg;
+}
+
+std::shared_ptr<FileEntry> createLazyFileEntry(const LazyRequestGroup& lazy,
+                                               const Option& option)
+{
+  // Same as createStreamRequestGroup() and createRequestGroup() do.
+  std::vector<std::string> uris;
+  splitURI(uris, std::begin(lazy.getUris()), std::end(lazy.getUris()),
+           option.getAsInt(PREF_SPLIT),
+           option.getAsInt(PREF_MAX_CONNECTION_PER_SERVER));
+  auto fileEntry = std::make_shared<FileEntry>(
+      option.blank(PREF_OUT)
+          ? A2STR::NIL
+          : util::applyDir(option.get(PREF_DIR), option.get(PREF_OUT)),
+      0, 0);
+  fileEntry->setUris(uris);
+  fileEntry->setMaxConnectionPerServer(
+      option.getAsInt(PREF_MAX_CONNECTION_PER_SERVER));
+  return fileEntry;
+}
+
 bool createRequestGroupFromUriListParser(
     std::vector<std::shared_ptr<RequestGroup>>& result, const Option* option,
     UriListParser* uriListParser)
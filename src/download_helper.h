@@ -51,6 +51,8 @@ class DownloadContext;
 class UriListParser;
 class ValueBase;
 class GroupId;
+class LazyRequestGroup;
+class FileEntry;
 
 #ifdef ENABLE_BITTORRENT
 // Create RequestGroup object using torrent file specified by
@@ -127,6 +129,28 @@ void createRequestGroupForUri(
     bool ignoreForceSequential = false, bool ignoreLocalPath = false,
     bool throwOnError = false);
 
+// Creates LazyRequestGroup for |uris| if they are all HTTP(S)/FTP/SFTP
+// URIs, which createRequestGroupForUri() turns into a single
+// RequestGroup.  |globalOption| is the snapshot of the global options
+// and |requestOption| holds the options given by the request on top
+// of it.  Returns nullptr if the download cannot be represented
+// lazily.
+std::unique_ptr<LazyRequestGroup>
+createLazyRequestGroupForUri(const std::shared_ptr<Option>& globalOption,
+                             const std::shared_ptr<Option>& requestOption,
+                             const std::vector<std::string>& uris);
+
+// Builds RequestGroup of |lazy| on top of the global options it
+// captured.  The returned RequestGroup shares GID with |lazy|.
+std::shared_ptr<RequestGroup>
+materializeRequestGroup(const LazyRequestGroup& lazy);
+
+// Creates the FileEntry which RequestGroup built from |lazy| has
+// before the download starts.  |option| must be the one created by
+// lazy.createOption().
+std::shared_ptr<FileEntry> createLazyFileEntry(const LazyRequestGroup& lazy,
+                                               const Option& option);
+
 template <typename InputIterator>
 void setMetadataInfo(InputIterator first, InputIterator last,
                      const std::shared_ptr<MetadataInfo>& mi)
@@ -34,7 +34,8 @@
 /* copyright --> */
 #include "json.h"
 
-#include <sstream>
+#include <cinttypes>
+#include <cstdio>
 
 #include "array_fun.h"
 #include "a2functional.h"
@@ -48,55 +49,202 @@ namespace json {
 std::string jsonEscape(const std::string& s)
 {
   std::string t;
-  for (std::string::const_iterator i = s.begin(), eoi = s.end(); i != eoi;
-       ++i) {
-    if (*i == '"' || *i == '\\' || *i == '/') {
-      t += "\\";
-      t += *i;
-    }
-    else if (*i == '\b') {
-      t += "\\b";
+  jsonEscape(t, s);
+  return t;
+}
+
+void jsonEscape(std::string& out, const std::string& s)
+{
+  auto first = s.begin();
+  for (auto i = s.begin(), eoi = s.end(); i != eoi; ++i) {
+    unsigned char c = *i;
+    if (c > 0x1Fu && c != '"' && c != '\\' && c != '/') {
+      continue;
     }
-    else if (*i == '\f') {
-      t += "\\f";
+    out.append(first, i);
+    first = i + 1;
+    switch (c) {
+    case '"':
+    case '\\':
+    case '/':
+      out += '\\';
+      out += c;
+      break;
+    case '\b':
+      out += "\\b";
+      break;
+    case '\f':
+      out += "\\f";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      out += "\\u00";
+      out += "0123456789ABCDEF"[c >> 4];
+      out += "0123456789ABCDEF"[c & 0x0Fu];
     }
-    else if (*i == '\n') {
-      t += "\\n";
+  }
+  out.append(first, s.end());
+}
+
+JsonWriter::JsonWriter(std::string& out) : out_(out), needComma_(false) {}
+
+void JsonWriter::separate()
+{
+  if (needComma_) {
+    out_ += ',';
+  }
+}
+
+JsonWriter& JsonWriter::beginObject()
+{
+  separate();
+  out_ += '{';
+  needComma_ = false;
+  return *this;
+}
+
+JsonWriter& JsonWriter::endObject()
+{
+  out_ += '}';
+  needComma_ = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::beginArray()
+{
+  separate();
+  out_ += '[';
+  needComma_ = false;
+  return *this;
+}
+
+JsonWriter& JsonWriter::endArray()
+{
+  out_ += ']';
+  needComma_ = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::key(const std::string& k)
+{
+  separate();
+  out_ += '"';
+  jsonEscape(out_, k);
+  out_ += "\":";
+  needComma_ = false;
+  return *this;
+}
+
+JsonWriter& JsonWriter::string(const std::string& s)
+{
+  separate();
+  out_ += '"';
+  jsonEscape(out_, s);
+  out_ += '"';
+  needComma_ = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::integer(int64_t i)
+{
+  separate();
+  char buf[32];
+  out_.append(buf, snprintf(buf, sizeof(buf), "%" PRId64, i));
+  needComma_ = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::boolean(bool b)
+{
+  separate();
+  out_ += b ? "true" : "false";
+  needComma_ = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::null()
+{
+  separate();
+  out_ += "null";
+  needComma_ = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::value(const ValueBase* vlb)
+{
+  class JsonValueBaseVisitor : public ValueBaseVisitor {
+  public:
+    JsonValueBaseVisitor(JsonWriter& w) : w_(w) {}
+
+    virtual void visit(const String& string) CXX11_OVERRIDE
+    {
+      w_.string(string.s());
     }
-    else if (*i == '\r') {
-      t += "\\r";
+
+    virtual void visit(const Integer& integer) CXX11_OVERRIDE
+    {
+      w_.integer(integer.i());
     }
-    else if (*i == '\t') {
-      t += "\\t";
+
+    virtual void visit(const Bool& boolValue) CXX11_OVERRIDE
+    {
+      w_.boolean(boolValue.val());
     }
-    else if (in(static_cast<unsigned char>(*i), 0x00u, 0x1Fu)) {
-      t += "\\u00";
-      char temp[3];
-      temp[2] = '\0';
-      temp[0] = (*i >> 4);
-      temp[1] = (*i) & 0x0Fu;
-      for (int j = 0; j < 2; ++j) {
-        if (temp[j] < 10) {
-          temp[j] += '0';
-        }
-        else {
-          temp[j] += 'A' - 10;
-        }
+
+    virtual void visit(const Null& nullValue) CXX11_OVERRIDE { w_.null(); }
+
+    virtual void visit(const List& list) CXX11_OVERRIDE
+    {
+      w_.beginArray();
+      for (auto& e : list) {
+        e->accept(*this);
       }
-      t += temp;
+      w_.endArray();
     }
-    else {
-      t.append(i, i + 1);
+
+    virtual void visit(const Dict& dict) CXX11_OVERRIDE
+    {
+      w_.beginObject();
+      for (auto& e : dict) {
+        w_.key(e.first);
+        e.second->accept(*this);
+      }
+      w_.endObject();
     }
+
+  private:
+    JsonWriter& w_;
+  };
+  if (!vlb) {
+    return null();
   }
-  return t;
+  JsonValueBaseVisitor visitor(*this);
+  vlb->accept(visitor);
+  return *this;
+}
+
+JsonWriter& JsonWriter::raw(const std::string& text)
+{
+  separate();
+  out_ += text;
+  needComma_ = true;
+  return *this;
 }
 
 // Serializes JSON object or array.
 std::string encode(const ValueBase* json)
 {
-  std::ostringstream out;
-  return encode(out, json).str();
+  std::string out;
+  JsonWriter(out).value(json);
+  return out;
 }
 
 JsonGetParam::JsonGetParam(const std::string& request,
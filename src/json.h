@@ -44,75 +44,40 @@ namespace json {
 
 std::string jsonEscape(const std::string& s);
 
-template <typename OutputStream>
-OutputStream& encode(OutputStream& out, const ValueBase* vlb)
-{
-  class JsonValueBaseVisitor : public ValueBaseVisitor {
-  public:
-    JsonValueBaseVisitor(OutputStream& out) : out_(out) {}
-
-    virtual void visit(const String& string) CXX11_OVERRIDE
-    {
-      encodeString(string.s());
-    }
-
-    virtual void visit(const Integer& integer) CXX11_OVERRIDE
-    {
-      out_ << integer.i();
-    }
-
-    virtual void visit(const Bool& boolValue) CXX11_OVERRIDE
-    {
-      out_ << (boolValue.val() ? "true" : "false");
-    }
-
-    virtual void visit(const Null& nullValue) CXX11_OVERRIDE { out_ << "null"; }
-
-    virtual void visit(const List& list) CXX11_OVERRIDE
-    {
-      out_ << "[";
-      if (!list.empty()) {
-        auto i = list.begin();
-        (*i)->accept(*this);
-        ++i;
-        for (auto eoi = list.end(); i != eoi; ++i) {
-          out_ << ",";
-          (*i)->accept(*this);
-        }
-      }
-      out_ << "]";
-    }
-
-    virtual void visit(const Dict& dict) CXX11_OVERRIDE
-    {
-      out_ << "{";
-      if (!dict.empty()) {
-        auto i = dict.begin();
-        encodeString((*i).first);
-        out_ << ":";
-        (*i).second->accept(*this);
-        ++i;
-        for (auto eoi = dict.end(); i != eoi; ++i) {
-          out_ << ",";
-          encodeString((*i).first);
-          out_ << ":";
-          (*i).second->accept(*this);
-        }
-      }
-      out_ << "}";
-    }
-
-  private:
-    void encodeString(const std::string& s)
-    {
-      out_ << "\"" << jsonEscape(s) << "\"";
-    }
-    OutputStream& out_;
-  };
-  JsonValueBaseVisitor visitor(out);
-  vlb->accept(visitor);
-  return out;
-}
+// Appends the escaped |s| to |out|.
+void jsonEscape(std::string& out, const std::string& s);
+
+// Writes JSON text to a string without building ValueBase.  Commas
+// are inserted between the elements automatically.  The keys of an
+// object are written in the given order, so the caller must write
+// them in the order of Dict if the output is compared with the one
+// of encode().
+class JsonWriter {
+public:
+  // Appends the output to |out|.
+  JsonWriter(std::string& out);
+
+  JsonWriter& beginObject();
+  JsonWriter& endObject();
+  JsonWriter& beginArray();
+  JsonWriter& endArray();
+  // Writes the key of the next value in the object.
+  JsonWriter& key(const std::string& k);
+  JsonWriter& string(const std::string& s);
+  JsonWriter& integer(int64_t i);
+  JsonWriter& boolean(bool b);
+  JsonWriter& null();
+  // Writes |vlb|, or null if |vlb| is nullptr.
+  JsonWriter& value(const ValueBase* vlb);
+  // Writes |text|, which must be a JSON value, as it is.
+  JsonWriter& raw(const std::string& text);
+
+private:
+  void separate();
+
+  std::string& out_;
+  bool needComma_;
+};
 
 // Serializes JSON object or array.
 std::string encode(const ValueBase* json);
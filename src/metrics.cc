@@ -0,0 +1,297 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "metrics.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "DownloadEngine.h"
+#include "RequestGroupMan.h"
+#include "RequestGroup.h"
+#include "NetStat.h"
+#include "SocketCore.h"
+#include "WrDiskCache.h"
+#include "RdDiskCache.h"
+#include "GroupId.h"
+#include "fmt.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+namespace metrics {
+
+Histogram::Histogram(std::vector<int64_t> bounds)
+    : bounds_(std::move(bounds)),
+      counts_(make_unique<std::atomic<uint64_t>[]>(bounds_.size() + 1)),
+      count_(0),
+      sum_(0)
+{
+  for (size_t i = 0; i <= bounds_.size(); ++i) {
+    counts_[i] = 0;
+  }
+}
+
+void Histogram::observe(std::chrono::microseconds d)
+{
+  auto v = std::max(static_cast<int64_t>(d.count()), static_cast<int64_t>(0));
+  auto i = std::lower_bound(std::begin(bounds_), std::end(bounds_), v) -
+           std::begin(bounds_);
+  counts_[i].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(v, std::memory_order_relaxed);
+}
+
+namespace {
+// Formats |us| microseconds as seconds without trailing zeros.
+std::string formatSeconds(uint64_t us)
+{
+  auto s = fmt("%" PRIu64 ".%06" PRIu64, us / 1000000, us % 1000000);
+  while (s.back() == '0') {
+    s.pop_back();
+  }
+  if (s.back() == '.') {
+    s.pop_back();
+  }
+  return s;
+}
+
+void writeHeader(std::string& out, const char* name, const char* help,
+                 const char* type)
+{
+  out += "# HELP ";
+  out += name;
+  out += " ";
+  out += help;
+  out += "\n# TYPE ";
+  out += name;
+  out += " ";
+  out += type;
+  out += "\n";
+}
+
+void writeSample(std::string& out, const char* name, const std::string& labels,
+                 int64_t value)
+{
+  out += name;
+  if (!labels.empty()) {
+    out += "{";
+    out += labels;
+    out += "}";
+  }
+  out += fmt(" %" PRId64 "\n", value);
+}
+
+void writeMetric(std::string& out, const char* name, const char* help,
+                 const char* type, int64_t value)
+{
+  writeHeader(out, name, help, type);
+  writeSample(out, name, "", value);
+}
+} // namespace
+
+void Histogram::write(std::string& out, const char* name,
+                      const char* help) const
+{
+  writeHeader(out, name, help, "histogram");
+  std::string bucket = name;
+  bucket += "_bucket";
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i <= bounds_.size(); ++i) {
+    cumulative += counts_[i].load(std::memory_order_relaxed);
+    std::string le = i == bounds_.size() ? "+Inf" : formatSeconds(bounds_[i]);
+    writeSample(out, bucket.c_str(), "le=\"" + le + "\"", cumulative);
+  }
+  // The total may be ahead of the buckets if observe() runs
+  // concurrently.  Keep the exposition consistent.
+  out += name;
+  out += "_sum ";
+  out += formatSeconds(sum_.load(std::memory_order_relaxed));
+  out += "\n";
+  out += name;
+  out += fmt("_count %" PRIu64 "\n", cumulative);
+}
+
+Histogram& eventLoopLatency()
+{
+  static Histogram h({100, 500, 1000, 5000, 10000, 50000, 100000, 500000,
+                      1000000});
+  return h;
+}
+
+Histogram& diskWriteLatency()
+{
+  static Histogram h({10, 100, 1000, 10000, 100000, 1000000});
+  return h;
+}
+
+namespace {
+uint64_t dnsCacheHits = 0;
+uint64_t dnsLookups = 0;
+} // namespace
+
+void countDnsCacheHit() { ++dnsCacheHits; }
+
+void countDnsLookup() { ++dnsLookups; }
+
+namespace {
+void renderDownloads(std::string& out, RequestGroupMan* rgman,
+                     size_t maxDownloads)
+{
+  auto& groups = rgman->getRequestGroups();
+  size_t n = std::min(maxDownloads, groups.size());
+  if (n > 0) {
+    struct Sample {
+      std::string labels;
+      int64_t completedLength;
+      int64_t totalLength;
+      int downloadSpeed;
+      int uploadSpeed;
+      int connections;
+    };
+    std::vector<Sample> samples;
+    samples.reserve(n);
+    for (auto i = std::begin(groups); samples.size() < n; ++i) {
+      auto& group = *i;
+      auto stat = group->calculateStat();
+      samples.push_back({"gid=\"" + GroupId::toHex(group->getGID()) + "\"",
+                         group->getCompletedLength(), group->getTotalLength(),
+                         stat.downloadSpeed, stat.uploadSpeed,
+                         group->getNumConnection()});
+    }
+    writeHeader(out, "aria2_download_completed_bytes",
+                "Completed length of the download.", "gauge");
+    for (auto& s : samples) {
+      writeSample(out, "aria2_download_completed_bytes", s.labels,
+                  s.completedLength);
+    }
+    writeHeader(out, "aria2_download_total_bytes",
+                "Total length of the download.", "gauge");
+    for (auto& s : samples) {
+      writeSample(out, "aria2_download_total_bytes", s.labels, s.totalLength);
+    }
+    writeHeader(out, "aria2_download_speed_bytes",
+                "Download speed of the download in bytes/sec.", "gauge");
+    for (auto& s : samples) {
+      writeSample(out, "aria2_download_speed_bytes", s.labels,
+                  s.downloadSpeed);
+    }
+    writeHeader(out, "aria2_upload_speed_bytes",
+                "Upload speed of the download in bytes/sec.", "gauge");
+    for (auto& s : samples) {
+      writeSample(out, "aria2_upload_speed_bytes", s.labels, s.uploadSpeed);
+    }
+    writeHeader(out, "aria2_download_connections",
+                "The number of connections of the download.", "gauge");
+    for (auto& s : samples) {
+      writeSample(out, "aria2_download_connections", s.labels, s.connections);
+    }
+  }
+  writeMetric(out, "aria2_download_series_omitted",
+              "The number of active downloads without their own time series "
+              "due to --rpc-metrics-max-downloads.",
+              "gauge", groups.size() - n);
+}
+} // namespace
+
+std::string render(DownloadEngine* e, size_t maxDownloads)
+{
+  std::string out;
+  auto& rgman = e->getRequestGroupMan();
+  auto& netStat = rgman->getNetStat();
+  writeMetric(out, "aria2_received_bytes_total",
+              "Bytes received in this session.", "counter",
+              netStat.getSessionDownloadLength());
+  writeMetric(out, "aria2_sent_bytes_total", "Bytes sent in this session.",
+              "counter", netStat.getSessionUploadLength());
+
+  writeHeader(out, "aria2_downloads", "The number of downloads.", "gauge");
+  writeSample(out, "aria2_downloads", "state=\"active\"",
+              rgman->getRequestGroups().size());
+  writeSample(out, "aria2_downloads", "state=\"waiting\"",
+              rgman->getReservedGroups().size());
+  writeSample(out, "aria2_downloads", "state=\"stopped\"",
+              rgman->getDownloadResults().size());
+
+  writeHeader(out, "aria2_commands", "The number of Commands.", "gauge");
+  writeSample(out, "aria2_commands", "queue=\"normal\"", e->countCommand());
+  writeSample(out, "aria2_commands", "queue=\"routine\"",
+              e->countRoutineCommand());
+  writeMetric(out, "aria2_open_sockets", "The number of open sockets.",
+              "gauge", SocketCore::getNumOpenSockets());
+  eventLoopLatency().write(out, "aria2_event_loop_iteration_seconds",
+                           "Time spent executing Commands in one iteration.");
+
+  writeMetric(out, "aria2_dns_cache_hits_total",
+              "Host names resolved by the DNS cache.", "counter",
+              dnsCacheHits);
+  writeMetric(out, "aria2_dns_lookups_total",
+              "Host names resolved by name resolution.", "counter",
+              dnsLookups);
+
+  diskWriteLatency().write(out, "aria2_disk_write_seconds",
+                           "Time spent in each write to the disk.");
+  auto wrDiskCache = rgman->getWrDiskCache();
+  if (wrDiskCache) {
+    const auto& stat = wrDiskCache->getStat();
+    writeMetric(out, "aria2_disk_cache_bytes",
+                "Bytes held in the disk write cache.", "gauge",
+                wrDiskCache->getSize());
+    writeMetric(out, "aria2_disk_cache_flushes_total",
+                "Cache entries flushed to the disk.", "counter",
+                stat.flushes + stat.evictions);
+    writeMetric(out, "aria2_disk_cache_flushed_bytes_total",
+                "Bytes flushed from the disk write cache.", "counter",
+                stat.bytesFlushed);
+  }
+  auto rdDiskCache = rgman->getRdDiskCache();
+  if (rdDiskCache) {
+    const auto& stat = rdDiskCache->getStat();
+    writeMetric(out, "aria2_disk_read_cache_bytes",
+                "Bytes held in the disk read cache.", "gauge",
+                rdDiskCache->getSize());
+    writeMetric(out, "aria2_disk_read_cache_hits_total",
+                "Reads served from the disk read cache.", "counter",
+                stat.hits);
+    writeMetric(out, "aria2_disk_read_cache_misses_total",
+                "Reads missed the disk read cache.", "counter", stat.misses);
+  }
+
+  renderDownloads(out, rgman.get(), maxDownloads);
+  return out;
+}
+
+} // namespace metrics
+
+} // namespace aria2
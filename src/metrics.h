@@ -0,0 +1,98 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2026 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_METRICS_H
+#define D_METRICS_H
+
+#include "common.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aria2 {
+
+class DownloadEngine;
+
+namespace metrics {
+
+// Histogram with fixed buckets whose upper bounds are given in
+// microseconds.  observe() may be called from any thread.
+class Histogram {
+public:
+  Histogram(std::vector<int64_t> bounds);
+
+  void observe(std::chrono::microseconds d);
+
+  template <typename Duration> void observe(Duration d)
+  {
+    observe(std::chrono::duration_cast<std::chrono::microseconds>(d));
+  }
+
+  uint64_t getCount() const { return count_; }
+
+  // Appends this histogram to |out| in Prometheus text format.  The
+  // values are exported in seconds.
+  void write(std::string& out, const char* name, const char* help) const;
+
+private:
+  std::vector<int64_t> bounds_;
+  // Non-cumulative counts.  The last one is for +Inf.
+  std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+  std::atomic<uint64_t> count_;
+  // Sum of the observed values in microseconds
+  std::atomic<uint64_t> sum_;
+};
+
+// Time spent executing Commands in one iteration of DownloadEngine.
+Histogram& eventLoopLatency();
+
+// Time spent in each write to the disk.
+Histogram& diskWriteLatency();
+
+void countDnsCacheHit();
+
+void countDnsLookup();
+
+// Returns the metrics of |e| in Prometheus text format.  At most
+// |maxDownloads| active downloads get their own time series.
+std::string render(DownloadEngine* e, size_t maxDownloads);
+
+} // namespace metrics
+
+} // namespace aria2
+
+#endif // D_METRICS_H
@@ -137,6 +137,7 @@ const std::string V_FEEDBACK("feedback");
 const std::string V_ADAPTIVE("adaptive");
 const std::string V_LIBUV("libuv");
 const std::string V_EPOLL("epoll");
+const std::string V_IO_URING("io_uring");
 const std::string V_KQUEUE("kqueue");
 const std::string V_PORT("port");
 const std::string V_POLL("poll");
@@ -274,6 +275,8 @@ PrefPtr PREF_RPC_USER = makePref("rpc-user");
 PrefPtr PREF_RPC_PASSWD = makePref("rpc-passwd");
 // value: 1*digit
 PrefPtr PREF_RPC_MAX_REQUEST_SIZE = makePref("rpc-max-request-size");
+// value: 1*digit
+PrefPtr PREF_RPC_METRICS_MAX_DOWNLOADS = makePref("rpc-metrics-max-downloads");
 // value: true | false
 PrefPtr PREF_RPC_LISTEN_ALL = makePref("rpc-listen-all");
 // value: true | false
@@ -335,6 +338,10 @@ PrefPtr PREF_STREAM_PIECE_SELECTOR = makePref("stream-piece-selector");
 // value: true | false
 PrefPtr PREF_TRUNCATE_CONSOLE_READOUT = makePref("truncate-console-readout");
 // value: true | false
+PrefPtr PREF_PROFILE_COMMANDS = makePref("profile-commands");
+// value: string that your file system recognizes as a file name.
+PrefPtr PREF_TRACE_FILE = makePref("trace-file");
+// value: true | false
 PrefPtr PREF_PAUSE = makePref("pause");
 // value: default | full | hide
 PrefPtr PREF_DOWNLOAD_RESULT = makePref("download-result");
@@ -352,6 +359,8 @@ PrefPtr PREF_FORCE_SAVE = makePref("force-save");
 PrefPtr PREF_SAVE_NOT_FOUND = makePref("save-not-found");
 // value: 1*digit
 PrefPtr PREF_DISK_CACHE = makePref("disk-cache");
+// value: 1*digit
+PrefPtr PREF_DISK_READ_CACHE = makePref("disk-read-cache");
 // value: string
 PrefPtr PREF_GID = makePref("gid");
 // values: 1*digit
@@ -376,6 +385,12 @@ PrefPtr PREF_STDERR = makePref("stderr");
 // value: true | false
 PrefPtr PREF_KEEP_UNFINISHED_DOWNLOAD_RESULT =
     makePref("keep-unfinished-download-result");
+// value: 1*digit
+PrefPtr PREF_DISK_WRITE_THREADS = makePref("disk-write-threads");
+// value: 1*digit
+PrefPtr PREF_DISK_WRITE_QUEUE_SIZE = makePref("disk-write-queue-size");
+// value: 1*digit
+PrefPtr PREF_CHECK_INTEGRITY_THREADS = makePref("check-integrity-threads");
 
 /**
  * FTP related preferences
@@ -408,6 +423,8 @@ PrefPtr PREF_ENABLE_HTTP_KEEP_ALIVE = makePref("enable-http-keep-alive");
 PrefPtr PREF_ENABLE_HTTP_PIPELINING = makePref("enable-http-pipelining");
 // value: 1*digit
 PrefPtr PREF_MAX_HTTP_PIPELINING = makePref("max-http-pipelining");
+// values: true | false
+PrefPtr PREF_ENABLE_HTTP_SPLICE = makePref("enable-http-splice");
 // value: string
 PrefPtr PREF_HEADER = makePref("header");
 // value: string that your file system recognizes as a file name.
@@ -566,6 +583,11 @@ PrefPtr PREF_BT_ENABLE_HOOK_AFTER_HASH_CHECK =
     makePref("bt-enable-hook-after-hash-check");
 // values: true | false
 PrefPtr PREF_BT_LOAD_SAVED_METADATA = makePref("bt-load-saved-metadata");
+// values: 1*digit
+PrefPtr PREF_BT_MAX_OUTSTANDING_REQUEST =
+    makePref("bt-max-outstanding-request");
+// values: true | false
+PrefPtr PREF_BT_ENABLE_UTP = makePref("bt-enable-utp");
 
 /**
  * Metalink related preferences
@@ -94,6 +94,7 @@ extern const std::string V_FEEDBACK;
 extern const std::string V_ADAPTIVE;
 extern const std::string V_LIBUV;
 extern const std::string V_EPOLL;
+extern const std::string V_IO_URING;
 extern const std::string V_KQUEUE;
 extern const std::string V_PORT;
 extern const std::string V_POLL;
@@ -227,6 +228,8 @@ extern PrefPtr PREF_RPC_USER;
 extern PrefPtr PREF_RPC_PASSWD;
 // value: 1*digit
 extern PrefPtr PREF_RPC_MAX_REQUEST_SIZE;
+// value: 1*digit
+extern PrefPtr PREF_RPC_METRICS_MAX_DOWNLOADS;
 // value: true | false
 extern PrefPtr PREF_RPC_LISTEN_ALL;
 // value: true | false
@@ -288,6 +291,10 @@ extern PrefPtr PREF_STREAM_PIECE_SELECTOR;
 // value: true | false
 extern PrefPtr PREF_TRUNCATE_CONSOLE_READOUT;
 // value: true | false
+extern PrefPtr PREF_PROFILE_COMMANDS;
+// value: string that your file system recognizes as a file name.
+extern PrefPtr PREF_TRACE_FILE;
+// value: true | false
 extern PrefPtr PREF_PAUSE;
 // value: default | full | hide
 extern PrefPtr PREF_DOWNLOAD_RESULT;
@@ -305,6 +312,8 @@ extern PrefPtr PREF_FORCE_SAVE;
 extern PrefPtr PREF_SAVE_NOT_FOUND;
 // value: 1*digit
 extern PrefPtr PREF_DISK_CACHE;
+// value: 1*digit
+extern PrefPtr PREF_DISK_READ_CACHE;
 // value: string
 extern PrefPtr PREF_GID;
 // values: 1*digit
@@ -329,6 +338,12 @@ extern PrefPtr PREF_MAX_MMAP_LIMIT;
 extern PrefPtr PREF_STDERR;
 // value: true | false
 extern PrefPtr PREF_KEEP_UNFINISHED_DOWNLOAD_RESULT;
+// value: 1*digit
+extern PrefPtr PREF_DISK_WRITE_THREADS;
+// value: 1*digit
+extern PrefPtr PREF_DISK_WRITE_QUEUE_SIZE;
+// value: 1*digit
+extern PrefPtr PREF_CHECK_INTEGRITY_THREADS;
 
 /**
  * FTP related preferences
@@ -361,6 +376,8 @@ extern PrefPtr PREF_ENABLE_HTTP_KEEP_ALIVE;
 extern PrefPtr PREF_ENABLE_HTTP_PIPELINING;
 // value: 1*digit
 extern PrefPtr PREF_MAX_HTTP_PIPELINING;
+// values: true | false
+extern PrefPtr PREF_ENABLE_HTTP_SPLICE;
 // value: string
 extern PrefPtr PREF_HEADER;
 // value: string that your file system recognizes as a file name.
@@ -517,6 +534,10 @@ extern PrefPtr PREF_BT_FORCE_ENCRYPTION;
 extern PrefPtr PREF_BT_ENABLE_HOOK_AFTER_HASH_CHECK;
 // values: true | false
 extern PrefPtr PREF_BT_LOAD_SAVED_METADATA;
+// values: 1*digit
+extern PrefPtr PREF_BT_MAX_OUTSTANDING_REQUEST;
+// values: true | false
+extern PrefPtr PREF_BT_ENABLE_UTP;
 
 /**
  * Metalink related preferences
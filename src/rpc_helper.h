@@ -62,8 +62,11 @@ RpcRequest xmlParseMemory(const char* xml, size_t size);
 RpcResponse createJsonRpcErrorResponse(int code, const std::string& msg,
                                        std::unique_ptr<ValueBase> id);
 
-// Processes JSON-RPC request |jsondict| and returns the result.
-RpcResponse processJsonRpcRequest(Dict* jsondict, DownloadEngine* e);
+// Processes JSON-RPC request |jsondict| and returns the result.  The
+// |wsSession| is the WebSocket session which the request is received
+// from, or nullptr.
+RpcResponse processJsonRpcRequest(Dict* jsondict, DownloadEngine* e,
+                                  WebSocketSession* wsSession = nullptr);
 
 } // namespace rpc
 
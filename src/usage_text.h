@@ -192,6 +192,12 @@
   _(" --enable-http-keep-alive[=true|false] Enable HTTP/1.1 persistent connection.")
 #define TEXT_ENABLE_HTTP_PIPELINING                                     \
   _(" --enable-http-pipelining[=true|false] Enable HTTP/1.1 pipelining.")
+#define TEXT_ENABLE_HTTP_SPLICE                                         \
+  _(" --enable-http-splice[=true|false] Move the response body of plain HTTP\n" \
+    "                              downloads from the socket to the file with\n" \
+    "                              splice(2), without copying it into aria2.\n" \
+    "                              This is only used when the response is not\n" \
+    "                              encoded and --disk-cache is 0.")
 #define TEXT_CHECK_INTEGRITY                                            \
   _(" -V, --check-integrity[=true|false] Check file integrity by validating piece\n" \
     "                              hashes or a hash of entire file. This option has\n" \
@@ -376,6 +382,20 @@
 #define TEXT_BT_SEED_UNVERIFIED                                         \
   _(" --bt-seed-unverified[=true|false] Seed previously downloaded files without\n" \
     "                              verifying piece hashes.")
+#define TEXT_BT_MAX_OUTSTANDING_REQUEST                                  \
+  _(" --bt-max-outstanding-request=NUM Set the upper limit of the number of block\n" \
+    "                              requests pipelined to a peer. The number is\n" \
+    "                              computed for each peer from its download speed\n" \
+    "                              and the round-trip time of the requests.")
+#define TEXT_BT_ENABLE_UTP                                              \
+  _(" --bt-enable-utp[=true|false] Enable uTP (Micro Transport Protocol) for\n" \
+    "                              BitTorrent peers. uTP uses the UDP port of\n" \
+    "                              IPv4 DHT, so --enable-dht must be true. The\n" \
+    "                              connections to peers are tried over uTP first\n" \
+    "                              and over TCP if the peer does not respond. To\n" \
+    "                              accept uTP connections from other clients,\n" \
+    "                              specify the same port in --dht-listen-port and\n" \
+    "                              --listen-port.")
 #define TEXT_BT_MAX_PEERS                                               \
   _(" --bt-max-peers=NUM           Specify the maximum number of peers per torrent.\n" \
     "                              0 means unlimited.\n"                \
@@ -826,6 +846,10 @@
   _(" --rpc-max-request-size=SIZE  Set max size of JSON-RPC/XML-RPC request. If aria2\n" \
     "                              detects the request is more than SIZE bytes, it\n" \
     "                              drops connection.")
+#define TEXT_RPC_METRICS_MAX_DOWNLOADS                              \
+  _(" --rpc-metrics-max-downloads=NUM Set the maximum number of active downloads\n" \
+    "                              whose per-download metrics are exported by\n" \
+    "                              /metrics of RPC server. 0 disables them.")
 #define TEXT_RPC_USER                               \
   _(" --rpc-user=USER              Set JSON-RPC/XML-RPC user. This option will be\n" \
     "                              deprecated in the future release. Migrate to\n" \
@@ -881,6 +905,16 @@
 #define TEXT_TRUNCATE_CONSOLE_READOUT                                   \
   _(" --truncate-console-readout[=true|false] Truncate console readout to fit in\n"\
     "                              a single line.")
+#define TEXT_PROFILE_COMMANDS                                           \
+  _(" --profile-commands[=true|false] Record the execution time of internal\n" \
+    "                              Commands per their type and the time spent\n" \
+    "                              waiting for I/O events. The result is returned\n" \
+    "                              by aria2.getCommandProfile RPC method and\n" \
+    "                              written to the log on SIGUSR2.")
+#define TEXT_TRACE_FILE                                                 \
+  _(" --trace-file=FILE            Write the execution of internal Commands, disk\n" \
+    "                              writes, hashing, DNS resolution and RPC methods\n" \
+    "                              to FILE in Chrome Trace Event format.")
 #define TEXT_PAUSE                              \
   _(" --pause[=true|false]         Pause download after added. This option is\n" \
     "                              effective only when --enable-rpc=true is given.")
@@ -999,6 +1033,36 @@
     "                              cached in memory, we don't need to read them\n" \
     "                              from the disk.\n"                    \
     "                              SIZE can include K or M(1K = 1024, 1M = 1024K).")
+#define TEXT_DISK_READ_CACHE                    \
+  _(" --disk-read-cache=SIZE       Cache the pieces sent to BitTorrent peers in\n" \
+    "                              memory, which grows to at most SIZE bytes. When\n" \
+    "                              a peer requests the first block of a piece, the\n" \
+    "                              whole piece is read, so that the following\n" \
+    "                              requests of the piece from any peer are served\n" \
+    "                              from memory. The least recently used pieces are\n" \
+    "                              evicted. The cache storage is shared by all\n" \
+    "                              downloads. If SIZE is 0, the cache is disabled.\n" \
+    "                              SIZE can include K or M(1K = 1024, 1M = 1024K).")
+#define TEXT_DISK_WRITE_THREADS                 \
+  _(" --disk-write-threads=NUM     Write downloaded data to the disk in NUM\n" \
+    "                              worker threads, so that a slow disk does not\n" \
+    "                              block network I/O. If NUM is 0, the data are\n" \
+    "                              written in the main thread. When more than\n" \
+    "                              --disk-write-queue-size bytes are waiting to be\n" \
+    "                              written, aria2 stops receiving data until the\n" \
+    "                              half of them are written. This option has no\n" \
+    "                              effect on the files with --enable-mmap.")
+#define TEXT_DISK_WRITE_QUEUE_SIZE              \
+  _(" --disk-write-queue-size=SIZE Set the maximum number of bytes waiting to be\n" \
+    "                              written by the threads enabled with\n" \
+    "                              --disk-write-threads.\n" \
+    "                              SIZE can include K or M(1K = 1024, 1M = 1024K).")
+#define TEXT_CHECK_INTEGRITY_THREADS            \
+  _(" --check-integrity-threads=NUM Compute piece hashes in NUM worker threads\n" \
+    "                              when checking file integrity. Up to NUM\n" \
+    "                              downloads are checked at the same time. If NUM\n" \
+    "                              is 0, piece hashes are computed in the main\n" \
+    "                              thread and downloads are checked one by one.")
 #define TEXT_GID                                \
   _(" --gid=GID                    Set GID manually. aria2 identifies each\n" \
     "                              download by the ID called GID. The GID must be\n" \
@@ -52,6 +52,9 @@
 #ifdef HAVE_PWD_H
 #  include <pwd.h>
 #endif // HAVE_PWD_H
+#ifdef HAVE_CXXABI_H
+#  include <cxxabi.h>
+#endif // HAVE_CXXABI_H
 
 #include <array>
 #include <cerrno>
@@ -2590,6 +2593,26 @@ bool gainPrivilege(LPCTSTR privName)
 }
 #endif // __MINGW32__
 
+std::string demangle(const char* name)
+{
+  std::string res;
+#ifdef HAVE_CXXABI_H
+  int status;
+  char* s = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  if (s) {
+    res = s;
+    free(s);
+  }
+#endif // HAVE_CXXABI_H
+  if (res.empty()) {
+    res = name;
+  }
+  if (startsWith(res, "aria2::")) {
+    res.erase(0, 7);
+  }
+  return res;
+}
+
 } // namespace util
 
 } // namespace aria2
@@ -879,6 +879,11 @@ void make_fd_cloexec(int fd);
 bool gainPrivilege(LPCTSTR privName);
 #endif // __MINGW32__
 
+// Returns the demangled form of the type name |name| returned by
+// std::type_info::name() without leading "aria2::".  If demangling is
+// not supported, |name| is returned as is.
+std::string demangle(const char* name);
+
 } // namespace util
 
 } // namespace aria2
@@ -67,6 +67,10 @@ void Aria2ApiTest::testAddUri()
   CPPUNIT_ASSERT_EQUAL((size_t)1, file.uris.size());
   CPPUNIT_ASSERT_EQUAL(uris[0], file.uris[0].uri);
   deleteDownloadHandle(hd);
+  // The download handle does not materialize the waiting download.
+  auto& rgman =
+      session_->context->reqinfo->getDownloadEngine()->getRequestGroupMan();
+  CPPUNIT_ASSERT_EQUAL((size_t)1, rgman->countLazyGroup());
 
   options.push_back(KeyVals::value_type("file-allocation", "foo"));
   CPPUNIT_ASSERT_EQUAL(-1, addUri(session_, &gid, uris, options));
@@ -0,0 +1,115 @@
+// Runs the microbenchmarks.  Usage:
+//
+//   aria2bench [--time=MSEC] [PREFIX...]
+//
+// Only the benchmarks whose names start with one of PREFIX are run.
+// Each benchmark runs for at least MSEC milliseconds (default: 200).
+#include "Bench.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "util.h"
+#include "Platform.h"
+#include "console.h"
+
+namespace aria2 {
+
+namespace bench {
+
+volatile size_t sink;
+
+namespace {
+std::vector<std::string> prefixes;
+std::chrono::milliseconds minTime(200);
+} // namespace
+
+bool selected(const std::string& prefix)
+{
+  if (prefixes.empty()) {
+    return true;
+  }
+  for (auto& p : prefixes) {
+    if (util::startsWith(p, prefix) || util::startsWith(prefix, p)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void run(const std::string& name, size_t bytes,
+         const std::function<size_t()>& f)
+{
+  using namespace std::chrono;
+  if (!prefixes.empty()) {
+    bool found = false;
+    for (auto& p : prefixes) {
+      if (util::startsWith(name, p)) {
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      return;
+    }
+  }
+  // Warm up caches and lazily initialized data.
+  sink = f();
+  size_t iterations = 0;
+  size_t batch = 1;
+  auto start = steady_clock::now();
+  auto now = start;
+  do {
+    for (size_t i = 0; i < batch; ++i) {
+      sink = f();
+    }
+    iterations += batch;
+    now = steady_clock::now();
+    // Keep the overhead of reading the clock small for the fast
+    // functions.
+    if (now - start < minTime / 100) {
+      batch *= 2;
+    }
+  } while (now - start < minTime);
+  double ns = duration_cast<nanoseconds>(now - start).count() /
+              static_cast<double>(iterations);
+  if (bytes) {
+    printf("%s\t%zu\t%.1f\t%.1f\n", name.c_str(), iterations, ns,
+           bytes * 1000.0 / ns);
+  }
+  else {
+    printf("%s\t%zu\t%.1f\t-\n", name.c_str(), iterations, ns);
+  }
+  fflush(stdout);
+}
+
+} // namespace bench
+
+} // namespace aria2
+
+int main(int argc, char* argv[])
+{
+  using namespace aria2;
+  for (int i = 1; i < argc; ++i) {
+    if (util::startsWith(argv[i], "--time=")) {
+      bench::minTime = std::chrono::milliseconds(atoi(argv[i] + 7));
+    }
+    else {
+      bench::prefixes.push_back(argv[i]);
+    }
+  }
+  global::initConsole(false);
+  Platform platform;
+  printf("# aria2 %s\n", PACKAGE_VERSION);
+  printf("# name\titerations\tns/op\tMB/s\n");
+  bench::bitfield();
+  bench::codec();
+  bench::messageDigest();
+  bench::pieceStatMan();
+  bench::rpc();
+  bench::wrDiskCache();
+  return 0;
+}
@@ -0,0 +1,48 @@
+// Harness of the microbenchmarks run by "make bench".  Each
+// benchmark calls a function repeatedly for a fixed time and prints a
+// tab separated line:
+//
+//   name  iterations  ns/op  MB/s
+//
+// MB/s is "-" if the benchmark does not process a fixed amount of
+// data.  Lines starting with "#" are comments.
+#ifndef D_BENCH_H
+#define D_BENCH_H
+
+#include "common.h"
+
+#include <functional>
+#include <string>
+
+#include "a2functional.h"
+
+namespace aria2 {
+
+namespace bench {
+
+// Keeps the compiler from discarding the results.
+extern volatile size_t sink;
+
+// Returns true if some benchmarks whose names start with |prefix|
+// are selected on the command line.  Used to skip the preparation
+// of the data of the benchmarks which are not run.
+bool selected(const std::string& prefix);
+
+// Runs |f| repeatedly and prints the time taken by a call.  |bytes|
+// is the amount of data processed by a call, or 0.  Does nothing if
+// |name| is not selected.
+void run(const std::string& name, size_t bytes,
+         const std::function<size_t()>& f);
+
+void bitfield();
+void codec();
+void messageDigest();
+void pieceStatMan();
+void rpc();
+void wrDiskCache();
+
+} // namespace bench
+
+} // namespace aria2
+
+#endif // D_BENCH_H
@@ -0,0 +1,240 @@
+// Benchmarks of the bitfield kernels against the byte-by-byte
+// implementation they replaced, and of BitfieldMan.
+#include "Bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "bitfield.h"
+#include "array_fun.h"
+#include "BitfieldMan.h"
+
+namespace aria2 {
+
+namespace bench {
+
+using namespace aria2::expr;
+
+namespace {
+
+// 1M pieces
+const size_t NBITS = 1 << 20;
+const size_t LEN = NBITS / 8;
+
+// The byte by byte implementation before the kernels were added.
+namespace old {
+
+size_t countSetBit(const unsigned char* bitfield, size_t nbits)
+{
+  size_t count = 0;
+  size_t size = sizeof(uint32_t);
+  size_t len = (nbits + 7) / 8;
+  if (nbits % 32 != 0) {
+    --len;
+    count += bitfield::countBit32(
+        static_cast<uint32_t>(bitfield[len] & bitfield::lastByteMask(nbits)));
+  }
+  size_t to = len / size;
+  for (size_t i = 0; i < to; ++i) {
+    uint32_t v;
+    memcpy(&v, &bitfield[i * size], sizeof(v));
+    count += bitfield::countBit32(v);
+  }
+  for (size_t i = len - len % size; i < len; ++i) {
+    count += bitfield::countBit32(static_cast<uint32_t>(bitfield[i]));
+  }
+  return count;
+}
+
+template <typename Array>
+bool copyBitfield(unsigned char* dst, const Array& src, size_t blocks)
+{
+  unsigned char bits = 0;
+  size_t len = (blocks + 7) / 8;
+  for (size_t i = 0; i < len - 1; ++i) {
+    dst[i] = src[i];
+    bits |= dst[i];
+  }
+  dst[len - 1] = src[len - 1] & bitfield::lastByteMask(blocks);
+  bits |= dst[len - 1];
+  return bits != 0;
+}
+
+bool hasMissingPiece(const unsigned char* have, const unsigned char* peer,
+                     const unsigned char* filter, size_t len)
+{
+  for (size_t i = 0; i < len; ++i) {
+    unsigned char temp = peer[i] & ~have[i] & filter[i];
+    if (temp & 0xffu) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename Array>
+bool getFirstSetBitIndex(size_t& index, const Array& bitfield, size_t nbits)
+{
+  for (size_t i = 0; i < nbits; ++i) {
+    if (bitfield::test(bitfield, nbits, i)) {
+      index = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace old
+
+const char* kernelName(bitfield::Kernel kernel)
+{
+  switch (kernel) {
+  case bitfield::KERNEL_WORD:
+    return "word";
+  case bitfield::KERNEL_VEC128:
+    return "vec128";
+  case bitfield::KERNEL_AVX2:
+    return "avx2";
+  }
+  return "";
+}
+
+// Runs |oldFun| as "bitfield/NAME/old" and |newFun| with each
+// available kernel as "bitfield/NAME/KERNEL".
+template <typename Old, typename New>
+void compare(const std::string& name, Old oldFun, New newFun)
+{
+  auto orig = bitfield::getKernel();
+  run("bitfield/" + name + "/old", LEN, oldFun);
+  for (auto kernel : {bitfield::KERNEL_WORD, bitfield::KERNEL_VEC128,
+                      bitfield::KERNEL_AVX2}) {
+    if (!bitfield::setKernel(kernel)) {
+      continue;
+    }
+    if (oldFun() != newFun()) {
+      fprintf(stderr, "%s: %s returned a different result\n", name.c_str(),
+              kernelName(kernel));
+      exit(EXIT_FAILURE);
+    }
+    run("bitfield/" + name + "/" + kernelName(kernel), LEN, newFun);
+  }
+  bitfield::setKernel(orig);
+}
+
+void bitfieldMan()
+{
+  // 16GiB in 16KiB pieces
+  BitfieldMan bt(16_k, static_cast<int64_t>(NBITS) * 16_k);
+  bt.setAllBit();
+  std::mt19937 rng(0);
+  for (size_t i = 0; i < 1000; ++i) {
+    size_t index = rng() % NBITS;
+    bt.unsetBit(index);
+    if (i % 2 == 0) {
+      bt.setUseBit(index);
+    }
+  }
+  std::vector<unsigned char> peerBuf(LEN), ignoreBuf(LEN), misBuf(LEN);
+  for (auto& c : peerBuf) {
+    c = rng();
+  }
+  auto peer = peerBuf.data();
+  // The peer has nothing we need, so the whole bitfield is scanned.
+  run("BitfieldMan/hasMissingPiece", LEN,
+      [&] { return bt.hasMissingPiece(bt.getBitfield(), LEN); });
+  run("BitfieldMan/getFirstMissingUnusedIndex", LEN, [&] {
+    size_t index = 0;
+    bt.getFirstMissingUnusedIndex(index);
+    return index;
+  });
+  run("BitfieldMan/getSparseMissingUnusedIndex", LEN, [&] {
+    size_t index = 0;
+    bt.getSparseMissingUnusedIndex(index, 1_m, ignoreBuf.data(), LEN);
+    return index;
+  });
+  run("BitfieldMan/getAllMissingUnusedIndexes", LEN, [&] {
+    return bt.getAllMissingUnusedIndexes(misBuf.data(), LEN, peer, LEN);
+  });
+  run("BitfieldMan/countMissingBlockNow", LEN,
+      [&] { return bt.countMissingBlockNow(); });
+  run("BitfieldMan/setBit", 0, [&] {
+    size_t index = rng() % NBITS;
+    bt.unsetBit(index);
+    return bt.setBit(index);
+  });
+}
+
+} // namespace
+
+void bitfield()
+{
+  if (selected("BitfieldMan/")) {
+    bitfieldMan();
+  }
+  if (!selected("bitfield/")) {
+    return;
+  }
+  std::mt19937 rng(0);
+  // A download which is about to finish: most pieces are done, the
+  // remaining ones are in use except for the last one.
+  std::vector<unsigned char> haveBuf(LEN, 0xff), useBuf(LEN), peerBuf(LEN),
+      filterBuf(LEN, 0xff), dstBuf(LEN);
+  for (auto& c : peerBuf) {
+    c = rng();
+  }
+  for (size_t i = 0; i < 1000; ++i) {
+    size_t index = rng() % (NBITS - 64);
+    haveBuf[index / 8] &= ~(128 >> (index % 8));
+    useBuf[index / 8] |= 128 >> (index % 8);
+  }
+  haveBuf[LEN - 1] = 0xfe;
+  filterBuf[0] = 0;
+  auto have = haveBuf.data();
+  auto use = useBuf.data();
+  auto peer = peerBuf.data();
+  auto filter = filterBuf.data();
+  auto dst = dstBuf.data();
+
+  compare("countSetBit", [&] { return old::countSetBit(peer, NBITS); },
+      [&] { return bitfield::countSetBit(peer, NBITS); });
+  compare("countSetBitAnd",
+      [&] {
+        return bitfield::countSetBitSlow(array(have) & array(filter), NBITS);
+      },
+      [&] { return bitfield::countSetBitAnd(have, filter, NBITS); });
+  compare("getAllMissing",
+      [&] {
+        return old::copyBitfield(
+            dst, ~array(have) & ~array(use) & array(peer) & array(filter),
+            NBITS);
+      },
+      [&] {
+        return bitfield::getMissing(dst, have, use, peer, filter, NBITS);
+      });
+  // The peer has nothing we need, so the whole bitfield is scanned.
+  compare("hasMissingPiece",
+      [&] { return old::hasMissingPiece(have, have, filter, LEN); },
+      [&] {
+        return bitfield::getMissing(nullptr, have, nullptr, have, filter,
+                                    NBITS);
+      });
+  compare("getFirstMissing",
+      [&] {
+        size_t index = 0;
+        old::getFirstSetBitIndex(index, ~array(have) & ~array(use) &
+                                            array(filter),
+                                 NBITS);
+        return index;
+      },
+      [&] {
+        size_t index = 0;
+        bitfield::getFirstNMissingIndex(&index, 1, have, use, filter, NBITS);
+        return index;
+      });
+}
+
+} // namespace bench
+
+} // namespace aria2
@@ -0,0 +1,205 @@
+// Benchmarks of bencode2, the JSON parsers and encoder and
+// util::percentDecode.
+#include "Bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "ValueBase.h"
+#include "bencode2.h"
+#include "json.h"
+#include "ValueBaseJsonParser.h"
+#include "JsonFastParser.h"
+#include "util.h"
+#include "fmt.h"
+
+namespace aria2 {
+
+namespace bench {
+
+namespace {
+
+// A multi-file torrent with 100k files and 16KiB pieces.
+std::unique_ptr<Dict> createTorrent()
+{
+  const size_t numFiles = 100000;
+  const int64_t fileLength = 1234567;
+  auto files = List::g();
+  for (size_t i = 0; i < numFiles; ++i) {
+    auto file = Dict::g();
+    file->put("length", Integer::g(fileLength));
+    auto path = List::g();
+    path->append(fmt("dir%zu", i / 1000));
+    path->append(fmt("file%zu.dat", i));
+    file->put("path", std::move(path));
+    files->append(std::move(file));
+  }
+  auto info = Dict::g();
+  info->put("files", std::move(files));
+  info->put("name", "bench");
+  info->put("piece length", Integer::g(16_k));
+  size_t numPieces = (numFiles * fileLength + 16_k - 1) / 16_k;
+  info->put("pieces", std::string(numPieces * 20, 'x'));
+  auto torrent = Dict::g();
+  torrent->put("announce", "http://tracker.example.org/announce");
+  torrent->put("info", std::move(info));
+  return torrent;
+}
+
+// The response of system.multicall of tellStatus, about 10MB when
+// encoded.
+std::unique_ptr<List> createRpcResponse()
+{
+  auto res = List::g();
+  for (size_t i = 0; i < 6000; ++i) {
+    auto status = Dict::g();
+    status->put("gid", fmt("%016zx", i));
+    status->put("status", "active");
+    status->put("totalLength", util::itos(1234567890));
+    status->put("completedLength", util::itos(i * 1000));
+    status->put("downloadSpeed", util::itos(i));
+    status->put("dir", "/home/user/Downloads");
+    auto files = List::g();
+    for (size_t j = 0; j < 5; ++j) {
+      auto file = Dict::g();
+      file->put("index", util::uitos(j + 1));
+      file->put("path",
+                fmt("/home/user/Downloads/\xc3\xa9t\xc3\xa9/file%zu.dat", j));
+      file->put("length", "246913578");
+      file->put("selected", "true");
+      auto uris = List::g();
+      for (size_t k = 0; k < 4; ++k) {
+        auto uri = Dict::g();
+        uri->put("status", "used");
+        uri->put("uri", fmt("http://mirror%zu.example.org/pub/file%zu.dat",
+                            k, j));
+        uris->append(std::move(uri));
+      }
+      file->put("uris", std::move(uris));
+      files->append(std::move(file));
+    }
+    status->put("files", std::move(files));
+    auto item = List::g();
+    item->append(std::move(status));
+    res->append(std::move(item));
+  }
+  return res;
+}
+
+void bencode()
+{
+  auto torrent = createTorrent();
+  auto data = bencode2::encode(torrent.get());
+  run("bencode2/decode", data.size(),
+      [&] { return bencode2::decode(data) ? 1 : 0; });
+  run("bencode2/encode", data.size(),
+      [&] { return bencode2::encode(torrent.get()).size(); });
+}
+
+void jsonCodec()
+{
+  auto res = createRpcResponse();
+  auto data = json::encode(res.get());
+  run("json/parse", data.size(), [&] {
+    json::ValueBaseJsonParser parser;
+    ssize_t error;
+    auto r = parser.parseFinal(data.c_str(), data.size(), error);
+    if (!r) {
+      fprintf(stderr, "json/parse: failed to parse\n");
+      exit(EXIT_FAILURE);
+    }
+    return error;
+  });
+  size_t consumed = 0;
+  auto r = json::parseFast(data.c_str(), data.size(), consumed);
+  if (!r || json::encode(r.get()) != data) {
+    fprintf(stderr, "json/parseFast: failed to parse\n");
+    exit(EXIT_FAILURE);
+  }
+  run("json/parseFast", data.size(), [&] {
+    return json::parseFast(data.c_str(), data.size(), consumed) ? 1 : 0;
+  });
+  run("json/encode", data.size(),
+      [&] { return json::encode(res.get()).size(); });
+}
+
+// A system.multicall request of aria2.addUri with 50k URIs.
+std::string createAddUriRequest()
+{
+  auto calls = List::g();
+  for (size_t i = 0; i < 50000; ++i) {
+    auto params = List::g();
+    auto uris = List::g();
+    uris->append(fmt("https://mirror.example.org/pub/dir%zu/file%zu.iso",
+                     i / 100, i));
+    params->append(std::move(uris));
+    auto options = Dict::g();
+    options->put("out", fmt("file%zu.iso", i));
+    params->append(std::move(options));
+    auto call = Dict::g();
+    call->put("methodName", "aria2.addUri");
+    call->put("params", std::move(params));
+    calls->append(std::move(call));
+  }
+  auto params = List::g();
+  params->append(std::move(calls));
+  auto req = Dict::g();
+  req->put("id", "1");
+  req->put("jsonrpc", "2.0");
+  req->put("method", "system.multicall");
+  req->put("params", std::move(params));
+  return json::encode(req.get());
+}
+
+void jsonRequest()
+{
+  auto data = createAddUriRequest();
+  run("json/addUri50k/parser", data.size(), [&] {
+    json::ValueBaseJsonParser parser;
+    ssize_t error;
+    parser.parseFinal(data.c_str(), data.size(), error);
+    return error;
+  });
+  size_t consumed = 0;
+  if (!json::parseFast(data.c_str(), data.size(), consumed)) {
+    fprintf(stderr, "json/addUri50k/fast: failed to parse\n");
+    exit(EXIT_FAILURE);
+  }
+  run("json/addUri50k/fast", data.size(), [&] {
+    return json::parseFast(data.c_str(), data.size(), consumed) ? 1 : 0;
+  });
+}
+
+void percentDecode()
+{
+  // A URI with a long path of mostly percent-encoded UTF-8
+  std::string uri = "http://example.org/";
+  while (uri.size() < 1_m) {
+    uri += "%E3%83%80%E3%82%A6%E3%83%B3%E3%83%AD%E3%83%BC%E3%83%89/file.txt";
+  }
+  run("util/percentDecode", uri.size(), [&] {
+    return util::percentDecode(uri.begin(), uri.end()).size();
+  });
+}
+
+} // namespace
+
+void codec()
+{
+  if (selected("bencode2/")) {
+    bencode();
+  }
+  if (selected("json/")) {
+    jsonCodec();
+  }
+  if (selected("json/addUri50k/")) {
+    jsonRequest();
+  }
+  if (selected("util/")) {
+    percentDecode();
+  }
+}
+
+} // namespace bench
+
+} // namespace aria2
@@ -0,0 +1,59 @@
+#include "CommandProfiler.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Command.h"
+
+namespace aria2 {
+
+class CommandProfilerTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(CommandProfilerTest);
+  CPPUNIT_TEST(testRecord);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testRecord();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CommandProfilerTest);
+
+namespace {
+class FooCommand : public Command {
+public:
+  FooCommand() : Command(1) {}
+  virtual bool execute() CXX11_OVERRIDE { return true; }
+};
+
+class BarCommand : public Command {
+public:
+  BarCommand() : Command(2) {}
+  virtual bool execute() CXX11_OVERRIDE { return true; }
+};
+} // namespace
+
+void CommandProfilerTest::testRecord()
+{
+  using namespace std::chrono;
+  CommandProfiler profiler;
+  FooCommand foo1, foo2;
+  BarCommand bar;
+  profiler.record(&foo1, milliseconds(1), false);
+  profiler.record(&foo2, milliseconds(2), true);
+  profiler.record(&bar, milliseconds(5), true);
+  profiler.recordPoll(milliseconds(10));
+
+  auto stats = profiler.getCommandStats();
+  CPPUNIT_ASSERT_EQUAL((size_t)2, stats.size());
+  // Ordered by the total time
+  CPPUNIT_ASSERT(stats[0].first.find("BarCommand") != std::string::npos);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)1, stats[0].second.count);
+  CPPUNIT_ASSERT(stats[1].first.find("FooCommand") != std::string::npos);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)2, stats[1].second.count);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)1, stats[1].second.idle);
+  CPPUNIT_ASSERT(milliseconds(3) == stats[1].second.total);
+  CPPUNIT_ASSERT(milliseconds(2) == stats[1].second.max);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)1, profiler.getPollStat().count);
+}
+
+} // namespace aria2
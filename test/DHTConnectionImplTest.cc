@@ -1,6 +1,7 @@
 #include "DHTConnectionImpl.h"
 
 #include <iostream>
+#include <cstring>
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "Exception.h"
@@ -13,6 +14,7 @@ class DHTConnectionImplTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(DHTConnectionImplTest);
   CPPUNIT_TEST(testWriteAndReadData);
+  CPPUNIT_TEST(testQueueAndReceiveMessages);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -21,6 +23,7 @@ public:
   void tearDown() {}
 
   void testWriteAndReadData();
+  void testQueueAndReceiveMessages();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DHTConnectionImplTest);
@@ -59,4 +62,54 @@ void DHTConnectionImplTest::testWriteAndReadData()
   }
 }
 
+void DHTConnectionImplTest::testQueueAndReceiveMessages()
+{
+  try {
+    DHTConnectionImpl con1(AF_INET);
+    uint16_t con1port = 0;
+    CPPUNIT_ASSERT(con1.bind(con1port, A2STR::NIL));
+
+    DHTConnectionImpl con2(AF_INET);
+    uint16_t con2port = 0;
+    CPPUNIT_ASSERT(con2.bind(con2port, A2STR::NIL));
+
+    const char* messages[] = {"alpha", "bravo", "charlie"};
+    for (auto m : messages) {
+      CPPUNIT_ASSERT(con1.queueMessage(
+          reinterpret_cast<const unsigned char*>(m), strlen(m), "localhost",
+          con2port));
+    }
+    CPPUNIT_ASSERT_EQUAL((size_t)3, con1.getQueuedMessageCount());
+    con1.flush();
+    CPPUNIT_ASSERT_EQUAL((size_t)0, con1.getQueuedMessageCount());
+
+    const size_t buflen = 100;
+    unsigned char readbuffer[buflen * 4];
+    size_t lengths[4];
+    Endpoint senders[4];
+    size_t total = 0;
+    while (total < 3) {
+      while (!con2.getSocket()->isReadable(0))
+        ;
+      total += con2.receiveMessages(readbuffer + total * buflen, buflen,
+                                    4 - total, lengths + total,
+                                    senders + total);
+    }
+    CPPUNIT_ASSERT_EQUAL((size_t)3, total);
+    for (size_t i = 0; i < 3; ++i) {
+      CPPUNIT_ASSERT_EQUAL(
+          std::string(messages[i]),
+          std::string(&readbuffer[i * buflen],
+                      &readbuffer[i * buflen + lengths[i]]));
+      CPPUNIT_ASSERT_EQUAL(con1port, senders[i].port);
+    }
+    CPPUNIT_ASSERT_EQUAL((size_t)0,
+                         con2.receiveMessages(readbuffer, buflen, 4, lengths,
+                                              senders));
+  }
+  catch (Exception& e) {
+    CPPUNIT_FAIL(e.stackTrace());
+  }
+}
+
 } // namespace aria2
@@ -0,0 +1,91 @@
+#include "DiskWriteQueue.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "DefaultDiskWriter.h"
+#include "SocketCore.h"
+#include "File.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+class DiskWriteQueueTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(DiskWriteQueueTest);
+  CPPUNIT_TEST(testWriteData);
+  CPPUNIT_TEST(testFull);
+  CPPUNIT_TEST(testError);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testWriteData();
+  void testFull();
+  void testError();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DiskWriteQueueTest);
+
+void DiskWriteQueueTest::testWriteData()
+{
+  auto queue = std::make_shared<DiskWriteQueue>(2, 1_m);
+  CPPUNIT_ASSERT(queue->good());
+  std::string filename = A2_TEST_OUT_DIR "/aria2_DiskWriteQueueTest_testWrite";
+  File(filename).remove();
+  DefaultDiskWriter dw(filename);
+  dw.enableAsyncWrite(queue);
+  dw.initAndOpenFile();
+  std::string data = "hello world";
+  dw.writeData(reinterpret_cast<const unsigned char*>(data.c_str()), 5, 0);
+  dw.writeData(reinterpret_cast<const unsigned char*>(data.c_str()) + 5, 6,
+               5);
+  // Overwrites the first write
+  dw.writeData(reinterpret_cast<const unsigned char*>("HELLO"), 5, 0);
+  unsigned char buf[11];
+  CPPUNIT_ASSERT_EQUAL((ssize_t)11, dw.readData(buf, sizeof(buf), 0));
+  CPPUNIT_ASSERT_EQUAL(std::string("HELLO world"),
+                       std::string(&buf[0], &buf[11]));
+  dw.closeFile();
+  CPPUNIT_ASSERT_EQUAL((int64_t)11, File(filename).size());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, queue->getQueuedBytes());
+}
+
+void DiskWriteQueueTest::testFull()
+{
+  DiskWriteQueue queue(1, 10);
+  auto file = std::make_shared<DiskWriteFile>();
+  std::string filename = A2_TEST_OUT_DIR "/aria2_DiskWriteQueueTest_testFull";
+  int fd = open(filename.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+  CPPUNIT_ASSERT(fd != -1);
+  CPPUNIT_ASSERT(!queue.full());
+  auto data = std::string(10, 'a');
+  queue.push(file, fd, reinterpret_cast<const unsigned char*>(data.c_str()),
+             data.size(), 0);
+  // The write may have been completed already.  If not, the wakeup
+  // socket must become readable when it is completed.
+  if (queue.full()) {
+    queue.wait(file);
+    CPPUNIT_ASSERT(queue.getWakeupSocket()->isReadable(1));
+  }
+  CPPUNIT_ASSERT(!queue.full());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, queue.getQueuedBytes());
+  close(fd);
+  CPPUNIT_ASSERT_EQUAL((int64_t)10, File(filename).size());
+}
+
+void DiskWriteQueueTest::testError()
+{
+  DiskWriteQueue queue(1, 1_m);
+  auto file = std::make_shared<DiskWriteFile>();
+  queue.push(file, -1, reinterpret_cast<const unsigned char*>("a"), 1, 0);
+  queue.wait(file, 0, 1);
+  CPPUNIT_ASSERT_EQUAL(EBADF, queue.takeError(file));
+  CPPUNIT_ASSERT_EQUAL(0, queue.takeError(file));
+}
+
+} // namespace aria2
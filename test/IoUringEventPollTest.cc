@@ -0,0 +1,108 @@
+#include "IoUringEventPoll.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Command.h"
+
+namespace aria2 {
+
+class IoUringEventPollTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(IoUringEventPollTest);
+  CPPUNIT_TEST(testAddEvents_sameEvents);
+  CPPUNIT_TEST(testAddEvents_reusedSocket);
+  CPPUNIT_TEST_SUITE_END();
+
+  int fds_[2];
+
+public:
+  void setUp()
+  {
+    CPPUNIT_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds_));
+  }
+
+  void tearDown()
+  {
+    close(fds_[0]);
+    close(fds_[1]);
+  }
+
+  void testAddEvents_sameEvents();
+  void testAddEvents_reusedSocket();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IoUringEventPollTest);
+
+namespace {
+class MockCommand : public Command {
+public:
+  MockCommand() : Command(1) {}
+
+  virtual bool execute() CXX11_OVERRIDE { return true; }
+
+  bool isReadEvent() const { return readEventEnabled(); }
+};
+
+std::chrono::milliseconds pollFor(IoUringEventPoll& poll, int msec)
+{
+  struct timeval tv = {msec / 1000, (msec % 1000) * 1000};
+  auto start = std::chrono::steady_clock::now();
+  poll.poll(tv);
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start);
+}
+} // namespace
+
+void IoUringEventPollTest::testAddEvents_sameEvents()
+{
+  IoUringEventPoll poll;
+  if (!poll.good()) {
+    // io_uring is not available in this environment.
+    return;
+  }
+  MockCommand command;
+  poll.addEvents(fds_[0], &command, EventPoll::EVENT_READ);
+  struct timeval tv = {0, 0};
+  poll.poll(tv);
+
+  // Adding the same events again must not re-arm the poll request:
+  // the completion of the cancelled request would wake up poll().
+  poll.addEvents(fds_[0], &command, EventPoll::EVENT_READ);
+  CPPUNIT_ASSERT(pollFor(poll, 200) >= std::chrono::milliseconds(150));
+  CPPUNIT_ASSERT(!command.isReadEvent());
+
+  CPPUNIT_ASSERT_EQUAL((ssize_t)1, write(fds_[1], "a", 1));
+  pollFor(poll, 1000);
+  CPPUNIT_ASSERT(command.isReadEvent());
+}
+
+void IoUringEventPollTest::testAddEvents_reusedSocket()
+{
+  IoUringEventPoll poll;
+  if (!poll.good()) {
+    return;
+  }
+  MockCommand command;
+  poll.addEvents(fds_[0], &command, EventPoll::EVENT_READ);
+  struct timeval tv = {0, 0};
+  poll.poll(tv);
+
+  // Make fds_[0] refer to another socket without deleting its events.
+  int other[2];
+  CPPUNIT_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, other));
+  CPPUNIT_ASSERT_EQUAL(fds_[0], dup2(other[0], fds_[0]));
+  close(other[0]);
+
+  poll.addEvents(fds_[0], &command, EventPoll::EVENT_READ);
+  CPPUNIT_ASSERT_EQUAL((ssize_t)1, write(other[1], "a", 1));
+  pollFor(poll, 1000);
+  CPPUNIT_ASSERT(command.isReadEvent());
+  close(other[1]);
+}
+
+} // namespace aria2
@@ -9,6 +9,9 @@
 #include "DiskAdaptor.h"
 #include "FileEntry.h"
 #include "PieceSelector.h"
+#ifdef HAVE_STD_THREAD
+#  include "PieceHashQueue.h"
+#endif // HAVE_STD_THREAD
 
 namespace aria2 {
 
@@ -17,6 +20,9 @@ class IteratableChunkChecksumValidatorTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(IteratableChunkChecksumValidatorTest);
   CPPUNIT_TEST(testValidate);
   CPPUNIT_TEST(testValidate_readError);
+#ifdef HAVE_STD_THREAD
+  CPPUNIT_TEST(testValidate_pieceHashQueue);
+#endif // HAVE_STD_THREAD
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -27,6 +33,9 @@ public:
 
   void testValidate();
   void testValidate_readError();
+#ifdef HAVE_STD_THREAD
+  void testValidate_pieceHashQueue();
+#endif // HAVE_STD_THREAD
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(IteratableChunkChecksumValidatorTest);
@@ -106,4 +115,44 @@ void IteratableChunkChecksumValidatorTest::testValidate_readError()
   CPPUNIT_ASSERT(!ps->hasPiece(4));
 }
 
+#ifdef HAVE_STD_THREAD
+void IteratableChunkChecksumValidatorTest::testValidate_pieceHashQueue()
+{
+  Option option;
+  std::shared_ptr<DownloadContext> dctx(new DownloadContext(
+      100, 500, A2_TEST_DIR "/chunkChecksumTestFile250.txt"));
+  std::deque<std::string> hashes(&csArray[0], &csArray[3]);
+  hashes[1] = fromHex("ffffffffffffffffffffffffffffffffffffffff");
+  hashes.push_back(fromHex("ffffffffffffffffffffffffffffffffffffffff"));
+  hashes.push_back(fromHex("ffffffffffffffffffffffffffffffffffffffff"));
+  dctx->setPieceHashes("sha-1", hashes.begin(), hashes.end());
+  std::shared_ptr<DefaultPieceStorage> ps(
+      new DefaultPieceStorage(dctx, &option));
+  ps->initStorage();
+  ps->getDiskAdaptor()->enableReadOnly();
+  ps->getDiskAdaptor()->openFile();
+
+  auto queue = std::make_shared<PieceHashQueue>(2);
+  CPPUNIT_ASSERT(queue->good());
+
+  IteratableChunkChecksumValidator validator(dctx, ps);
+  validator.init();
+  validator.setPieceHashQueue(queue);
+
+  int64_t offset = 0;
+  while (!validator.finished()) {
+    validator.validateChunk();
+    CPPUNIT_ASSERT(offset <= validator.getCurrentOffset());
+    offset = validator.getCurrentOffset();
+  }
+
+  CPPUNIT_ASSERT(ps->hasPiece(0));
+  CPPUNIT_ASSERT(!ps->hasPiece(1));
+  // The rest of pieces are too short.
+  CPPUNIT_ASSERT(!ps->hasPiece(2));
+  CPPUNIT_ASSERT(!ps->hasPiece(3));
+  CPPUNIT_ASSERT(!ps->hasPiece(4));
+}
+#endif // HAVE_STD_THREAD
+
 } // namespace aria2
@@ -0,0 +1,136 @@
+#include "JsonFastParser.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ValueBaseJsonParser.h"
+#include "json.h"
+
+namespace aria2 {
+
+class JsonFastParserTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(JsonFastParserTest);
+  CPPUNIT_TEST(testParseFast);
+  CPPUNIT_TEST(testParseFast_fallback);
+  CPPUNIT_TEST(testParse);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testParseFast();
+  void testParseFast_fallback();
+  void testParse();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(JsonFastParserTest);
+
+namespace {
+// Returns the result of ValueBaseJsonParser encoded in JSON.
+std::string parseSlow(const std::string& src, ssize_t& error)
+{
+  auto r = json::ValueBaseJsonParser().parseFinal(src.c_str(), src.size(),
+                                                  error);
+  return r ? json::encode(r.get()) : "";
+}
+} // namespace
+
+void JsonFastParserTest::testParseFast()
+{
+  // Long strings cross the 16 byte blocks of the vectorized search.
+  std::string longString(100, 'a');
+  std::string longEscaped = longString + "\\\"" + longString + "\\\\" +
+                            std::string(14, 'b') + "\\n\\/";
+  for (auto& src : std::vector<std::string>{
+           "{}",
+           "[]",
+           "\"abc\"",
+           " \r\n\t{ } ",
+           "[\"\"]",
+           "{\"jsonrpc\":\"2.0\",\"method\":\"aria2.addUri\",\"id\":\"qwer\","
+           "\"params\":[[\"http://localhost/\"],{\"split\":\"4\"}]}",
+           "[ 1 , -2 , 0 , 007 , 9223372036854775807 , -9223372036854775807 ]",
+           "[true,false,null,[],{},[[[]]]]",
+           "{\"a\":1,\"a\":2,\"b\" : {\"c\" : [ \"d\" ] } }",
+           // JsonParser drops the members with an empty key.
+           "{\"\":1,\"b\":2}",
+           "[\"\\b\\f\\n\\r\\t\\\"\\\\\\/\\a\"]",
+           "[\"" + longString + "\",\"" + longEscaped + "\"]",
+           "{\"" + longEscaped + "\":\"\\u\"}x",
+           // Raw control characters and UTF-8 are taken as they are.
+           "[\"\t\xe3\x81\x82\"]",
+           // The text after the value is ignored.
+           "{} {",
+       }) {
+    size_t consumed;
+    auto r = json::parseFast(src.c_str(), src.size(), consumed);
+    if (src.find("\\u") != std::string::npos) {
+      CPPUNIT_ASSERT_MESSAGE(src, !r);
+      continue;
+    }
+    CPPUNIT_ASSERT_MESSAGE(src, r);
+    ssize_t error;
+    CPPUNIT_ASSERT_EQUAL(parseSlow(src, error), json::encode(r.get()));
+    CPPUNIT_ASSERT_EQUAL(error, static_cast<ssize_t>(consumed));
+  }
+}
+
+void JsonFastParserTest::testParseFast_fallback()
+{
+  for (auto& src : std::vector<std::string>{
+           // Not handled
+           "[\"\\u3042\"]",
+           "[1.5]",
+           "[1e3]",
+           "true",
+           "123",
+           std::string(40, '[') + std::string(40, ']'),
+           // A trailing comma is allowed in an object by JsonParser.
+           "{\"a\":1,}",
+           // Malformed
+           "",
+           "   ",
+           "{",
+           "[1,]",
+           "[1 2]",
+           "{\"a\" 1}",
+           "{\"a\":}",
+           "{a:1}",
+           "[\"abc",
+           "[\"abc\\",
+           "[-]",
+           "[9223372036854775808]",
+           "[tru]",
+           "[nul",
+           "x",
+       }) {
+    size_t consumed;
+    CPPUNIT_ASSERT_MESSAGE(src, !json::parseFast(src.c_str(), src.size(),
+                                                 consumed));
+  }
+}
+
+void JsonFastParserTest::testParse()
+{
+  // Whether or not parseFast() handles the text, the results are the
+  // same as the ones of ValueBaseJsonParser.
+  for (auto& src : std::vector<std::string>{
+           "{\"a\":[\"b\",1,true,null]}",
+           "[\"\\u3042\\ud800\\udc00\"]",
+           "[1.5]",
+           "true",
+           "{\"a\":1,}",
+           std::string(60, '[') + std::string(60, ']'),
+           "",
+           "[1 2]",
+           "[\"abc",
+           "[9223372036854775808]",
+       }) {
+    ssize_t slowError;
+    auto expected = parseSlow(src, slowError);
+    ssize_t error;
+    auto r = json::parse(src.c_str(), src.size(), error);
+    CPPUNIT_ASSERT_EQUAL(slowError, error);
+    CPPUNIT_ASSERT_EQUAL(expected, r ? json::encode(r.get()) : "");
+  }
+}
+
+} // namespace aria2
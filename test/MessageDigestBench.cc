@@ -0,0 +1,53 @@
+// Benchmarks of MessageDigest, which uses crypto_hash when aria2 is
+// built with the internal message digest implementation.
+#include "Bench.h"
+
+#include <random>
+#include <vector>
+
+#include "MessageDigest.h"
+
+namespace aria2 {
+
+namespace bench {
+
+void messageDigest()
+{
+  if (!selected("MessageDigest/")) {
+    return;
+  }
+  // 16 pieces of 1MiB
+  const size_t pieceLength = 1_m;
+  const size_t numPieces = 16;
+  std::mt19937 rng(0);
+  std::vector<unsigned char> buf(pieceLength * numPieces);
+  for (auto& c : buf) {
+    c = rng();
+  }
+  std::vector<const unsigned char*> pieces;
+  std::vector<size_t> lengths(numPieces, pieceLength);
+  for (size_t i = 0; i < numPieces; ++i) {
+    pieces.push_back(buf.data() + i * pieceLength);
+  }
+  for (auto& hashType : {"md5", "sha-1", "sha-256"}) {
+    if (!MessageDigest::supports(hashType)) {
+      continue;
+    }
+    auto ctx = MessageDigest::create(hashType);
+    run(std::string("MessageDigest/") + hashType, pieceLength, [&] {
+      ctx->reset();
+      ctx->update(pieces[0], pieceLength);
+      return ctx->digest().size();
+    });
+    run(std::string("MessageDigest/digestMany/") + hashType,
+        pieceLength * numPieces, [&] {
+          return MessageDigest::digestMany(hashType, pieces.data(),
+                                           lengths.data(), numPieces)
+              .size();
+        });
+  }
+}
+
+} // namespace bench
+
+} // namespace aria2
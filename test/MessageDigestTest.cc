@@ -10,6 +10,7 @@ class MessageDigestTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(MessageDigestTest);
   CPPUNIT_TEST(testDigest);
+  CPPUNIT_TEST(testDigestMany);
   CPPUNIT_TEST(testSupports);
   CPPUNIT_TEST(testGetDigestLength);
   CPPUNIT_TEST(testIsStronger);
@@ -32,6 +33,7 @@ public:
   }
 
   void testDigest();
+  void testDigestMany();
   void testSupports();
   void testGetDigestLength();
   void testIsStronger();
@@ -72,6 +74,38 @@ void MessageDigestTest::testDigest()
 #endif // HAVE_ZLIB
 }
 
+void MessageDigestTest::testDigestMany()
+{
+  // Different lengths exercise the SIMD lanes and the leftover blocks.
+  std::vector<std::string> messages;
+  for (size_t i = 0; i < 11; ++i) {
+    std::string m;
+    for (size_t j = 0; j < 4096 + (i % 3) * 100 + i; ++j) {
+      m += static_cast<char>(j * 31 + i);
+    }
+    messages.push_back(m);
+  }
+  messages.push_back("");
+  std::vector<const unsigned char*> data;
+  std::vector<size_t> lengths;
+  for (auto& m : messages) {
+    data.push_back(reinterpret_cast<const unsigned char*>(m.data()));
+    lengths.push_back(m.size());
+  }
+  for (auto& hashType : {"sha-1", "sha-256", "md5"}) {
+    auto digests = MessageDigest::digestMany(hashType, data.data(),
+                                             lengths.data(), data.size());
+    CPPUNIT_ASSERT_EQUAL(messages.size(), digests.size());
+    auto ctx = MessageDigest::create(hashType);
+    for (size_t i = 0; i < messages.size(); ++i) {
+      ctx->reset();
+      ctx->update(messages[i].data(), messages[i].size());
+      CPPUNIT_ASSERT_EQUAL(util::toHex(ctx->digest()),
+                           util::toHex(digests[i]));
+    }
+  }
+}
+
 void MessageDigestTest::testSupports()
 {
   CPPUNIT_ASSERT(MessageDigest::supports("md5"));
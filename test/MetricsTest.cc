@@ -0,0 +1,92 @@
+#include "metrics.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "TestUtil.h"
+#include "prefs.h"
+#include "Option.h"
+#include "RequestGroup.h"
+#include "RequestGroupMan.h"
+#include "DownloadEngine.h"
+#include "SelectEventPoll.h"
+#include "GroupId.h"
+
+namespace aria2 {
+
+class MetricsTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(MetricsTest);
+  CPPUNIT_TEST(testHistogram);
+  CPPUNIT_TEST(testRender);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testHistogram();
+  void testRender();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MetricsTest);
+
+void MetricsTest::testHistogram()
+{
+  metrics::Histogram h({1000, 500000});
+  h.observe(std::chrono::microseconds(1000));
+  h.observe(std::chrono::milliseconds(2));
+  h.observe(std::chrono::seconds(3));
+  CPPUNIT_ASSERT_EQUAL((uint64_t)3, h.getCount());
+  std::string out;
+  h.write(out, "foo_seconds", "Foo.");
+  CPPUNIT_ASSERT_EQUAL(std::string("# HELP foo_seconds Foo.\n"
+                                   "# TYPE foo_seconds histogram\n"
+                                   "foo_seconds_bucket{le=\"0.001\"} 1\n"
+                                   "foo_seconds_bucket{le=\"0.5\"} 2\n"
+                                   "foo_seconds_bucket{le=\"+Inf\"} 3\n"
+                                   "foo_seconds_sum 3.003\n"
+                                   "foo_seconds_count 3\n"),
+                       out);
+}
+
+namespace {
+bool contains(const std::string& s, const std::string& t)
+{
+  return s.find(t) != std::string::npos;
+}
+} // namespace
+
+void MetricsTest::testRender()
+{
+  auto option = std::make_shared<Option>();
+  option->put(PREF_MAX_DOWNLOAD_RESULT, "10");
+  DownloadEngine e(make_unique<SelectEventPoll>());
+  e.setOption(option.get());
+  e.setRequestGroupMan(make_unique<RequestGroupMan>(
+      std::vector<std::shared_ptr<RequestGroup>>{}, 1, option.get()));
+  auto& rgman = e.getRequestGroupMan();
+  std::shared_ptr<RequestGroup> groups[] = {
+      createRequestGroup(0, 0, "foo1", "http://host/foo1", option),
+      createRequestGroup(0, 0, "foo2", "http://host/foo2", option),
+      createRequestGroup(0, 0, "foo3", "http://host/foo3", option)};
+  rgman->addRequestGroup(groups[0]);
+  rgman->addRequestGroup(groups[1]);
+  rgman->addReservedGroup(groups[2]);
+
+  auto out = metrics::render(&e, 1);
+  CPPUNIT_ASSERT(contains(out, "aria2_downloads{state=\"active\"} 2\n"));
+  CPPUNIT_ASSERT(contains(out, "aria2_downloads{state=\"waiting\"} 1\n"));
+  CPPUNIT_ASSERT(contains(out, "aria2_downloads{state=\"stopped\"} 0\n"));
+  CPPUNIT_ASSERT(contains(out, "# TYPE aria2_received_bytes_total counter\n"));
+  CPPUNIT_ASSERT(contains(out, "aria2_event_loop_iteration_seconds_count "));
+  CPPUNIT_ASSERT(contains(out, "aria2_download_connections{gid=\"" +
+                                   GroupId::toHex(groups[0]->getGID()) +
+                                   "\"} 0\n"));
+  CPPUNIT_ASSERT(!contains(out, GroupId::toHex(groups[1]->getGID())));
+  CPPUNIT_ASSERT(contains(out, "aria2_download_series_omitted 1\n"));
+  // The disk caches are disabled.
+  CPPUNIT_ASSERT(!contains(out, "aria2_disk_cache_bytes"));
+
+  out = metrics::render(&e, 0);
+  CPPUNIT_ASSERT(!contains(out, "gid="));
+  CPPUNIT_ASSERT(contains(out, "aria2_download_series_omitted 2\n"));
+}
+
+} // namespace aria2
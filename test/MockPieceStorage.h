@@ -228,6 +228,8 @@ public:
 
   virtual WrDiskCache* getWrDiskCache() CXX11_OVERRIDE { return 0; }
 
+  virtual RdDiskCache* getRdDiskCache() CXX11_OVERRIDE { return 0; }
+
   virtual void flushWrDiskCacheEntry() CXX11_OVERRIDE {}
 
   void setDiskAdaptor(const std::shared_ptr<DiskAdaptor>& adaptor)
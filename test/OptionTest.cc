@@ -5,6 +5,7 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "prefs.h"
+#include "util.h"
 
 namespace aria2 {
 
@@ -19,6 +20,7 @@ class OptionTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testMerge);
   CPPUNIT_TEST(testParent);
   CPPUNIT_TEST(testRemove);
+  CPPUNIT_TEST(testCopyOnWrite);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -33,6 +35,7 @@ public:
   void testMerge();
   void testParent();
   void testRemove();
+  void testCopyOnWrite();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(OptionTest);
@@ -148,4 +151,41 @@ void OptionTest::testRemove()
   CPPUNIT_ASSERT(parent->defined(PREF_TIMEOUT));
 }
 
+void OptionTest::testCopyOnWrite()
+{
+  Option op;
+  op.put(PREF_TIMEOUT, "100");
+  op.put(PREF_DIR, "/tmp");
+  Option copy(op);
+  copy.put(PREF_TIMEOUT, "200");
+  copy.removeLocal(PREF_DIR);
+  CPPUNIT_ASSERT_EQUAL(std::string("100"), op.get(PREF_TIMEOUT));
+  CPPUNIT_ASSERT_EQUAL(std::string("/tmp"), op.get(PREF_DIR));
+  CPPUNIT_ASSERT_EQUAL(std::string("200"), copy.get(PREF_TIMEOUT));
+  CPPUNIT_ASSERT(!copy.definedLocal(PREF_DIR));
+  CPPUNIT_ASSERT(copy.blank(PREF_DIR));
+
+  // Enough values to be folded into a new table
+  for (size_t i = 1, len = option::countOption(); i < len; ++i) {
+    copy.put(option::i2p(i), util::uitos(i));
+  }
+  for (size_t i = 1, len = option::countOption(); i < len; ++i) {
+    CPPUNIT_ASSERT_EQUAL(util::uitos(i), copy.get(option::i2p(i)));
+  }
+  CPPUNIT_ASSERT_EQUAL(std::string("100"), op.get(PREF_TIMEOUT));
+  CPPUNIT_ASSERT(!op.defined(PREF_SPLIT));
+
+  op.put(PREF_TIMEOUT, "300");
+  CPPUNIT_ASSERT_EQUAL(util::uitos(PREF_TIMEOUT->i), copy.get(PREF_TIMEOUT));
+
+  Option merged(op);
+  merged.merge(copy);
+  CPPUNIT_ASSERT_EQUAL(util::uitos(PREF_DIR->i), merged.get(PREF_DIR));
+  CPPUNIT_ASSERT_EQUAL(std::string("/tmp"), op.get(PREF_DIR));
+
+  copy.clear();
+  CPPUNIT_ASSERT(copy.emptyLocal());
+  CPPUNIT_ASSERT(!op.emptyLocal());
+}
+
 } // namespace aria2
@@ -29,6 +29,7 @@ class PeerSessionResourceTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testOptUnchoking);
   CPPUNIT_TEST(testShouldBeChoking);
   CPPUNIT_TEST(testCountOutstandingRequest);
+  CPPUNIT_TEST(testUpdateBlockRtt);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -54,6 +55,7 @@ public:
   void testOptUnchoking();
   void testShouldBeChoking();
   void testCountOutstandingRequest();
+  void testUpdateBlockRtt();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(PeerSessionResourceTest);
@@ -258,4 +260,23 @@ void PeerSessionResourceTest::testCountOutstandingRequest()
   CPPUNIT_ASSERT_EQUAL((size_t)0, res.countOutstandingUpload());
 }
 
+void PeerSessionResourceTest::testUpdateBlockRtt()
+{
+  PeerSessionResource res(1_k, 1_m);
+  CPPUNIT_ASSERT_EQUAL(DEFAULT_MAX_OUTSTANDING_REQUEST,
+                       res.getMaxOutstandingRequest());
+  CPPUNIT_ASSERT_EQUAL((int64_t)0, (int64_t)res.getBlockRtt().count());
+  CPPUNIT_ASSERT_EQUAL((int64_t)0, (int64_t)res.getMinBlockRtt().count());
+
+  res.updateBlockRtt(std::chrono::milliseconds(200));
+  CPPUNIT_ASSERT_EQUAL((int64_t)200, (int64_t)res.getBlockRtt().count());
+  CPPUNIT_ASSERT_EQUAL((int64_t)200, (int64_t)res.getMinBlockRtt().count());
+  // Queueing delay raises the smoothed one only.
+  res.updateBlockRtt(std::chrono::milliseconds(1000));
+  CPPUNIT_ASSERT_EQUAL((int64_t)300, (int64_t)res.getBlockRtt().count());
+  CPPUNIT_ASSERT_EQUAL((int64_t)200, (int64_t)res.getMinBlockRtt().count());
+  res.updateBlockRtt(std::chrono::milliseconds(100));
+  CPPUNIT_ASSERT_EQUAL((int64_t)100, (int64_t)res.getMinBlockRtt().count());
+}
+
 } // namespace aria2
@@ -0,0 +1,131 @@
+#include "PieceHashQueue.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "MessageDigest.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+class PieceHashQueueTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(PieceHashQueueTest);
+  CPPUNIT_TEST(testOrderedCompletion);
+  CPPUNIT_TEST(testDigest);
+  CPPUNIT_TEST(testCancel);
+  CPPUNIT_TEST(testShutdown);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testOrderedCompletion();
+  void testDigest();
+  void testCancel();
+  void testShutdown();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PieceHashQueueTest);
+
+namespace {
+std::shared_ptr<PieceHashJob> createJob(const std::string& hashType,
+                                        size_t length, size_t seed)
+{
+  auto data = make_unique<unsigned char[]>(length);
+  for (size_t i = 0; i < length; ++i) {
+    data[i] = static_cast<unsigned char>(i * 31 + seed);
+  }
+  return std::make_shared<PieceHashJob>(hashType, std::move(data), length);
+}
+
+std::string digest(const PieceHashJob& job)
+{
+  auto md = MessageDigest::create(job.hashType);
+  md->update(job.data.get(), job.length);
+  return md->digest();
+}
+} // namespace
+
+void PieceHashQueueTest::testOrderedCompletion()
+{
+  // A single worker completes the jobs in the order they were pushed.
+  PieceHashQueue queue(1);
+  CPPUNIT_ASSERT(queue.good());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, queue.getNumThreads());
+  std::vector<std::shared_ptr<PieceHashJob>> jobs;
+  for (size_t i = 0; i < 20; ++i) {
+    jobs.push_back(createJob("sha-1", 16_k, i));
+    queue.push(jobs.back());
+  }
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    queue.wait(jobs[i]);
+    for (size_t j = 0; j < i; ++j) {
+      CPPUNIT_ASSERT(queue.done(jobs[j]));
+    }
+    CPPUNIT_ASSERT_EQUAL(digest(*jobs[i]), jobs[i]->digest);
+  }
+}
+
+void PieceHashQueueTest::testDigest()
+{
+  PieceHashQueue queue(3);
+  CPPUNIT_ASSERT_EQUAL((size_t)3, queue.getNumThreads());
+  std::vector<std::shared_ptr<PieceHashJob>> jobs;
+  // Mixed hash types and lengths, more jobs than MAX_BATCH per worker.
+  for (size_t i = 0; i < 40; ++i) {
+    jobs.push_back(
+        createJob(i % 3 == 0 ? "sha-256" : "sha-1", 1000 + i * 97, i));
+    queue.push(jobs.back());
+  }
+  jobs.push_back(createJob("md5", 0, 0));
+  queue.push(jobs.back());
+  for (auto& job : jobs) {
+    queue.wait(job);
+    CPPUNIT_ASSERT(queue.done(job));
+    CPPUNIT_ASSERT_EQUAL(digest(*job), job->digest);
+  }
+}
+
+void PieceHashQueueTest::testCancel()
+{
+  PieceHashQueue queue(1);
+  std::vector<std::shared_ptr<PieceHashJob>> jobs;
+  for (size_t i = 0; i < 30; ++i) {
+    jobs.push_back(createJob("sha-1", 256_k, i));
+  }
+  for (auto& job : jobs) {
+    queue.push(job);
+  }
+  // The last job is still queued behind the others.
+  queue.cancel(jobs.back());
+  queue.wait(jobs[jobs.size() - 2]);
+  CPPUNIT_ASSERT(!queue.done(jobs.back()));
+  CPPUNIT_ASSERT(jobs.back()->digest.empty());
+}
+
+void PieceHashQueueTest::testShutdown()
+{
+  std::vector<std::shared_ptr<PieceHashJob>> jobs;
+  for (size_t i = 0; i < 64; ++i) {
+    jobs.push_back(createJob("sha-1", 1_m, i));
+  }
+  {
+    PieceHashQueue queue(1);
+    for (auto& job : jobs) {
+      queue.push(job);
+    }
+    // The destructor discards the queued jobs instead of hashing all
+    // of them.
+  }
+  size_t numDone = 0;
+  for (auto& job : jobs) {
+    if (job->done) {
+      ++numDone;
+      CPPUNIT_ASSERT_EQUAL(digest(*job), job->digest);
+    }
+    else {
+      CPPUNIT_ASSERT(job->digest.empty());
+    }
+  }
+  CPPUNIT_ASSERT(numDone < jobs.size());
+}
+
+} // namespace aria2
@@ -0,0 +1,125 @@
+// Benchmarks of PieceStatMan and RarestPieceSelector with 1M pieces
+// and 50 peers.
+#include "Bench.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "PieceStatMan.h"
+#include "RarestPieceSelector.h"
+#include "bitfield.h"
+
+namespace aria2 {
+
+namespace bench {
+
+namespace {
+// The linear scan of the order which RarestPieceSelector used before
+// it skipped the words without candidates.
+bool selectOld(size_t& index, const PieceStatMan& psm,
+               const unsigned char* bitfield, size_t nbits)
+{
+  for (auto idx : psm.getOrder()) {
+    if (bitfield::test(bitfield, nbits, idx)) {
+      index = idx;
+      return true;
+    }
+  }
+  return false;
+}
+
+void rarestPieceSelector(const std::shared_ptr<PieceStatMan>& psm,
+                         size_t numPieces, std::mt19937& rng)
+{
+  RarestPieceSelector selector(psm);
+  std::vector<unsigned char> candidates(numPieces / 8);
+  auto compare = [&](const std::string& name) {
+    run("RarestPieceSelector/" + name + "/old", candidates.size(), [&] {
+      size_t index = 0;
+      selectOld(index, *psm, candidates.data(), numPieces);
+      return index;
+    });
+    run("RarestPieceSelector/" + name, candidates.size(), [&] {
+      size_t index = 0;
+      selector.select(index, candidates.data(), numPieces);
+      return index;
+    });
+  };
+  // Late in a download: a few missing pieces which this peer has.
+  // Both implementations have to look at every piece.
+  for (size_t i = 0; i < 10; ++i) {
+    size_t index = rng() % numPieces;
+    candidates[index / 8] |= 128 >> (index % 8);
+  }
+  compare("select/10Candidates");
+  // Early in a download: this peer has half of the pieces.
+  for (auto& c : candidates) {
+    c = rng();
+  }
+  compare("select/halfCandidates");
+}
+} // namespace
+
+void pieceStatMan()
+{
+  if (!selected("PieceStatMan/") && !selected("RarestPieceSelector/")) {
+    return;
+  }
+  const size_t numPieces = 1 << 20;
+  const size_t len = numPieces / 8;
+  const size_t numPeers = 50;
+  std::mt19937 rng(0);
+  std::vector<std::vector<unsigned char>> bitfields(numPeers);
+  for (auto& bitfield : bitfields) {
+    bitfield.resize(len);
+    for (auto& c : bitfield) {
+      c = rng();
+    }
+  }
+  auto psmPtr = std::make_shared<PieceStatMan>(numPieces, true);
+  auto& psm = *psmPtr;
+  for (auto& bitfield : bitfields) {
+    psm.addPieceStats(bitfield.data(), len);
+  }
+  if (selected("RarestPieceSelector/")) {
+    rarestPieceSelector(psmPtr, numPieces, rng);
+  }
+  // A peer connects and disconnects.
+  size_t peer = 0;
+  run("PieceStatMan/addSubtractPieceStats", len, [&] {
+    auto& bitfield = bitfields[peer++ % numPeers];
+    psm.subtractPieceStats(bitfield.data(), len);
+    psm.addPieceStats(bitfield.data(), len);
+    return psm.getOrder()[0];
+  });
+  // A peer sends a bitfield which differs from the last one in 1% of
+  // the pieces.
+  auto oldBitfield = bitfields[0];
+  auto newBitfield = oldBitfield;
+  for (size_t i = 0; i < numPieces / 100; ++i) {
+    size_t index = rng() % numPieces;
+    newBitfield[index / 8] ^= 128 >> (index % 8);
+  }
+  bool flip = false;
+  run("PieceStatMan/updatePieceStats", len, [&] {
+    flip = !flip;
+    if (flip) {
+      psm.updatePieceStats(newBitfield.data(), len, oldBitfield.data());
+    }
+    else {
+      psm.updatePieceStats(oldBitfield.data(), len, newBitfield.data());
+    }
+    return psm.getOrder()[0];
+  });
+  // Have messages
+  run("PieceStatMan/addPieceStats", 0, [&] {
+    size_t index = rng() % numPieces;
+    psm.addPieceStats(index);
+    return psm.getCounts()[index];
+  });
+}
+
+} // namespace bench
+
+} // namespace aria2
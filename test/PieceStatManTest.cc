@@ -1,7 +1,11 @@
 #include "PieceStatMan.h"
 
+#include <algorithm>
+
 #include <cppunit/extensions/HelperMacros.h>
 
+#include "SimpleRandomizer.h"
+
 namespace aria2 {
 
 class PieceStatManTest : public CppUnit::TestFixture {
@@ -11,6 +15,7 @@ class PieceStatManTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testAddPieceStats_bitfield);
   CPPUNIT_TEST(testUpdatePieceStats);
   CPPUNIT_TEST(testSubtractPieceStats);
+  CPPUNIT_TEST(testOrder);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -22,6 +27,7 @@ public:
   void testAddPieceStats_bitfield();
   void testUpdatePieceStats();
   void testSubtractPieceStats();
+  void testOrder();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(PieceStatManTest);
@@ -35,9 +41,10 @@ void PieceStatManTest::testAddPieceStats_index()
     const std::vector<size_t>& order(pieceStatMan.getOrder());
     const std::vector<int>& counts(pieceStatMan.getCounts());
     for (size_t i = 0; i < 10; ++i) {
-      CPPUNIT_ASSERT_EQUAL(i, order[i]);
       CPPUNIT_ASSERT_EQUAL(ans[i], counts[i]);
     }
+    // The most common piece comes last.
+    CPPUNIT_ASSERT_EQUAL((size_t)1, order[9]);
   }
   pieceStatMan.addPieceStats(1);
   {
@@ -126,4 +133,44 @@ void PieceStatManTest::testSubtractPieceStats()
   }
 }
 
+void PieceStatManTest::testOrder()
+{
+  const size_t numPiece = 1000;
+  PieceStatMan pieceStatMan(numPiece, true);
+  std::vector<int> expected(numPiece);
+  unsigned char bitfield[numPiece / 8];
+  auto& rand = *SimpleRandomizer::getInstance();
+  for (int k = 0; k < 50; ++k) {
+    rand.getRandomBytes(bitfield, sizeof(bitfield));
+    bool add = k < 20 || rand.getRandomNumber(2);
+    if (add) {
+      pieceStatMan.addPieceStats(bitfield, sizeof(bitfield));
+    }
+    else {
+      pieceStatMan.subtractPieceStats(bitfield, sizeof(bitfield));
+    }
+    for (size_t i = 0; i < numPiece; ++i) {
+      if (bitfield[i / 8] & (0x80u >> (i % 8))) {
+        if (add) {
+          ++expected[i];
+        }
+        else if (expected[i] > 0) {
+          --expected[i];
+        }
+      }
+    }
+    pieceStatMan.addPieceStats(k);
+    ++expected[k];
+  }
+  CPPUNIT_ASSERT(expected == pieceStatMan.getCounts());
+  auto order = pieceStatMan.getOrder();
+  for (size_t i = 1; i < numPiece; ++i) {
+    CPPUNIT_ASSERT(expected[order[i - 1]] <= expected[order[i]]);
+  }
+  std::sort(order.begin(), order.end());
+  for (size_t i = 0; i < numPiece; ++i) {
+    CPPUNIT_ASSERT_EQUAL(i, order[i]);
+  }
+}
+
 } // namespace aria2
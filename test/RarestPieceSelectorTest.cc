@@ -5,6 +5,7 @@
 #include "BitfieldMan.h"
 #include "PieceStatMan.h"
 #include "a2functional.h"
+#include "bitfield.h"
 
 namespace aria2 {
 
@@ -12,6 +13,7 @@ class RarestPieceSelectorTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(RarestPieceSelectorTest);
   CPPUNIT_TEST(testSelect);
+  CPPUNIT_TEST(testSelect_fewCandidates);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -24,6 +26,7 @@ public:
   void testUpdatePieceStats();
   void testSubtractPieceStats();
   void testSelect();
+  void testSelect_fewCandidates();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(RarestPieceSelectorTest);
@@ -47,4 +50,35 @@ void RarestPieceSelectorTest::testSelect()
   CPPUNIT_ASSERT_EQUAL((size_t)2, index);
 }
 
+void RarestPieceSelectorTest::testSelect_fewCandidates()
+{
+  const size_t numPieces = 10000;
+  auto pieceStatMan = std::make_shared<PieceStatMan>(numPieces, true);
+  RarestPieceSelector selector(pieceStatMan);
+  for (size_t i = 0; i < numPieces; ++i) {
+    for (size_t j = 0; j < i % 7 + 1; ++j) {
+      pieceStatMan->addPieceStats(i);
+    }
+  }
+  BitfieldMan bf(1_k, numPieces * 1_k);
+  size_t index;
+  CPPUNIT_ASSERT(!selector.select(index, bf.getBitfield(), numPieces));
+
+  // The candidates are far from the front of the order.
+  bf.setBit(9999);
+  bf.setBit(70);
+  bf.setBit(5001);
+  bf.setBit(13);
+  size_t expected = numPieces;
+  for (auto i : pieceStatMan->getOrder()) {
+    if (bitfield::test(bf.getBitfield(), numPieces, i)) {
+      expected = i;
+      break;
+    }
+  }
+  CPPUNIT_ASSERT(selector.select(index, bf.getBitfield(), numPieces));
+  CPPUNIT_ASSERT_EQUAL(expected, index);
+  CPPUNIT_ASSERT_EQUAL((size_t)70, index);
+}
+
 } // namespace aria2
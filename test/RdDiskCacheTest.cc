@@ -0,0 +1,134 @@
+#include "RdDiskCache.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "DirectDiskAdaptor.h"
+#include "ByteArrayDiskWriter.h"
+
+namespace aria2 {
+
+class RdDiskCacheTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(RdDiskCacheTest);
+  CPPUNIT_TEST(testReadData);
+  CPPUNIT_TEST(testReadData_lastPiece);
+  CPPUNIT_TEST(testEnsureLimit);
+  CPPUNIT_TEST(testRemove);
+  CPPUNIT_TEST_SUITE_END();
+
+  std::shared_ptr<DirectDiskAdaptor> adaptor_;
+  ByteArrayDiskWriter* writer_;
+
+public:
+  void setUp()
+  {
+    adaptor_ = std::make_shared<DirectDiskAdaptor>();
+    auto dw = make_unique<ByteArrayDiskWriter>();
+    writer_ = dw.get();
+    adaptor_->setDiskWriter(std::move(dw));
+    // 4 pieces of 8 bytes, the last one is 4 bytes.
+    writer_->setString("0123456789abcdefghijklmnopqrstuvwxyz");
+  }
+
+  bool read(RdDiskCache& cache, std::string& out, size_t index,
+            int32_t begin, size_t len, int32_t pieceLength = 8)
+  {
+    unsigned char buf[8];
+    if (!cache.readData(buf, len, adaptor_, index, begin, index * 8,
+                        pieceLength)) {
+      return false;
+    }
+    out.assign(&buf[0], &buf[len]);
+    return true;
+  }
+
+  void testReadData();
+  void testReadData_lastPiece();
+  void testEnsureLimit();
+  void testRemove();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RdDiskCacheTest);
+
+void RdDiskCacheTest::testReadData()
+{
+  RdDiskCache cache(100);
+  std::string out;
+  // The piece is not read unless the first block is requested.
+  CPPUNIT_ASSERT(!read(cache, out, 1, 4, 4));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, cache.getSize());
+
+  CPPUNIT_ASSERT(read(cache, out, 1, 0, 4));
+  CPPUNIT_ASSERT_EQUAL(std::string("89ab"), out);
+  CPPUNIT_ASSERT_EQUAL((size_t)8, cache.getSize());
+
+  // Served from the cache even if the file is changed.
+  writer_->setString(std::string(36, 'x'));
+  CPPUNIT_ASSERT(read(cache, out, 1, 4, 4));
+  CPPUNIT_ASSERT_EQUAL(std::string("cdef"), out);
+  // Out of range
+  CPPUNIT_ASSERT(!read(cache, out, 1, 6, 4));
+
+  auto& stat = cache.getStat();
+  CPPUNIT_ASSERT_EQUAL((uint64_t)2, stat.hits);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)2, stat.misses);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)1, stat.readaheads);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)8, stat.bytesServed);
+}
+
+void RdDiskCacheTest::testReadData_lastPiece()
+{
+  RdDiskCache cache(100);
+  std::string out;
+  CPPUNIT_ASSERT(read(cache, out, 4, 0, 4, 4));
+  CPPUNIT_ASSERT_EQUAL(std::string("wxyz"), out);
+  CPPUNIT_ASSERT_EQUAL((size_t)4, cache.getSize());
+  // The piece cannot be read fully.
+  CPPUNIT_ASSERT(!read(cache, out, 3, 0, 4, 16));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, cache.countPiece());
+  // The piece is larger than the cache.
+  RdDiskCache small(4);
+  CPPUNIT_ASSERT(!read(small, out, 0, 0, 4));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, small.getSize());
+}
+
+void RdDiskCacheTest::testEnsureLimit()
+{
+  RdDiskCache cache(16);
+  std::string out;
+  CPPUNIT_ASSERT(read(cache, out, 0, 0, 4));
+  CPPUNIT_ASSERT(read(cache, out, 1, 0, 4));
+  // Piece 0 becomes the most recently used one.
+  CPPUNIT_ASSERT(read(cache, out, 0, 4, 4));
+  CPPUNIT_ASSERT(read(cache, out, 2, 0, 4));
+  CPPUNIT_ASSERT_EQUAL((size_t)16, cache.getSize());
+  CPPUNIT_ASSERT_EQUAL((uint64_t)1, cache.getStat().evictions);
+  CPPUNIT_ASSERT(read(cache, out, 0, 4, 4));
+  CPPUNIT_ASSERT_EQUAL(std::string("4567"), out);
+  CPPUNIT_ASSERT(!read(cache, out, 1, 4, 4));
+}
+
+void RdDiskCacheTest::testRemove()
+{
+  auto adaptor2 = std::make_shared<DirectDiskAdaptor>();
+  auto dw = make_unique<ByteArrayDiskWriter>();
+  dw->setString("ABCDEFGH");
+  adaptor2->setDiskWriter(std::move(dw));
+
+  RdDiskCache cache(100);
+  std::string out;
+  CPPUNIT_ASSERT(read(cache, out, 0, 0, 4));
+  CPPUNIT_ASSERT(read(cache, out, 1, 0, 4));
+  unsigned char buf[4];
+  CPPUNIT_ASSERT(cache.readData(buf, 4, adaptor2, 0, 0, 0, 8));
+  CPPUNIT_ASSERT_EQUAL(std::string("ABCD"), std::string(&buf[0], &buf[4]));
+  CPPUNIT_ASSERT_EQUAL((size_t)3, cache.countPiece());
+
+  cache.remove(adaptor_.get());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, cache.countPiece());
+  CPPUNIT_ASSERT_EQUAL((size_t)8, cache.getSize());
+  CPPUNIT_ASSERT(cache.readData(buf, 4, adaptor2, 0, 4, 0, 8));
+  CPPUNIT_ASSERT_EQUAL(std::string("EFGH"), std::string(&buf[0], &buf[4]));
+}
+
+} // namespace aria2
@@ -20,6 +20,9 @@
 #include "DownloadEngine.h"
 #include "SelectEventPoll.h"
 #include "UriListParser.h"
+#include "LazyRequestGroup.h"
+#include "download_helper.h"
+#include "Command.h"
 
 namespace aria2 {
 
@@ -34,7 +37,9 @@ class RequestGroupManTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testFillRequestGroupFromReserver);
   CPPUNIT_TEST(testFillRequestGroupFromReserver_uriParser);
   CPPUNIT_TEST(testInsertReservedGroup);
+  CPPUNIT_TEST(testLazyReservedGroup);
   CPPUNIT_TEST(testAddDownloadResult);
+  CPPUNIT_TEST(testWakeUpOnHalt);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -66,7 +71,9 @@ public:
   void testFillRequestGroupFromReserver();
   void testFillRequestGroupFromReserver_uriParser();
   void testInsertReservedGroup();
+  void testLazyReservedGroup();
   void testAddDownloadResult();
+  void testWakeUpOnHalt();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(RequestGroupManTest);
@@ -267,6 +274,79 @@ void RequestGroupManTest::testInsertReservedGroup()
   CPPUNIT_ASSERT_EQUAL(rgs2[1]->getGID(), (*itr++)->getGID());
 }
 
+void RequestGroupManTest::testLazyReservedGroup()
+{
+  auto globalOption = util::copy(option_);
+  auto requestOption = std::make_shared<Option>();
+  requestOption->setParent(globalOption);
+  requestOption->put(PREF_DIR, A2_TEST_OUT_DIR);
+  requestOption->put(PREF_PIECE_LENGTH, option_->get(PREF_PIECE_LENGTH));
+  std::vector<a2_gid_t> gids;
+  std::vector<std::unique_ptr<LazyRequestGroup>> lazy;
+  for (auto uri : {"http://host/lazy1", "http://host/lazy2",
+                   "http://host/lazy3"}) {
+    lazy.push_back(createLazyRequestGroupForUri(globalOption, requestOption,
+                                                {std::string(uri)}));
+    CPPUNIT_ASSERT(lazy.back());
+    gids.push_back(lazy.back()->getGID());
+  }
+  CPPUNIT_ASSERT(!createLazyRequestGroupForUri(
+      globalOption, requestOption,
+      {"magnet:?xt=urn:btih:248D0A1CD08284299DE78D5C1ED359BB46717D8C"}));
+  // All options given by the request are kept, even if they are the
+  // same as the global options.
+  CPPUNIT_ASSERT_EQUAL((size_t)2, lazy[0]->getOptions().size());
+  CPPUNIT_ASSERT(lazy[0]->findOption(PREF_DIR));
+  CPPUNIT_ASSERT(lazy[0]->findOption(PREF_PIECE_LENGTH));
+  CPPUNIT_ASSERT(globalOption == lazy[0]->getGlobalOption());
+
+  auto eager = createRequestGroup(0, 0, "foo", "http://host/foo",
+                                  util::copy(option_));
+  rgman_->addReservedGroup(std::move(lazy[0]));
+  rgman_->addReservedGroup(eager);
+  rgman_->insertReservedGroup(0, std::move(lazy[1]));
+  rgman_->addReservedGroup(std::move(lazy[2]));
+  // lazy2 lazy1 foo lazy3
+  CPPUNIT_ASSERT_EQUAL((size_t)4, rgman_->getReservedGroups().size());
+  CPPUNIT_ASSERT_EQUAL((size_t)3, rgman_->countLazyGroup());
+  CPPUNIT_ASSERT(!rgman_->getReservedGroups()[0]);
+
+  CPPUNIT_ASSERT_EQUAL((size_t)0, rgman_->changeReservedGroupPosition(
+                                      gids[2], 0, OFFSET_MODE_SET));
+  // lazy3 lazy2 lazy1 foo
+  CPPUNIT_ASSERT(!rgman_->findGroup(gids[1]));
+  CPPUNIT_ASSERT_EQUAL((size_t)3, rgman_->countLazyGroup());
+  auto rg = rgman_->materializeGroup(gids[1]);
+  CPPUNIT_ASSERT(rg);
+  CPPUNIT_ASSERT(rg == rgman_->getReservedGroups()[1]);
+  CPPUNIT_ASSERT_EQUAL(gids[1], rg->getGID());
+  CPPUNIT_ASSERT_EQUAL(std::string(A2_TEST_OUT_DIR),
+                       rg->getOption()->get(PREF_DIR));
+  CPPUNIT_ASSERT_EQUAL(
+      std::string("http://host/lazy2"),
+      rg->getDownloadContext()->getFirstFileEntry()->getRemainingUris()[0]);
+  CPPUNIT_ASSERT(!rgman_->findLazyGroup(gids[1]));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, rgman_->countLazyGroup());
+
+  CPPUNIT_ASSERT(rgman_->removeReservedGroup(gids[0]));
+  CPPUNIT_ASSERT(!rgman_->findLazyGroup(gids[0]));
+  CPPUNIT_ASSERT(!rgman_->findGroup(gids[0]));
+  // lazy3 lazy2 foo
+
+  // Paused downloads stay in the queue without being materialized.
+  rgman_->setLazyGroupsPauseRequested(true);
+  rgman_->fillRequestGroupFromReserver(e_.get());
+  CPPUNIT_ASSERT_EQUAL((size_t)2, rgman_->getRequestGroups().size());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, rgman_->getReservedGroups().size());
+  CPPUNIT_ASSERT(rgman_->findLazyGroup(gids[2]));
+
+  rgman_->setLazyGroupsPauseRequested(false);
+  rgman_->fillRequestGroupFromReserver(e_.get());
+  CPPUNIT_ASSERT_EQUAL((size_t)3, rgman_->getRequestGroups().size());
+  CPPUNIT_ASSERT(rgman_->getReservedGroups().empty());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, rgman_->countLazyGroup());
+}
+
 void RequestGroupManTest::testAddDownloadResult()
 {
   std::string uri = "http://example.org";
@@ -280,4 +360,67 @@ void RequestGroupManTest::testAddDownloadResult()
                        rgman_->getDownloadStat().getLastErrorResult());
 }
 
+namespace {
+// Sleeps until its download is halted.
+class IdleCommand : public Command {
+public:
+  IdleCommand(DownloadEngine* e, RequestGroup* group)
+      : Command(e->newCUID()), e_(e), group_(group)
+  {
+  }
+
+  virtual bool execute() CXX11_OVERRIDE
+  {
+    if (group_->isHaltRequested()) {
+      return true;
+    }
+    e_->addCommand(std::unique_ptr<Command>(this));
+    e_->sleepCommand(this, 10_s);
+    return false;
+  }
+
+private:
+  DownloadEngine* e_;
+  RequestGroup* group_;
+};
+
+class HaltCommand : public Command {
+public:
+  HaltCommand(DownloadEngine* e, RequestGroup* group)
+      : Command(e->newCUID()), group_(group)
+  {
+  }
+
+  virtual bool execute() CXX11_OVERRIDE
+  {
+    group_->setHaltRequested(true);
+    return true;
+  }
+
+private:
+  RequestGroup* group_;
+};
+} // namespace
+
+void RequestGroupManTest::testWakeUpOnHalt()
+{
+  auto group =
+      std::make_shared<RequestGroup>(GroupId::create(), util::copy(option_));
+  group->setRequestGroupMan(rgman_);
+  rgman_->addRequestGroup(group);
+  e_->addCommand(make_unique<IdleCommand>(e_.get(), group.get()));
+  e_->run(true);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, e_->countSleepingCommand());
+
+  auto start = std::chrono::steady_clock::now();
+  e_->addRoutineCommand(make_unique<HaltCommand>(e_.get(), group.get()));
+  while (e_->countCommand() &&
+         std::chrono::steady_clock::now() - start < 20_s) {
+    e_->run(true);
+  }
+  // IdleCommand sees the halt without waiting for its timeout.
+  CPPUNIT_ASSERT_EQUAL((size_t)0, e_->countCommand());
+  CPPUNIT_ASSERT(std::chrono::steady_clock::now() - start < 5_s);
+}
+
 } // namespace aria2
@@ -0,0 +1,196 @@
+// Benchmarks of the RPC methods which return the status of many
+// downloads.
+#include "Bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "DownloadEngine.h"
+#include "SelectEventPoll.h"
+#include "Option.h"
+#include "prefs.h"
+#include "RequestGroupMan.h"
+#include "RequestGroup.h"
+#include "RpcMethodImpl.h"
+#include "RpcRequest.h"
+#include "RpcResponse.h"
+#include "download_helper.h"
+#include "DownloadResult.h"
+#include "FileEntry.h"
+#include "GroupId.h"
+#include "StatusSubscription.h"
+#include "json.h"
+#include "fmt.h"
+#include "util.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+namespace bench {
+
+namespace {
+
+const size_t NUM_DOWNLOADS = 3000;
+
+const size_t NUM_DOWNLOAD_RESULTS = 100000;
+
+const size_t NUM_CLIENTS = 50;
+
+// The keys a web UI requests to show the list of downloads.
+const char* const LIST_KEYS[] = {"gid", "status", "totalLength",
+                                 "completedLength", "downloadSpeed"};
+
+rpc::RpcRequest createTellWaiting(bool jsonRpc)
+{
+  auto params = List::g();
+  params->append(Integer::g(0));
+  params->append(Integer::g(NUM_DOWNLOADS));
+  return {rpc::TellWaitingRpcMethod::getMethodName(), std::move(params),
+          Null::g(), jsonRpc};
+}
+
+rpc::RpcRequest createPaginationRequest(const char* methodName,
+                                        int64_t offset, int64_t num)
+{
+  auto params = List::g();
+  params->append(Integer::g(offset));
+  params->append(Integer::g(num));
+  auto keys = List::g();
+  for (auto k : LIST_KEYS) {
+    keys->append(k);
+  }
+  params->append(std::move(keys));
+  return {methodName, std::move(params), Null::g(), true};
+}
+
+std::shared_ptr<DownloadResult> createDownloadResult(size_t i)
+{
+  auto dr = std::make_shared<DownloadResult>();
+  dr->gid = GroupId::create();
+  dr->fileEntries.push_back(std::make_shared<FileEntry>(
+      fmt("/home/user/Downloads/file%zu.dat", i), 1_g, 0,
+      std::vector<std::string>{
+          fmt("http://mirror0.example.org/pub/file%zu.dat", i)}));
+  dr->totalLength = 1_g;
+  dr->completedLength = 1_g;
+  dr->pieceLength = 1_m;
+  dr->numPieces = 1024;
+  dr->bitfield.assign(dr->numPieces / 8, '\xff');
+  dr->dir = "/home/user/Downloads";
+  dr->result = error_code::FINISHED;
+  dr->option = std::make_shared<Option>();
+  return dr;
+}
+
+void tellStopped()
+{
+  auto option = std::make_shared<Option>();
+  option->put(PREF_MAX_DOWNLOAD_RESULT, util::uitos(NUM_DOWNLOAD_RESULTS));
+  auto e = make_unique<DownloadEngine>(make_unique<SelectEventPoll>());
+  e->setOption(option.get());
+  e->setRequestGroupMan(make_unique<RequestGroupMan>(
+      std::vector<std::shared_ptr<RequestGroup>>{}, 1, option.get()));
+  for (size_t i = 0; i < NUM_DOWNLOAD_RESULTS; ++i) {
+    e->getRequestGroupMan()->addDownloadResult(createDownloadResult(i));
+  }
+  rpc::TellStoppedRpcMethod m;
+  // A page in the middle of the list, and the last page in the reverse
+  // order.
+  run("rpc/tellStopped/page", 0, [&] {
+    auto res = m.execute(createPaginationRequest(
+                             rpc::TellStoppedRpcMethod::getMethodName(),
+                             NUM_DOWNLOAD_RESULTS / 2, 50),
+                         e.get());
+    return rpc::toJson(res, "", false).size();
+  });
+  run("rpc/tellStopped/lastPage", 0, [&] {
+    auto res = m.execute(
+        createPaginationRequest(rpc::TellStoppedRpcMethod::getMethodName(),
+                                -1, 50),
+        e.get());
+    return rpc::toJson(res, "", false).size();
+  });
+}
+
+} // namespace
+
+void rpc()
+{
+  if (selected("rpc/tellStopped/")) {
+    tellStopped();
+  }
+  if (!selected("rpc/tellWaiting/") && !selected("rpc/subscription/")) {
+    return;
+  }
+  auto option = std::make_shared<Option>();
+  option->put(PREF_DIR, "/home/user/Downloads");
+  option->put(PREF_SPLIT, "4");
+  option->put(PREF_MAX_DOWNLOAD_RESULT, "10");
+  auto e = make_unique<DownloadEngine>(make_unique<SelectEventPoll>());
+  e->setOption(option.get());
+  e->setRequestGroupMan(make_unique<RequestGroupMan>(
+      std::vector<std::shared_ptr<RequestGroup>>{}, 1, option.get()));
+  std::vector<std::shared_ptr<RequestGroup>> groups;
+  for (size_t i = 0; i < NUM_DOWNLOADS; ++i) {
+    std::vector<std::string> uris;
+    for (size_t j = 0; j < 4; ++j) {
+      uris.push_back(
+          fmt("http://mirror%zu.example.org/pub/file%zu.dat", j, i));
+    }
+    createRequestGroupForUri(groups, option, uris);
+  }
+  e->getRequestGroupMan()->addReservedGroup(groups);
+
+  rpc::TellWaitingRpcMethod m;
+  // The response built as ValueBase and then encoded, which is the
+  // way of XML-RPC.
+  auto tree = [&] {
+    auto res = m.execute(createTellWaiting(false), e.get());
+    return rpc::toJson(res, "", false);
+  };
+  // The response written by writeJson().
+  auto stream = [&] {
+    auto res = m.execute(createTellWaiting(true), e.get());
+    return rpc::toJson(res, "", false);
+  };
+  auto text = stream();
+  if (tree() != text) {
+    fprintf(stderr, "rpc/tellWaiting: the outputs differ\n");
+    exit(EXIT_FAILURE);
+  }
+  run("rpc/tellWaiting/tree", text.size(), [&] { return tree().size(); });
+  run("rpc/tellWaiting/json", text.size(), [&] { return stream().size(); });
+  run("rpc/tellWaiting/keys", 0, [&] {
+    auto res = m.execute(
+        createPaginationRequest(rpc::TellWaitingRpcMethod::getMethodName(), 0,
+                                NUM_DOWNLOADS),
+        e.get());
+    return rpc::toJson(res, "", false).size();
+  });
+
+  // The clients which watch all the downloads.  The status is gathered
+  // once for all of them, and only the changes are sent, while each
+  // client calls tellWaiting with LIST_KEYS otherwise.
+  std::vector<a2_gid_t> gids;
+  for (auto& group : groups) {
+    gids.push_back(group->getGID());
+  }
+  std::vector<std::string> keys(std::begin(LIST_KEYS), std::end(LIST_KEYS));
+  std::vector<rpc::StatusSubscription> subs;
+  for (size_t i = 0; i < NUM_CLIENTS; ++i) {
+    subs.emplace_back(gids, keys, 1_s);
+  }
+  Timer now;
+  run(fmt("rpc/subscription/%zuclients", NUM_CLIENTS), 0, [&] {
+    rpc::StatusSnapshot snapshot(e.get(), keys);
+    size_t n = 0;
+    for (auto& sub : subs) {
+      n += sub.update(snapshot, now).size();
+    }
+    return n;
+  });
+}
+
+} // namespace bench
+
+} // namespace aria2
@@ -21,6 +21,9 @@
 #include "download_helper.h"
 #include "FileEntry.h"
 #include "RpcMethodFactory.h"
+#include "CommandProfiler.h"
+#include "json.h"
+#include "ValueBaseJsonParser.h"
 #ifdef ENABLE_BITTORRENT
 #  include "BtRegistry.h"
 #  include "BtRuntime.h"
@@ -41,6 +44,8 @@ class RpcMethodTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testAddUri_withBadOption);
   CPPUNIT_TEST(testAddUri_withPosition);
   CPPUNIT_TEST(testAddUri_withBadPosition);
+  CPPUNIT_TEST(testAddUri_changeGlobalOption);
+  CPPUNIT_TEST(testAddUri_lazyQuery);
 #ifdef ENABLE_BITTORRENT
   CPPUNIT_TEST(testAddTorrent);
   CPPUNIT_TEST(testAddTorrent_withoutTorrent);
@@ -64,6 +69,7 @@ class RpcMethodTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testTellStatus_withoutGid);
   CPPUNIT_TEST(testTellWaiting);
   CPPUNIT_TEST(testTellWaiting_fail);
+  CPPUNIT_TEST(testTell_json);
   CPPUNIT_TEST(testGetVersion);
   CPPUNIT_TEST(testNoSuchMethod);
   CPPUNIT_TEST(testGatherStoppedDownload);
@@ -71,17 +77,21 @@ class RpcMethodTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testGatherStoppedDownload_bt);
 #endif // ENABLE_BITTORRENT
   CPPUNIT_TEST(testGatherProgressCommon);
+  CPPUNIT_TEST(testStatusKeys);
 #ifdef ENABLE_BITTORRENT
   CPPUNIT_TEST(testGatherBitTorrentMetadata);
 #endif // ENABLE_BITTORRENT
   CPPUNIT_TEST(testChangePosition);
   CPPUNIT_TEST(testChangePosition_fail);
   CPPUNIT_TEST(testGetSessionInfo);
+  CPPUNIT_TEST(testGetCommandProfile);
+  CPPUNIT_TEST(testSubscribe_fail);
   CPPUNIT_TEST(testChangeUri);
   CPPUNIT_TEST(testChangeUri_fail);
   CPPUNIT_TEST(testPause);
   CPPUNIT_TEST(testSystemMulticall);
   CPPUNIT_TEST(testSystemMulticall_fail);
+  CPPUNIT_TEST(testSystemMulticall_json);
   CPPUNIT_TEST(testSystemListMethods);
   CPPUNIT_TEST(testSystemListNotifications);
   CPPUNIT_TEST_SUITE_END();
@@ -111,6 +121,8 @@ public:
   void testAddUri_withBadOption();
   void testAddUri_withPosition();
   void testAddUri_withBadPosition();
+  void testAddUri_changeGlobalOption();
+  void testAddUri_lazyQuery();
 #ifdef ENABLE_BITTORRENT
   void testAddTorrent();
   void testAddTorrent_withoutTorrent();
@@ -134,6 +146,7 @@ public:
   void testTellStatus_withoutGid();
   void testTellWaiting();
   void testTellWaiting_fail();
+  void testTell_json();
   void testGetVersion();
   void testNoSuchMethod();
   void testGatherStoppedDownload();
@@ -141,16 +154,20 @@ public:
   void testGatherStoppedDownload_bt();
 #endif // ENABLE_BITTORRENT
   void testGatherProgressCommon();
+  void testStatusKeys();
 #ifdef ENABLE_BITTORRENT
   void testGatherBitTorrentMetadata();
 #endif // ENABLE_BITTORRENT
   void testChangePosition();
   void testChangePosition_fail();
   void testGetSessionInfo();
+  void testGetCommandProfile();
+  void testSubscribe_fail();
   void testChangeUri();
   void testChangeUri_fail();
   void testPause();
   void testSystemMulticall();
+  void testSystemMulticall_json();
   void testSystemMulticall_fail();
   void testSystemListMethods();
   void testSystemListNotifications();
@@ -226,7 +243,7 @@ void RpcMethodTest::testAddUri()
     const RequestGroupList& rgs = e_->getRequestGroupMan()->getReservedGroups();
     CPPUNIT_ASSERT_EQUAL((size_t)1, rgs.size());
     CPPUNIT_ASSERT_EQUAL(std::string("http://localhost/"),
-                         (*rgs.begin())
+                         getReservedGroup(e_->getRequestGroupMan().get(), 0)
                              ->getDownloadContext()
                              ->getFirstFileEntry()
                              ->getRemainingUris()
@@ -324,6 +341,118 @@ void RpcMethodTest::testAddUri_withBadPosition()
   CPPUNIT_ASSERT_EQUAL(1, res.code);
 }
 
+void RpcMethodTest::testAddUri_changeGlobalOption()
+{
+  option_->put(PREF_SPLIT, "5");
+  AddUriRpcMethod m;
+  auto req = createReq(AddUriRpcMethod::getMethodName());
+  auto urisParam = List::g();
+  urisParam->append("http://localhost/");
+  req.params->append(std::move(urisParam));
+  // Same value as the global option
+  auto opt = Dict::g();
+  opt->put(PREF_DIR->k, option_->get(PREF_DIR));
+  req.params->append(std::move(opt));
+  auto res = m.execute(std::move(req), e_.get());
+  CPPUNIT_ASSERT_EQUAL(0, res.code);
+  a2_gid_t gid;
+  CPPUNIT_ASSERT_EQUAL(
+      0, GroupId::toNumericId(gid, downcast<String>(res.param)->s().c_str()));
+  CPPUNIT_ASSERT(e_->getRequestGroupMan()->findLazyGroup(gid));
+
+  ChangeGlobalOptionRpcMethod cm;
+  req = createReq(ChangeGlobalOptionRpcMethod::getMethodName());
+  opt = Dict::g();
+  opt->put(PREF_DIR->k, "/b");
+  opt->put(PREF_SPLIT->k, "2");
+  req.params->append(std::move(opt));
+  res = cm.execute(std::move(req), e_.get());
+  CPPUNIT_ASSERT_EQUAL(0, res.code);
+  CPPUNIT_ASSERT_EQUAL(std::string("/b"), option_->get(PREF_DIR));
+
+  // The download keeps the global options at the time it was added.
+  auto option =
+      findReservedGroup(e_->getRequestGroupMan().get(), gid)->getOption();
+  CPPUNIT_ASSERT_EQUAL(std::string(A2_TEST_OUT_DIR "/aria2_RpcMethodTest"),
+                       option->get(PREF_DIR));
+  CPPUNIT_ASSERT_EQUAL(std::string("5"), option->get(PREF_SPLIT));
+}
+
+namespace {
+// Calls RPC method M with params and returns the result in JSON.
+template <typename M>
+std::string callMethod(DownloadEngine* e, std::unique_ptr<List> params)
+{
+  M m;
+  auto res = m.execute(RpcRequest(M::getMethodName(), std::move(params)), e);
+  CPPUNIT_ASSERT_EQUAL(0, res.code);
+  return json::encode(res.param.get());
+}
+} // namespace
+
+namespace {
+// Returns the results of the read-only queries about the download gid
+// in JSON.
+std::vector<std::string> queryDownload(DownloadEngine* e,
+                                       const std::string& gid)
+{
+  std::vector<std::string> res;
+  auto params = List::g();
+  params->append(gid);
+  res.push_back(callMethod<TellStatusRpcMethod>(e, std::move(params)));
+  params = List::g();
+  params->append(Integer::g(0));
+  params->append(Integer::g(10));
+  res.push_back(callMethod<TellWaitingRpcMethod>(e, std::move(params)));
+  params = List::g();
+  params->append(gid);
+  res.push_back(callMethod<GetFilesRpcMethod>(e, std::move(params)));
+  params = List::g();
+  params->append(gid);
+  res.push_back(callMethod<GetUrisRpcMethod>(e, std::move(params)));
+  params = List::g();
+  params->append(gid);
+  res.push_back(callMethod<GetOptionRpcMethod>(e, std::move(params)));
+  return res;
+}
+} // namespace
+
+void RpcMethodTest::testAddUri_lazyQuery()
+{
+  option_->put(PREF_ENABLE_RPC, A2_V_TRUE);
+  option_->put(PREF_SPLIT, "3");
+  option_->put(PREF_MAX_CONNECTION_PER_SERVER, "2");
+  AddUriRpcMethod m;
+  auto req = createReq(AddUriRpcMethod::getMethodName());
+  auto urisParam = List::g();
+  urisParam->append("http://localhost/a");
+  urisParam->append("http://localhost/b");
+  req.params->append(std::move(urisParam));
+  auto opt = Dict::g();
+  opt->put(PREF_OUT->k, "lazy");
+  opt->put(PREF_PAUSE->k, A2_V_TRUE);
+  req.params->append(std::move(opt));
+  auto res = m.execute(std::move(req), e_.get());
+  CPPUNIT_ASSERT_EQUAL(0, res.code);
+  auto gid = downcast<String>(res.param)->s();
+  auto& rgman = e_->getRequestGroupMan();
+
+  // Queries do not materialize the download.
+  auto lazyResults = queryDownload(e_.get(), gid);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, rgman->countLazyGroup());
+  CPPUNIT_ASSERT(!rgman->getReservedGroups()[0]);
+
+  // ... and give the same results as for the materialized one.
+  rgman->materializeReservedGroups(0, 1);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, rgman->countLazyGroup());
+  auto results = queryDownload(e_.get(), gid);
+  for (size_t i = 0; i < results.size(); ++i) {
+    CPPUNIT_ASSERT_EQUAL(results[i], lazyResults[i]);
+  }
+  CPPUNIT_ASSERT(results[0].find("\"status\":\"paused\"") !=
+                 std::string::npos);
+}
+
 #ifdef ENABLE_BITTORRENT
 namespace {
 RpcRequest createAddTorrentReq()
@@ -901,6 +1030,89 @@ void RpcMethodTest::testTellWaiting_fail()
   CPPUNIT_ASSERT_EQUAL(1, res.code);
 }
 
+namespace {
+// Executes the request created by createParams() as XML-RPC and
+// JSON-RPC, and checks that JSON-RPC result written by writeJson() is
+// the same as the JSON encoding of XML-RPC result.
+void checkJson(RpcMethod& m, const std::string& methodName,
+               const std::function<std::unique_ptr<List>()>& createParams,
+               DownloadEngine* e)
+{
+  auto res = m.execute({methodName, createParams()}, e);
+  CPPUNIT_ASSERT_EQUAL(0, res.code);
+  CPPUNIT_ASSERT(res.jsonParam.empty());
+  auto jsonRes =
+      m.execute({methodName, createParams(), Null::g(), true}, e);
+  CPPUNIT_ASSERT_EQUAL(0, jsonRes.code);
+  CPPUNIT_ASSERT(!jsonRes.param);
+  CPPUNIT_ASSERT_EQUAL(json::encode(res.param.get()), jsonRes.jsonParam);
+}
+} // namespace
+
+void RpcMethodTest::testTell_json()
+{
+  addUri("http://1/", e_);
+  addUri("http://2/", e_);
+#ifdef ENABLE_BITTORRENT
+  addTorrent(A2_TEST_DIR "/single.torrent", e_);
+#endif // ENABLE_BITTORRENT
+  auto& rgman = e_->getRequestGroupMan();
+  auto group = getReservedGroup(rgman.get(), 0);
+  rgman->addDownloadResult(group->createDownloadResult());
+  rgman->addDownloadResult(
+      getReservedGroup(rgman.get(), 1)->createDownloadResult());
+
+  for (auto offset : {0, -1}) {
+    TellWaitingRpcMethod m;
+    checkJson(m, TellWaitingRpcMethod::getMethodName(),
+              [offset] {
+                auto params = List::g();
+                params->append(Integer::g(offset));
+                params->append(Integer::g(10));
+                return params;
+              },
+              e_.get());
+  }
+  for (auto offset : {0, -1}) {
+    TellStoppedRpcMethod m;
+    checkJson(m, TellStoppedRpcMethod::getMethodName(),
+              [offset] {
+                auto params = List::g();
+                params->append(Integer::g(offset));
+                params->append(Integer::g(10));
+                return params;
+              },
+              e_.get());
+  }
+  {
+    TellStatusRpcMethod m;
+    checkJson(m, TellStatusRpcMethod::getMethodName(),
+              [&group] {
+                auto params = List::g();
+                params->append(GroupId::toHex(group->getGID()));
+                return params;
+              },
+              e_.get());
+    checkJson(m, TellStatusRpcMethod::getMethodName(),
+              [&group] {
+                auto params = List::g();
+                params->append(GroupId::toHex(group->getGID()));
+                auto keys = List::g();
+                keys->append("gid");
+                keys->append("status");
+                keys->append("files");
+                params->append(std::move(keys));
+                return params;
+              },
+              e_.get());
+  }
+  {
+    TellActiveRpcMethod m;
+    checkJson(m, TellActiveRpcMethod::getMethodName(),
+              [] { return List::g(); }, e_.get());
+  }
+}
+
 void RpcMethodTest::testGetVersion()
 {
   GetVersionRpcMethod m;
@@ -1035,6 +1247,25 @@ void RpcMethodTest::testGatherProgressCommon()
   CPPUNIT_ASSERT(entry->containsKey("gid"));
 }
 
+void RpcMethodTest::testStatusKeys()
+{
+  StatusKeys all(std::vector<std::string>{});
+  for (int i = 0; i < StatusKeys::MAX_KEY; ++i) {
+    CPPUNIT_ASSERT(all.has(static_cast<StatusKeys::Key>(i)));
+  }
+  StatusKeys keys({"gid", "foo", "verifyIntegrityPending", "files"});
+  CPPUNIT_ASSERT(keys.has(StatusKeys::GID));
+  CPPUNIT_ASSERT(keys.has(StatusKeys::VERIFY_PENDING));
+  CPPUNIT_ASSERT(keys.has(StatusKeys::FILES));
+  CPPUNIT_ASSERT(!keys.has(StatusKeys::BITFIELD));
+  CPPUNIT_ASSERT(!keys.has(StatusKeys::VERIFIED_LENGTH));
+  CPPUNIT_ASSERT(!keys.has(StatusKeys::UPLOAD_SPEED));
+  StatusKeys unknown({"foo"});
+  for (int i = 0; i < StatusKeys::MAX_KEY; ++i) {
+    CPPUNIT_ASSERT(!unknown.has(static_cast<StatusKeys::Key>(i)));
+  }
+}
+
 #ifdef ENABLE_BITTORRENT
 void RpcMethodTest::testGatherBitTorrentMetadata()
 {
@@ -1284,6 +1515,53 @@ void RpcMethodTest::testGetSessionInfo()
                        getString(downcast<Dict>(res.param), "sessionId"));
 }
 
+void RpcMethodTest::testGetCommandProfile()
+{
+  GetCommandProfileRpcMethod m;
+  auto res = m.execute(createReq(GetCommandProfileRpcMethod::getMethodName()),
+                       e_.get());
+  // Disabled by default
+  CPPUNIT_ASSERT_EQUAL(1, res.code);
+
+  ChangeGlobalOptionRpcMethod cm;
+  auto req = createReq(ChangeGlobalOptionRpcMethod::getMethodName());
+  auto opt = Dict::g();
+  opt->put(PREF_PROFILE_COMMANDS->k, A2_V_TRUE);
+  req.params->append(std::move(opt));
+  res = cm.execute(std::move(req), e_.get());
+  CPPUNIT_ASSERT_EQUAL(0, res.code);
+  CPPUNIT_ASSERT(e_->getCommandProfiler());
+  e_->getCommandProfiler()->recordPoll(std::chrono::milliseconds(3));
+
+  res = m.execute(createReq(GetCommandProfileRpcMethod::getMethodName()),
+                  e_.get());
+  CPPUNIT_ASSERT_EQUAL(0, res.code);
+  const Dict* resParams = downcast<Dict>(res.param);
+  const Dict* poll = downcast<Dict>(resParams->get("poll"));
+  CPPUNIT_ASSERT_EQUAL(std::string("1"), getString(poll, "count"));
+  CPPUNIT_ASSERT_EQUAL(std::string("3000"), getString(poll, "totalTime"));
+  CPPUNIT_ASSERT_EQUAL(std::string("3000"), getString(poll, "maxTime"));
+  CPPUNIT_ASSERT(downcast<List>(resParams->get("commands"))->empty());
+}
+
+void RpcMethodTest::testSubscribe_fail()
+{
+  SubscribeRpcMethod m;
+  // Too short interval
+  auto req = createReq(SubscribeRpcMethod::getMethodName());
+  req.params->append(List::g());
+  req.params->append(List::g());
+  req.params->append(Integer::g(99));
+  auto res = m.execute(std::move(req), e_.get());
+  CPPUNIT_ASSERT_EQUAL(1, res.code);
+  // Not over WebSocket
+  res = m.execute(createReq(SubscribeRpcMethod::getMethodName()), e_.get());
+  CPPUNIT_ASSERT_EQUAL(1, res.code);
+  UnsubscribeRpcMethod um;
+  res = um.execute(createReq(UnsubscribeRpcMethod::getMethodName()), e_.get());
+  CPPUNIT_ASSERT_EQUAL(1, res.code);
+}
+
 void RpcMethodTest::testPause()
 {
   std::vector<std::string> uris{
@@ -1418,6 +1696,60 @@ void RpcMethodTest::testSystemMulticall_fail()
   CPPUNIT_ASSERT_EQUAL(1, res.code);
 }
 
+void RpcMethodTest::testSystemMulticall_json()
+{
+  addUri("http://localhost/", e_);
+  auto gid = GroupId::toHex(
+      getReservedGroup(e_->getRequestGroupMan().get(), 0)->getGID());
+  SystemMulticallRpcMethod m;
+  checkJson(m, SystemMulticallRpcMethod::getMethodName(),
+            [&gid] {
+              auto reqparams = List::g();
+              {
+                auto dict = Dict::g();
+                dict->put("methodName", TellStatusRpcMethod::getMethodName());
+                auto params = List::g();
+                params->append(gid);
+                dict->put("params", std::move(params));
+                reqparams->append(std::move(dict));
+              }
+              {
+                auto dict = Dict::g();
+                dict->put("methodName", GetVersionRpcMethod::getMethodName());
+                reqparams->append(std::move(dict));
+              }
+              auto params = List::g();
+              params->append(std::move(reqparams));
+              return params;
+            },
+            e_.get());
+  // The errors are written with the keys of JSON-RPC.
+  auto reqparams = List::g();
+  reqparams->append("not struct");
+  {
+    auto dict = Dict::g();
+    dict->put("methodName", TellStatusRpcMethod::getMethodName());
+    dict->put("params", List::g());
+    reqparams->append(std::move(dict));
+  }
+  auto params = List::g();
+  params->append(std::move(reqparams));
+  auto res = m.execute({SystemMulticallRpcMethod::getMethodName(),
+                        std::move(params), Null::g(), true},
+                       e_.get());
+  CPPUNIT_ASSERT_EQUAL(0, res.code);
+  json::ValueBaseJsonParser parser;
+  ssize_t error;
+  auto r = parser.parseFinal(res.jsonParam.c_str(), res.jsonParam.size(),
+                             error);
+  const List* resParams = downcast<List>(r);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, resParams->size());
+  for (auto& v : *resParams) {
+    auto code = downcast<Integer>(downcast<Dict>(v)->get("code"));
+    CPPUNIT_ASSERT_EQUAL((int64_t)1, code->i());
+  }
+}
+
 void RpcMethodTest::testSystemListMethods()
 {
   SystemListMethodsRpcMethod m;
@@ -15,6 +15,7 @@
 #include "FileEntry.h"
 #include "SelectEventPoll.h"
 #include "DownloadEngine.h"
+#include "LazyRequestGroup.h"
 
 namespace aria2 {
 
@@ -23,11 +24,13 @@ class SessionSerializerTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(SessionSerializerTest);
   CPPUNIT_TEST(testSave);
   CPPUNIT_TEST(testSaveErrorDownload);
+  CPPUNIT_TEST(testSave_lazy);
   CPPUNIT_TEST_SUITE_END();
 
 public:
   void testSave();
   void testSaveErrorDownload();
+  void testSave_lazy();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SessionSerializerTest);
@@ -155,4 +158,47 @@ void SessionSerializerTest::testSaveErrorDownload()
   CPPUNIT_ASSERT_EQUAL(std::string("http://error\t"), line);
 }
 
+void SessionSerializerTest::testSave_lazy()
+{
+  auto option = std::make_shared<Option>();
+  option->put(PREF_DIR, "/tmp");
+  option->put(PREF_ENABLE_RPC, A2_V_TRUE);
+  option->put(PREF_MAX_DOWNLOAD_RESULT, "10");
+  RequestGroupMan rgman{std::vector<std::shared_ptr<RequestGroup>>{}, 1,
+                        option.get()};
+  auto globalOption = std::make_shared<Option>(*option);
+  auto requestOption = std::make_shared<Option>();
+  requestOption->setParent(globalOption);
+  requestOption->put(PREF_OUT, "lazy");
+  requestOption->put(PREF_HEADER, "X-A: 1\nX-B: 2");
+  requestOption->put(PREF_PAUSE, A2_V_TRUE);
+  auto lazy = createLazyRequestGroupForUri(
+      globalOption, requestOption,
+      {"http://localhost/file", "http://mirror/file"});
+  CPPUNIT_ASSERT(lazy);
+  auto gid = lazy->getGID();
+  rgman.addReservedGroup(std::move(lazy));
+
+  SessionSerializer s(&rgman);
+  std::string filename =
+      A2_TEST_OUT_DIR "/aria2_SessionSerializerTest_testSave_lazy";
+  s.save(filename);
+  std::ifstream ss(filename.c_str(), std::ios::binary);
+  std::string line;
+  std::getline(ss, line);
+  CPPUNIT_ASSERT_EQUAL(
+      std::string("http://localhost/file\thttp://mirror/file\t"), line);
+  std::getline(ss, line);
+  CPPUNIT_ASSERT_EQUAL(fmt(" gid=%s", GroupId::toHex(gid).c_str()), line);
+  std::getline(ss, line);
+  CPPUNIT_ASSERT_EQUAL(std::string(" pause=true"), line);
+
+  // The output must not change after the download is materialized.
+  auto hash = s.calculateHash();
+  CPPUNIT_ASSERT(!hash.empty());
+  rgman.materializeReservedGroups(0, 1);
+  CPPUNIT_ASSERT(rgman.getReservedGroups()[0]);
+  CPPUNIT_ASSERT_EQUAL(util::toHex(hash), util::toHex(s.calculateHash()));
+}
+
 } // namespace aria2
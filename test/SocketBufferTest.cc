@@ -0,0 +1,141 @@
+#include "SocketBuffer.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "SocketCore.h"
+#include "DefaultDiskWriter.h"
+#include "a2functional.h"
+#include "RecoverableException.h"
+#ifdef HAVE_SENDFILE
+#  include "FileHandle.h"
+#endif // HAVE_SENDFILE
+
+namespace aria2 {
+
+class SocketBufferTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(SocketBufferTest);
+  CPPUNIT_TEST(testSend);
+#ifdef HAVE_SENDFILE
+  CPPUNIT_TEST(testSend_fileRange);
+#endif // HAVE_SENDFILE
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testSend();
+#ifdef HAVE_SENDFILE
+  void testSend_fileRange();
+#endif // HAVE_SENDFILE
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SocketBufferTest);
+
+namespace {
+std::pair<std::shared_ptr<SocketCore>, std::shared_ptr<SocketCore>>
+createSocketPair()
+{
+  SocketCore server;
+  server.bind(0);
+  server.beginListen();
+  server.setBlockingMode();
+  auto endpoint = server.getAddrInfo();
+
+  auto client = std::make_shared<SocketCore>();
+  client->establishConnection("localhost", endpoint.port);
+  while (!client->isWritable(0)) {
+  }
+  client->setBlockingMode();
+  auto inbound = server.acceptConnection();
+  inbound->setBlockingMode();
+  return {client, inbound};
+}
+
+std::string readAll(SocketCore& socket, size_t len)
+{
+  std::string res;
+  char buf[4_k];
+  while (res.size() < len) {
+    size_t n = std::min(sizeof(buf), len - res.size());
+    socket.readData(buf, n);
+    CPPUNIT_ASSERT(n > 0);
+    res.append(buf, n);
+  }
+  return res;
+}
+} // namespace
+
+void SocketBufferTest::testSend()
+{
+  auto sockets = createSocketPair();
+  SocketBuffer buf(sockets.first);
+  buf.pushStr("hello");
+  buf.pushBytes({' ', 'w', 'o', 'r', 'l', 'd'});
+  CPPUNIT_ASSERT_EQUAL((size_t)2, buf.getBufferEntrySize());
+  CPPUNIT_ASSERT_EQUAL((ssize_t)11, buf.send());
+  CPPUNIT_ASSERT(buf.sendBufferIsEmpty());
+  CPPUNIT_ASSERT_EQUAL(std::string("hello world"),
+                       readAll(*sockets.second, 11));
+}
+
+#ifdef HAVE_SENDFILE
+namespace {
+struct CountUpdate : public ProgressUpdate {
+  CountUpdate(size_t* total) : total(total) {}
+  virtual void update(size_t length, bool complete) CXX11_OVERRIDE
+  {
+    *total += length;
+  }
+  size_t* total;
+};
+} // namespace
+
+void SocketBufferTest::testSend_fileRange()
+{
+  std::string path = A2_TEST_OUT_DIR "/aria2_SocketBufferTest_fileRange";
+  std::string data;
+  for (int i = 0; i < 4096; ++i) {
+    data += static_cast<char>('a' + i % 26);
+  }
+  {
+    DefaultDiskWriter dw(path);
+    dw.initAndOpenFile();
+    dw.writeData(reinterpret_cast<const unsigned char*>(data.data()),
+                 data.size(), 0);
+  }
+  std::shared_ptr<FileHandle> fileHandle;
+  {
+    DefaultDiskWriter dw(path);
+    CPPUNIT_ASSERT(!dw.getFileHandle(0, 100));
+    dw.openExistingFile();
+    fileHandle = dw.getFileHandle(100, 1000);
+    CPPUNIT_ASSERT(fileHandle);
+    CPPUNIT_ASSERT(fileHandle == dw.getFileHandle(0, 100));
+  }
+  // The handle outlives the DiskWriter.
+  auto sockets = createSocketPair();
+  SocketBuffer buf(sockets.first);
+  size_t total = 0;
+  buf.pushStr("head");
+  buf.pushFileRange(fileHandle, 100, 1000, make_unique<CountUpdate>(&total));
+  buf.pushFileRange(fileHandle, 0, 0);
+  buf.pushStr("tail");
+  CPPUNIT_ASSERT_EQUAL((size_t)3, buf.getBufferEntrySize());
+  CPPUNIT_ASSERT_EQUAL((ssize_t)1008, buf.send());
+  CPPUNIT_ASSERT(buf.sendBufferIsEmpty());
+  CPPUNIT_ASSERT_EQUAL((size_t)1000, total);
+  CPPUNIT_ASSERT_EQUAL("head" + data.substr(100, 1000) + "tail",
+                       readAll(*sockets.second, 1008));
+
+  // Reading beyond the end of file is an error.
+  buf.pushFileRange(fileHandle, 4000, 1000);
+  try {
+    buf.send();
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (RecoverableException& e) {
+    // success
+  }
+}
+#endif // HAVE_SENDFILE
+
+} // namespace aria2
@@ -0,0 +1,77 @@
+#include "SplicePipe.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "SocketCore.h"
+#include "DefaultDiskWriter.h"
+#include "FileHandle.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+class SplicePipeTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(SplicePipeTest);
+  CPPUNIT_TEST(testMoveTo);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testMoveTo();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SplicePipeTest);
+
+void SplicePipeTest::testMoveTo()
+{
+  std::string path = A2_TEST_OUT_DIR "/aria2_SplicePipeTest_moveTo";
+  DefaultDiskWriter dw(path);
+  dw.initAndOpenFile();
+  dw.writeData(reinterpret_cast<const unsigned char*>("0123456789"), 10, 0);
+  auto fileHandle = dw.getFileHandle(2, 5);
+  CPPUNIT_ASSERT(fileHandle);
+
+  SocketCore server;
+  server.bind(0);
+  server.beginListen();
+  server.setBlockingMode();
+  auto endpoint = server.getAddrInfo();
+  SocketCore client;
+  client.establishConnection("localhost", endpoint.port);
+  while (!client.isWritable(0)) {
+  }
+  auto inbound = server.acceptConnection();
+  inbound->setNonBlockingMode();
+
+  SplicePipe pipe;
+  CPPUNIT_ASSERT(pipe.getCapacity() >= 64_k);
+
+  // No data is available yet.
+  CPPUNIT_ASSERT_EQUAL((ssize_t)0, inbound->spliceData(pipe.getWriteFd(), 5));
+  CPPUNIT_ASSERT(inbound->wantRead());
+
+  client.writeData("abcdefgh");
+  while (!inbound->isReadable(0)) {
+  }
+  // Only the requested length is moved and the rest stays in the
+  // socket.
+  CPPUNIT_ASSERT_EQUAL((ssize_t)5, inbound->spliceData(pipe.getWriteFd(), 5));
+  CPPUNIT_ASSERT_EQUAL(0, pipe.moveTo(fileHandle->getFd(), 2, 5));
+  char buf[10];
+  CPPUNIT_ASSERT_EQUAL((ssize_t)10,
+                       dw.readData(reinterpret_cast<unsigned char*>(buf), 10,
+                                   0));
+  CPPUNIT_ASSERT_EQUAL(std::string("01abcde789"), std::string(buf, 10));
+
+  char rest[3];
+  size_t len = sizeof(rest);
+  inbound->readData(rest, len);
+  CPPUNIT_ASSERT_EQUAL(std::string("fgh"), std::string(rest, len));
+
+  client.closeConnection();
+  while (!inbound->isReadable(0)) {
+  }
+  CPPUNIT_ASSERT_EQUAL((ssize_t)0, inbound->spliceData(pipe.getWriteFd(), 5));
+  CPPUNIT_ASSERT(!inbound->wantRead());
+}
+
+} // namespace aria2
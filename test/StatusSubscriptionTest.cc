@@ -0,0 +1,176 @@
+#include "StatusSubscription.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "DownloadEngine.h"
+#include "SelectEventPoll.h"
+#include "Option.h"
+#include "RequestGroupMan.h"
+#include "RequestGroup.h"
+#include "DownloadContext.h"
+#include "prefs.h"
+#include "util.h"
+#include "fmt.h"
+
+namespace aria2 {
+
+class StatusSubscriptionTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(StatusSubscriptionTest);
+  CPPUNIT_TEST(testUpdate);
+  CPPUNIT_TEST(testUpdate_gids);
+  CPPUNIT_TEST(testUpdate_removedKey);
+  CPPUNIT_TEST(testGetTimeout);
+  CPPUNIT_TEST(testUnionKeys);
+  CPPUNIT_TEST_SUITE_END();
+
+  std::unique_ptr<DownloadEngine> e_;
+  std::shared_ptr<Option> option_;
+
+public:
+  void setUp()
+  {
+    option_ = std::make_shared<Option>();
+    option_->put(PREF_DIR, "/tmp");
+    e_ = make_unique<DownloadEngine>(make_unique<SelectEventPoll>());
+    e_->setOption(option_.get());
+    e_->setRequestGroupMan(make_unique<RequestGroupMan>(
+        std::vector<std::shared_ptr<RequestGroup>>{}, 1, option_.get()));
+  }
+
+  void testUpdate();
+  void testUpdate_gids();
+  void testUpdate_removedKey();
+  void testGetTimeout();
+  void testUnionKeys();
+
+  std::shared_ptr<RequestGroup> createGroup(int32_t pieceLength)
+  {
+    auto group =
+        std::make_shared<RequestGroup>(GroupId::create(), util::copy(option_));
+    group->setDownloadContext(
+        std::make_shared<DownloadContext>(pieceLength, 1_m, "/tmp/file"));
+    return group;
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StatusSubscriptionTest);
+
+using namespace rpc;
+
+void StatusSubscriptionTest::testUpdate()
+{
+  auto group = createGroup(100);
+  e_->getRequestGroupMan()->addRequestGroup(group);
+  auto gid = GroupId::toHex(group->getGID());
+  StatusSubscription sub({}, {"gid", "pieceLength", "dir"}, 1_s);
+  Timer now;
+  {
+    // The first update sends all the requested keys.
+    StatusSnapshot snapshot(e_.get(), sub.getKeys());
+    CPPUNIT_ASSERT_EQUAL(
+        fmt("{\"jsonrpc\":\"2.0\",\"method\":\"aria2.onStatusChange\","
+            "\"params\":[{\"gid\":\"%s\",\"pieceLength\":\"100\","
+            "\"dir\":\"\\/tmp\"}]}",
+            gid.c_str()),
+        sub.update(snapshot, now));
+  }
+  {
+    StatusSnapshot snapshot(e_.get(), sub.getKeys());
+    CPPUNIT_ASSERT_EQUAL(std::string(), sub.update(snapshot, now));
+  }
+  group->getOption()->put(PREF_DIR, "/tmp/other");
+  auto group2 = createGroup(200);
+  e_->getRequestGroupMan()->addRequestGroup(group2);
+  {
+    // Only the changes are sent, and the new download is sent in full.
+    StatusSnapshot snapshot(e_.get(), sub.getKeys());
+    CPPUNIT_ASSERT_EQUAL(
+        fmt("{\"jsonrpc\":\"2.0\",\"method\":\"aria2.onStatusChange\","
+            "\"params\":[{\"gid\":\"%s\",\"dir\":\"\\/tmp\\/other\"},"
+            "{\"gid\":\"%s\",\"pieceLength\":\"200\",\"dir\":\"\\/tmp\"}]}",
+            gid.c_str(), GroupId::toHex(group2->getGID()).c_str()),
+        sub.update(snapshot, now));
+  }
+}
+
+void StatusSubscriptionTest::testUpdate_gids()
+{
+  auto active = createGroup(100);
+  e_->getRequestGroupMan()->addRequestGroup(active);
+  auto waiting = createGroup(200);
+  e_->getRequestGroupMan()->addReservedGroup(waiting);
+  // Downloads which do not exist are ignored.
+  StatusSubscription sub({waiting->getGID(), GroupId::create()->getNumericId()},
+                         {"status"}, 1_s);
+  // The keys of the snapshot may include the ones other subscriptions
+  // request.
+  StatusSnapshot snapshot(e_.get(), {"status", "pieceLength"});
+  CPPUNIT_ASSERT_EQUAL(
+      fmt("{\"jsonrpc\":\"2.0\",\"method\":\"aria2.onStatusChange\","
+          "\"params\":[{\"gid\":\"%s\",\"status\":\"waiting\"}]}",
+          GroupId::toHex(waiting->getGID()).c_str()),
+      sub.update(snapshot, Timer()));
+  CPPUNIT_ASSERT(snapshot.get(active->getGID()));
+  CPPUNIT_ASSERT(!snapshot.get(GroupId::create()->getNumericId()));
+}
+
+void StatusSubscriptionTest::testUpdate_removedKey()
+{
+  auto group = createGroup(100);
+  group->following(GroupId::create()->getNumericId());
+  e_->getRequestGroupMan()->addRequestGroup(group);
+  auto gid = GroupId::toHex(group->getGID());
+  StatusSubscription sub({}, {"following"}, 1_s);
+  {
+    StatusSnapshot snapshot(e_.get(), sub.getKeys());
+    CPPUNIT_ASSERT_EQUAL(
+        fmt("{\"jsonrpc\":\"2.0\",\"method\":\"aria2.onStatusChange\","
+            "\"params\":[{\"gid\":\"%s\",\"following\":\"%s\"}]}",
+            gid.c_str(), GroupId::toHex(group->following()).c_str()),
+        sub.update(snapshot, Timer()));
+  }
+  group->following(0);
+  {
+    // The key which is gone is sent as null.
+    StatusSnapshot snapshot(e_.get(), sub.getKeys());
+    CPPUNIT_ASSERT_EQUAL(
+        fmt("{\"jsonrpc\":\"2.0\",\"method\":\"aria2.onStatusChange\","
+            "\"params\":[{\"gid\":\"%s\",\"following\":null}]}",
+            gid.c_str()),
+        sub.update(snapshot, Timer()));
+  }
+  {
+    StatusSnapshot snapshot(e_.get(), sub.getKeys());
+    CPPUNIT_ASSERT_EQUAL(std::string(), sub.update(snapshot, Timer()));
+  }
+}
+
+void StatusSubscriptionTest::testGetTimeout()
+{
+  StatusSubscription sub({}, {}, 1_s);
+  Timer now;
+  CPPUNIT_ASSERT(std::chrono::milliseconds(0) == sub.getTimeout(now));
+  StatusSnapshot snapshot(e_.get(), {});
+  sub.update(snapshot, now);
+  CPPUNIT_ASSERT(std::chrono::milliseconds(1_s) == sub.getTimeout(now));
+  now.advance(600_ms);
+  CPPUNIT_ASSERT(std::chrono::milliseconds(400) == sub.getTimeout(now));
+  now.advance(400_ms);
+  CPPUNIT_ASSERT(std::chrono::milliseconds(0) == sub.getTimeout(now));
+}
+
+void StatusSubscriptionTest::testUnionKeys()
+{
+  StatusSubscription a({}, {"gid", "status"}, 1_s);
+  StatusSubscription b({}, {"totalLength", "gid"}, 1_s);
+  StatusSubscription all({}, {}, 1_s);
+  auto keys = StatusSubscription::unionKeys({&a, &b});
+  CPPUNIT_ASSERT_EQUAL((size_t)3, keys.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("gid"), keys[0]);
+  CPPUNIT_ASSERT_EQUAL(std::string("status"), keys[1]);
+  CPPUNIT_ASSERT_EQUAL(std::string("totalLength"), keys[2]);
+  CPPUNIT_ASSERT(StatusSubscription::unionKeys({&a, &all}).empty());
+}
+
+} // namespace aria2
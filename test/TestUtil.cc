@@ -95,7 +95,7 @@ WrDiskCacheEntry::DataCell* createDataCell(int64_t goff, const char* data,
 std::shared_ptr<RequestGroup> findReservedGroup(RequestGroupMan* rgman,
                                                 a2_gid_t gid)
 {
-  auto rg = rgman->findGroup(gid);
+  auto rg = rgman->materializeGroup(gid);
   if (rg) {
     if (rg->getState() == RequestGroup::STATE_WAITING) {
       return rg;
@@ -111,6 +111,7 @@ std::shared_ptr<RequestGroup> getReservedGroup(RequestGroupMan* rgman,
                                                size_t index)
 {
   assert(rgman->getReservedGroups().size() > index);
+  rgman->materializeReservedGroups(index, index + 1);
   auto i = rgman->getReservedGroups().begin();
   std::advance(i, index);
   return *i;
@@ -0,0 +1,177 @@
+#include "TimerWheel.h"
+
+#include <memory>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace aria2 {
+
+class TimerWheelTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(TimerWheelTest);
+  CPPUNIT_TEST(testExpire);
+  CPPUNIT_TEST(testExpire_cascade);
+  CPPUNIT_TEST(testExpire_farFuture);
+  CPPUNIT_TEST(testCancel);
+  CPPUNIT_TEST(testGetNextTimeout);
+  CPPUNIT_TEST(testClear);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testExpire();
+  void testExpire_cascade();
+  void testExpire_farFuture();
+  void testCancel();
+  void testGetNextTimeout();
+  void testClear();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TimerWheelTest);
+
+namespace {
+Timer at(int64_t millis)
+{
+  // Aligned to the tick, but not to the root wheel.
+  return Timer(std::chrono::milliseconds(1000030 + millis));
+}
+} // namespace
+
+void TimerWheelTest::testExpire()
+{
+  TimerWheel wheel(10_ms, at(0));
+  TimerWheel::Entry e1, e2, e3;
+  wheel.schedule(&e1, at(0), 100_ms);
+  wheel.schedule(&e2, at(0), 0_ms);
+  wheel.schedule(&e3, at(0), 105_ms);
+  CPPUNIT_ASSERT_EQUAL((size_t)3, wheel.size());
+
+  std::vector<TimerWheel::Entry*> out;
+  wheel.expire(out, at(10));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, out.size());
+  CPPUNIT_ASSERT(&e2 == out[0]);
+  CPPUNIT_ASSERT(!e2.isTimerScheduled());
+
+  out.clear();
+  wheel.expire(out, at(99));
+  CPPUNIT_ASSERT(out.empty());
+  wheel.expire(out, at(100));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, out.size());
+  CPPUNIT_ASSERT(&e1 == out[0]);
+
+  out.clear();
+  // Never expires before its deadline.
+  wheel.expire(out, at(104));
+  CPPUNIT_ASSERT(out.empty());
+  wheel.expire(out, at(200));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, out.size());
+  CPPUNIT_ASSERT(&e3 == out[0]);
+  CPPUNIT_ASSERT(wheel.empty());
+}
+
+void TimerWheelTest::testExpire_cascade()
+{
+  TimerWheel wheel(10_ms, at(0));
+  std::vector<std::unique_ptr<TimerWheel::Entry>> entries;
+  // 3s, 60s, 200s and 3h later; they are in different wheels.
+  std::vector<int64_t> timeouts{3000, 60000, 200000, 10800000};
+  for (auto t : timeouts) {
+    entries.push_back(make_unique<TimerWheel::Entry>());
+    wheel.schedule(entries.back().get(), at(0), std::chrono::milliseconds(t));
+  }
+  std::vector<TimerWheel::Entry*> out;
+  for (size_t i = 0; i < timeouts.size(); ++i) {
+    out.clear();
+    wheel.expire(out, at(timeouts[i] - 10));
+    CPPUNIT_ASSERT(out.empty());
+    wheel.expire(out, at(timeouts[i]));
+    CPPUNIT_ASSERT_EQUAL((size_t)1, out.size());
+    CPPUNIT_ASSERT(entries[i].get() == out[0]);
+  }
+  CPPUNIT_ASSERT(wheel.empty());
+}
+
+void TimerWheelTest::testExpire_farFuture()
+{
+  TimerWheel wheel(10_ms, at(0));
+  TimerWheel::Entry e;
+  // Beyond the range of the top level wheel.
+  auto day = std::chrono::milliseconds(24_h);
+  wheel.schedule(&e, at(0), day * 10);
+  std::vector<TimerWheel::Entry*> out;
+  for (int i = 1; i < 10; ++i) {
+    wheel.expire(out, at(day.count() * i));
+    CPPUNIT_ASSERT(out.empty());
+  }
+  wheel.expire(out, at(day.count() * 10 - 10));
+  CPPUNIT_ASSERT(out.empty());
+  wheel.expire(out, at(day.count() * 10));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, out.size());
+}
+
+void TimerWheelTest::testCancel()
+{
+  TimerWheel wheel(10_ms, at(0));
+  TimerWheel::Entry e1, e2;
+  wheel.schedule(&e1, at(0), 100_ms);
+  {
+    TimerWheel::Entry e3;
+    wheel.schedule(&e3, at(0), 100_ms);
+    wheel.schedule(&e2, at(0), 100_ms);
+    CPPUNIT_ASSERT_EQUAL((size_t)3, wheel.size());
+  }
+  // e3 was removed by its destructor.
+  CPPUNIT_ASSERT_EQUAL((size_t)2, wheel.size());
+  e1.cancelTimer();
+  CPPUNIT_ASSERT(!e1.isTimerScheduled());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, wheel.size());
+  // Rescheduling replaces the previous deadline.
+  wheel.schedule(&e2, at(0), 1_s);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, wheel.size());
+
+  std::vector<TimerWheel::Entry*> out;
+  wheel.expire(out, at(500));
+  CPPUNIT_ASSERT(out.empty());
+  wheel.expire(out, at(1000));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, out.size());
+  CPPUNIT_ASSERT(&e2 == out[0]);
+}
+
+void TimerWheelTest::testGetNextTimeout()
+{
+  TimerWheel wheel(10_ms, at(0));
+  CPPUNIT_ASSERT_EQUAL((int64_t)1000,
+                       (int64_t)wheel.getNextTimeout(at(0), 1_s).count());
+  TimerWheel::Entry e1, e2;
+  wheel.schedule(&e1, at(0), 300_ms);
+  wheel.schedule(&e2, at(0), 1_h);
+  auto t = wheel.getNextTimeout(at(0), 1_s);
+  CPPUNIT_ASSERT(t >= 300_ms);
+  CPPUNIT_ASSERT(t <= 310_ms);
+  CPPUNIT_ASSERT_EQUAL((int64_t)200,
+                       (int64_t)wheel.getNextTimeout(at(0), 200_ms).count());
+  CPPUNIT_ASSERT_EQUAL((int64_t)0,
+                       (int64_t)wheel.getNextTimeout(at(400), 1_s).count());
+
+  std::vector<TimerWheel::Entry*> out;
+  wheel.expire(out, at(400));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, out.size());
+  // e2 is in the upper wheel, so the next wrap around of the root
+  // wheel is reported.
+  t = wheel.getNextTimeout(at(400), 10_s);
+  CPPUNIT_ASSERT(t > 0_ms);
+  CPPUNIT_ASSERT(t <= 2560_ms);
+}
+
+void TimerWheelTest::testClear()
+{
+  TimerWheel wheel(10_ms, at(0));
+  TimerWheel::Entry e1, e2;
+  wheel.schedule(&e1, at(0), 100_ms);
+  wheel.schedule(&e2, at(0), 1_h);
+  wheel.clear();
+  CPPUNIT_ASSERT(wheel.empty());
+  CPPUNIT_ASSERT(!e1.isTimerScheduled());
+  CPPUNIT_ASSERT(!e2.isTimerScheduled());
+}
+
+} // namespace aria2
@@ -0,0 +1,150 @@
+#include "Tracer.h"
+
+#include <algorithm>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "TestUtil.h"
+#include "Command.h"
+#include "ValueBase.h"
+#include "ValueBaseJsonParser.h"
+
+namespace aria2 {
+
+class TracerTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(TracerTest);
+  CPPUNIT_TEST(testAddSpan);
+  CPPUNIT_TEST(testAddSpan_flush);
+  CPPUNIT_TEST(testAddCommandSpan);
+  CPPUNIT_TEST(testTraceSpan);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testAddSpan();
+  void testAddSpan_flush();
+  void testAddCommandSpan();
+  void testTraceSpan();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TracerTest);
+
+namespace {
+class TraceTestCommand : public Command {
+public:
+  TraceTestCommand() : Command(7) {}
+  virtual bool execute() CXX11_OVERRIDE { return true; }
+};
+
+std::unique_ptr<ValueBase> parseTrace(const std::string& path)
+{
+  auto src = readFile(path);
+  json::ValueBaseJsonParser parser;
+  ssize_t error;
+  return parser.parseFinal(src.c_str(), src.size(), error);
+}
+} // namespace
+
+void TracerTest::testAddSpan()
+{
+  std::string path = A2_TEST_OUT_DIR "/aria2_TracerTest_testAddSpan.json";
+  {
+    Tracer tracer(path);
+    auto start = Tracer::Clock::now();
+    tracer.addSpan("disk", "write", start,
+                   start + std::chrono::microseconds(1500));
+    tracer.addSpan("dns", "resolve", start, start, "aria2.\"example\"");
+  }
+  auto r = parseTrace(path);
+  auto events = downcast<List>(r);
+  CPPUNIT_ASSERT(events);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, events->size());
+
+  auto ev = downcast<Dict>(events->get(0));
+  CPPUNIT_ASSERT_EQUAL(std::string("write"),
+                       downcast<String>(ev->get("name"))->s());
+  CPPUNIT_ASSERT_EQUAL(std::string("disk"),
+                       downcast<String>(ev->get("cat"))->s());
+  CPPUNIT_ASSERT_EQUAL(std::string("X"), downcast<String>(ev->get("ph"))->s());
+  CPPUNIT_ASSERT_EQUAL((Integer::ValueType)1500,
+                       downcast<Integer>(ev->get("dur"))->i());
+  CPPUNIT_ASSERT(!ev->containsKey("args"));
+
+  ev = downcast<Dict>(events->get(1));
+  CPPUNIT_ASSERT_EQUAL(
+      std::string("aria2.\"example\""),
+      downcast<String>(downcast<Dict>(ev->get("args"))->get("detail"))->s());
+}
+
+void TracerTest::testAddSpan_flush()
+{
+  std::string path =
+      A2_TEST_OUT_DIR "/aria2_TracerTest_testAddSpan_flush.json";
+  {
+    Tracer tracer(path, 2);
+    auto start = Tracer::Clock::now();
+    for (int i = 0; i < 5; ++i) {
+      tracer.addSpan("engine", "poll", start, start);
+    }
+    // The first 4 events were written out when the buffer was full.
+    auto src = readFile(path);
+    CPPUNIT_ASSERT_EQUAL((size_t)4, (size_t)std::count(src.begin(), src.end(),
+                                                        '{'));
+  }
+  auto r = parseTrace(path);
+  auto events = downcast<List>(r);
+  CPPUNIT_ASSERT(events);
+  CPPUNIT_ASSERT_EQUAL((size_t)5, events->size());
+}
+
+void TracerTest::testAddCommandSpan()
+{
+  std::string path =
+      A2_TEST_OUT_DIR "/aria2_TracerTest_testAddCommandSpan.json";
+  {
+    Tracer tracer(path);
+    TraceTestCommand command;
+    auto start = Tracer::Clock::now();
+    tracer.addCommandSpan(&command, start, start);
+  }
+  auto r = parseTrace(path);
+  auto events = downcast<List>(r);
+  CPPUNIT_ASSERT(events);
+  auto ev = downcast<Dict>(events->get(0));
+  auto& name = downcast<String>(ev->get("name"))->s();
+  CPPUNIT_ASSERT(name.find("TraceTestCommand") != std::string::npos);
+  CPPUNIT_ASSERT_EQUAL(std::string("command"),
+                       downcast<String>(ev->get("cat"))->s());
+  CPPUNIT_ASSERT_EQUAL(
+      std::string("CUID#7"),
+      downcast<String>(downcast<Dict>(ev->get("args"))->get("detail"))->s());
+}
+
+void TracerTest::testTraceSpan()
+{
+  std::string path = A2_TEST_OUT_DIR "/aria2_TracerTest_testTraceSpan.json";
+  {
+    // Nothing is recorded without the active Tracer.
+    TraceSpan span("rpc", "aria2.tellActive");
+  }
+  {
+    Tracer tracer(path);
+    Tracer::setInstance(&tracer);
+    {
+      TraceSpan span("rpc", "execute", "aria2.tellActive");
+    }
+    Tracer::setInstance(nullptr);
+  }
+  auto r = parseTrace(path);
+  auto events = downcast<List>(r);
+  CPPUNIT_ASSERT(events);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, events->size());
+  auto ev = downcast<Dict>(events->get(0));
+  CPPUNIT_ASSERT_EQUAL(std::string("rpc"),
+                       downcast<String>(ev->get("cat"))->s());
+  CPPUNIT_ASSERT_EQUAL(
+      std::string("aria2.tellActive"),
+      downcast<String>(downcast<Dict>(ev->get("args"))->get("detail"))->s());
+}
+
+} // namespace aria2
@@ -0,0 +1,331 @@
+#include "UtpConnection.h"
+
+#include <cstring>
+#include <algorithm>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace aria2 {
+
+class UtpConnectionTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(UtpConnectionTest);
+  CPPUNIT_TEST(testParseUtpHeader);
+  CPPUNIT_TEST(testConnect);
+  CPPUNIT_TEST(testConnect_timeout);
+  CPPUNIT_TEST(testWrite);
+  CPPUNIT_TEST(testWrite_reordered);
+  CPPUNIT_TEST(testFastRetransmit);
+  CPPUNIT_TEST(testRetransmitTimeout);
+  CPPUNIT_TEST(testLedbat);
+  CPPUNIT_TEST(testClose);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testParseUtpHeader();
+  void testConnect();
+  void testConnect_timeout();
+  void testWrite();
+  void testWrite_reordered();
+  void testFastRetransmit();
+  void testRetransmitTimeout();
+  void testLedbat();
+  void testClose();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UtpConnectionTest);
+
+namespace {
+Timer at(int64_t millis)
+{
+  return Timer(std::chrono::milliseconds(1000000 + millis));
+}
+
+// Delivers the outgoing packets of from to to.  The packets whose
+// index is in drop are lost.  Returns the number of packets.
+size_t transfer(UtpConnection& from, UtpConnection& to, const Timer& now,
+                std::vector<size_t> drop = {})
+{
+  auto& packets = from.getOutgoingPackets();
+  size_t num = packets.size();
+  for (size_t i = 0; i < num; ++i) {
+    if (std::find(std::begin(drop), std::end(drop), i) != std::end(drop)) {
+      continue;
+    }
+    UtpHeader hdr;
+    auto offset = parseUtpHeader(hdr, packets[i].data(), packets[i].size());
+    CPPUNIT_ASSERT(offset >= 0);
+    to.receivePacket(hdr, packets[i].data() + offset,
+                     packets[i].size() - offset, now);
+  }
+  packets.clear();
+  return num;
+}
+
+void establish(UtpConnection& a, UtpConnection& b, const Timer& now)
+{
+  a.connect(now);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, a.getOutgoingPackets().size());
+  UtpHeader syn;
+  auto& packet = a.getOutgoingPackets().front();
+  CPPUNIT_ASSERT_EQUAL((ssize_t)UTP_HEADER_LENGTH,
+                       parseUtpHeader(syn, packet.data(), packet.size()));
+  a.getOutgoingPackets().clear();
+  b.accept(syn, now);
+  transfer(b, a, now);
+}
+
+std::string read(UtpConnection& c)
+{
+  std::string s(c.getReceivedData(),
+                c.getReceivedData() + c.getReceivedDataLength());
+  c.consumeReceivedData(s.size());
+  return s;
+}
+} // namespace
+
+void UtpConnectionTest::testParseUtpHeader()
+{
+  UtpHeader hdr{UTP_ST_DATA, 1000, 0x01020304, 0x05060708, 65536, 65535, 7};
+  unsigned char data[UTP_HEADER_LENGTH + 10];
+  packUtpHeader(data, hdr);
+  CPPUNIT_ASSERT_EQUAL((unsigned char)0x01, data[0]);
+  UtpHeader res;
+  CPPUNIT_ASSERT_EQUAL((ssize_t)UTP_HEADER_LENGTH,
+                       parseUtpHeader(res, data, UTP_HEADER_LENGTH));
+  CPPUNIT_ASSERT_EQUAL((int)UTP_ST_DATA, (int)res.type);
+  CPPUNIT_ASSERT_EQUAL((uint16_t)1000, res.connectionId);
+  CPPUNIT_ASSERT_EQUAL((uint32_t)0x01020304, res.timestamp);
+  CPPUNIT_ASSERT_EQUAL((uint32_t)0x05060708, res.timestampDiff);
+  CPPUNIT_ASSERT_EQUAL((uint32_t)65536, res.windowSize);
+  CPPUNIT_ASSERT_EQUAL((uint16_t)65535, res.seqNr);
+  CPPUNIT_ASSERT_EQUAL((uint16_t)7, res.ackNr);
+
+  // Selective ACK extension is skipped.
+  data[1] = 1;
+  data[UTP_HEADER_LENGTH] = 0;
+  data[UTP_HEADER_LENGTH + 1] = 4;
+  CPPUNIT_ASSERT_EQUAL((ssize_t)UTP_HEADER_LENGTH + 6,
+                       parseUtpHeader(res, data, sizeof(data)));
+  CPPUNIT_ASSERT_EQUAL((ssize_t)-1,
+                       parseUtpHeader(res, data, UTP_HEADER_LENGTH + 5));
+
+  // Version 0 and the unknown type.
+  data[1] = 0;
+  data[0] = 0x00;
+  CPPUNIT_ASSERT_EQUAL((ssize_t)-1, parseUtpHeader(res, data, sizeof(data)));
+  data[0] = 0x51;
+  CPPUNIT_ASSERT_EQUAL((ssize_t)-1, parseUtpHeader(res, data, sizeof(data)));
+  data[0] = 0x41;
+  CPPUNIT_ASSERT_EQUAL((ssize_t)-1, parseUtpHeader(res, data, 19));
+}
+
+void UtpConnectionTest::testConnect()
+{
+  UtpConnection a(100, 101, at(0));
+  UtpConnection b(101, 100, at(0));
+  a.connect(at(0));
+  CPPUNIT_ASSERT_EQUAL(UTP_CS_SYN_SENT, a.getState());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, a.getSendWindow());
+  auto& packet = a.getOutgoingPackets().front();
+  UtpHeader syn;
+  parseUtpHeader(syn, packet.data(), packet.size());
+  CPPUNIT_ASSERT_EQUAL((int)UTP_ST_SYN, (int)syn.type);
+  // SYN carries the ID of the packets sent to the initiator.
+  CPPUNIT_ASSERT_EQUAL((uint16_t)100, syn.connectionId);
+  a.getOutgoingPackets().clear();
+
+  b.accept(syn, at(0));
+  CPPUNIT_ASSERT_EQUAL(UTP_CS_CONNECTED, b.getState());
+  // Duplicate SYN is acknowledged again.
+  b.receivePacket(syn, nullptr, 0, at(1));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, transfer(b, a, at(10)));
+  CPPUNIT_ASSERT_EQUAL(UTP_CS_CONNECTED, a.getState());
+  CPPUNIT_ASSERT(a.getRtt() >= 9);
+  CPPUNIT_ASSERT(a.getSendWindow() > 0);
+}
+
+void UtpConnectionTest::testConnect_timeout()
+{
+  UtpConnection a(100, 101, at(0));
+  a.connect(at(0));
+  a.handleTimeout(at(999));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, a.getOutgoingPackets().size());
+  a.handleTimeout(at(1000));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, a.getOutgoingPackets().size());
+  // RTO is doubled.
+  a.handleTimeout(at(2999));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, a.getOutgoingPackets().size());
+  a.handleTimeout(at(3000));
+  CPPUNIT_ASSERT_EQUAL((size_t)3, a.getOutgoingPackets().size());
+  CPPUNIT_ASSERT_EQUAL(UTP_CS_SYN_SENT, a.getState());
+  a.handleTimeout(at(7000));
+  CPPUNIT_ASSERT_EQUAL(UTP_CS_CLOSED, a.getState());
+}
+
+void UtpConnectionTest::testWrite()
+{
+  UtpConnection a(100, 101, at(0));
+  UtpConnection b(101, 100, at(0));
+  establish(a, b, at(0));
+  std::string data(3 * UTP_MAX_PAYLOAD_LENGTH + 10, 'a');
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] += i % 26;
+  }
+  auto window = a.getSendWindow();
+  a.write(reinterpret_cast<const unsigned char*>(data.data()), data.size(),
+          at(1));
+  CPPUNIT_ASSERT_EQUAL(data.size(), a.getBytesInFlight());
+  CPPUNIT_ASSERT_EQUAL(window - data.size(), a.getSendWindow());
+  CPPUNIT_ASSERT_EQUAL((size_t)4, transfer(a, b, at(2)));
+  CPPUNIT_ASSERT_EQUAL(data, read(b));
+  b.sendAck(at(2));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, transfer(b, a, at(3)));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, a.getBytesInFlight());
+
+  // The other direction
+  b.write(reinterpret_cast<const unsigned char*>("hello"), 5, at(4));
+  transfer(b, a, at(5));
+  CPPUNIT_ASSERT_EQUAL(std::string("hello"), read(a));
+  // No ACK is sent if nothing is received.
+  a.sendAck(at(5));
+  a.sendAck(at(5));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, transfer(a, b, at(6)));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, b.getBytesInFlight());
+}
+
+void UtpConnectionTest::testWrite_reordered()
+{
+  UtpConnection a(100, 101, at(0));
+  UtpConnection b(101, 100, at(0));
+  establish(a, b, at(0));
+  std::string data(3 * UTP_MAX_PAYLOAD_LENGTH, 'a');
+  data[UTP_MAX_PAYLOAD_LENGTH] = 'b';
+  data[2 * UTP_MAX_PAYLOAD_LENGTH] = 'c';
+  a.write(reinterpret_cast<const unsigned char*>(data.data()), data.size(),
+          at(1));
+  auto& packets = a.getOutgoingPackets();
+  std::swap(packets[0], packets[2]);
+  transfer(a, b, at(2));
+  CPPUNIT_ASSERT_EQUAL(data, read(b));
+}
+
+void UtpConnectionTest::testFastRetransmit()
+{
+  UtpConnection a(100, 101, at(0));
+  UtpConnection b(101, 100, at(0));
+  establish(a, b, at(0));
+  std::string data(5 * UTP_MAX_PAYLOAD_LENGTH, 'x');
+  a.write(reinterpret_cast<const unsigned char*>(data.data()), data.size(),
+          at(1));
+  auto window = a.getWindow();
+  transfer(a, b, at(2), {0});
+  CPPUNIT_ASSERT_EQUAL((size_t)0, b.getReceivedDataLength());
+  // Each packet after the lost one is acknowledged with the same
+  // ack_nr.
+  CPPUNIT_ASSERT_EQUAL((size_t)4, transfer(b, a, at(3)));
+  CPPUNIT_ASSERT(a.getWindow() < window);
+  // The lost packet is sent again.
+  CPPUNIT_ASSERT_EQUAL((size_t)1, transfer(a, b, at(4)));
+  CPPUNIT_ASSERT_EQUAL(data, read(b));
+  b.sendAck(at(4));
+  transfer(b, a, at(5));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, a.getBytesInFlight());
+}
+
+void UtpConnectionTest::testRetransmitTimeout()
+{
+  UtpConnection a(100, 101, at(0));
+  UtpConnection b(101, 100, at(0));
+  establish(a, b, at(100));
+  a.write(reinterpret_cast<const unsigned char*>("hello"), 5, at(200));
+  a.getOutgoingPackets().clear();
+  // RTO is at least 500ms.
+  a.handleTimeout(at(699));
+  CPPUNIT_ASSERT(a.getOutgoingPackets().empty());
+  a.handleTimeout(at(700));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, transfer(a, b, at(701)));
+  CPPUNIT_ASSERT_EQUAL(std::string("hello"), read(b));
+  b.sendAck(at(701));
+  transfer(b, a, at(702));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, a.getBytesInFlight());
+
+  // Without response, the connection is closed.
+  a.write(reinterpret_cast<const unsigned char*>("hello"), 5, at(800));
+  for (int i = 1; i < 100 && a.getState() != UTP_CS_CLOSED; ++i) {
+    a.handleTimeout(at(800 + i * 1000));
+  }
+  CPPUNIT_ASSERT_EQUAL(UTP_CS_CLOSED, a.getState());
+}
+
+void UtpConnectionTest::testLedbat()
+{
+  UtpConnection a(100, 101, at(0));
+  UtpConnection b(101, 100, at(0));
+  establish(a, b, at(0));
+  std::vector<unsigned char> data(UTP_MAX_PAYLOAD_LENGTH);
+  uint16_t lastSeqNr = 0;
+  // Sends packets as many as the window allows.
+  auto fill = [&](int64_t t) {
+    while (a.getSendWindow() >= data.size()) {
+      a.write(data.data(), data.size(), at(t));
+    }
+    auto& packets = a.getOutgoingPackets();
+    UtpHeader hdr;
+    parseUtpHeader(hdr, packets.back().data(), packets.back().size());
+    lastSeqNr = hdr.seqNr;
+    packets.clear();
+  };
+  // Acknowledges all packets in flight.  The remote peer measured
+  // the one way delay in microseconds.
+  auto acknowledge = [&](uint32_t delay, int64_t t) {
+    UtpHeader hdr{UTP_ST_STATE, 100, 0, delay, 1000000, 0, lastSeqNr};
+    a.receivePacket(hdr, nullptr, 0, at(t));
+    CPPUNIT_ASSERT_EQUAL((size_t)0, a.getBytesInFlight());
+  };
+  // The queuing delay is below the target: the window grows.
+  size_t window = a.getWindow();
+  for (int i = 0; i < 5; ++i) {
+    fill(i * 10);
+    acknowledge(50000 + i * 1000, i * 10 + 5);
+    CPPUNIT_ASSERT(a.getWindow() > window);
+    window = a.getWindow();
+  }
+  CPPUNIT_ASSERT_EQUAL((uint32_t)4000, a.getQueuingDelay());
+  // The queuing delay goes beyond the target: the window shrinks.
+  for (int i = 0; i < 5; ++i) {
+    fill(100 + i * 10);
+    acknowledge(250000, 100 + i * 10 + 5);
+    CPPUNIT_ASSERT(a.getWindow() < window);
+    window = a.getWindow();
+  }
+  CPPUNIT_ASSERT_EQUAL((uint32_t)200000, a.getQueuingDelay());
+  // The base delay is the lowest one.
+  fill(200);
+  acknowledge(40000, 205);
+  CPPUNIT_ASSERT_EQUAL((uint32_t)0, a.getQueuingDelay());
+  CPPUNIT_ASSERT(a.getWindow() > window);
+}
+
+void UtpConnectionTest::testClose()
+{
+  UtpConnection a(100, 101, at(0));
+  UtpConnection b(101, 100, at(0));
+  establish(a, b, at(0));
+  a.write(reinterpret_cast<const unsigned char*>("bye"), 3, at(1));
+  a.close(at(1));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, a.getSendWindow());
+  // FIN arrives before data.
+  std::swap(a.getOutgoingPackets()[0], a.getOutgoingPackets()[1]);
+  transfer(a, b, at(2));
+  CPPUNIT_ASSERT(b.isEofReceived());
+  CPPUNIT_ASSERT_EQUAL(std::string("bye"), read(b));
+  b.sendAck(at(2));
+  transfer(b, a, at(3));
+  CPPUNIT_ASSERT(a.isFinAcked());
+  b.close(at(3));
+  transfer(b, a, at(4));
+  CPPUNIT_ASSERT(a.isEofReceived());
+}
+
+} // namespace aria2
@@ -0,0 +1,229 @@
+#include "UtpSocketManager.h"
+
+#include <cstring>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "SocketCore.h"
+#include "Command.h"
+
+namespace aria2 {
+
+class UtpSocketManagerTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(UtpSocketManagerTest);
+  CPPUNIT_TEST(testIsUtpPacket);
+  CPPUNIT_TEST(testConnect);
+  CPPUNIT_TEST(testConnect_timeout);
+  CPPUNIT_TEST(testTransfer);
+  CPPUNIT_TEST(testClose);
+  CPPUNIT_TEST(testReset);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testIsUtpPacket();
+  void testConnect();
+  void testConnect_timeout();
+  void testTransfer();
+  void testClose();
+  void testReset();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UtpSocketManagerTest);
+
+namespace {
+Timer at(int64_t millis)
+{
+  return Timer(std::chrono::milliseconds(1000000 + millis));
+}
+
+// Sends the pending packets of from to to, as if from is bound to
+// fromPort and to is bound to toPort.  Returns the number of packets.
+size_t transfer(UtpSocketManager& from, uint16_t fromPort,
+                UtpSocketManager& to, uint16_t toPort, const Timer& now)
+{
+  size_t num = 0;
+  while (!from.getPendingPackets().empty()) {
+    auto& packet = from.getPendingPackets().front();
+    CPPUNIT_ASSERT_EQUAL(std::string("127.0.0.1"), packet.remoteAddr);
+    CPPUNIT_ASSERT_EQUAL(toPort, packet.remotePort);
+    to.receivePacket(packet.data.data(), packet.data.size(), "127.0.0.1",
+                     fromPort, now);
+    from.packetSent();
+    ++num;
+  }
+  return num;
+}
+
+// Runs both managers until no packet is exchanged.
+void run(UtpSocketManager& a, UtpSocketManager& b, const Timer& now)
+{
+  for (int i = 0; i < 1000; ++i) {
+    a.process(now);
+    b.process(now);
+    if (transfer(a, 6881, b, 6882, now) + transfer(b, 6882, a, 6881, now) ==
+        0) {
+      return;
+    }
+  }
+  CPPUNIT_FAIL("Too many iterations");
+}
+
+class WaiterCommand : public Command {
+public:
+  WaiterCommand() : Command(1) {}
+  virtual bool execute() CXX11_OVERRIDE { return true; }
+};
+
+std::string readAll(const std::shared_ptr<SocketCore>& socket)
+{
+  std::string res;
+  char buf[4096];
+  for (;;) {
+    size_t len = sizeof(buf);
+    socket->readData(buf, len);
+    if (len == 0) {
+      break;
+    }
+    res.append(buf, len);
+  }
+  return res;
+}
+} // namespace
+
+void UtpSocketManagerTest::testIsUtpPacket()
+{
+  unsigned char data[20] = {0x41};
+  CPPUNIT_ASSERT(UtpSocketManager::isUtpPacket(data, sizeof(data)));
+  CPPUNIT_ASSERT(!UtpSocketManager::isUtpPacket(data, 19));
+  data[0] = 'd';
+  CPPUNIT_ASSERT(!UtpSocketManager::isUtpPacket(data, sizeof(data)));
+  // UDP tracker response
+  data[0] = 0;
+  CPPUNIT_ASSERT(!UtpSocketManager::isUtpPacket(data, sizeof(data)));
+}
+
+void UtpSocketManagerTest::testConnect()
+{
+  UtpSocketManager a, b;
+  auto socket = a.connect("127.0.0.1", 6882, at(0));
+  WaiterCommand waiter;
+  a.setConnectWaiter(socket, &waiter);
+  CPPUNIT_ASSERT_EQUAL(UTP_CS_SYN_SENT, a.getConnectionState(socket));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, transfer(a, 6881, b, 6882, at(1)));
+  a.process(at(1));
+  CPPUNIT_ASSERT(!waiter.statusMatch(Command::STATUS_ACTIVE));
+  std::shared_ptr<SocketCore> accepted;
+  std::string remoteAddr;
+  uint16_t remotePort;
+  CPPUNIT_ASSERT(b.popAcceptedConnection(accepted, remoteAddr, remotePort));
+  CPPUNIT_ASSERT_EQUAL(std::string("127.0.0.1"), remoteAddr);
+  CPPUNIT_ASSERT_EQUAL((uint16_t)6881, remotePort);
+  CPPUNIT_ASSERT(!b.popAcceptedConnection(accepted, remoteAddr, remotePort));
+  CPPUNIT_ASSERT_EQUAL(UTP_CS_CONNECTED, b.getConnectionState(accepted));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, transfer(b, 6882, a, 6881, at(2)));
+  CPPUNIT_ASSERT_EQUAL(UTP_CS_CONNECTED, a.getConnectionState(socket));
+  a.process(at(2));
+  CPPUNIT_ASSERT(waiter.statusMatch(Command::STATUS_ACTIVE));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, a.countConnection());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, b.countConnection());
+}
+
+void UtpSocketManagerTest::testConnect_timeout()
+{
+  UtpSocketManager a;
+  auto socket = a.connect("127.0.0.1", 6882, at(0));
+  WaiterCommand waiter;
+  a.setConnectWaiter(socket, &waiter);
+  for (int i = 0; i < 10; ++i) {
+    a.process(at(i * 1000));
+  }
+  CPPUNIT_ASSERT(waiter.statusMatch(Command::STATUS_ACTIVE));
+  CPPUNIT_ASSERT_EQUAL((size_t)3, a.getPendingPackets().size());
+  CPPUNIT_ASSERT_EQUAL(UTP_CS_CLOSED, a.getConnectionState(socket));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, a.countConnection());
+}
+
+void UtpSocketManagerTest::testTransfer()
+{
+  UtpSocketManager a, b;
+  auto socket = a.connect("127.0.0.1", 6882, at(0));
+  run(a, b, at(0));
+  std::shared_ptr<SocketCore> accepted;
+  std::string remoteAddr;
+  uint16_t remotePort;
+  CPPUNIT_ASSERT(b.popAcceptedConnection(accepted, remoteAddr, remotePort));
+
+  // Larger than the window of the connection and the buffer of the
+  // socket.
+  std::string data;
+  for (size_t i = 0; i < 3_m; ++i) {
+    data += static_cast<char>(i * 7 % 251);
+  }
+  std::string received;
+  size_t written = 0;
+  for (int i = 0; i < 10000 && received.size() < data.size(); ++i) {
+    if (written < data.size()) {
+      written += socket->writeData(data.data() + written,
+                                   std::min<size_t>(data.size() - written,
+                                                    64_k));
+    }
+    run(a, b, at(i));
+    received += readAll(accepted);
+  }
+  CPPUNIT_ASSERT(data == received);
+
+  accepted->writeData("hello");
+  run(a, b, at(20000));
+  CPPUNIT_ASSERT_EQUAL(std::string("hello"), readAll(socket));
+}
+
+void UtpSocketManagerTest::testClose()
+{
+  UtpSocketManager a, b;
+  auto socket = a.connect("127.0.0.1", 6882, at(0));
+  run(a, b, at(0));
+  std::shared_ptr<SocketCore> accepted;
+  std::string remoteAddr;
+  uint16_t remotePort;
+  CPPUNIT_ASSERT(b.popAcceptedConnection(accepted, remoteAddr, remotePort));
+  socket->writeData("bye");
+  socket.reset();
+  run(a, b, at(1));
+  CPPUNIT_ASSERT_EQUAL(std::string("bye"), readAll(accepted));
+  // End of file
+  char buf[4];
+  size_t len = sizeof(buf);
+  accepted->readData(buf, len);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, len);
+  CPPUNIT_ASSERT(!accepted->wantRead());
+  accepted.reset();
+  run(a, b, at(2));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, a.countConnection());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, b.countConnection());
+}
+
+void UtpSocketManagerTest::testReset()
+{
+  UtpSocketManager a, b;
+  auto socket = a.connect("127.0.0.1", 6882, at(0));
+  run(a, b, at(0));
+  CPPUNIT_ASSERT_EQUAL(UTP_CS_CONNECTED, a.getConnectionState(socket));
+  // b is restarted and does not know the connection.
+  UtpSocketManager c;
+  socket->writeData("hello");
+  a.process(at(1));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, transfer(a, 6881, c, 6882, at(1)));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, transfer(c, 6882, a, 6881, at(1)));
+  a.process(at(1));
+  CPPUNIT_ASSERT_EQUAL(UTP_CS_CLOSED, a.getConnectionState(socket));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, a.countConnection());
+  // The application sees the end of file.
+  char buf[4];
+  size_t len = sizeof(buf);
+  socket->readData(buf, len);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, len);
+  CPPUNIT_ASSERT(!socket->wantRead());
+}
+
+} // namespace aria2
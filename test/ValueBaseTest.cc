@@ -97,6 +97,10 @@ void ValueBaseTest::testDict()
   CPPUNIT_ASSERT(dict.containsKey("ks"));
   CPPUNIT_ASSERT_EQUAL(std::string("abc"), downcast<String>(dict["ks"])->s());
 
+  dict.put("ks", String::g("def"));
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), dict.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("def"), downcast<String>(dict["ks"])->s());
+
   CPPUNIT_ASSERT(!dict["kn"]); // This does not adds kn key
   CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), dict.size());
 
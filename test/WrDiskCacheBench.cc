@@ -0,0 +1,85 @@
+// Benchmark of WrDiskCache receiving 16KiB blocks for 32 pieces at a
+// time.  The data is discarded instead of being written to the disk.
+#include "Bench.h"
+
+#include <cstring>
+#include <vector>
+
+#include "WrDiskCache.h"
+#include "WrDiskCacheEntry.h"
+#include "Piece.h"
+#include "DirectDiskAdaptor.h"
+#include "DiskWriter.h"
+
+namespace aria2 {
+
+namespace bench {
+
+namespace {
+
+class NullDiskWriter : public DiskWriter {
+public:
+  virtual void initAndOpenFile(int64_t totalLength = 0) CXX11_OVERRIDE {}
+  virtual void openFile(int64_t totalLength = 0) CXX11_OVERRIDE {}
+  virtual void closeFile() CXX11_OVERRIDE {}
+  virtual void openExistingFile(int64_t totalLength = 0) CXX11_OVERRIDE {}
+  virtual int64_t size() CXX11_OVERRIDE { return 0; }
+  virtual void writeData(const unsigned char* data, size_t len,
+                         int64_t offset) CXX11_OVERRIDE
+  {
+  }
+  virtual ssize_t readData(unsigned char* data, size_t len,
+                           int64_t offset) CXX11_OVERRIDE
+  {
+    return 0;
+  }
+};
+
+} // namespace
+
+void wrDiskCache()
+{
+  if (!selected("WrDiskCache/")) {
+    return;
+  }
+  const size_t pieceLength = 1_m;
+  const size_t blockLength = 16_k;
+  const size_t numActive = 32;
+  auto adaptor = std::make_shared<DirectDiskAdaptor>();
+  adaptor->setDiskWriter(make_unique<NullDiskWriter>());
+  WrDiskCache cache(16_m);
+  std::vector<unsigned char> block(blockLength, 'x');
+  std::vector<std::unique_ptr<Piece>> pieces(numActive);
+  std::vector<size_t> received(numActive);
+  size_t nextIndex = 0;
+  for (auto& piece : pieces) {
+    piece = make_unique<Piece>(nextIndex++, pieceLength);
+    piece->initWrCache(&cache, adaptor);
+  }
+  size_t i = 0;
+  run("WrDiskCache/update", blockLength, [&] {
+    auto n = i++ % numActive;
+    auto& piece = pieces[n];
+    auto data = new unsigned char[blockLength];
+    memcpy(data, block.data(), blockLength);
+    piece->updateWrCache(&cache, data, 0, blockLength, blockLength,
+                         piece->getIndex() * pieceLength +
+                             received[n] * blockLength);
+    if (++received[n] == pieceLength / blockLength) {
+      piece->flushWrCache(&cache);
+      piece->releaseWrCache(&cache);
+      piece = make_unique<Piece>(nextIndex++, pieceLength);
+      piece->initWrCache(&cache, adaptor);
+      received[n] = 0;
+    }
+    return cache.getSize();
+  });
+  for (auto& piece : pieces) {
+    piece->clearWrCache(&cache);
+    piece->releaseWrCache(&cache);
+  }
+}
+
+} // namespace bench
+
+} // namespace aria2
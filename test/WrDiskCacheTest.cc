@@ -14,6 +14,8 @@ class WrDiskCacheTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(WrDiskCacheTest);
   CPPUNIT_TEST(testAdd);
+  CPPUNIT_TEST(testEnsureLimit_run);
+  CPPUNIT_TEST(testFlush);
   CPPUNIT_TEST_SUITE_END();
 
   std::shared_ptr<DirectDiskAdaptor> adaptor_;
@@ -29,6 +31,8 @@ public:
   }
 
   void testAdd();
+  void testEnsureLimit_run();
+  void testFlush();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(WrDiskCacheTest);
@@ -50,27 +54,110 @@ void WrDiskCacheTest::testAdd()
   WrDiskCacheEntry e3(adaptor_);
   e3.cacheData(createDataCell(10, "hello"));
   CPPUNIT_ASSERT(dc.add(&e3));
-  CPPUNIT_ASSERT_EQUAL((size_t)15, dc.getSize());
-  // e1 is flushed to the disk
-  CPPUNIT_ASSERT_EQUAL(std::string("who knows?"), writer_->getString());
+  CPPUNIT_ASSERT_EQUAL((size_t)10, dc.getSize());
+  // e1 is flushed to the disk, and so is e3 which continues it.
+  CPPUNIT_ASSERT_EQUAL(std::string("who knows?hello"), writer_->getString());
   CPPUNIT_ASSERT_EQUAL((size_t)0, e1.getSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, e3.getSize());
 
   e3.cacheData(createDataCell(15, " world"));
   CPPUNIT_ASSERT(dc.update(&e3, 6));
-
-  // e3 is flushed to the disk
-  CPPUNIT_ASSERT_EQUAL(std::string("who knows?hello world"),
-                       writer_->getString());
-  CPPUNIT_ASSERT_EQUAL((size_t)0, e3.getSize());
-  CPPUNIT_ASSERT_EQUAL((size_t)10, dc.getSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)16, dc.getSize());
 
   e2.cacheData(createDataCell(31, "01234567890"));
   CPPUNIT_ASSERT(dc.update(&e2, 11));
-  // e2 is flushed to the disk
+  // e2 and e3 are flushed to the disk
   CPPUNIT_ASSERT_EQUAL(
       std::string("who knows?hello worldseconddata01234567890"),
       writer_->getString());
   CPPUNIT_ASSERT_EQUAL((size_t)0, e2.getSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, e3.getSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, dc.getSize());
+
+  auto& stat = dc.getStat();
+  CPPUNIT_ASSERT_EQUAL((uint64_t)2, stat.writes);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)4, stat.evictions);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)5, stat.cellsFlushed);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)2, stat.writeCalls);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)42, stat.bytesFlushed);
+}
+
+void WrDiskCacheTest::testEnsureLimit_run()
+{
+  WrDiskCache dc(25);
+  WrDiskCacheEntry e1(adaptor_), e2(adaptor_), e3(adaptor_), e4(adaptor_);
+  CPPUNIT_ASSERT(dc.add(&e1));
+  CPPUNIT_ASSERT(dc.add(&e2));
+  CPPUNIT_ASSERT(dc.add(&e3));
+  CPPUNIT_ASSERT(dc.add(&e4));
+  e2.cacheData(createDataCell(10, "abcdefghij"));
+  CPPUNIT_ASSERT(dc.update(&e2, 10));
+  e1.cacheData(createDataCell(5, "56789"));
+  CPPUNIT_ASSERT(dc.update(&e1, 5));
+  e3.cacheData(createDataCell(20, "klmno"));
+  CPPUNIT_ASSERT(dc.update(&e3, 5));
+  // e4 is not contiguous to e3.
+  e4.cacheData(createDataCell(40, "xyz"));
+  CPPUNIT_ASSERT(dc.update(&e4, 3));
+  CPPUNIT_ASSERT(writer_->getString().empty());
+
+  e4.cacheData(createDataCell(43, "xyz"));
+  CPPUNIT_ASSERT(dc.update(&e4, 3));
+  // e2 is the largest, and e1 and e3 are its neighbours.
+  CPPUNIT_ASSERT_EQUAL(std::string("56789abcdefghijklmno"),
+                       writer_->getString().substr(5));
+  CPPUNIT_ASSERT_EQUAL((size_t)6, dc.getSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)6, e4.getSize());
+
+  auto& stat = dc.getStat();
+  CPPUNIT_ASSERT_EQUAL((uint64_t)3, stat.evictions);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)3, stat.cellsFlushed);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)1, stat.writeCalls);
+
+  e4.clear();
+  CPPUNIT_ASSERT(dc.update(&e4, -6));
+}
+
+void WrDiskCacheTest::testFlush()
+{
+  WrDiskCache dc(100);
+  WrDiskCacheEntry e1(adaptor_), e2(adaptor_);
+  CPPUNIT_ASSERT(dc.add(&e1));
+  CPPUNIT_ASSERT(dc.add(&e2));
+  std::string data = "hello";
+  auto cell = new WrDiskCacheEntry::DataCell();
+  cell->goff = 0;
+  cell->data = new unsigned char[10];
+  cell->offset = 0;
+  cell->len = data.size();
+  cell->capacity = 10;
+  memcpy(cell->data, data.c_str(), data.size());
+  e1.cacheData(cell);
+  CPPUNIT_ASSERT(dc.update(&e1, 5));
+  CPPUNIT_ASSERT_EQUAL((size_t)5,
+                       e1.append(5, reinterpret_cast<const unsigned char*>(
+                                        " world"),
+                                 6));
+  CPPUNIT_ASSERT(dc.merge(&e1, 5));
+  e2.cacheData(createDataCell(10, "!"));
+  CPPUNIT_ASSERT(dc.update(&e2, 1));
+  CPPUNIT_ASSERT_EQUAL((size_t)11, dc.getSize());
+
+  CPPUNIT_ASSERT(dc.flush(&e1));
+  // Only e1 is flushed.
+  CPPUNIT_ASSERT_EQUAL(std::string("hello worl"), writer_->getString());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, dc.getSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, e1.getSize());
+
+  auto& stat = dc.getStat();
+  CPPUNIT_ASSERT_EQUAL((uint64_t)3, stat.writes);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)1, stat.hits);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)1, stat.flushes);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)0, stat.evictions);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)1, stat.writeCalls);
+
+  CPPUNIT_ASSERT(dc.flush(&e2));
+  CPPUNIT_ASSERT_EQUAL(std::string("hello worl!"), writer_->getString());
   CPPUNIT_ASSERT_EQUAL((size_t)0, dc.getSize());
 }
 
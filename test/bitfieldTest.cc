@@ -1,5 +1,8 @@
 #include "bitfield.h"
 
+#include <random>
+#include <vector>
+
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "TimerA2.h"
@@ -13,6 +16,8 @@ class bitfieldTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testCountBit32);
   CPPUNIT_TEST(testCountSetBit);
   CPPUNIT_TEST(testLastByteMask);
+  CPPUNIT_TEST(testGetFirstNSetBitIndex);
+  CPPUNIT_TEST(testKernels);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -21,6 +26,8 @@ public:
   void testCountBit32();
   void testCountSetBit();
   void testLastByteMask();
+  void testGetFirstNSetBitIndex();
+  void testKernels();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(bitfieldTest);
@@ -71,4 +78,103 @@ void bitfieldTest::testLastByteMask()
                        (unsigned int)bitfield::lastByteMask(16));
 }
 
+void bitfieldTest::testGetFirstNSetBitIndex()
+{
+  unsigned char bitfield[] = {0x00, 0x41, 0x00, 0xff};
+  size_t index;
+  CPPUNIT_ASSERT(bitfield::getFirstSetBitIndex(index, bitfield, 32));
+  CPPUNIT_ASSERT_EQUAL((size_t)9, index);
+  std::vector<size_t> out;
+  CPPUNIT_ASSERT_EQUAL((size_t)3,
+                       bitfield::getFirstNSetBitIndex(std::back_inserter(out),
+                                                      3, bitfield, 32));
+  CPPUNIT_ASSERT_EQUAL((size_t)24, out[2]);
+  out.clear();
+  // Bits beyond nbits are ignored.
+  CPPUNIT_ASSERT_EQUAL((size_t)3,
+                       bitfield::getFirstNSetBitIndex(std::back_inserter(out),
+                                                      10, bitfield, 25));
+  CPPUNIT_ASSERT_EQUAL((size_t)24, out[2]);
+  CPPUNIT_ASSERT(!bitfield::getFirstSetBitIndex(index, bitfield, 9));
+}
+
+namespace {
+std::vector<unsigned char> randomBitfield(std::mt19937& rng, size_t len,
+                                          int density)
+{
+  std::vector<unsigned char> v(len);
+  for (auto& c : v) {
+    for (int i = 0; i < 8; ++i) {
+      c = (c << 1) | (static_cast<int>(rng() % 100) < density);
+    }
+  }
+  return v;
+}
+} // namespace
+
+void bitfieldTest::testKernels()
+{
+  auto orig = bitfield::getKernel();
+  std::mt19937 rng(0);
+  for (auto kernel : {bitfield::KERNEL_WORD, bitfield::KERNEL_VEC128,
+                      bitfield::KERNEL_AVX2}) {
+    if (!bitfield::setKernel(kernel)) {
+      continue;
+    }
+    CPPUNIT_ASSERT_EQUAL(kernel, bitfield::getKernel());
+    for (size_t nbits : {0, 1, 63, 64, 127, 255, 256, 1000, 4099}) {
+      size_t len = (nbits + 7) / 8;
+      // The bits beyond nbits are random, too.
+      auto have = randomBitfield(rng, len, 95);
+      auto use = randomBitfield(rng, len, 50);
+      auto peer = randomBitfield(rng, len, 50);
+      auto filter = randomBitfield(rng, len, 90);
+      std::vector<size_t> expected;
+      size_t count = 0, countAnd = 0;
+      for (size_t i = 0; i < nbits; ++i) {
+        count += bitfield::test(use, nbits, i);
+        countAnd +=
+            bitfield::test(use, nbits, i) && bitfield::test(peer, nbits, i);
+      }
+      CPPUNIT_ASSERT_EQUAL(count, bitfield::countSetBit(use.data(), nbits));
+      CPPUNIT_ASSERT_EQUAL(countAnd, bitfield::countSetBitAnd(
+                                         use.data(), peer.data(), nbits));
+      for (int ops = 0; ops < 8; ++ops) {
+        auto u = ops & 1 ? use.data() : nullptr;
+        auto p = ops & 2 ? peer.data() : nullptr;
+        auto f = ops & 4 ? filter.data() : nullptr;
+        std::vector<unsigned char> ref(len), dst(len, 0xff);
+        std::vector<size_t> indexes;
+        for (size_t i = 0; i < nbits; ++i) {
+          if (!bitfield::test(have, nbits, i) &&
+              (!u || !bitfield::test(use, nbits, i)) &&
+              (!p || bitfield::test(peer, nbits, i)) &&
+              (!f || bitfield::test(filter, nbits, i))) {
+            ref[i / 8] |= 128 >> (i % 8);
+            indexes.push_back(i);
+          }
+        }
+        bool any = !indexes.empty();
+        CPPUNIT_ASSERT_EQUAL(any, bitfield::getMissing(dst.data(), have.data(),
+                                                       u, p, f, nbits));
+        CPPUNIT_ASSERT(ref == dst);
+        CPPUNIT_ASSERT_EQUAL(
+            any, bitfield::getMissing(nullptr, have.data(), u, p, f, nbits));
+        if (p) {
+          continue;
+        }
+        for (size_t n : {1, 3, 1000}) {
+          std::vector<size_t> out(n);
+          size_t found = bitfield::getFirstNMissingIndex(
+              out.data(), n, have.data(), u, f, nbits);
+          CPPUNIT_ASSERT_EQUAL(std::min(n, indexes.size()), found);
+          out.resize(found);
+          CPPUNIT_ASSERT(std::equal(out.begin(), out.end(), indexes.begin()));
+        }
+      }
+    }
+  }
+  bitfield::setKernel(orig);
+}
+
 } // namespace aria2